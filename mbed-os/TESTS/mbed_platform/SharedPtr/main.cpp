@@ -108,6 +108,47 @@ void test_equality_comparators()
     TEST_ASSERT_TRUE(s_ptr1_1 != s_ptr2); // Shared pointer / Shared pointer
 }
 
+/**
+ * Test that make_shared constructs the object and manages its lifetime
+ */
+void test_make_shared()
+{
+    TEST_ASSERT_EQUAL(0, TestStruct::s_count);
+
+    {
+        SharedPtr<TestStruct> s_ptr1 = mbed::make_shared<TestStruct>();
+        TEST_ASSERT_EQUAL(1, TestStruct::s_count);
+        TEST_ASSERT_EQUAL(42, s_ptr1->value);
+
+        SharedPtr<TestStruct> s_ptr2 = s_ptr1;
+        TEST_ASSERT_EQUAL(2, s_ptr1.use_count());
+        TEST_ASSERT_EQUAL(1, TestStruct::s_count);
+    }
+
+    TEST_ASSERT_EQUAL(0, TestStruct::s_count);
+}
+
+/**
+ * Test that a weak pointer does not keep the object alive,
+ * and can be locked only while it exists
+ */
+void test_weak_pointer()
+{
+    WeakPtr<TestStruct> w_ptr;
+
+    {
+        SharedPtr<TestStruct> s_ptr(new TestStruct);
+        w_ptr = WeakPtr<TestStruct>(s_ptr);
+        TEST_ASSERT_FALSE(w_ptr.expired());
+        TEST_ASSERT_TRUE(w_ptr.lock() == s_ptr);
+        TEST_ASSERT_EQUAL(1, s_ptr.use_count());
+    }
+
+    TEST_ASSERT_EQUAL(0, TestStruct::s_count);
+    TEST_ASSERT_TRUE(w_ptr.expired());
+    TEST_ASSERT_FALSE(w_ptr.lock());
+}
+
 utest::v1::status_t test_setup(const size_t number_of_cases)
 {
     GREENTEA_SETUP(10, "default_auto");
@@ -117,7 +158,9 @@ utest::v1::status_t test_setup(const size_t number_of_cases)
 Case cases[] = {
     Case("Test single shared pointer instance", test_single_sharedptr_lifetime),
     Case("Test instance sharing across multiple shared pointers", test_instance_sharing),
-    Case("Test equality comparators", test_equality_comparators)
+    Case("Test equality comparators", test_equality_comparators),
+    Case("Test make_shared", test_make_shared),
+    Case("Test weak pointer", test_weak_pointer)
 };
 
 utest::v1::Specification specification(test_setup, cases);
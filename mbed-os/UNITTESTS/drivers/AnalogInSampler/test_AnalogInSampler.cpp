@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/AnalogInSampler.h"
+#include "platform/mbed_thread.h"
+
+#include <string.h>
+#include <utility>
+#include <vector>
+
+using namespace mbed;
+
+/* Simulated ADC HAL: each conversion returns the next value of a ramp */
+static uint16_t next_value;
+static int conversions;
+
+static bool hardware_supported;
+static struct {
+    uint16_t *buffer;
+    size_t count;
+    uint32_t period_us;
+    bool circular;
+    analogin_sample_handler_t handler;
+    void *context;
+    int starts;
+    int stops;
+} hardware;
+
+extern "C" {
+
+void analogin_init(analogin_t *obj, PinName pin)
+{
+}
+
+void analogin_init_direct(analogin_t *obj, const PinMap *pinmap)
+{
+}
+
+uint16_t analogin_read_u16(analogin_t *obj)
+{
+    conversions++;
+    return next_value++;
+}
+
+float analogin_read(analogin_t *obj)
+{
+    return analogin_read_u16(obj) / 65535.0f;
+}
+
+bool analogin_sample_start(analogin_t *obj, uint16_t *buffer, size_t count, uint32_t period_us, bool circular,
+                           analogin_sample_handler_t handler, void *context)
+{
+    if (!hardware_supported) {
+        return false;
+    }
+    hardware.buffer = buffer;
+    hardware.count = count;
+    hardware.period_us = period_us;
+    hardware.circular = circular;
+    hardware.handler = handler;
+    hardware.context = context;
+    hardware.starts++;
+    return true;
+}
+
+void analogin_sample_stop(analogin_t *obj)
+{
+    hardware.stops++;
+}
+
+}
+
+/* Samples are taken while the caller waits */
+void thread_sleep_for(uint32_t millisec)
+{
+    Ticker *ticker = Ticker::last_attached();
+    if (ticker != NULL) {
+        ticker->expire();
+    }
+}
+
+/* Counts the locks taken by the driver */
+class CountingSampler : public AnalogInSampler {
+public:
+    CountingSampler() : AnalogInSampler(PTC0), locks(0)
+    {
+    }
+
+    int locks;
+
+protected:
+    virtual void lock()
+    {
+        locks++;
+        AnalogInSampler::lock();
+    }
+};
+
+static std::vector<std::pair<const uint16_t *, size_t> > blocks;
+static AnalogInSampler *stop_in_callback;
+
+static void on_samples(const uint16_t *samples, size_t count)
+{
+    blocks.push_back(std::make_pair(samples, count));
+    if (stop_in_callback) {
+        stop_in_callback->stop();
+    }
+}
+
+class TestAnalogInSampler : public testing::Test {
+protected:
+    void SetUp()
+    {
+        next_value = 0;
+        conversions = 0;
+        hardware_supported = false;
+        memset(&hardware, 0, sizeof hardware);
+        blocks.clear();
+        stop_in_callback = NULL;
+        Ticker::last_attached() = NULL;
+    }
+
+    void tick(int count)
+    {
+        Ticker *ticker = Ticker::last_attached();
+        ASSERT_TRUE(ticker != NULL);
+        for (int i = 0; i < count; i++) {
+            ticker->expire();
+        }
+    }
+};
+
+TEST_F(TestAnalogInSampler, block)
+{
+    AnalogInSampler adc(PTC0);
+    uint16_t buffer[8];
+
+    EXPECT_EQ(0, adc.sample(buffer, 8, 100, on_samples));
+    EXPECT_TRUE(adc.sampling());
+    Ticker *ticker = Ticker::last_attached();
+    EXPECT_EQ(100u, ticker->interval());
+
+    tick(7);
+    EXPECT_TRUE(blocks.empty());
+    tick(1);
+    ASSERT_EQ(1u, blocks.size());
+    EXPECT_EQ(buffer, blocks[0].first);
+    EXPECT_EQ(8u, blocks[0].second);
+    EXPECT_FALSE(adc.sampling());
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(i, buffer[i]);
+    }
+
+    // The ticker is detached once the block is full
+    EXPECT_TRUE(Ticker::last_attached() == NULL);
+    ticker->expire();
+    EXPECT_EQ(8, conversions);
+}
+
+TEST_F(TestAnalogInSampler, invalid_and_busy)
+{
+    AnalogInSampler adc(PTC0);
+    uint16_t buffer[8];
+
+    EXPECT_EQ(-1, adc.sample(NULL, 8, 100, on_samples));
+    EXPECT_EQ(-1, adc.sample(buffer, 0, 100, on_samples));
+    EXPECT_EQ(-1, adc.sample(buffer, 8, 0, on_samples));
+    EXPECT_EQ(-1, adc.sample_continuous(buffer, 7, 100, on_samples));
+    EXPECT_FALSE(adc.sampling());
+
+    EXPECT_EQ(0, adc.sample(buffer, 8, 100, on_samples));
+    EXPECT_EQ(-1, adc.sample(buffer, 8, 100, on_samples));
+    EXPECT_EQ(-1, adc.sample_continuous(buffer, 8, 100, on_samples));
+
+    adc.stop();
+    EXPECT_FALSE(adc.sampling());
+    EXPECT_EQ(0, adc.sample_continuous(buffer, 8, 100, on_samples));
+}
+
+TEST_F(TestAnalogInSampler, continuous)
+{
+    AnalogInSampler adc(PTC0);
+    uint16_t buffer[8];
+
+    EXPECT_EQ(0, adc.sample_continuous(buffer, 8, 50, on_samples));
+    EXPECT_EQ(50u, Ticker::last_attached()->interval());
+
+    tick(4);
+    ASSERT_EQ(1u, blocks.size());
+    EXPECT_EQ(buffer, blocks[0].first);
+    EXPECT_EQ(4u, blocks[0].second);
+
+    tick(4);
+    ASSERT_EQ(2u, blocks.size());
+    EXPECT_EQ(buffer + 4, blocks[1].first);
+    EXPECT_EQ(4u, blocks[1].second);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(i, buffer[i]);
+    }
+
+    // Sampling wraps around to the first half
+    tick(5);
+    ASSERT_EQ(3u, blocks.size());
+    EXPECT_EQ(buffer, blocks[2].first);
+    EXPECT_EQ(8, buffer[0]);
+    EXPECT_EQ(11, buffer[3]);
+    EXPECT_EQ(12, buffer[4]);
+    EXPECT_TRUE(adc.sampling());
+
+    adc.stop();
+    EXPECT_FALSE(adc.sampling());
+    EXPECT_TRUE(Ticker::last_attached() == NULL);
+}
+
+TEST_F(TestAnalogInSampler, stop_in_callback)
+{
+    AnalogInSampler adc(PTC0);
+    uint16_t buffer[8];
+
+    stop_in_callback = &adc;
+    EXPECT_EQ(0, adc.sample_continuous(buffer, 8, 100, on_samples));
+    Ticker *ticker = Ticker::last_attached();
+    tick(4);
+    EXPECT_FALSE(adc.sampling());
+    EXPECT_EQ(1u, blocks.size());
+
+    ticker->expire();
+    EXPECT_EQ(4, conversions);
+}
+
+TEST_F(TestAnalogInSampler, no_lock_per_sample)
+{
+    CountingSampler adc;
+    const int samples = 1000;
+    uint16_t buffer[samples];
+
+    int locks = adc.locks;
+    for (int i = 0; i < samples; i++) {
+        adc.read_u16();
+    }
+    EXPECT_EQ(samples, adc.locks - locks);
+
+    locks = adc.locks;
+    EXPECT_EQ(0, adc.sample(buffer, samples, 200, on_samples));
+    tick(samples);
+    EXPECT_EQ(1u, blocks.size());
+    EXPECT_EQ(0, adc.locks - locks);
+    EXPECT_EQ(2 * samples, conversions);
+}
+
+TEST_F(TestAnalogInSampler, read_waits_for_sampling)
+{
+    AnalogInSampler adc(PTC0);
+    uint16_t buffer[8];
+
+    EXPECT_EQ(0, adc.sample(buffer, 8, 100, on_samples));
+    tick(3);
+    // The ADC is only read once the block is complete
+    EXPECT_EQ(8, adc.read_u16());
+    EXPECT_FALSE(adc.sampling());
+    ASSERT_EQ(1u, blocks.size());
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(i, buffer[i]);
+    }
+}
+
+TEST_F(TestAnalogInSampler, hardware)
+{
+    uint16_t buffer[8];
+    hardware_supported = true;
+    {
+        AnalogInSampler adc(PTC0);
+
+        EXPECT_EQ(0, adc.sample_continuous(buffer, 8, 25, on_samples));
+        EXPECT_EQ(1, hardware.starts);
+        EXPECT_EQ(buffer, hardware.buffer);
+        EXPECT_EQ(8u, hardware.count);
+        EXPECT_EQ(25u, hardware.period_us);
+        EXPECT_TRUE(hardware.circular);
+        EXPECT_TRUE(Ticker::last_attached() == NULL);
+
+        hardware.handler(hardware.context, buffer + 4, 4);
+        ASSERT_EQ(1u, blocks.size());
+        EXPECT_EQ(buffer + 4, blocks[0].first);
+        EXPECT_TRUE(adc.sampling());
+        EXPECT_EQ(0, conversions);
+    }
+    // Sampling is stopped when the sampler is destroyed
+    EXPECT_EQ(1, hardware.stops);
+
+    AnalogInSampler adc(PTC0);
+    EXPECT_EQ(0, adc.sample(buffer, 8, 25, on_samples));
+    EXPECT_FALSE(hardware.circular);
+    hardware.handler(hardware.context, buffer, 8);
+    EXPECT_FALSE(adc.sampling());
+    EXPECT_EQ(2u, blocks.size());
+    adc.stop();
+    EXPECT_EQ(1, hardware.stops);
+}
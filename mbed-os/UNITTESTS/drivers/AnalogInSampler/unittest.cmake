@@ -0,0 +1,30 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "AnalogInSampler")
+
+# Add test specific include paths
+set(unittest-includes ${unittest-includes}
+  .
+  ../hal
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/AnalogIn.cpp
+  ../drivers/source/AnalogInSampler.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/AnalogInSampler/test_AnalogInSampler.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_critical_stub.c
+  stubs/Mutex_stub.cpp
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
+
+# defines
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DDEVICE_ANALOGIN")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DDEVICE_ANALOGIN")
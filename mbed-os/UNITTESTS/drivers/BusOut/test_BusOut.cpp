@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/BusIn.h"
+#include "drivers/BusInOut.h"
+#include "drivers/BusOut.h"
+#include "hal/gpio_api.h"
+#include "hal/port_api.h"
+
+#include <string.h>
+
+using namespace mbed;
+
+/* Mock GPIO HAL: pin n of port p is PinName p * 32 + n */
+#define PIN(port, n) ((PinName)((port) * 32 + (n)))
+
+static const int port_count = 8;
+
+static struct {
+    int gpio_write;
+    int gpio_read;
+    int gpio_dir;
+    int gpio_mode;
+    int port_init;
+    int port_write;
+    int port_read;
+    int port_dir;
+    int port_mode;
+} calls;
+
+static bool lookup_supported;
+static uint32_t levels[port_count];
+static uint32_t outputs[port_count];
+static PinMode modes[port_count * 32];
+
+static void set_dir(int pin, PinDirection direction)
+{
+    if (direction == PIN_OUTPUT) {
+        outputs[pin / 32] |= 1UL << (pin % 32);
+    } else {
+        outputs[pin / 32] &= ~(1UL << (pin % 32));
+    }
+}
+
+static void set_level(int pin, int value)
+{
+    if (value) {
+        levels[pin / 32] |= 1UL << (pin % 32);
+    } else {
+        levels[pin / 32] &= ~(1UL << (pin % 32));
+    }
+}
+
+extern "C" {
+
+int gpio_is_connected(const gpio_t *obj)
+{
+    return obj->unused != (int)NC;
+}
+
+void gpio_init_in(gpio_t *gpio, PinName pin)
+{
+    gpio->unused = pin;
+    set_dir(pin, PIN_INPUT);
+}
+
+void gpio_init_in_ex(gpio_t *gpio, PinName pin, PinMode mode)
+{
+    gpio_init_in(gpio, pin);
+    modes[pin] = mode;
+}
+
+void gpio_init_out(gpio_t *gpio, PinName pin)
+{
+    gpio->unused = pin;
+    set_dir(pin, PIN_OUTPUT);
+}
+
+void gpio_init_out_ex(gpio_t *gpio, PinName pin, int value)
+{
+    gpio_init_out(gpio, pin);
+    set_level(pin, value);
+}
+
+void gpio_init_inout(gpio_t *gpio, PinName pin, PinDirection direction, PinMode mode, int value)
+{
+    gpio->unused = pin;
+    set_dir(pin, direction);
+    modes[pin] = mode;
+    set_level(pin, value);
+}
+
+void gpio_write(gpio_t *obj, int value)
+{
+    calls.gpio_write++;
+    set_level(obj->unused, value);
+}
+
+int gpio_read(gpio_t *obj)
+{
+    calls.gpio_read++;
+    return (levels[obj->unused / 32] >> (obj->unused % 32)) & 1;
+}
+
+void gpio_dir(gpio_t *obj, PinDirection direction)
+{
+    calls.gpio_dir++;
+    set_dir(obj->unused, direction);
+}
+
+void gpio_mode(gpio_t *obj, PinMode mode)
+{
+    calls.gpio_mode++;
+    modes[obj->unused] = mode;
+}
+
+bool port_pin_lookup(PinName pin, PortName *port, int *pin_n)
+{
+    if (!lookup_supported || pin == NC) {
+        return false;
+    }
+    *port = (PortName)(pin / 32);
+    *pin_n = pin % 32;
+    return true;
+}
+
+/* The port name and mask are packed into the port object */
+static int port_of(port_t *obj)
+{
+    return obj->unused & 0xFF;
+}
+
+static uint32_t mask_of(port_t *obj)
+{
+    return (uint32_t)obj->unused >> 8;
+}
+
+void port_init(port_t *obj, PortName port, int mask, PinDirection dir)
+{
+    calls.port_init++;
+    // Masks of the tests fit in the top 24 bits
+    obj->unused = port | (mask << 8);
+    for (int n = 0; n < 24; n++) {
+        if (mask & (1 << n)) {
+            set_dir(port * 32 + n, dir);
+        }
+    }
+}
+
+void port_write(port_t *obj, int value)
+{
+    calls.port_write++;
+    int port = port_of(obj);
+    levels[port] = (levels[port] & ~mask_of(obj)) | (value & mask_of(obj));
+}
+
+int port_read(port_t *obj)
+{
+    calls.port_read++;
+    return levels[port_of(obj)] & mask_of(obj);
+}
+
+void port_dir(port_t *obj, PinDirection dir)
+{
+    calls.port_dir++;
+    for (int n = 0; n < 24; n++) {
+        if (mask_of(obj) & (1UL << n)) {
+            set_dir(port_of(obj) * 32 + n, dir);
+        }
+    }
+}
+
+void port_mode(port_t *obj, PinMode mode)
+{
+    calls.port_mode++;
+    for (int n = 0; n < 24; n++) {
+        if (mask_of(obj) & (1UL << n)) {
+            modes[port_of(obj) * 32 + n] = mode;
+        }
+    }
+}
+
+}
+
+class TestBus : public testing::Test {
+protected:
+    void SetUp()
+    {
+        memset(&calls, 0, sizeof calls);
+        memset(levels, 0, sizeof levels);
+        memset(outputs, 0, sizeof outputs);
+        memset(modes, 0, sizeof modes);
+        lookup_supported = true;
+    }
+};
+
+TEST_F(TestBus, out_one_port)
+{
+    BusOut bus(PIN(0, 0), PIN(0, 1), PIN(0, 2), PIN(0, 3), PIN(0, 4), PIN(0, 5), PIN(0, 6), PIN(0, 7));
+    EXPECT_EQ(1, calls.port_init);
+    EXPECT_EQ(0xFFu, outputs[0]);
+
+    bus = 0xA5;
+    EXPECT_EQ(1, calls.port_write);
+    EXPECT_EQ(0, calls.gpio_write);
+    EXPECT_EQ(0xA5u, levels[0]);
+
+    EXPECT_EQ(0xA5, bus.read());
+    EXPECT_EQ(1, calls.port_read);
+    EXPECT_EQ(0, calls.gpio_read);
+
+    // Bits without a pin are ignored
+    bus = 0x15A;
+    EXPECT_EQ(0x5Au, levels[0]);
+}
+
+TEST_F(TestBus, out_without_lookup)
+{
+    lookup_supported = false;
+    BusOut bus(PIN(0, 0), PIN(0, 1), PIN(0, 2), PIN(0, 3), PIN(0, 4), PIN(0, 5), PIN(0, 6), PIN(0, 7));
+    EXPECT_EQ(0, calls.port_init);
+
+    bus = 0xA5;
+    EXPECT_EQ(0, calls.port_write);
+    EXPECT_EQ(8, calls.gpio_write);
+    EXPECT_EQ(0xA5u, levels[0]);
+
+    EXPECT_EQ(0xA5, bus.read());
+    EXPECT_EQ(8, calls.gpio_read);
+}
+
+TEST_F(TestBus, out_shifted_ports)
+{
+    // Bus bits 0-3 are bits 4-7 of port 1, bus bits 4-7 are bits 0-3 of port 2
+    BusOut bus(PIN(1, 4), PIN(1, 5), PIN(1, 6), PIN(1, 7), PIN(2, 0), PIN(2, 1), PIN(2, 2), PIN(2, 3));
+    EXPECT_EQ(2, calls.port_init);
+
+    levels[1] = 0x0F;
+    levels[2] = 0xF0;
+    bus = 0x3C;
+    EXPECT_EQ(2, calls.port_write);
+    EXPECT_EQ(0, calls.gpio_write);
+    EXPECT_EQ(0xCFu, levels[1]);
+    EXPECT_EQ(0xF3u, levels[2]);
+
+    EXPECT_EQ(0x3C, bus.read());
+    EXPECT_EQ(2, calls.port_read);
+}
+
+TEST_F(TestBus, out_scrambled_pins)
+{
+    // Bus bits in reverse order, with a pin not connected
+    PinName pins[16] = { PIN(3, 7), PIN(3, 6), NC, PIN(3, 4), PIN(3, 3), PIN(3, 2), PIN(3, 1), PIN(3, 0),
+                         NC, NC, NC, NC, NC, NC, NC, NC
+                       };
+    BusOut bus(pins);
+    EXPECT_EQ(1, calls.port_init);
+    EXPECT_EQ(0xFB, bus.mask());
+
+    bus = 0x81;
+    EXPECT_EQ(1, calls.port_write);
+    EXPECT_EQ(0x81u, levels[3]);
+
+    bus = 0x06;
+    EXPECT_EQ(0x40u, levels[3]);
+    EXPECT_EQ(0x02, bus.read());
+}
+
+TEST_F(TestBus, out_too_many_ports)
+{
+    BusOut bus(PIN(0, 0), PIN(1, 0), PIN(2, 0), PIN(3, 0), PIN(4, 0));
+    EXPECT_EQ(0, calls.port_init);
+
+    bus = 0x15;
+    EXPECT_EQ(0, calls.port_write);
+    EXPECT_EQ(5, calls.gpio_write);
+    EXPECT_EQ(1u, levels[0]);
+    EXPECT_EQ(0u, levels[1]);
+    EXPECT_EQ(1u, levels[2]);
+    EXPECT_EQ(0u, levels[3]);
+    EXPECT_EQ(1u, levels[4]);
+}
+
+TEST_F(TestBus, in_read_and_mode)
+{
+    BusIn bus(PIN(5, 8), PIN(5, 9), PIN(5, 10), PIN(5, 11), PIN(6, 0), PIN(6, 1));
+    EXPECT_EQ(2, calls.port_init);
+    EXPECT_EQ(0u, outputs[5]);
+
+    levels[5] = 0xA00;
+    levels[6] = 0x3;
+    EXPECT_EQ(0x3A, bus.read());
+    EXPECT_EQ(2, calls.port_read);
+    EXPECT_EQ(0, calls.gpio_read);
+
+    bus.mode(PullDown);
+    EXPECT_EQ(2, calls.port_mode);
+    EXPECT_EQ(0, calls.gpio_mode);
+    EXPECT_EQ(PullDown, modes[PIN(5, 11)]);
+    EXPECT_EQ(PullDown, modes[PIN(6, 1)]);
+}
+
+TEST_F(TestBus, inout_direction)
+{
+    BusInOut bus(PIN(7, 0), PIN(7, 1), PIN(7, 2), PIN(7, 3));
+    EXPECT_EQ(1, calls.port_init);
+    EXPECT_EQ(0u, outputs[7]);
+
+    bus.output();
+    EXPECT_EQ(1, calls.port_dir);
+    EXPECT_EQ(0, calls.gpio_dir);
+    EXPECT_EQ(0xFu, outputs[7]);
+
+    bus = 0x9;
+    EXPECT_EQ(1, calls.port_write);
+    EXPECT_EQ(0x9u, levels[7]);
+
+    bus.input();
+    bus.mode(PullUp);
+    EXPECT_EQ(2, calls.port_dir);
+    EXPECT_EQ(1, calls.port_mode);
+    EXPECT_EQ(0u, outputs[7]);
+
+    levels[7] = 0x6;
+    EXPECT_EQ(0x6, bus.read());
+    EXPECT_EQ(1, calls.port_read);
+    EXPECT_EQ(0, calls.gpio_write + calls.gpio_read + calls.gpio_dir + calls.gpio_mode);
+}
+
+TEST_F(TestBus, inout_without_lookup)
+{
+    lookup_supported = false;
+    BusInOut bus(PIN(7, 0), PIN(7, 1), PIN(7, 2), PIN(7, 3));
+
+    bus.output();
+    bus = 0x9;
+    bus.input();
+    EXPECT_EQ(8, calls.gpio_dir);
+    EXPECT_EQ(4, calls.gpio_write);
+    EXPECT_EQ(0x9, bus.read());
+    EXPECT_EQ(4, calls.gpio_read);
+    EXPECT_EQ(0, calls.port_init + calls.port_write + calls.port_read + calls.port_dir);
+}
@@ -0,0 +1,35 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "BusOut")
+
+# Add test specific include paths
+set(unittest-includes ${unittest-includes}
+  .
+  ../hal
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/BusIn.cpp
+  ../drivers/source/BusInOut.cpp
+  ../drivers/source/BusOut.cpp
+  ../drivers/source/BusPorts.cpp
+  ../drivers/source/DigitalIn.cpp
+  ../drivers/source/DigitalInOut.cpp
+  ../drivers/source/DigitalOut.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/BusOut/test_BusOut.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_critical_stub.c
+  stubs/Mutex_stub.cpp
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
+
+# defines
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DDEVICE_PORTIN -DDEVICE_PORTOUT -DDEVICE_PORTINOUT")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DDEVICE_PORTIN -DDEVICE_PORTOUT -DDEVICE_PORTINOUT")
@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/I2C.h"
+#include "platform/mbed_critical.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace mbed;
+
+typedef std::chrono::steady_clock Clock;
+
+/* Mock I2C HAL. Slaves at 8-bit addresses 0x90 to 0x9E hold 256 registers,
+ * where register r of slave a holds a ^ r. The first byte written selects
+ * the register, reads and further writes carry on from it.
+ *
+ * The bus is logged as text: "S" start, "Sr" repeated start, the address,
+ * "w" and the bytes written, "r" and the number of bytes read, "N" for a
+ * nack and "P" for a stop. */
+static std::string bus;
+static bool bus_open;
+static uint8_t registers[16][256];
+static uint8_t register_index[16];
+
+static struct {
+    bool active;
+    const char *tx;
+    size_t tx_length;
+    char *rx;
+    size_t rx_length;
+    uint32_t address;
+    uint32_t stop;
+    int transfers;
+    Clock::time_point started;
+    Clock::time_point completed;
+    Clock::duration idle;
+} async;
+
+static void log_bus(const char *format, int value)
+{
+    char text[8];
+    snprintf(text, sizeof text, format, value);
+    bus += text;
+}
+
+static void bus_stop()
+{
+    if (bus_open) {
+        bus += "P ";
+        bus_open = false;
+    }
+}
+
+static uint8_t *bus_start(int address)
+{
+    bus += bus_open ? "Sr " : "S ";
+    bus_open = true;
+    log_bus("%02x ", address);
+    if ((address & 0xF0) != 0x90) {
+        bus += "N ";
+        bus_stop();
+        return NULL;
+    }
+    return registers[(address >> 1) & 0x7];
+}
+
+static bool bus_write(int address, const char *data, int length)
+{
+    uint8_t *slave = bus_start(address & ~1);
+    if (!slave) {
+        return false;
+    }
+    uint8_t &index = register_index[(address >> 1) & 0x7];
+    bus += "w ";
+    for (int i = 0; i < length; i++) {
+        log_bus("%02x ", (uint8_t)data[i]);
+        if (i == 0) {
+            index = data[i];
+        } else {
+            slave[index++] = data[i];
+        }
+    }
+    return true;
+}
+
+static bool bus_read(int address, char *data, int length)
+{
+    uint8_t *slave = bus_start(address | 1);
+    if (!slave) {
+        return false;
+    }
+    uint8_t &index = register_index[(address >> 1) & 0x7];
+    log_bus("r %d ", length);
+    for (int i = 0; i < length; i++) {
+        data[i] = slave[index++];
+    }
+    return true;
+}
+
+extern "C" {
+
+int gpio_is_connected(const gpio_t *obj)
+{
+    return 1;
+}
+
+void gpio_init_inout(gpio_t *gpio, PinName pin, PinDirection direction, PinMode mode, int value)
+{
+}
+
+int gpio_read(gpio_t *obj)
+{
+    return 1;
+}
+
+void gpio_write(gpio_t *obj, int value)
+{
+}
+
+void gpio_dir(gpio_t *obj, PinDirection direction)
+{
+}
+
+void gpio_mode(gpio_t *obj, PinMode mode)
+{
+}
+
+void i2c_init(i2c_t *obj, PinName sda, PinName scl)
+{
+}
+
+void i2c_init_direct(i2c_t *obj, const i2c_pinmap_t *pinmap)
+{
+}
+
+void i2c_frequency(i2c_t *obj, int hz)
+{
+}
+
+int i2c_start(i2c_t *obj)
+{
+    return 0;
+}
+
+int i2c_stop(i2c_t *obj)
+{
+    bus_stop();
+    return 0;
+}
+
+int i2c_read(i2c_t *obj, int address, char *data, int length, int stop)
+{
+    if (!bus_read(address, data, length)) {
+        return I2C_ERROR_NO_SLAVE;
+    }
+    if (stop) {
+        bus_stop();
+    }
+    return length;
+}
+
+int i2c_write(i2c_t *obj, int address, const char *data, int length, int stop)
+{
+    if (!bus_write(address, data, length)) {
+        return I2C_ERROR_NO_SLAVE;
+    }
+    if (stop) {
+        bus_stop();
+    }
+    return length;
+}
+
+int i2c_byte_read(i2c_t *obj, int last)
+{
+    return 0;
+}
+
+int i2c_byte_write(i2c_t *obj, int data)
+{
+    return 1;
+}
+
+void i2c_transfer_asynch(i2c_t *obj, const void *tx, size_t tx_length, void *rx, size_t rx_length, uint32_t address, uint32_t stop, uint32_t handler, uint32_t event, DMAUsage hint)
+{
+    async.started = Clock::now();
+    async.idle = async.started - async.completed;
+    async.active = true;
+    async.tx = (const char *)tx;
+    async.tx_length = tx_length;
+    async.rx = (char *)rx;
+    async.rx_length = rx_length;
+    async.address = address;
+    async.stop = stop;
+    async.transfers++;
+}
+
+/* Runs the whole async transfer */
+uint32_t i2c_irq_handler_asynch(i2c_t *obj)
+{
+    uint32_t event = I2C_EVENT_TRANSFER_COMPLETE;
+    async.active = false;
+    if (async.tx_length && !bus_write(async.address, async.tx, async.tx_length)) {
+        event = I2C_EVENT_ERROR_NO_SLAVE;
+    } else if (async.rx_length && !bus_read(async.address, async.rx, async.rx_length)) {
+        event = I2C_EVENT_ERROR_NO_SLAVE;
+    } else if (async.stop) {
+        bus_stop();
+    }
+    async.completed = Clock::now();
+    return event;
+}
+
+uint8_t i2c_active(i2c_t *obj)
+{
+    return async.active;
+}
+
+void i2c_abort_asynch(i2c_t *obj)
+{
+    async.active = false;
+    bus_stop();
+}
+
+}
+
+void sleep_manager_lock_deep_sleep(void)
+{
+}
+
+void sleep_manager_unlock_deep_sleep(void)
+{
+}
+
+/* Critical sections exclude the transfer interrupt, which the benchmark runs from another thread */
+static std::recursive_mutex critical;
+
+void core_util_critical_section_enter(void)
+{
+    critical.lock();
+}
+
+void core_util_critical_section_exit(void)
+{
+    critical.unlock();
+}
+
+/* Runs the asynchronous interrupt handler */
+class TestI2CDevice : public I2C {
+public:
+    TestI2CDevice() : I2C(PTC0, PTC1)
+    {
+    }
+
+    void interrupt()
+    {
+        std::lock_guard<std::recursive_mutex> guard(critical);
+        irq_handler_asynch();
+    }
+};
+
+static std::vector<int> events;
+
+static void on_event(int event)
+{
+    events.push_back(event);
+}
+
+class TestI2C : public testing::Test {
+protected:
+    void SetUp()
+    {
+        bus.clear();
+        bus_open = false;
+        memset(&async, 0, sizeof async);
+        for (int slave = 0; slave < 16; slave++) {
+            for (int r = 0; r < 256; r++) {
+                registers[slave][r] = (0x90 + 2 * slave) ^ r;
+            }
+        }
+        memset(register_index, 0, sizeof register_index);
+        events.clear();
+    }
+
+    /* Register read of a slave: register write then repeated start read */
+    static void register_read(I2C::message_t *messages, int address, char *reg, char *data, int length)
+    {
+        messages[0].address = address;
+        messages[0].data = reg;
+        messages[0].length = 1;
+        messages[0].read = false;
+        messages[1].address = address;
+        messages[1].data = data;
+        messages[1].length = length;
+        messages[1].read = true;
+    }
+};
+
+TEST_F(TestI2C, messages)
+{
+    TestI2CDevice i2c;
+    char reg = 0x10;
+    char data[2];
+    I2C::message_t messages[2];
+
+    register_read(messages, 0x92, &reg, data, sizeof data);
+    EXPECT_EQ(2, i2c.transfer(messages, 2));
+    EXPECT_EQ("S 92 w 10 Sr 93 r 2 P ", bus);
+    EXPECT_EQ(0x92 ^ 0x10, (uint8_t)data[0]);
+    EXPECT_EQ(0x92 ^ 0x11, (uint8_t)data[1]);
+}
+
+TEST_F(TestI2C, messages_nack)
+{
+    TestI2CDevice i2c;
+    char reg = 0x10;
+    char data[2];
+    I2C::message_t messages[2];
+
+    register_read(messages, 0x40, &reg, data, sizeof data);
+    EXPECT_EQ(0, i2c.transfer(messages, 2));
+    EXPECT_EQ("S 40 N P ", bus);
+}
+
+TEST_F(TestI2C, async_messages)
+{
+    TestI2CDevice i2c;
+    char write[2] = { 0x20, 0x55 };
+    char reg = 0x20;
+    char data[3];
+    I2C::message_t messages[3];
+
+    messages[0].address = 0x94;
+    messages[0].data = write;
+    messages[0].length = 2;
+    messages[0].read = false;
+    register_read(messages + 1, 0x94, &reg, data, sizeof data);
+
+    EXPECT_EQ(0, i2c.transfer(messages, 3, on_event));
+    EXPECT_EQ(1, async.transfers);
+    EXPECT_EQ(0u, async.stop);
+
+    // Write then register read, as a single transfer of the HAL
+    i2c.interrupt();
+    EXPECT_EQ(2, async.transfers);
+    EXPECT_EQ(1u, async.stop);
+    EXPECT_TRUE(events.empty());
+    i2c.interrupt();
+    EXPECT_EQ("S 94 w 20 55 Sr 94 w 20 Sr 95 r 3 P ", bus);
+    EXPECT_EQ(std::vector<int>({I2C_EVENT_TRANSFER_COMPLETE}), events);
+    EXPECT_EQ(0x55, data[0]);
+    EXPECT_EQ(0x94 ^ 0x21, (uint8_t)data[1]);
+    EXPECT_FALSE(async.active);
+}
+
+TEST_F(TestI2C, async_queue)
+{
+    TestI2CDevice i2c;
+    const int transfers = MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE + 1;
+    char reg = 0x00;
+    char data[transfers][2];
+    I2C::message_t messages[transfers][2];
+
+    for (int i = 0; i < transfers; i++) {
+        register_read(messages[i], 0x90 + 2 * i, &reg, data[i], 2);
+        EXPECT_EQ(0, i2c.transfer(messages[i], 2, on_event));
+    }
+    EXPECT_EQ(1, async.transfers);
+    EXPECT_EQ(-1, i2c.transfer(messages[0], 2, on_event));
+
+    // A single transfer is refused while messages are pending
+    EXPECT_EQ(-1, i2c.transfer(0x90, &reg, 1, data[0], 2, on_event));
+
+    // Each transfer starts from the interrupt completing the previous one
+    for (int i = 0; i < transfers; i++) {
+        i2c.interrupt();
+        EXPECT_EQ(i + 1, (int)events.size());
+        EXPECT_EQ(std::min(i + 2, transfers), async.transfers);
+        EXPECT_EQ((0x90 + 2 * i) ^ 0x00, (uint8_t)data[i][0]);
+    }
+    EXPECT_FALSE(async.active);
+
+    // The queue takes transfers again once they have started
+    EXPECT_EQ(0, i2c.transfer(messages[0], 2, on_event));
+    i2c.interrupt();
+    EXPECT_EQ(transfers + 1, (int)events.size());
+}
+
+TEST_F(TestI2C, async_queue_waits_for_lock)
+{
+    TestI2CDevice i2c;
+    TestI2CDevice other;
+    char reg = 0x00;
+    char data[2][2];
+    I2C::message_t messages[2][2];
+
+    register_read(messages[0], 0x90, &reg, data[0], 2);
+    register_read(messages[1], 0x92, &reg, data[1], 2);
+    EXPECT_EQ(0, i2c.transfer(messages[0], 2, on_event));
+    EXPECT_EQ(0, i2c.transfer(messages[1], 2, on_event));
+
+    // Another thread holds the bus, so the interrupt leaves the queued transfer to it
+    other.lock();
+    other.frequency(400000);
+    i2c.interrupt();
+    EXPECT_EQ(1u, events.size());
+    EXPECT_EQ(1, async.transfers);
+    EXPECT_FALSE(async.active);
+
+    other.unlock();
+    EXPECT_EQ(2, async.transfers);
+    EXPECT_EQ(0x92u, async.address);
+    i2c.interrupt();
+    EXPECT_EQ(2u, events.size());
+    EXPECT_EQ((0x92 ^ 0x00), (uint8_t)data[1][0]);
+}
+
+TEST_F(TestI2C, async_error)
+{
+    TestI2CDevice i2c;
+    char reg = 0x00;
+    char data[2];
+    I2C::message_t failing[4];
+    I2C::message_t next[2];
+
+    register_read(failing, 0x40, &reg, data, 2);
+    register_read(failing + 2, 0x90, &reg, data, 2);
+    register_read(next, 0x92, &reg, data, 2);
+    EXPECT_EQ(0, i2c.transfer(failing, 4, on_event, I2C_EVENT_ALL));
+    EXPECT_EQ(0, i2c.transfer(next, 2, on_event));
+
+    // The failing transfer ends at the nack, and the queued one starts
+    i2c.interrupt();
+    EXPECT_EQ(std::vector<int>({I2C_EVENT_ERROR_NO_SLAVE}), events);
+    EXPECT_EQ(2, async.transfers);
+    EXPECT_EQ(0x92u, async.address);
+    i2c.interrupt();
+    EXPECT_EQ("S 40 N P S 92 w 00 Sr 93 r 2 P ", bus);
+    EXPECT_EQ(2u, events.size());
+}
+
+static std::mutex done_mutex;
+static std::condition_variable done_signal;
+static int done;
+
+static void signal_done(int event)
+{
+    std::lock_guard<std::mutex> guard(done_mutex);
+    done++;
+    done_signal.notify_one();
+}
+
+/* Bus idle time while polling 8 slaves, with a thread starting each transfer
+ * once the previous one completes, and with the queue. Each transfer takes
+ * 50us of bus time, about 3 bytes at 400kHz. The idle time of a poll is the
+ * sum of the times from the end of a transfer to the start of the next. */
+static long long percentile(std::vector<long long> values, int percent)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() * percent / 100];
+}
+
+TEST_F(TestI2C, idle_time_benchmark)
+{
+    const int devices = 8;
+    const int rounds = 200;
+    const Clock::duration transfer_time = std::chrono::microseconds(50);
+    TestI2CDevice i2c;
+    char reg = 0x00;
+    char data[devices][2];
+    I2C::message_t messages[devices][2];
+    for (int i = 0; i < devices; i++) {
+        register_read(messages[i], 0x90 + 2 * i, &reg, data[i], 2);
+    }
+
+    std::atomic<bool> running(true);
+    std::vector<long long> idle;
+    Clock::duration poll_idle;
+    int completions = 0;
+
+    // The bus completes each transfer once its bus time has elapsed
+    std::thread bus_thread([&]() {
+        while (running) {
+            bool completed = false;
+            {
+                std::lock_guard<std::recursive_mutex> guard(critical);
+                if (async.active && Clock::now() - async.started >= transfer_time) {
+                    if (completions % devices == 0) {
+                        poll_idle = Clock::duration::zero();
+                    } else {
+                        poll_idle += async.idle;
+                    }
+                    i2c.interrupt();
+                    completed = true;
+                    if (++completions % devices == 0) {
+                        idle.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(poll_idle).count());
+                    }
+                }
+            }
+            if (!completed) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    done = 0;
+
+    // One transfer at a time: the thread waits for each to complete
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < devices; i++) {
+            int expected = done + 1;
+            ASSERT_EQ(0, i2c.transfer(0x90 + 2 * i, &reg, 1, data[i], 2, signal_done, I2C_EVENT_ALL, false));
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done_signal.wait(lock, [&]() {
+                return done == expected;
+            });
+        }
+    }
+    std::vector<long long> single;
+    {
+        std::lock_guard<std::recursive_mutex> guard(critical);
+        single.swap(idle);
+    }
+
+    // Queued: the thread queues all slaves, transfers follow each other from the interrupt
+    for (int round = 0; round < rounds; round++) {
+        int expected;
+        {
+            std::lock_guard<std::mutex> guard(done_mutex);
+            expected = done + devices;
+        }
+        for (int i = 0; i < devices; i++) {
+            while (i2c.transfer(messages[i], 2, signal_done, I2C_EVENT_ALL) != 0) {
+                std::this_thread::yield();
+            }
+        }
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_signal.wait(lock, [&]() {
+            return done == expected;
+        });
+    }
+    running = false;
+    bus_thread.join();
+
+    std::cout << "[          ] poll of " << devices << " slaves, one transfer at a time: bus idle median "
+              << percentile(single, 50) << " ns, 99th percentile " << percentile(single, 99) << " ns" << std::endl;
+    std::cout << "[          ] poll of " << devices << " slaves, queued: bus idle median "
+              << percentile(idle, 50) << " ns, 99th percentile " << percentile(idle, 99) << " ns" << std::endl;
+    EXPECT_EQ(rounds, (int)single.size());
+    EXPECT_EQ(rounds, (int)idle.size());
+}
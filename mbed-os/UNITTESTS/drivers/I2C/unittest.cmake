@@ -0,0 +1,30 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "I2C")
+
+# Add test specific include paths
+set(unittest-includes ${unittest-includes}
+  .
+  ../hal
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/DigitalInOut.cpp
+  ../drivers/source/I2C.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/I2C/test_I2C.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_wait_api_stub.cpp
+  stubs/Mutex_stub.cpp
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
+
+# defines
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DDEVICE_I2C -DDEVICE_I2C_ASYNCH")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DDEVICE_I2C -DDEVICE_I2C_ASYNCH")
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/InterruptInRecorder.h"
+#include "events/EventQueue.h"
+#include "hal/us_ticker_api.h"
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mbed;
+
+extern "C" unsigned int equeue_global_time;
+
+/* Simulated gpio_irq_api, edges are raised through the stored handler */
+static gpio_irq_handler irq_handler;
+static uint32_t irq_id;
+static bool irq_rise_enabled;
+static bool irq_fall_enabled;
+
+void gpio_init_in(gpio_t *gpio, PinName pin)
+{
+}
+
+void gpio_init_in_ex(gpio_t *gpio, PinName pin, PinMode mode)
+{
+}
+
+void gpio_mode(gpio_t *obj, PinMode mode)
+{
+}
+
+int gpio_read(gpio_t *obj)
+{
+    return 0;
+}
+
+int gpio_irq_init(gpio_irq_t *obj, PinName pin, gpio_irq_handler handler, uint32_t id)
+{
+    irq_handler = handler;
+    irq_id = id;
+    return 0;
+}
+
+void gpio_irq_free(gpio_irq_t *obj)
+{
+    irq_handler = NULL;
+}
+
+void gpio_irq_set(gpio_irq_t *obj, gpio_irq_event event, uint32_t enable)
+{
+    if (event == IRQ_RISE) {
+        irq_rise_enabled = enable;
+    } else if (event == IRQ_FALL) {
+        irq_fall_enabled = enable;
+    }
+}
+
+void gpio_irq_enable(gpio_irq_t *obj)
+{
+}
+
+void gpio_irq_disable(gpio_irq_t *obj)
+{
+}
+
+/* Simulated us_ticker, a 1 MHz 32 bit counter read from a variable */
+static uint32_t fake_tick;
+
+static void fake_init()
+{
+}
+
+static uint32_t fake_read()
+{
+    return fake_tick;
+}
+
+static void fake_disable_interrupt()
+{
+}
+
+static void fake_clear_interrupt()
+{
+}
+
+static void fake_set_interrupt(timestamp_t timestamp)
+{
+}
+
+static void fake_fire_interrupt()
+{
+}
+
+static void fake_free()
+{
+}
+
+static const ticker_info_t *fake_get_info()
+{
+    static const ticker_info_t info = { 1000000, 32 };
+    return &info;
+}
+
+static const ticker_interface_t fake_interface = {
+    fake_init,
+    fake_read,
+    fake_disable_interrupt,
+    fake_clear_interrupt,
+    fake_set_interrupt,
+    fake_fire_interrupt,
+    fake_free,
+    fake_get_info,
+    false
+};
+
+static ticker_event_queue_t fake_queue;
+static const ticker_data_t fake_ticker = { &fake_interface, &fake_queue };
+
+const ticker_data_t *get_us_ticker_data(void)
+{
+    return &fake_ticker;
+}
+
+extern "C" void thread_sleep_for(uint32_t millisec)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
+}
+
+/* An edge at the given time, the way the target's GPIO interrupt raises it */
+static void edge(uint32_t tick, bool rise)
+{
+    fake_tick = tick;
+    irq_handler(irq_id, rise ? IRQ_RISE : IRQ_FALL);
+}
+
+class TestInterruptInRecorder : public testing::Test {
+public:
+    void batch(const InterruptInRecorder::Edge *edges, uint32_t count)
+    {
+        batches.push_back(std::vector<InterruptInRecorder::Edge>(edges, edges + count));
+    }
+
+protected:
+    enum { size = 8 };
+
+    InterruptInRecorder::Edge buffer[size];
+    events::EventQueue queue;
+    std::vector<std::vector<InterruptInRecorder::Edge> > batches;
+
+    void SetUp()
+    {
+        // Start the ticker again from 0
+        memset(&fake_queue, 0, sizeof fake_queue);
+        fake_tick = 0;
+        ticker_read_us(&fake_ticker);
+        irq_rise_enabled = false;
+        irq_fall_enabled = false;
+        batches.clear();
+    }
+};
+
+TEST_F(TestInterruptInRecorder, records_time_and_direction)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.record();
+    EXPECT_TRUE(irq_rise_enabled);
+    EXPECT_TRUE(irq_fall_enabled);
+
+    edge(100, true);
+    edge(150, false);
+    edge(1000, true);
+    EXPECT_EQ(3u, recorder.available());
+
+    InterruptInRecorder::Edge edges[4];
+    ASSERT_EQ(3u, recorder.read_edges(edges, 4));
+    EXPECT_EQ(100u, edges[0].timestamp);
+    EXPECT_TRUE(edges[0].rise);
+    EXPECT_EQ(150u, edges[1].timestamp);
+    EXPECT_FALSE(edges[1].rise);
+    EXPECT_EQ(1000u, edges[2].timestamp);
+    EXPECT_TRUE(edges[2].rise);
+    EXPECT_EQ(0u, recorder.available());
+    EXPECT_EQ(0u, recorder.read_edges(edges, 4));
+}
+
+TEST_F(TestInterruptInRecorder, records_selected_edges)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.record(true, false);
+    EXPECT_TRUE(irq_rise_enabled);
+    EXPECT_FALSE(irq_fall_enabled);
+
+    edge(10, true);
+    edge(20, false);
+    EXPECT_EQ(1u, recorder.available());
+
+    recorder.stop();
+    EXPECT_FALSE(irq_rise_enabled);
+    edge(30, true);
+
+    // Edges recorded before stopping can still be read
+    InterruptInRecorder::Edge edges[2];
+    ASSERT_EQ(1u, recorder.read_edges(edges, 2));
+    EXPECT_EQ(10u, edges[0].timestamp);
+}
+
+TEST_F(TestInterruptInRecorder, full_buffer_drops_edges)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.record();
+
+    for (uint32_t i = 0; i < size + 3; i++) {
+        edge(i * 10, i % 2 == 0);
+    }
+    EXPECT_EQ(size, recorder.available());
+    EXPECT_EQ(3u, recorder.dropped());
+
+    // The oldest edges are kept, and space is reused once read
+    InterruptInRecorder::Edge edges[size];
+    ASSERT_EQ(2u, recorder.read_edges(edges, 2));
+    EXPECT_EQ(0u, edges[0].timestamp);
+    EXPECT_EQ(10u, edges[1].timestamp);
+    edge(500, true);
+    EXPECT_EQ(3u, recorder.dropped());
+    ASSERT_EQ(size - 1, recorder.read_edges(edges, size));
+    EXPECT_EQ(20u, edges[0].timestamp);
+    EXPECT_EQ(500u, edges[size - 2].timestamp);
+}
+
+TEST_F(TestInterruptInRecorder, delivers_batches_on_queue)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.attach(&queue, callback(this, &TestInterruptInRecorder::batch));
+    recorder.record();
+
+    for (uint32_t i = 0; i < 5; i++) {
+        edge(i * 10, i % 2 == 0);
+    }
+    EXPECT_TRUE(batches.empty());
+
+    // All edges recorded before the queue runs come in one call
+    queue.dispatch(0);
+    ASSERT_EQ(1u, batches.size());
+    ASSERT_EQ(5u, batches[0].size());
+    for (uint32_t i = 0; i < 5; i++) {
+        EXPECT_EQ(i * 10, batches[0][i].timestamp);
+        EXPECT_EQ(i % 2 == 0, batches[0][i].rise);
+    }
+    EXPECT_EQ(0u, recorder.available());
+
+    // Nothing more is posted until another edge
+    queue.dispatch(0);
+    EXPECT_EQ(1u, batches.size());
+    edge(100, true);
+    queue.dispatch(0);
+    ASSERT_EQ(2u, batches.size());
+    EXPECT_EQ(1u, batches[1].size());
+}
+
+TEST_F(TestInterruptInRecorder, wrapped_batch_is_delivered_in_place)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.attach(&queue, callback(this, &TestInterruptInRecorder::batch));
+    recorder.record();
+
+    for (uint32_t i = 0; i < 6; i++) {
+        edge(i, true);
+    }
+    queue.dispatch(0);
+
+    // Edges 6 to 10 wrap around the end of the buffer
+    for (uint32_t i = 6; i < 11; i++) {
+        edge(i, false);
+    }
+    queue.dispatch(0);
+    ASSERT_EQ(3u, batches.size());
+    ASSERT_EQ(2u, batches[1].size());
+    ASSERT_EQ(3u, batches[2].size());
+    EXPECT_EQ(6u, batches[1][0].timestamp);
+    EXPECT_EQ(10u, batches[2][2].timestamp);
+    EXPECT_EQ(0u, recorder.dropped());
+}
+
+TEST_F(TestInterruptInRecorder, delay_gathers_edges)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.attach(&queue, callback(this, &TestInterruptInRecorder::batch), 20);
+    recorder.record();
+
+    edge(0, true);
+    queue.dispatch(0);
+    EXPECT_TRUE(batches.empty());
+
+    equeue_global_time += 10;
+    edge(10000, false);
+    queue.dispatch(0);
+    EXPECT_TRUE(batches.empty());
+
+    equeue_global_time += 20;
+    queue.dispatch(0);
+    ASSERT_EQ(1u, batches.size());
+    EXPECT_EQ(2u, batches[0].size());
+}
+
+TEST_F(TestInterruptInRecorder, attach_and_detach)
+{
+    InterruptInRecorder recorder(PTC0, buffer, size);
+    recorder.record();
+
+    // Edges recorded before attaching are delivered by the first event
+    edge(1, true);
+    edge(2, false);
+    recorder.attach(&queue, callback(this, &TestInterruptInRecorder::batch));
+    queue.dispatch(0);
+    ASSERT_EQ(1u, batches.size());
+    EXPECT_EQ(2u, batches[0].size());
+
+    // Detaching cancels the pending event and edges are kept for reading
+    edge(3, true);
+    recorder.attach(NULL, NULL);
+    edge(4, false);
+    queue.dispatch(0);
+    EXPECT_EQ(1u, batches.size());
+    EXPECT_EQ(2u, recorder.available());
+}
+
+TEST_F(TestInterruptInRecorder, one_event_for_many_edges)
+{
+    const uint32_t count = 64;
+    InterruptInRecorder::Edge ring[count];
+    InterruptInRecorder recorder(PTC0, ring, count);
+    recorder.attach(&queue, callback(this, &TestInterruptInRecorder::batch));
+    recorder.record();
+
+    // A burst of edges costs one event, however long it is
+    uint32_t delivered = 0;
+    for (uint32_t burst = 0; burst < 10; burst++) {
+        for (uint32_t i = 0; i < count / 2; i++) {
+            edge(burst * 1000 + i, i % 2 == 0);
+        }
+        queue.dispatch(0);
+    }
+    for (size_t i = 0; i < batches.size(); i++) {
+        delivered += batches[i].size();
+    }
+    EXPECT_EQ(10 * count / 2, delivered);
+    EXPECT_EQ(10u, batches.size());
+    EXPECT_EQ(0u, recorder.dropped());
+}
+
+static std::atomic<bool> slow_entered;
+static std::atomic<bool> slow_returned;
+
+static void slow_batch(const InterruptInRecorder::Edge *edges, uint32_t count)
+{
+    slow_entered = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    slow_returned = true;
+}
+
+TEST_F(TestInterruptInRecorder, destructor_waits_for_delivery)
+{
+    InterruptInRecorder *recorder = new InterruptInRecorder(PTC0, buffer, size);
+    slow_entered = false;
+    slow_returned = false;
+    recorder->attach(&queue, slow_batch);
+    recorder->record();
+    edge(1, true);
+
+    // The batch runs on another thread while the recorder is destroyed
+    std::thread dispatcher([this] { queue.dispatch(0); });
+    while (!slow_entered) {
+        std::this_thread::yield();
+    }
+    delete recorder;
+    EXPECT_TRUE(slow_returned);
+    dispatcher.join();
+}
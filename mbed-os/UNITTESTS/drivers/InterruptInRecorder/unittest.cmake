@@ -0,0 +1,36 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "InterruptInRecorder")
+
+# The real event queue delivers the batches, so its mocks are left out
+list(REMOVE_ITEM unittest-includes ${PROJECT_SOURCE_DIR}/target_h/events ${PROJECT_SOURCE_DIR}/target_h/events/equeue)
+
+# Add test specific include paths
+set(unittest-includes ${unittest-includes}
+  .
+  ../hal
+  ../events
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/InterruptInRecorder.cpp
+  ../events/source/EventQueue.cpp
+  ../events/source/equeue.c
+  ../hal/mbed_ticker_api.c
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/InterruptInRecorder/test_InterruptInRecorder.cpp
+  stubs/InterruptIn_stub.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_atomic_stub.c
+  stubs/mbed_critical_stub.c
+  stubs/EqueuePosix_stub.c
+)
+
+# defines
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -pthread -DDEVICE_INTERRUPTIN -DEQUEUE_PLATFORM_POSIX")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -pthread -DDEVICE_INTERRUPTIN -DEQUEUE_PLATFORM_POSIX")
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/MbedCRC.h"
+
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace mbed;
+
+static const char check_data[] = "123456789";
+
+static uint32_t reflect(uint32_t data, uint8_t bits)
+{
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+        if (data & (1ul << i)) {
+            result |= 1ul << (bits - 1 - i);
+        }
+    }
+    return result;
+}
+
+/* Bit by bit CRC, presented like MbedCRC presents its results */
+static uint32_t reference_crc(uint32_t polynomial, uint8_t width, uint32_t initial_xor, uint32_t final_xor,
+                              bool reflect_data, bool reflect_remainder, const uint8_t *data, size_t size)
+{
+    const uint32_t mask = (uint32_t)((1ull << width) - 1);
+    uint32_t crc = initial_xor & mask;
+    for (size_t i = 0; i < size; i++) {
+        uint8_t byte = reflect_data ? reflect(data[i], 8) : data[i];
+        for (int bit = 7; bit >= 0; bit--) {
+            uint32_t top = (crc >> (width - 1)) & 1;
+            crc = (crc << 1) & mask;
+            if (top ^ ((byte >> bit) & 1)) {
+                crc ^= polynomial;
+            }
+        }
+    }
+
+    // Narrow CRCs are returned in the top of a byte
+    uint8_t bits = width;
+    if (width < 8) {
+        crc <<= 8 - width;
+        bits = 8;
+    }
+    if (reflect_remainder) {
+        crc = reflect(crc, bits);
+    }
+    return (crc ^ final_xor) & (uint32_t)((1ull << bits) - 1);
+}
+
+static uint8_t random_data[1024];
+
+class TestMbedCRC : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        srand(0x5eed);
+        for (size_t i = 0; i < sizeof random_data; i++) {
+            random_data[i] = rand();
+        }
+    }
+};
+
+template <uint32_t polynomial, uint8_t width>
+static void check_equivalence(uint32_t initial_xor, uint32_t final_xor, bool reflect_data, bool reflect_remainder)
+{
+    SCOPED_TRACE(testing::Message() << "poly 0x" << std::hex << polynomial << " width " << std::dec << (int)width
+                 << " init 0x" << std::hex << initial_xor << " reflect " << reflect_data << reflect_remainder);
+    MbedCRC<polynomial, width> ct(initial_xor, final_xor, reflect_data, reflect_remainder);
+
+    // Every single byte, then lengths and alignments of random data
+    for (int value = 0; value < 256; value++) {
+        uint8_t byte = value;
+        uint32_t crc;
+        ASSERT_EQ(0, ct.compute(&byte, 1, &crc));
+        ASSERT_EQ(reference_crc(polynomial, width, initial_xor, final_xor, reflect_data, reflect_remainder, &byte, 1), crc)
+                << "byte " << value;
+    }
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size < 80; size++) {
+            uint32_t crc;
+            ASSERT_EQ(0, ct.compute(random_data + offset, size, &crc));
+            ASSERT_EQ(reference_crc(polynomial, width, initial_xor, final_xor, reflect_data, reflect_remainder,
+                                    random_data + offset, size), crc) << "size " << size << " offset " << offset;
+        }
+    }
+
+    // Split into two partial computations at every point
+    const uint32_t expected = reference_crc(polynomial, width, initial_xor, final_xor, reflect_data, reflect_remainder,
+                                            random_data, 40);
+    for (size_t split = 0; split <= 40; split++) {
+        uint32_t crc;
+        ct.compute_partial_start(&crc);
+        ct.compute_partial(random_data, split, &crc);
+        ct.compute_partial(random_data + split, 40 - split, &crc);
+        ct.compute_partial_stop(&crc);
+        ASSERT_EQ(expected, crc) << "split " << split;
+    }
+}
+
+template <uint32_t polynomial, uint8_t width>
+static void check_all_modes(uint32_t initial_xor, uint32_t final_xor)
+{
+    check_equivalence<polynomial, width>(initial_xor, final_xor, false, false);
+    check_equivalence<polynomial, width>(initial_xor, final_xor, true, false);
+    check_equivalence<polynomial, width>(initial_xor, final_xor, false, true);
+    check_equivalence<polynomial, width>(initial_xor, final_xor, true, true);
+}
+
+TEST_F(TestMbedCRC, check_values)
+{
+    uint32_t crc;
+    {
+        MbedCRC<POLY_7BIT_SD, 7> ct;
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xEAu, crc);
+    }
+    {
+        MbedCRC<POLY_8BIT_CCITT, 8> ct;
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xF4u, crc);
+    }
+    {
+        MbedCRC<POLY_16BIT_CCITT, 16> ct;
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0x29B1u, crc);
+    }
+    {
+        MbedCRC<POLY_16BIT_IBM, 16> ct;
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xBB3Du, crc);
+    }
+    {
+        MbedCRC<POLY_32BIT_ANSI, 32> ct;
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xCBF43926u, crc);
+    }
+    {
+        MbedCRC<POLY_32BIT_REV_ANSI, 32> ct;
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xCBF43926u, crc);
+    }
+    {
+        // CRC-16/DNP and CRC-32C, without ROM tables
+        MbedCRC<0x3D65, 16> ct(0x0, 0xFFFF, 1, 1);
+        ct.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xEA82u, crc);
+        MbedCRC<0x1EDC6F41, 32> ct32(0xFFFFFFFF, 0xFFFFFFFF, 1, 1);
+        ct32.compute(check_data, 9, &crc);
+        EXPECT_EQ(0xE3069283u, crc);
+    }
+}
+
+TEST_F(TestMbedCRC, sd_card_commands)
+{
+    // Command CRCs from the SD specification, with the end bit set
+    MbedCRC<POLY_7BIT_SD, 7> crc7;
+    const uint8_t cmd0[] = { 0x40, 0x00, 0x00, 0x00, 0x00 };
+    const uint8_t cmd8[] = { 0x48, 0x00, 0x00, 0x01, 0xAA };
+    uint32_t crc;
+    crc7.compute(cmd0, sizeof cmd0, &crc);
+    EXPECT_EQ(0x95u, (crc | 0x1) & 0xFF);
+    crc7.compute(cmd8, sizeof cmd8, &crc);
+    EXPECT_EQ(0x87u, (crc | 0x1) & 0xFF);
+}
+
+TEST_F(TestMbedCRC, equivalent_to_bitwise)
+{
+    check_all_modes<POLY_7BIT_SD, 7>(0, 0);
+    check_all_modes<POLY_7BIT_SD, 7>(0x55, 0x7F);
+    check_all_modes<0x5, 5>(0x1F, 0);
+    check_all_modes<POLY_8BIT_CCITT, 8>(0, 0);
+    check_all_modes<POLY_8BIT_CCITT, 8>(0xFF, 0x55);
+    check_all_modes<0x233, 10>(0x3FF, 0);
+    check_all_modes<POLY_16BIT_CCITT, 16>(0xFFFF, 0);
+    check_all_modes<POLY_16BIT_IBM, 16>(0, 0xFFFF);
+    check_all_modes<0x3D65, 16>(0x1234, 0);
+    check_all_modes<0x5D6DCB, 24>(0xFEDCBA, 0);
+    check_all_modes<POLY_32BIT_ANSI, 32>(0xFFFFFFFF, 0xFFFFFFFF);
+    check_all_modes<POLY_32BIT_ANSI, 32>(0x12345678, 0);
+    check_all_modes<0x1EDC6F41, 32>(0xFFFFFFFF, 0xFFFFFFFF);
+}
+
+TEST_F(TestMbedCRC, every_two_byte_message)
+{
+    MbedCRC<POLY_16BIT_CCITT, 16> ccitt;
+    MbedCRC<POLY_32BIT_ANSI, 32> ansi;
+    for (uint32_t value = 0; value < 0x10000; value++) {
+        uint8_t data[2] = { (uint8_t)(value >> 8), (uint8_t)value };
+        uint32_t crc;
+        ccitt.compute(data, 2, &crc);
+        ASSERT_EQ(reference_crc(POLY_16BIT_CCITT, 16, 0xFFFF, 0, false, false, data, 2), crc);
+        ansi.compute(data, 2, &crc);
+        ASSERT_EQ(reference_crc(POLY_32BIT_ANSI, 32, 0xFFFFFFFF, 0xFFFFFFFF, true, true, data, 2), crc);
+    }
+}
+
+TEST_F(TestMbedCRC, slicing_kernels)
+{
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size < 100; size++) {
+            const uint8_t *data = random_data + offset;
+            uint32_t bytewise = internal::crc_reflected_table_compute<POLY_32BIT_ANSI, 32, 1>(data, size, 0xFFFFFFFF);
+            EXPECT_EQ(bytewise, (internal::crc_reflected_table_compute<POLY_32BIT_ANSI, 32, 4>(data, size, 0xFFFFFFFF)));
+            EXPECT_EQ(bytewise, (internal::crc_reflected_table_compute<POLY_32BIT_ANSI, 32, 8>(data, size, 0xFFFFFFFF)));
+            EXPECT_EQ(reflect(reference_crc(POLY_32BIT_ANSI, 32, 0xFFFFFFFF, 0, true, false, data, size), 32), bytewise);
+        }
+    }
+}
+
+TEST_F(TestMbedCRC, generated_tables_match_rom_tables)
+{
+    EXPECT_EQ(0, memcmp(Table_CRC_7Bit_SD, (internal::CrcTable<POLY_7BIT_SD, 7, false>::table), 256));
+    EXPECT_EQ(0, memcmp(Table_CRC_8bit_CCITT, (internal::CrcTable<POLY_8BIT_CCITT, 8, false>::table), 256));
+    EXPECT_EQ(0, memcmp(Table_CRC_16bit_CCITT, (internal::CrcTable<POLY_16BIT_CCITT, 16, false>::table), 512));
+    EXPECT_EQ(0, memcmp(Table_CRC_16bit_IBM, (internal::CrcTable<POLY_16BIT_IBM, 16, false>::table), 512));
+    EXPECT_EQ(0, memcmp(Table_CRC_32bit_ANSI, (internal::CrcTable<POLY_32BIT_ANSI, 32, false>::table), 1024));
+}
+
+template <typename F>
+static double megabytes_per_second(F compute)
+{
+    const size_t rounds = 2000;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; i++) {
+        compute();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return rounds * sizeof random_data / seconds / 1e6;
+}
+
+TEST_F(TestMbedCRC, benchmark)
+{
+    volatile uint32_t sink = 0;
+    MbedCRC<POLY_32BIT_ANSI, 32> normal(0xFFFFFFFF, 0xFFFFFFFF, false, false);
+    MbedCRC<POLY_32BIT_ANSI, 32> reflected;
+
+    double bitwise_rate = megabytes_per_second([&]() {
+        sink += reference_crc(POLY_32BIT_ANSI, 32, 0xFFFFFFFF, 0xFFFFFFFF, true, true, random_data, sizeof random_data);
+    });
+    double normal_rate = megabytes_per_second([&]() {
+        uint32_t crc;
+        normal.compute(random_data, sizeof random_data, &crc);
+        sink += crc;
+    });
+    double reflected_rate = megabytes_per_second([&]() {
+        uint32_t crc;
+        reflected.compute(random_data, sizeof random_data, &crc);
+        sink += crc;
+    });
+    double slice4_rate = megabytes_per_second([&]() {
+        sink += internal::crc_reflected_table_compute<POLY_32BIT_ANSI, 32, 4>(random_data, sizeof random_data, 0);
+    });
+    double slice8_rate = megabytes_per_second([&]() {
+        sink += internal::crc_reflected_table_compute<POLY_32BIT_ANSI, 32, 8>(random_data, sizeof random_data, 0);
+    });
+
+    std::cout << "[          ] CRC-32 MB/s: bitwise " << bitwise_rate << ", normal table " << normal_rate
+              << ", reflected table " << reflected_rate << ", slicing by 4 " << slice4_rate
+              << ", slicing by 8 " << slice8_rate << std::endl;
+    EXPECT_GT(reflected_rate, bitwise_rate);
+}
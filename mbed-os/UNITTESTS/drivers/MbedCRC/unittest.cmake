@@ -0,0 +1,14 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+  ../drivers/source/MbedCRC.cpp
+  ../drivers/source/TableCRC.cpp
+)
+
+set(unittest-test-sources
+  drivers/MbedCRC/test_MbedCRC.cpp
+  stubs/Mutex_stub.cpp
+  stubs/mbed_assert_stub.cpp
+)
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/SPI.h"
+
+#include <string>
+#include <string.h>
+
+using namespace mbed;
+
+/* Mock SPI HAL, logging the bus as text: "<" while selected, ">" when
+ * deselected, and the bytes written in hex. Bytes read are the bytes
+ * written plus one. */
+static std::string bus;
+static int hal_calls;
+
+static struct {
+    bool active;
+    const uint8_t *tx;
+    size_t tx_length;
+    uint8_t *rx;
+    size_t rx_length;
+    uint32_t event;
+} async;
+
+static void log_byte(int value)
+{
+    char text[4];
+    snprintf(text, sizeof text, "%02x ", value & 0xFF);
+    bus += text;
+}
+
+static int bus_byte(int value)
+{
+    log_byte(value);
+    return (value + 1) & 0xFF;
+}
+
+extern "C" {
+
+int gpio_is_connected(const gpio_t *obj)
+{
+    return obj->unused != (int)NC;
+}
+
+void gpio_init_out_ex(gpio_t *gpio, PinName pin, int value)
+{
+    gpio->unused = pin;
+}
+
+void gpio_init_out(gpio_t *gpio, PinName pin)
+{
+    gpio->unused = pin;
+}
+
+void gpio_write(gpio_t *obj, int value)
+{
+    bus += value ? ">" : "<";
+}
+
+int gpio_read(gpio_t *obj)
+{
+    return 0;
+}
+
+void spi_init(spi_t *obj, PinName mosi, PinName miso, PinName sclk, PinName ssel)
+{
+}
+
+void spi_init_direct(spi_t *obj, const spi_pinmap_t *pinmap)
+{
+}
+
+void spi_format(spi_t *obj, int bits, int mode, int slave)
+{
+}
+
+void spi_frequency(spi_t *obj, int hz)
+{
+}
+
+int spi_master_write(spi_t *obj, int value)
+{
+    hal_calls++;
+    return bus_byte(value);
+}
+
+int spi_master_block_write(spi_t *obj, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, char write_fill)
+{
+    hal_calls++;
+    int length = tx_length > rx_length ? tx_length : rx_length;
+    for (int i = 0; i < length; i++) {
+        int value = bus_byte(i < tx_length ? tx_buffer[i] : write_fill);
+        if (i < rx_length) {
+            rx_buffer[i] = value;
+        }
+    }
+    return length;
+}
+
+void spi_master_transfer(spi_t *obj, const void *tx, size_t tx_length, void *rx, size_t rx_length, uint8_t bit_width, uint32_t handler, uint32_t event, DMAUsage hint)
+{
+    hal_calls++;
+    async.active = true;
+    async.tx = (const uint8_t *)tx;
+    async.tx_length = tx_length;
+    async.rx = (uint8_t *)rx;
+    async.rx_length = rx_length;
+    async.event = event;
+}
+
+/* Runs the whole async transfer */
+uint32_t spi_irq_handler_asynch(spi_t *obj)
+{
+    size_t length = async.tx_length > async.rx_length ? async.tx_length : async.rx_length;
+    for (size_t i = 0; i < length; i++) {
+        int value = bus_byte(i < async.tx_length ? async.tx[i] : SPI_FILL_CHAR);
+        if (i < async.rx_length) {
+            async.rx[i] = value;
+        }
+    }
+    async.active = false;
+    return SPI_EVENT_COMPLETE & async.event;
+}
+
+uint8_t spi_active(spi_t *obj)
+{
+    return async.active;
+}
+
+void spi_abort_asynch(spi_t *obj)
+{
+    async.active = false;
+}
+
+}
+
+void sleep_manager_lock_deep_sleep(void)
+{
+}
+
+void sleep_manager_unlock_deep_sleep(void)
+{
+}
+
+/* Counts locks and runs the asynchronous interrupt handler */
+class TestSPIDevice : public SPI {
+public:
+    TestSPIDevice() : SPI(PTC0, PTC1, PTC0, PTC1, use_gpio_ssel), locks(0)
+    {
+    }
+
+    virtual void lock()
+    {
+        locks++;
+        SPI::lock();
+    }
+
+    void interrupt()
+    {
+        irq_handler_asynch();
+    }
+
+    int locks;
+};
+
+static int events;
+static int callbacks;
+
+static void on_event(int event)
+{
+    events |= event;
+    callbacks++;
+}
+
+class TestSPI : public testing::Test {
+protected:
+    void SetUp()
+    {
+        bus.clear();
+        hal_calls = 0;
+        memset(&async, 0, sizeof async);
+        events = 0;
+        callbacks = 0;
+    }
+};
+
+TEST_F(TestSPI, batch_building)
+{
+    char data[4];
+    SPI::Batch batch;
+
+    // Command, address and dummy bytes make one phase
+    batch.command(0x0B).address(0x123456, 3).dummy(1);
+    EXPECT_EQ(1, batch.phases());
+    EXPECT_EQ(5, batch.length());
+
+    batch.read(data, sizeof data).command(0x05).write(data, 0);
+    EXPECT_EQ(3, batch.phases());
+    EXPECT_EQ(10, batch.length());
+    EXPECT_TRUE(batch.valid());
+
+    batch.write(data, 2);
+    batch.read(data, 2);
+    EXPECT_EQ(SPI::Batch::max_phases, batch.phases());
+    EXPECT_FALSE(batch.valid());
+
+    batch.clear();
+    EXPECT_EQ(0, batch.phases());
+    EXPECT_TRUE(batch.valid());
+
+    batch.dummy(SPI::Batch::max_inline).command(0);
+    EXPECT_FALSE(batch.valid());
+
+    batch.clear();
+    batch.address(0, 5);
+    EXPECT_FALSE(batch.valid());
+}
+
+TEST_F(TestSPI, flash_read)
+{
+    TestSPIDevice spi;
+    char data[4];
+    SPI::Batch batch;
+
+    batch.command(0x0B).address(0x123456, 3).dummy(1, 0).read(data, sizeof data);
+    EXPECT_EQ(9, spi.write(batch));
+    EXPECT_EQ("<0b 12 34 56 00 ff ff ff ff >", bus);
+    EXPECT_EQ(2, hal_calls);
+    EXPECT_EQ(1, spi.locks);
+    for (size_t i = 0; i < sizeof data; i++) {
+        EXPECT_EQ(0, data[i]);
+    }
+}
+
+TEST_F(TestSPI, flash_read_per_byte)
+{
+    // The same read as flash_read, one write at a time as drivers used to do it
+    TestSPIDevice spi;
+    char data[4];
+
+    spi.select();
+    spi.write(0x0B);
+    for (int shift = 16; shift >= 0; shift -= 8) {
+        spi.write((0x123456 >> shift) & 0xFF);
+    }
+    spi.write(0);
+    for (size_t i = 0; i < sizeof data; i++) {
+        data[i] = spi.write(0xFF);
+    }
+    spi.deselect();
+    EXPECT_EQ("<0b 12 34 56 00 ff ff ff ff >", bus);
+    EXPECT_EQ(9, hal_calls);
+    EXPECT_EQ(10, spi.locks);
+}
+
+TEST_F(TestSPI, write_and_transfer_phases)
+{
+    TestSPIDevice spi;
+    const char tx[3] = { 1, 2, 3 };
+    char rx[3];
+    SPI::Batch batch;
+
+    spi.set_default_write_value(0xAA);
+    batch.command(0x02).write(tx, 2).transfer(tx, rx, 3).read(rx, 1);
+    EXPECT_EQ(7, spi.write(batch));
+    EXPECT_EQ("<02 01 02 01 02 03 aa >", bus);
+    EXPECT_EQ((char)0xAB, rx[0]);
+    EXPECT_EQ(3, rx[1]);
+    EXPECT_EQ(4, rx[2]);
+
+    batch.clear();
+    batch.dummy(SPI::Batch::max_inline + 1);
+    bus.clear();
+    EXPECT_EQ(-1, spi.write(batch));
+    EXPECT_EQ("", bus);
+}
+
+TEST_F(TestSPI, async_batch)
+{
+    TestSPIDevice spi;
+    char data[2];
+    SPI::Batch batch;
+
+    batch.command(0x03).address(0x10, 2).read(data, sizeof data);
+    EXPECT_EQ(0, spi.transfer(batch, on_event, 0));
+    EXPECT_EQ("<", bus);
+    EXPECT_TRUE(async.event & SPI_EVENT_COMPLETE);
+
+    // The Slave Select line stays asserted between phases
+    spi.interrupt();
+    EXPECT_EQ("<03 00 10 ", bus);
+    EXPECT_EQ(0, callbacks);
+    spi.interrupt();
+    EXPECT_EQ("<03 00 10 ff ff >", bus);
+    EXPECT_EQ(1, callbacks);
+    EXPECT_EQ(SPI_EVENT_COMPLETE, events);
+    EXPECT_EQ(0, data[0]);
+
+    SPI::Batch empty;
+    EXPECT_EQ(-1, spi.transfer(empty, on_event));
+}
+
+TEST_F(TestSPI, async_batch_queued)
+{
+    TestSPIDevice spi;
+    const char tx[2] = { 5, 6 };
+    char rx[2];
+    SPI::Batch batch;
+
+    batch.command(0x9F).read(rx, 2);
+    EXPECT_EQ(0, spi.transfer(tx, 2, rx, 0, on_event));
+    EXPECT_EQ(0, spi.transfer(batch, on_event));
+    EXPECT_EQ("<", bus);
+
+    // The batch starts once the transfer in progress completes
+    spi.interrupt();
+    EXPECT_EQ(1, callbacks);
+    EXPECT_EQ("<05 06 ><", bus);
+    spi.interrupt();
+    spi.interrupt();
+    EXPECT_EQ(2, callbacks);
+    EXPECT_EQ("<05 06 ><9f ff ff >", bus);
+    EXPECT_FALSE(async.active);
+}
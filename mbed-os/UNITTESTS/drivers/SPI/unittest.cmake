@@ -0,0 +1,30 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "SPI")
+
+# Add test specific include paths
+set(unittest-includes ${unittest-includes}
+  .
+  ../hal
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/SPI.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/SPI/test_SPI.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_critical_stub.c
+  stubs/Mutex_stub.cpp
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
+
+# defines
+set(SPI_DEFINES "-DDEVICE_SPI -DDEVICE_SPI_ASYNCH -DTRANSACTION_QUEUE_SIZE_SPI=2")
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${SPI_DEFINES}")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${SPI_DEFINES}")
@@ -0,0 +1,532 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/UARTSerial.h"
+#include "platform/mbed_thread.h"
+
+#include <vector>
+
+using namespace mbed;
+
+/* Simulated UART: one character data registers for each direction, and
+ * asynchronous transfers that move data without interrupting until the
+ * transfer ends. Every interrupt the driver would take is counted. */
+struct SimUart {
+    Callback<void()> *irq;
+    serial_t *serial;
+    bool *rx_asynch_set;
+    bool *tx_asynch_set;
+    event_callback_t *rx_callback;
+    event_callback_t *tx_callback;
+
+    bool rx_full;
+    uint8_t rx_data;
+    bool tx_full;
+    uint8_t tx_data;
+    std::vector<uint8_t> wire;
+    int interrupts;
+    int overruns;
+    int tx_start_failures;
+};
+
+static SimUart sim;
+
+/* A character arrives on the line */
+static void sim_receive(uint8_t c)
+{
+    if (*sim.rx_asynch_set) {
+        buffer_t &rx = sim.serial->rx_buff;
+        static_cast<uint8_t *>(rx.buffer)[rx.pos++] = c;
+        if (rx.pos == rx.length) {
+            event_callback_t cb = *sim.rx_callback;
+            *sim.rx_asynch_set = false;
+            *sim.rx_callback = NULL;
+            sim.interrupts++;
+            cb.call(SERIAL_EVENT_RX_COMPLETE);
+        }
+        return;
+    }
+
+    if (sim.rx_full) {
+        sim.overruns++;
+        return;
+    }
+    sim.rx_full = true;
+    sim.rx_data = c;
+    if (sim.irq[SerialBase::RxIrq]) {
+        sim.interrupts++;
+        sim.irq[SerialBase::RxIrq].call();
+    }
+}
+
+/* One character time passes on the transmit line */
+static void sim_transmit()
+{
+    if (sim.tx_full) {
+        sim.wire.push_back(sim.tx_data);
+        sim.tx_full = false;
+        if (sim.irq[SerialBase::TxIrq]) {
+            sim.interrupts++;
+            sim.irq[SerialBase::TxIrq].call();
+        }
+    } else if (*sim.tx_asynch_set) {
+        buffer_t &tx = sim.serial->tx_buff;
+        sim.wire.push_back(static_cast<const uint8_t *>(tx.buffer)[tx.pos++]);
+        if (tx.pos == tx.length) {
+            event_callback_t cb = *sim.tx_callback;
+            *sim.tx_asynch_set = false;
+            *sim.tx_callback = NULL;
+            sim.interrupts++;
+            cb.call(SERIAL_EVENT_TX_COMPLETE);
+        }
+    }
+}
+
+static void sim_poll()
+{
+    ASSERT_TRUE(Ticker::last_attached() != NULL);
+    Ticker::last_attached()->expire();
+}
+
+namespace mbed {
+
+SerialBase::SerialBase(PinName tx, PinName rx, int baud) :
+    _baud(baud), _tx_pin(tx), _rx_pin(rx)
+{
+    sim.irq = _irq;
+    sim.serial = &_serial;
+    sim.rx_asynch_set = &_rx_asynch_set;
+    sim.tx_asynch_set = &_tx_asynch_set;
+    sim.rx_callback = &_rx_callback;
+    sim.tx_callback = &_tx_callback;
+}
+
+SerialBase::SerialBase(const serial_pinmap_t &static_pinmap, int baud) :
+    SerialBase(NC, NC, baud)
+{
+}
+
+SerialBase::~SerialBase()
+{
+}
+
+void SerialBase::baud(int baudrate)
+{
+}
+
+void SerialBase::format(int bits, Parity parity, int stop_bits)
+{
+}
+
+int SerialBase::readable()
+{
+    return sim.rx_full;
+}
+
+int SerialBase::writeable()
+{
+    return !sim.tx_full;
+}
+
+void SerialBase::attach(Callback<void()> func, IrqType type)
+{
+    _irq[type] = func;
+}
+
+int SerialBase::_base_getc()
+{
+    sim.rx_full = false;
+    return sim.rx_data;
+}
+
+int SerialBase::_base_putc(int c)
+{
+    while (sim.tx_full) {
+        sim.wire.push_back(sim.tx_data);
+        sim.tx_full = false;
+    }
+    sim.tx_full = true;
+    sim.tx_data = c;
+    return c;
+}
+
+void SerialBase::send_break()
+{
+}
+
+#if DEVICE_SERIAL_FC
+void SerialBase::set_flow_control(Flow type, PinName flow1, PinName flow2)
+{
+}
+#endif
+
+void SerialBase::enable_input(bool enable)
+{
+    _rx_enabled = enable;
+}
+
+void SerialBase::enable_output(bool enable)
+{
+    _tx_enabled = enable;
+}
+
+void SerialBase::lock()
+{
+}
+
+void SerialBase::unlock()
+{
+}
+
+int SerialBase::write(const uint8_t *buffer, int length, const event_callback_t &callback, int event)
+{
+    if (_tx_asynch_set) {
+        return -1;
+    }
+    /* Transmitter still busy, as some targets report just after a transfer completes */
+    if (sim.tx_start_failures) {
+        sim.tx_start_failures--;
+        return -1;
+    }
+    _tx_asynch_set = true;
+    _tx_callback = callback;
+    _serial.tx_buff.buffer = const_cast<uint8_t *>(buffer);
+    _serial.tx_buff.length = length;
+    _serial.tx_buff.pos = 0;
+    return 0;
+}
+
+int SerialBase::read(uint8_t *buffer, int length, const event_callback_t &callback, int event, unsigned char char_match)
+{
+    if (_rx_asynch_set) {
+        return -1;
+    }
+    _rx_asynch_set = true;
+    _rx_callback = callback;
+    _serial.rx_buff.buffer = buffer;
+    _serial.rx_buff.length = length;
+    _serial.rx_buff.pos = 0;
+    return 0;
+}
+
+void SerialBase::abort_write()
+{
+    _tx_callback = NULL;
+    _tx_asynch_set = false;
+}
+
+void SerialBase::abort_read()
+{
+    _rx_callback = NULL;
+    _rx_asynch_set = false;
+}
+
+int SerialBase::set_dma_usage_tx(DMAUsage usage)
+{
+    _tx_usage = usage;
+    return 0;
+}
+
+int SerialBase::set_dma_usage_rx(DMAUsage usage)
+{
+    _rx_usage = usage;
+    return 0;
+}
+
+InterruptIn::InterruptIn(PinName pin)
+{
+}
+
+InterruptIn::~InterruptIn()
+{
+}
+
+int InterruptIn::read()
+{
+    return 0;
+}
+
+void InterruptIn::rise(Callback<void()> func)
+{
+}
+
+void InterruptIn::fall(Callback<void()> func)
+{
+}
+
+}
+
+static int critical_nesting;
+
+bool core_util_in_critical_section(void)
+{
+    return critical_nesting != 0;
+}
+
+void core_util_critical_section_enter(void)
+{
+    critical_nesting++;
+}
+
+void core_util_critical_section_exit(void)
+{
+    critical_nesting--;
+}
+
+void thread_sleep_for(uint32_t millisec)
+{
+    /* Time passes on the line while the caller waits */
+    for (int i = 0; i < 8; i++) {
+        sim_transmit();
+    }
+}
+
+class TestUARTSerial : public testing::Test {
+protected:
+    UARTSerial *serial;
+
+    virtual void SetUp()
+    {
+        sim = SimUart();
+        serial = new UARTSerial(NC, NC);
+        serial->set_blocking(false);
+    }
+
+    virtual void TearDown()
+    {
+        delete serial;
+    }
+
+    void receive(int count)
+    {
+        for (int i = 0; i < count; i++) {
+            sim_receive(static_cast<uint8_t>(i));
+        }
+    }
+
+    int read_all(std::vector<uint8_t> &out)
+    {
+        uint8_t buf[32];
+        ssize_t len;
+        int total = 0;
+        while ((len = serial->read(buf, sizeof buf)) > 0) {
+            out.insert(out.end(), buf, buf + len);
+            total += len;
+        }
+        return total;
+    }
+
+    int receive_and_read(int count, std::vector<uint8_t> &out)
+    {
+        int total = 0;
+        for (int i = 0; i < count; i++) {
+            sim_receive(static_cast<uint8_t>(i));
+            if (i % 32 == 31) {
+                total += read_all(out);
+            }
+        }
+        return total + read_all(out);
+    }
+
+    void write_and_send(int count)
+    {
+        std::vector<uint8_t> data;
+        for (int i = 0; i < count; i++) {
+            data.push_back(static_cast<uint8_t>(i * 7));
+        }
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t len = serial->write(&data[written], data.size() - written);
+            if (len > 0) {
+                written += len;
+            }
+            sim_transmit();
+        }
+        for (int i = 0; i < count; i++) {
+            sim_transmit();
+        }
+        EXPECT_EQ(data, sim.wire);
+    }
+};
+
+TEST_F(TestUARTSerial, rx_per_character_interrupts)
+{
+    std::vector<uint8_t> out;
+
+    EXPECT_EQ(256, receive_and_read(256, out));
+    EXPECT_EQ(256, sim.interrupts);
+    EXPECT_EQ(0, sim.overruns);
+    for (int i = 0; i < 256; i++) {
+        EXPECT_EQ(i, out[i]);
+    }
+}
+
+TEST_F(TestUARTSerial, rx_async_chunks)
+{
+    std::vector<uint8_t> out;
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    EXPECT_EQ(256, receive_and_read(256, out));
+    EXPECT_EQ(256 / MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE, sim.interrupts);
+    EXPECT_EQ(0, sim.overruns);
+    for (int i = 0; i < 256; i++) {
+        EXPECT_EQ(i, out[i]);
+    }
+}
+
+TEST_F(TestUARTSerial, rx_async_idle_line)
+{
+    std::vector<uint8_t> out;
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    receive(5);
+
+    /* Nothing is delivered while characters keep arriving */
+    sim_poll();
+    EXPECT_EQ(0, read_all(out));
+
+    /* A poll period without a character hands over the partial chunk */
+    sim_poll();
+    EXPECT_EQ(5, read_all(out));
+    EXPECT_EQ(0, read_all(out));
+    sim_poll();
+
+    receive(MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE);
+    EXPECT_EQ(MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE, read_all(out));
+    EXPECT_EQ(1, sim.interrupts);
+}
+
+TEST_F(TestUARTSerial, rx_async_pauses_when_buffer_full)
+{
+    std::vector<uint8_t> out;
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+
+    /* Only chunks that fit in the receive buffer are started */
+    receive(MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE);
+    EXPECT_FALSE(*sim.rx_asynch_set);
+    receive(4);
+    /* The first is held in the data register */
+    EXPECT_EQ(3, sim.overruns);
+
+    EXPECT_EQ(MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE, read_all(out));
+    EXPECT_TRUE(*sim.rx_asynch_set);
+}
+
+TEST_F(TestUARTSerial, switch_mode_keeps_received_data)
+{
+    std::vector<uint8_t> out;
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    receive(3);
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_NEVER));
+    EXPECT_TRUE(Ticker::last_attached() == NULL);
+    receive(3);
+    EXPECT_EQ(6, read_all(out));
+    EXPECT_EQ(3, sim.interrupts);
+}
+
+TEST_F(TestUARTSerial, tx_per_character_interrupts)
+{
+    write_and_send(200);
+    /* The first character is written without waiting for an interrupt */
+    EXPECT_EQ(199, sim.interrupts);
+}
+
+TEST_F(TestUARTSerial, tx_async_chunks)
+{
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    write_and_send(200);
+    EXPECT_EQ((200 + MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE - 1) / MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE, sim.interrupts);
+}
+
+TEST_F(TestUARTSerial, tx_async_sync)
+{
+    const char data[] = "0123456789";
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    EXPECT_EQ(10, serial->write(data, 10));
+    EXPECT_TRUE(*sim.tx_asynch_set);
+    EXPECT_EQ(0, serial->sync());
+    EXPECT_FALSE(*sim.tx_asynch_set);
+    EXPECT_EQ(std::vector<uint8_t>(data, data + 10), sim.wire);
+}
+
+TEST_F(TestUARTSerial, tx_async_unbuffered)
+{
+    const char data[] = "0123456789";
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    EXPECT_EQ(10, serial->write(data, 10));
+    sim_transmit();
+    sim_transmit();
+
+    core_util_critical_section_enter();
+    EXPECT_EQ(3, serial->write("abc", 3));
+    core_util_critical_section_exit();
+    sim_transmit();
+
+    EXPECT_EQ(std::vector<uint8_t>({'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c'}), sim.wire);
+}
+
+TEST_F(TestUARTSerial, tx_async_start_failure_keeps_chunk)
+{
+    const char data[] = "0123456789";
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    sim.tx_start_failures = 2;
+    EXPECT_EQ(10, serial->write(data, 10));
+    EXPECT_FALSE(*sim.tx_asynch_set);
+
+    /* Retried by the next write and from the receive poll, ahead of data written since */
+    EXPECT_EQ(3, serial->write("abc", 3));
+    EXPECT_FALSE(*sim.tx_asynch_set);
+    sim_poll();
+    EXPECT_TRUE(*sim.tx_asynch_set);
+    for (int i = 0; i < 20; i++) {
+        sim_transmit();
+    }
+    EXPECT_EQ(std::vector<uint8_t>({'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c'}), sim.wire);
+}
+
+TEST_F(TestUARTSerial, tx_async_start_failure_sync)
+{
+    const char data[] = "0123456789";
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    sim.tx_start_failures = 2;
+    EXPECT_EQ(10, serial->write(data, 10));
+    EXPECT_EQ(0, serial->sync());
+    EXPECT_EQ(std::vector<uint8_t>(data, data + 10), sim.wire);
+}
+
+TEST_F(TestUARTSerial, tx_async_start_failure_unbuffered)
+{
+    const char data[] = "0123456789";
+
+    EXPECT_EQ(0, serial->set_dma_usage(DMA_USAGE_ALWAYS));
+    sim.tx_start_failures = 1;
+    EXPECT_EQ(10, serial->write(data, 10));
+
+    core_util_critical_section_enter();
+    EXPECT_EQ(3, serial->write("abc", 3));
+    core_util_critical_section_exit();
+    sim_transmit();
+
+    EXPECT_EQ(std::vector<uint8_t>({'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c'}), sim.wire);
+}
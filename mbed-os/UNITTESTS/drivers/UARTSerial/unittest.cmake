@@ -0,0 +1,23 @@
+
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "UARTSerial")
+
+# Source files
+set(unittest-sources
+  ../drivers/source/UARTSerial.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/UARTSerial/test_UARTSerial.cpp
+  stubs/FileHandle_stub.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/Mutex_stub.cpp
+)
+
+# defines
+set(UARTSERIAL_DEFINES "-DDEVICE_SERIAL=1 -DDEVICE_INTERRUPTIN=1 -DDEVICE_SERIAL_ASYNCH=1 -DMBED_CONF_DRIVERS_UART_SERIAL_ASYNC=1 -DMBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE=16 -DMBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE=64 -DMBED_CONF_DRIVERS_UART_SERIAL_TXBUF_SIZE=64 -DMBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE=9600")
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${UARTSERIAL_DEFINES}")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${UARTSERIAL_DEFINES}")
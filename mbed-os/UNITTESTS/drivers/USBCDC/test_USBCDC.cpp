@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/USBCDC.h"
+#include "USBPhy.h"
+#include "usb_phy_api.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string.h>
+#include <vector>
+
+#define MAX_PACKET      64
+
+/* USB phy recording the bulk traffic, scripted by the test which plays the host */
+class RecordingPhy : public USBPhy {
+public:
+    RecordingPhy() : events(NULL), bulk_in(0), bulk_out(0), out_buffer(NULL), out_size(0),
+        in_pending(false), record(true), in_bytes(0), in_sum(0)
+    {
+        memset(&table, 0, sizeof(table));
+        table.resources = 16;
+        table.table[0].attributes = USB_EP_ATTR_ALLOW_CTRL | USB_EP_ATTR_DIR_IN_AND_OUT;
+        for (int i = 1; i < 16; i++) {
+            table.table[i].attributes = USB_EP_ATTR_ALLOW_ALL | USB_EP_ATTR_DIR_IN_AND_OUT;
+        }
+        memset(setup, 0, sizeof(setup));
+    }
+
+    /* Deliver an event from the phy's interrupt */
+    void deliver(std::function<void()> event)
+    {
+        pending = event;
+        events->start_process();
+    }
+
+    virtual void init(USBPhyEvents *events)
+    {
+        this->events = events;
+    }
+    virtual void deinit() {}
+    virtual bool powered()
+    {
+        return true;
+    }
+    virtual void connect() {}
+    virtual void disconnect() {}
+    virtual void configure() {}
+    virtual void unconfigure() {}
+    virtual void sof_enable() {}
+    virtual void sof_disable() {}
+    virtual void set_address(uint8_t address) {}
+    virtual void remote_wakeup() {}
+    virtual const usb_ep_table_t *endpoint_table()
+    {
+        return &table;
+    }
+    virtual uint32_t ep0_set_max_packet(uint32_t max_packet)
+    {
+        return max_packet;
+    }
+    virtual void ep0_setup_read_result(uint8_t *buffer, uint32_t size)
+    {
+        memcpy(buffer, setup, sizeof(setup));
+    }
+    virtual void ep0_read(uint8_t *data, uint32_t size) {}
+    virtual uint32_t ep0_read_result()
+    {
+        return 0;
+    }
+    virtual void ep0_write(uint8_t *buffer, uint32_t size) {}
+    virtual void ep0_stall() {}
+    virtual bool endpoint_add(usb_ep_t endpoint, uint32_t max_packet, usb_ep_type_t type)
+    {
+        if (type == USB_EP_TYPE_BULK) {
+            if (endpoint & 0x80) {
+                bulk_in = endpoint;
+            } else {
+                bulk_out = endpoint;
+            }
+        }
+        return true;
+    }
+    virtual void endpoint_remove(usb_ep_t endpoint) {}
+    virtual void endpoint_stall(usb_ep_t endpoint) {}
+    virtual void endpoint_unstall(usb_ep_t endpoint) {}
+    virtual bool endpoint_read(usb_ep_t endpoint, uint8_t *data, uint32_t size)
+    {
+        EXPECT_EQ((uint32_t)MAX_PACKET, size);
+        out_buffer = data;
+        return true;
+    }
+    virtual uint32_t endpoint_read_result(usb_ep_t endpoint)
+    {
+        return out_size;
+    }
+    virtual bool endpoint_write(usb_ep_t endpoint, uint8_t *data, uint32_t size)
+    {
+        EXPECT_FALSE(in_pending);
+        in_pending = true;
+        if (record) {
+            in_packets.push_back(std::vector<uint8_t>(data, data + size));
+        }
+        in_bytes += size;
+        in_sum += size ? data[0] : 0;
+        return true;
+    }
+    virtual void endpoint_abort(usb_ep_t endpoint)
+    {
+        if (endpoint == bulk_out) {
+            out_buffer = NULL;
+        } else {
+            in_pending = false;
+        }
+    }
+    virtual void process()
+    {
+        std::function<void()> event = pending;
+        pending = nullptr;
+        event();
+    }
+
+    USBPhyEvents *events;
+    usb_ep_table_t table;
+    uint8_t setup[8];
+    usb_ep_t bulk_in;
+    usb_ep_t bulk_out;
+    uint8_t *out_buffer;
+    uint32_t out_size;
+    bool in_pending;
+    bool record;
+    std::vector<std::vector<uint8_t> > in_packets;
+    uint64_t in_bytes;
+    uint64_t in_sum;
+    std::function<void()> pending;
+};
+
+USBPhy *get_usb_phy()
+{
+    return NULL;
+}
+
+class TestCDC : public USBCDC {
+public:
+    TestCDC(USBPhy *phy) : USBCDC(phy, 0x1f00, 0x2012, 0x0001), rx_count(0), tx_count(0)
+    {
+    }
+
+    virtual ~TestCDC()
+    {
+        deinit();
+    }
+
+    virtual void data_rx()
+    {
+        rx_count++;
+    }
+
+    virtual void data_tx()
+    {
+        tx_count++;
+    }
+
+    int rx_count;
+    int tx_count;
+};
+
+class TestUSBCDC : public testing::Test {
+protected:
+    void SetUp()
+    {
+        cdc = new TestCDC(&phy);
+        cdc->connect();
+
+        // Bus reset, SET_CONFIGURATION 1 then SET_CONTROL_LINE_STATE with DTR
+        phy.deliver([this]() {
+            phy.events->reset();
+        });
+        control(0x00, 0x09, 0x0001);
+        control(0x21, 0x22, 0x0001);
+        ASSERT_TRUE(cdc->ready());
+        ASSERT_TRUE(phy.out_buffer != NULL);
+    }
+
+    void TearDown()
+    {
+        delete cdc;
+    }
+
+    void control(uint8_t request_type, uint8_t request, uint16_t value)
+    {
+        const uint8_t setup[8] = { request_type, request, (uint8_t)value, (uint8_t)(value >> 8), 0, 0, 0, 0 };
+        memcpy(phy.setup, setup, sizeof(setup));
+        phy.deliver([this]() {
+            phy.events->ep0_setup();
+        });
+    }
+
+    /* Host sends a packet on the bulk OUT endpoint */
+    void host_out(const uint8_t *data, uint32_t size)
+    {
+        ASSERT_TRUE(phy.out_buffer != NULL);
+        memcpy(phy.out_buffer, data, size);
+        phy.out_buffer = NULL;
+        phy.out_size = size;
+        phy.deliver([this]() {
+            phy.events->out(phy.bulk_out);
+        });
+    }
+
+    /* Host takes the packet on the bulk IN endpoint */
+    bool host_in()
+    {
+        if (!phy.in_pending) {
+            return false;
+        }
+        phy.in_pending = false;
+        phy.deliver([this]() {
+            phy.events->in(phy.bulk_in);
+        });
+        return true;
+    }
+
+    std::vector<uint32_t> in_sizes()
+    {
+        std::vector<uint32_t> sizes;
+        for (size_t i = 0; i < phy.in_packets.size(); i++) {
+            sizes.push_back(phy.in_packets[i].size());
+        }
+        return sizes;
+    }
+
+    RecordingPhy phy;
+    TestCDC *cdc;
+};
+
+TEST_F(TestUSBCDC, stream_send_transfers)
+{
+    uint8_t buffer[512];
+    ASSERT_TRUE(cdc->set_stream_buffers(buffer, sizeof(buffer), NULL, 0));
+
+    uint32_t size;
+    uint8_t *half = cdc->send_acquire(&size);
+    ASSERT_EQ(buffer, half);
+    EXPECT_EQ(256u, size);
+    for (uint32_t i = 0; i < 200; i++) {
+        half[i] = i;
+    }
+    EXPECT_TRUE(cdc->send_commit(200));
+
+    // Packets go out of the application buffer as they are taken
+    while (host_in());
+    EXPECT_EQ(std::vector<uint32_t>({64, 64, 64, 8}), in_sizes());
+    EXPECT_EQ(0, memcmp(&phy.in_packets[1][0], buffer + 64, 64));
+    EXPECT_EQ(199, phy.in_packets[3][7]);
+
+    // A transfer of whole packets ends with a zero length packet
+    phy.in_packets.clear();
+    half = cdc->send_acquire(&size);
+    ASSERT_EQ(buffer + 256, half);
+    EXPECT_TRUE(cdc->send_commit(128));
+    while (host_in());
+    EXPECT_EQ(std::vector<uint32_t>({64, 64, 0}), in_sizes());
+    EXPECT_EQ(2, cdc->tx_count);
+}
+
+TEST_F(TestUSBCDC, stream_send_double_buffered)
+{
+    uint8_t buffer[256];
+    ASSERT_TRUE(cdc->set_stream_buffers(buffer, sizeof(buffer), NULL, 0));
+
+    uint32_t size;
+    uint8_t *first = cdc->send_acquire(&size);
+    memset(first, 1, size);
+    EXPECT_TRUE(cdc->send_commit(size));
+
+    // The other half is filled while the first is on the bus
+    uint8_t *second = cdc->send_acquire(&size);
+    ASSERT_EQ(buffer + 128, second);
+    memset(second, 2, size);
+    EXPECT_TRUE(cdc->send_commit(100));
+    EXPECT_TRUE(cdc->send_acquire(&size) == NULL);
+    EXPECT_EQ(0u, size);
+
+    // The first half comes back once sent, zero length packet included
+    EXPECT_TRUE(host_in());
+    EXPECT_TRUE(host_in());
+    EXPECT_TRUE(cdc->send_acquire(&size) == NULL);
+    EXPECT_TRUE(host_in());
+    EXPECT_EQ(1, cdc->tx_count);
+    EXPECT_EQ(first, cdc->send_acquire(&size));
+
+    while (host_in());
+    EXPECT_EQ(std::vector<uint32_t>({64, 64, 0, 64, 36}), in_sizes());
+    EXPECT_EQ(2, phy.in_packets[4][35]);
+
+    // Sending through the copying interface still works afterwards
+    uint8_t text[] = "hello";
+    uint32_t actual;
+    cdc->send_nb(text, sizeof(text), &actual);
+    EXPECT_EQ(sizeof(text), actual);
+    EXPECT_TRUE(host_in());
+    EXPECT_EQ(sizeof(text), phy.in_packets.back().size());
+}
+
+TEST_F(TestUSBCDC, stream_receive_transfers)
+{
+    uint8_t buffer[256];
+    ASSERT_TRUE(cdc->set_stream_buffers(NULL, 0, buffer, sizeof(buffer)));
+
+    // The pending read was restarted into the stream buffer
+    ASSERT_EQ(buffer, phy.out_buffer);
+
+    uint8_t packet[MAX_PACKET];
+    memset(packet, 0xA5, sizeof(packet));
+    host_out(packet, 64);
+    host_out(packet, 10);
+    EXPECT_EQ(1, cdc->rx_count);
+
+    // A half which fills up ends the transfer too
+    host_out(packet, 64);
+    host_out(packet, 64);
+    EXPECT_EQ(2, cdc->rx_count);
+
+    // Both halves are held, so reception waits
+    EXPECT_TRUE(phy.out_buffer == NULL);
+
+    uint32_t size;
+    uint8_t *data = cdc->receive_acquire(&size);
+    ASSERT_EQ(buffer, data);
+    EXPECT_EQ(74u, size);
+    cdc->receive_release();
+    EXPECT_EQ(buffer, phy.out_buffer);
+
+    data = cdc->receive_acquire(&size);
+    ASSERT_EQ(buffer + 128, data);
+    EXPECT_EQ(128u, size);
+    cdc->receive_release();
+    EXPECT_TRUE(cdc->receive_acquire(&size) == NULL);
+
+    // A zero length packet alone is not a transfer
+    host_out(packet, 0);
+    EXPECT_EQ(2, cdc->rx_count);
+    EXPECT_TRUE(cdc->receive_acquire(&size) == NULL);
+
+    // Back to the copying interface
+    ASSERT_TRUE(cdc->set_stream_buffers(NULL, 0, NULL, 0));
+    host_out(packet, 5);
+    uint8_t copy[16];
+    uint32_t actual;
+    cdc->receive_nb(copy, sizeof(copy), &actual);
+    EXPECT_EQ(5u, actual);
+}
+
+TEST_F(TestUSBCDC, stream_dropped_on_disconnect)
+{
+    uint8_t tx[256], rx[256];
+    ASSERT_TRUE(cdc->set_stream_buffers(tx, sizeof(tx), rx, sizeof(rx)));
+
+    uint32_t size;
+    cdc->send_acquire(&size);
+    EXPECT_TRUE(cdc->send_commit(10));
+    EXPECT_FALSE(cdc->set_stream_buffers(NULL, 0, NULL, 0));
+
+    // Terminal closes: DTR cleared
+    control(0x21, 0x22, 0x0000);
+    EXPECT_FALSE(phy.in_pending);
+    EXPECT_TRUE(cdc->send_acquire(&size) == NULL);
+    EXPECT_FALSE(cdc->send_commit(10));
+    EXPECT_TRUE(cdc->set_stream_buffers(NULL, 0, NULL, 0));
+}
+
+TEST_F(TestUSBCDC, throughput)
+{
+    const uint32_t total = 4 * 1024 * 1024;
+    phy.record = false;
+
+    // Copying interface: the application fills its buffer then send_nb copies it
+    typedef std::chrono::steady_clock Clock;
+    uint8_t data[MAX_PACKET];
+    uint32_t copy_calls = 0;
+    Clock::time_point start = Clock::now();
+    for (uint32_t sent = 0; sent < total; sent += MAX_PACKET) {
+        memset(data, sent / MAX_PACKET, MAX_PACKET);
+        uint32_t actual;
+        cdc->send_nb(data, MAX_PACKET, &actual);
+        copy_calls++;
+        ASSERT_EQ((uint32_t)MAX_PACKET, actual);
+        host_in();
+    }
+    double copy_time = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t copy_sum = phy.in_sum;
+    EXPECT_EQ(total, phy.in_bytes);
+
+    // Streaming: the application fills the endpoint buffer in place
+    static uint8_t buffer[2 * 4096];
+    ASSERT_TRUE(cdc->set_stream_buffers(buffer, sizeof(buffer), NULL, 0));
+    phy.in_bytes = 0;
+    phy.in_sum = 0;
+    uint32_t stream_calls = 0;
+    start = Clock::now();
+    uint32_t sent = 0;
+    while (sent < total) {
+        uint32_t size;
+        uint8_t *half = cdc->send_acquire(&size);
+        if (half) {
+            for (uint32_t i = 0; i < size; i += MAX_PACKET) {
+                memset(half + i, (sent + i) / MAX_PACKET, MAX_PACKET);
+            }
+            ASSERT_TRUE(cdc->send_commit(size));
+            stream_calls += 2;
+            sent += size;
+        } else {
+            host_in();
+        }
+    }
+    while (host_in());
+    double stream_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    EXPECT_EQ(total, phy.in_bytes);
+    EXPECT_EQ(copy_sum, phy.in_sum);
+
+    // On the host the bus simulation dominates, so the figures of interest
+    // are the calls made by the application and the bytes copied
+    std::cout << "[          ] send_nb: " << (total / copy_time / 1e6) << " MB/s, "
+              << copy_calls << " calls, " << total << " bytes copied" << std::endl;
+    std::cout << "[          ] stream: " << (total / stream_time / 1e6) << " MB/s, "
+              << stream_calls << " calls, 0 bytes copied" << std::endl;
+}
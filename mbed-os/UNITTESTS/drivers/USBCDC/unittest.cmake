@@ -0,0 +1,34 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "USBCDC")
+
+# Add test specific include paths, the rtos mocks first for the plain
+# "Mutex.h" include of AsyncOp.h
+set(unittest-includes target_h/rtos ${unittest-includes}
+  .
+  ../hal
+  ../hal/usb
+  ../drivers/internal
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/usb/USBCDC.cpp
+  ../drivers/source/usb/USBDevice.cpp
+  ../drivers/source/usb/EndpointResolver.cpp
+  ../drivers/source/usb/AsyncOp.cpp
+  ../drivers/source/usb/OperationListBase.cpp
+  ../drivers/source/usb/LinkedListBase.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/USBCDC/test_USBCDC.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_critical_stub.c
+  stubs/Mutex_stub.cpp
+  stubs/Semaphore_stub.cpp
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "drivers/USBMSD.h"
+#include "HeapBlockDevice.h"
+#include "USBPhy.h"
+#include "usb_phy_api.h"
+
+#include <functional>
+#include <string.h>
+#include <vector>
+
+#define BLOCK_SIZE      512
+#define BLOCK_COUNT     256
+#define MAX_PACKET      64
+
+#define SCSI_TEST_UNIT_READY    0x00
+#define SCSI_READ10             0x28
+#define SCSI_WRITE10            0x2A
+#define SCSI_SYNCHRONIZE_CACHE  0x35
+
+/* Heap block device counting the accesses made to it */
+class CountingBlockDevice : public HeapBlockDevice {
+public:
+    CountingBlockDevice() : HeapBlockDevice(BLOCK_SIZE * BLOCK_COUNT, BLOCK_SIZE), reads(0), programs(0), erases(0), fail_program(false)
+    {
+    }
+
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size)
+    {
+        reads++;
+        return HeapBlockDevice::read(buffer, addr, size);
+    }
+
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size)
+    {
+        programs++;
+        if (fail_program) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        return HeapBlockDevice::program(buffer, addr, size);
+    }
+
+    virtual int erase(bd_addr_t addr, bd_size_t size)
+    {
+        erases++;
+        return HeapBlockDevice::erase(addr, size);
+    }
+
+    int reads;
+    int programs;
+    int erases;
+    bool fail_program;
+};
+
+/* USB phy scripted by the test, which plays the host */
+class ScriptedPhy : public USBPhy {
+public:
+    ScriptedPhy() : events(NULL), bulk_in(0), bulk_out(0), out_buffer(NULL), out_size(0)
+    {
+        memset(&table, 0, sizeof(table));
+        table.resources = 16;
+        table.table[0].attributes = USB_EP_ATTR_ALLOW_CTRL | USB_EP_ATTR_DIR_IN_AND_OUT;
+        for (int i = 1; i < 16; i++) {
+            table.table[i].attributes = USB_EP_ATTR_ALLOW_ALL | USB_EP_ATTR_DIR_IN_AND_OUT;
+        }
+        memset(setup, 0, sizeof(setup));
+    }
+
+    /* Deliver an event from the phy's interrupt */
+    void deliver(std::function<void()> event)
+    {
+        pending = event;
+        events->start_process();
+    }
+
+    virtual void init(USBPhyEvents *events)
+    {
+        this->events = events;
+    }
+    virtual void deinit() {}
+    virtual bool powered()
+    {
+        return true;
+    }
+    virtual void connect() {}
+    virtual void disconnect() {}
+    virtual void configure() {}
+    virtual void unconfigure() {}
+    virtual void sof_enable() {}
+    virtual void sof_disable() {}
+    virtual void set_address(uint8_t address) {}
+    virtual void remote_wakeup() {}
+    virtual const usb_ep_table_t *endpoint_table()
+    {
+        return &table;
+    }
+    virtual uint32_t ep0_set_max_packet(uint32_t max_packet)
+    {
+        return max_packet;
+    }
+    virtual void ep0_setup_read_result(uint8_t *buffer, uint32_t size)
+    {
+        memcpy(buffer, setup, sizeof(setup));
+    }
+    virtual void ep0_read(uint8_t *data, uint32_t size) {}
+    virtual uint32_t ep0_read_result()
+    {
+        return 0;
+    }
+    virtual void ep0_write(uint8_t *buffer, uint32_t size) {}
+    virtual void ep0_stall() {}
+    virtual bool endpoint_add(usb_ep_t endpoint, uint32_t max_packet, usb_ep_type_t type)
+    {
+        if (endpoint & 0x80) {
+            bulk_in = endpoint;
+        } else {
+            bulk_out = endpoint;
+        }
+        return true;
+    }
+    virtual void endpoint_remove(usb_ep_t endpoint) {}
+    virtual void endpoint_stall(usb_ep_t endpoint) {}
+    virtual void endpoint_unstall(usb_ep_t endpoint) {}
+    virtual bool endpoint_read(usb_ep_t endpoint, uint8_t *data, uint32_t size)
+    {
+        out_buffer = data;
+        return true;
+    }
+    virtual uint32_t endpoint_read_result(usb_ep_t endpoint)
+    {
+        return out_size;
+    }
+    virtual bool endpoint_write(usb_ep_t endpoint, uint8_t *data, uint32_t size)
+    {
+        in_packets.push_back(std::vector<uint8_t>(data, data + size));
+        return true;
+    }
+    virtual void endpoint_abort(usb_ep_t endpoint) {}
+    virtual void process()
+    {
+        std::function<void()> event = pending;
+        pending = nullptr;
+        event();
+    }
+
+    USBPhyEvents *events;
+    usb_ep_table_t table;
+    uint8_t setup[8];
+    usb_ep_t bulk_in;
+    usb_ep_t bulk_out;
+    uint8_t *out_buffer;
+    uint32_t out_size;
+    std::vector<std::vector<uint8_t> > in_packets;
+    std::function<void()> pending;
+};
+
+USBPhy *get_usb_phy()
+{
+    return NULL;
+}
+
+class TestUSBMSD : public testing::Test {
+protected:
+    void SetUp()
+    {
+        bd = new CountingBlockDevice();
+        msd = new USBMSD(&phy, bd, 0x0703, 0x0104, 0x0001);
+        ASSERT_TRUE(msd->connect());
+
+        // Bus reset then SET_CONFIGURATION 1
+        phy.deliver([this]() {
+            phy.events->reset();
+        });
+        msd->process();
+        const uint8_t set_configuration[8] = { 0x00, 0x09, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+        memcpy(phy.setup, set_configuration, sizeof(set_configuration));
+        phy.deliver([this]() {
+            phy.events->ep0_setup();
+        });
+        msd->process();
+        ASSERT_TRUE(phy.out_buffer != NULL);
+
+        // Known contents, then count accesses made over USB only
+        std::vector<uint8_t> block(BLOCK_SIZE);
+        for (uint32_t i = 0; i < BLOCK_COUNT; i++) {
+            fill(&block[0], i, 0);
+            bd->program(&block[0], i * BLOCK_SIZE, BLOCK_SIZE);
+        }
+        bd->reads = 0;
+        bd->programs = 0;
+        bd->erases = 0;
+        tag = 0;
+    }
+
+    void TearDown()
+    {
+        delete msd;
+        delete bd;
+    }
+
+    static void fill(uint8_t *data, uint32_t block, uint8_t seed)
+    {
+        for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+            data[i] = (uint8_t)(block * 7 + i + seed);
+        }
+    }
+
+    /* Host sends a packet on the bulk OUT endpoint */
+    void host_out(const uint8_t *data, uint32_t size)
+    {
+        ASSERT_TRUE(phy.out_buffer != NULL);
+        memcpy(phy.out_buffer, data, size);
+        phy.out_buffer = NULL;
+        phy.out_size = size;
+        phy.deliver([this]() {
+            phy.events->out(phy.bulk_out);
+        });
+        msd->process();
+    }
+
+    /* Host takes a packet from the bulk IN endpoint */
+    std::vector<uint8_t> host_in()
+    {
+        EXPECT_EQ(1u, phy.in_packets.size());
+        if (phy.in_packets.empty()) {
+            return std::vector<uint8_t>();
+        }
+        std::vector<uint8_t> packet = phy.in_packets.front();
+        phy.in_packets.erase(phy.in_packets.begin());
+        phy.deliver([this]() {
+            phy.events->in(phy.bulk_in);
+        });
+        msd->process();
+        return packet;
+    }
+
+    /* Run a SCSI command through the bulk-only transport, returning the CSW status */
+    int scsi(uint8_t opcode, uint32_t lba, uint16_t blocks, bool in, uint8_t *data)
+    {
+        uint32_t length = (opcode == SCSI_READ10 || opcode == SCSI_WRITE10) ? blocks * BLOCK_SIZE : 0;
+        uint8_t cbw[31];
+        memset(cbw, 0, sizeof(cbw));
+        const uint32_t fields[3] = { 0x43425355, ++tag, length };
+        memcpy(cbw, fields, sizeof(fields));
+        cbw[12] = in ? 0x80 : 0x00;
+        cbw[14] = 10;
+        cbw[15] = opcode;
+        cbw[17] = lba >> 24;
+        cbw[18] = lba >> 16;
+        cbw[19] = lba >> 8;
+        cbw[20] = lba;
+        cbw[22] = blocks >> 8;
+        cbw[23] = blocks;
+        host_out(cbw, sizeof(cbw));
+
+        for (uint32_t done = 0; done < length; done += MAX_PACKET) {
+            if (in) {
+                std::vector<uint8_t> packet = host_in();
+                EXPECT_EQ((size_t)MAX_PACKET, packet.size());
+                memcpy(data + done, &packet[0], packet.size());
+            } else {
+                host_out(data + done, MAX_PACKET);
+            }
+        }
+
+        std::vector<uint8_t> csw = host_in();
+        EXPECT_EQ(13u, csw.size());
+        uint32_t signature, csw_tag, residue;
+        memcpy(&signature, &csw[0], 4);
+        memcpy(&csw_tag, &csw[4], 4);
+        memcpy(&residue, &csw[8], 4);
+        EXPECT_EQ(0x53425355u, signature);
+        EXPECT_EQ(tag, csw_tag);
+        EXPECT_EQ(0u, residue);
+        return csw[12];
+    }
+
+    int read(uint32_t lba, uint16_t blocks, uint8_t *data)
+    {
+        return scsi(SCSI_READ10, lba, blocks, true, data);
+    }
+
+    int write(uint32_t lba, uint16_t blocks, uint8_t seed)
+    {
+        std::vector<uint8_t> data(blocks * BLOCK_SIZE);
+        for (uint32_t i = 0; i < blocks; i++) {
+            fill(&data[i * BLOCK_SIZE], lba + i, seed);
+        }
+        return scsi(SCSI_WRITE10, lba, blocks, false, &data[0]);
+    }
+
+    /* Whether the block device holds the data written with seed */
+    bool holds(uint32_t lba, uint8_t seed)
+    {
+        std::vector<uint8_t> expected(BLOCK_SIZE), actual(BLOCK_SIZE);
+        fill(&expected[0], lba, seed);
+        bd->HeapBlockDevice::read(&actual[0], lba * BLOCK_SIZE, BLOCK_SIZE);
+        return expected == actual;
+    }
+
+    bool data_matches(const uint8_t *data, uint32_t lba, uint16_t blocks, uint8_t seed)
+    {
+        std::vector<uint8_t> expected(BLOCK_SIZE);
+        for (uint32_t i = 0; i < blocks; i++) {
+            fill(&expected[0], lba + i, seed);
+            if (memcmp(&expected[0], data + i * BLOCK_SIZE, BLOCK_SIZE)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ScriptedPhy phy;
+    CountingBlockDevice *bd;
+    USBMSD *msd;
+    uint32_t tag;
+};
+
+TEST_F(TestUSBMSD, read_spans_many_blocks)
+{
+    std::vector<uint8_t> data(16 * BLOCK_SIZE);
+
+    EXPECT_EQ(0, read(0, 16, &data[0]));
+    EXPECT_TRUE(data_matches(&data[0], 0, 16, 0));
+
+    // One block device read per 8 blocks rather than per block
+    EXPECT_EQ(2, bd->reads);
+}
+
+TEST_F(TestUSBMSD, sequential_reads_are_read_ahead)
+{
+    std::vector<uint8_t> data(BLOCK_SIZE);
+
+    for (uint32_t lba = 32; lba < 48; lba++) {
+        EXPECT_EQ(0, read(lba, 1, &data[0]));
+        EXPECT_TRUE(data_matches(&data[0], lba, 1, 0));
+    }
+    EXPECT_EQ(3, bd->reads);
+
+    // Reads elsewhere fetch only what they ask for
+    bd->reads = 0;
+    const uint32_t scattered[] = { 100, 7, 200, BLOCK_COUNT - 1 };
+    for (size_t i = 0; i < sizeof(scattered) / sizeof(scattered[0]); i++) {
+        EXPECT_EQ(0, read(scattered[i], 1, &data[0]));
+        EXPECT_TRUE(data_matches(&data[0], scattered[i], 1, 0));
+    }
+    EXPECT_EQ(4, bd->reads);
+}
+
+TEST_F(TestUSBMSD, write_spans_many_blocks)
+{
+    // One program per 8 blocks, all done before the status
+    EXPECT_EQ(0, write(60, 12, 1));
+    EXPECT_EQ(2, bd->programs);
+    EXPECT_EQ(2, bd->erases);
+    for (uint32_t lba = 60; lba < 72; lba++) {
+        EXPECT_TRUE(holds(lba, 1));
+    }
+    EXPECT_TRUE(holds(59, 0));
+    EXPECT_TRUE(holds(72, 0));
+
+    // Nothing is left to write
+    EXPECT_EQ(0, scsi(SCSI_SYNCHRONIZE_CACHE, 0, 0, false, NULL));
+    EXPECT_EQ(2, bd->programs);
+}
+
+TEST_F(TestUSBMSD, writes_are_not_held_after_status)
+{
+    std::vector<uint8_t> data(4 * BLOCK_SIZE);
+
+    for (uint32_t lba = 10; lba < 22; lba += 2) {
+        EXPECT_EQ(0, write(lba, 2, 2));
+        EXPECT_TRUE(holds(lba, 2));
+        EXPECT_TRUE(holds(lba + 1, 2));
+    }
+    EXPECT_EQ(6, bd->programs);
+
+    // A read sees the blocks just written
+    EXPECT_EQ(0, write(50, 3, 3));
+    EXPECT_EQ(0, read(49, 4, &data[0]));
+    EXPECT_TRUE(data_matches(&data[0], 49, 1, 0));
+    EXPECT_TRUE(data_matches(&data[BLOCK_SIZE], 50, 3, 3));
+    EXPECT_EQ(7, bd->programs);
+}
+
+TEST_F(TestUSBMSD, write_failure_is_reported)
+{
+    bd->fail_program = true;
+
+    EXPECT_EQ(1, write(40, 2, 4));
+
+    // A failure while the cache fills fails the write too
+    EXPECT_EQ(1, write(60, 12, 4));
+    EXPECT_EQ(0, scsi(SCSI_SYNCHRONIZE_CACHE, 0, 0, false, NULL));
+
+    bd->fail_program = false;
+    EXPECT_EQ(0, write(60, 12, 4));
+    EXPECT_TRUE(holds(71, 4));
+}
@@ -0,0 +1,40 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "USBMSD")
+
+# Add test specific include paths, the rtos mocks first for the plain
+# "Mutex.h" include of USBMSD.h
+set(unittest-includes target_h/rtos ${unittest-includes}
+  .
+  ../hal
+  ../hal/usb
+  ../drivers/internal
+  ../features/storage/blockdevice
+)
+
+# Source files
+set(unittest-sources
+  ../drivers/source/usb/USBMSD.cpp
+  ../drivers/source/usb/USBDevice.cpp
+  ../drivers/source/usb/EndpointResolver.cpp
+  ../drivers/source/usb/PolledQueue.cpp
+  ../drivers/source/usb/TaskBase.cpp
+  ../drivers/source/usb/LinkedListBase.cpp
+  ../features/storage/blockdevice/HeapBlockDevice.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  drivers/USBMSD/test_USBMSD.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_atomic_stub.c
+  stubs/mbed_critical_stub.c
+  stubs/Mutex_stub.cpp
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
+
+# defines
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS=8")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS=8")
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "NanostackMemoryManager.h"
+#include "EMAC.h"
+#include "nsdynmemLIB.h"
+
+#include <chrono>
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Nanostack heap, counted to tell pool buffers from heap ones */
+static int heap_allocs;
+static int heap_frees;
+
+void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size)
+{
+    heap_allocs++;
+    return malloc(alloc_size);
+}
+
+void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size)
+{
+    heap_allocs++;
+    return malloc(alloc_size);
+}
+
+void ns_dyn_mem_free(void *heap_ptr)
+{
+    if (heap_ptr) {
+        heap_frees++;
+    }
+    ::free(heap_ptr);
+}
+
+/* Allocates pool buffers the way the manager did before it had a pool */
+class HeapMemoryManager : public NanostackMemoryManager {
+public:
+    virtual emac_mem_buf_t *alloc_pool(uint32_t size, uint32_t align)
+    {
+        return alloc_heap(size, align);
+    }
+};
+
+/* Sends frames straight back, receiving them into a new pool buffer like a driver would */
+class LoopbackEMAC : public EMAC {
+public:
+    LoopbackEMAC() : memory_manager(NULL) {}
+
+    virtual uint32_t get_mtu_size() const
+    {
+        return 1500;
+    }
+
+    virtual uint32_t get_align_preference() const
+    {
+        return 0;
+    }
+
+    virtual void get_ifname(char *name, uint8_t size) const
+    {
+        strncpy(name, "lo", size);
+    }
+
+    virtual uint8_t get_hwaddr_size() const
+    {
+        return 6;
+    }
+
+    virtual bool get_hwaddr(uint8_t *addr) const
+    {
+        return false;
+    }
+
+    virtual void set_hwaddr(const uint8_t *addr)
+    {
+    }
+
+    virtual bool link_out(emac_mem_buf_t *buf)
+    {
+        uint32_t len = memory_manager->get_total_len(buf);
+        emac_mem_buf_t *rx = memory_manager->alloc_pool(len, get_align_preference());
+        if (rx) {
+            memory_manager->copy(rx, buf);
+        }
+        memory_manager->free(buf);
+        if (!rx) {
+            return false;
+        }
+        input_cb(rx);
+        return true;
+    }
+
+    virtual bool power_up()
+    {
+        return true;
+    }
+
+    virtual void power_down()
+    {
+    }
+
+    virtual void set_link_input_cb(emac_link_input_cb_t input_cb)
+    {
+        this->input_cb = input_cb;
+    }
+
+    virtual void set_link_state_cb(emac_link_state_change_cb_t state_cb)
+    {
+    }
+
+    virtual void add_multicast_group(const uint8_t *address)
+    {
+    }
+
+    virtual void remove_multicast_group(const uint8_t *address)
+    {
+    }
+
+    virtual void set_all_multicast(bool all)
+    {
+    }
+
+    virtual void set_memory_manager(EMACMemoryManager &mem_mngr)
+    {
+        memory_manager = &mem_mngr;
+    }
+
+private:
+    EMACMemoryManager *memory_manager;
+    emac_link_input_cb_t input_cb;
+};
+
+/* Takes frames in and out like the Nanostack EMAC glue */
+class EMACPhyModel {
+public:
+    EMACPhyModel(EMACMemoryManager &mem, EMAC &emac) : memory_manager(mem), emac(emac), received(0), copied(0), sum(0)
+    {
+        emac.set_memory_manager(memory_manager);
+        emac.set_link_input_cb(mbed::callback(this, &EMACPhyModel::rx));
+    }
+
+    bool tx(const uint8_t *data, uint16_t len)
+    {
+        emac_mem_buf_t *mem = memory_manager.alloc_pool(len, 0);
+        if (!mem) {
+            return false;
+        }
+        memory_manager.copy_to_buf(mem, data, len);
+        return emac.link_out(mem);
+    }
+
+    void rx(emac_mem_buf_t *mem)
+    {
+        const uint8_t *ptr;
+        uint8_t *tmpbuf = NULL;
+        uint32_t total_len;
+
+        if (memory_manager.get_next(mem) == NULL) {
+            ptr = static_cast<const uint8_t *>(memory_manager.get_ptr(mem));
+            total_len = memory_manager.get_len(mem);
+        } else {
+            // Nanostack needs contiguous frames
+            total_len = memory_manager.get_total_len(mem);
+            ptr = tmpbuf = static_cast<uint8_t *>(ns_dyn_mem_temporary_alloc(total_len));
+            memory_manager.copy_from_buf(tmpbuf, total_len, mem);
+            copied++;
+        }
+        sum += ptr[0] + ptr[total_len - 1];
+        received++;
+        ns_dyn_mem_free(tmpbuf);
+        memory_manager.free(mem);
+    }
+
+    EMACMemoryManager &memory_manager;
+    EMAC &emac;
+    uint32_t received;
+    uint32_t copied;
+    uint32_t sum;
+};
+
+class TestNanostackMemoryManager : public testing::Test {
+protected:
+    enum { units = MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS };
+
+    NanostackMemoryManager manager;
+
+    void SetUp()
+    {
+        heap_allocs = 0;
+        heap_frees = 0;
+    }
+
+    void TearDown()
+    {
+        // Every buffer went back where it came from
+        EXPECT_EQ(heap_allocs, heap_frees);
+        int allocs = heap_allocs;
+        emac_mem_buf_t *all = manager.alloc_pool(units * manager.get_pool_alloc_unit(0), 0);
+        EXPECT_EQ(allocs, heap_allocs);
+        manager.free(all);
+    }
+};
+
+TEST_F(TestNanostackMemoryManager, frame_is_one_pool_buffer)
+{
+    EXPECT_EQ(1536u, manager.get_pool_alloc_unit(0));
+
+    emac_mem_buf_t *buf = manager.alloc_pool(1514, 0);
+    ASSERT_TRUE(buf != NULL);
+    EXPECT_TRUE(manager.get_next(buf) == NULL);
+    EXPECT_EQ(1514u, manager.get_len(buf));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(manager.get_ptr(buf)) % 8);
+    EXPECT_EQ(0, heap_allocs);
+
+    memset(manager.get_ptr(buf), 0xA5, 1514);
+    manager.free(buf);
+}
+
+TEST_F(TestNanostackMemoryManager, large_allocation_is_chained)
+{
+    emac_mem_buf_t *buf = manager.alloc_pool(4000, 0);
+    ASSERT_TRUE(buf != NULL);
+    EXPECT_EQ(4000u, manager.get_total_len(buf));
+    EXPECT_EQ(1536u, manager.get_len(buf));
+    emac_mem_buf_t *next = manager.get_next(buf);
+    ASSERT_TRUE(next != NULL);
+    EXPECT_EQ(1536u, manager.get_len(next));
+    next = manager.get_next(next);
+    ASSERT_TRUE(next != NULL);
+    EXPECT_EQ(928u, manager.get_len(next));
+    EXPECT_TRUE(manager.get_next(next) == NULL);
+    EXPECT_EQ(0, heap_allocs);
+
+    // Data survives a round trip through the chain
+    uint8_t in[4000], out[4000];
+    for (size_t i = 0; i < sizeof in; i++) {
+        in[i] = i * 7;
+    }
+    manager.copy_to_buf(buf, in, sizeof in);
+    manager.copy_from_buf(out, sizeof out, buf);
+    EXPECT_EQ(0, memcmp(in, out, sizeof in));
+    manager.free(buf);
+}
+
+TEST_F(TestNanostackMemoryManager, alignment_reduces_unit)
+{
+    uint32_t unit = manager.get_pool_alloc_unit(32);
+    EXPECT_EQ(1536u - 24u, unit);
+
+    emac_mem_buf_t *bufs[units];
+    for (int i = 0; i < units; i++) {
+        bufs[i] = manager.alloc_pool(unit, 32);
+        ASSERT_TRUE(bufs[i] != NULL);
+        EXPECT_TRUE(manager.get_next(bufs[i]) == NULL);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(manager.get_ptr(bufs[i])) % 32);
+        memset(manager.get_ptr(bufs[i]), i, unit);
+    }
+    for (int i = 0; i < units; i++) {
+        EXPECT_EQ(i, static_cast<uint8_t *>(manager.get_ptr(bufs[i]))[unit - 1]);
+        manager.free(bufs[i]);
+    }
+    EXPECT_EQ(0, heap_allocs);
+}
+
+TEST_F(TestNanostackMemoryManager, exhausted_pool_uses_heap)
+{
+    emac_mem_buf_t *bufs[units];
+    for (int i = 0; i < units; i++) {
+        bufs[i] = manager.alloc_pool(100, 0);
+    }
+    EXPECT_EQ(0, heap_allocs);
+
+    emac_mem_buf_t *extra = manager.alloc_pool(100, 0);
+    ASSERT_TRUE(extra != NULL);
+    EXPECT_EQ(1, heap_allocs);
+
+    // A chain needing more units than are left comes from the heap whole
+    manager.free(bufs[0]);
+    emac_mem_buf_t *chain = manager.alloc_pool(2000, 0);
+    EXPECT_EQ(2, heap_allocs);
+    EXPECT_TRUE(manager.get_next(chain) == NULL);
+
+    // Freed units are used again
+    emac_mem_buf_t *reused = manager.alloc_pool(100, 0);
+    EXPECT_EQ(2, heap_allocs);
+
+    manager.free(reused);
+    manager.free(chain);
+    manager.free(extra);
+    for (int i = 1; i < units; i++) {
+        manager.free(bufs[i]);
+    }
+}
+
+TEST_F(TestNanostackMemoryManager, free_releases_whole_chain)
+{
+    emac_mem_buf_t *pool_buf = manager.alloc_pool(100, 0);
+    emac_mem_buf_t *heap_buf = manager.alloc_heap(100, 0);
+    emac_mem_buf_t *pool_chain = manager.alloc_pool(2000, 0);
+    manager.cat(pool_buf, heap_buf);
+    manager.cat(pool_buf, pool_chain);
+    EXPECT_EQ(2200u, manager.get_total_len(pool_buf));
+
+    manager.free(pool_buf);
+    EXPECT_EQ(1, heap_frees);
+}
+
+TEST_F(TestNanostackMemoryManager, loopback_rx_rate)
+{
+    const uint32_t frames = 200000;
+    const uint16_t sizes[] = { 64, 590, 1280, 1514 };
+    uint8_t frame[1514];
+    for (size_t i = 0; i < sizeof frame; i++) {
+        frame[i] = i;
+    }
+
+    HeapMemoryManager heap_manager;
+    NanostackMemoryManager *managers[] = { &heap_manager, &manager };
+    const char *names[] = { "heap", "pool" };
+    for (int m = 0; m < 2; m++) {
+        LoopbackEMAC emac;
+        EMACPhyModel phy(*managers[m], emac);
+        heap_allocs = heap_frees = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < frames; i++) {
+            ASSERT_TRUE(phy.tx(frame, sizes[i % 4]));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        EXPECT_EQ(frames, phy.received);
+        EXPECT_EQ(0u, phy.copied);
+        std::cout << "[          ] " << names[m] << ": " << static_cast<uint32_t>(frames / seconds)
+                  << " frames/s, " << heap_allocs << " heap allocations" << std::endl;
+        if (m == 1) {
+            EXPECT_EQ(0, heap_allocs);
+        } else {
+            EXPECT_EQ(2 * frames, static_cast<uint32_t>(heap_allocs));
+        }
+    }
+    heap_allocs = heap_frees = 0;
+}
@@ -0,0 +1,25 @@
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "NanostackMemoryManager")
+
+# Add test specific include paths
+set(unittest-includes ${unittest-includes}
+  ../features/nanostack/mbed-mesh-api/source/include
+)
+
+# Source files
+set(unittest-sources
+  ../features/nanostack/mbed-mesh-api/source/NanostackMemoryManager.cpp
+  ../features/netsocket/NetStackMemoryManager.cpp
+)
+
+# Test files
+set(unittest-test-sources
+  features/nanostack/NanostackMemoryManager/test_NanostackMemoryManager.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_critical_stub.c
+)
+
+# defines
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNIT_SIZE=1536 -DMBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS=8")
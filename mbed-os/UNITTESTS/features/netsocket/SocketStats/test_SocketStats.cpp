@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "features/netsocket/SocketStats.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+
+using mbed::StatCounter;
+
+// Sockets are only used as identifiers
+static uint32_t socket_ids[8];
+#define SOCKET(n) (reinterpret_cast<Socket *>(&socket_ids[n]))
+
+static uint32_t registered_total(const char *name)
+{
+    mbed_stats_counter_t stats[16];
+    size_t n = StatCounter::get_each(stats, 16);
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(stats[i].name, name) == 0) {
+            return stats[i].value;
+        }
+    }
+    return 0;
+}
+
+class TestSocketStats : public testing::Test {
+protected:
+    void SetUp()
+    {
+        StatCounter::reset_all();
+    }
+};
+
+TEST_F(TestSocketStats, byte_counts)
+{
+    SocketStats owner;
+    owner.stats_new_socket_entry(SOCKET(0));
+    owner.stats_update_proto(SOCKET(0), NSAPI_UDP);
+    owner.stats_update_socket_state(SOCKET(0), SOCK_OPEN);
+    owner.stats_update_sent_bytes(SOCKET(0), 100);
+    owner.stats_update_sent_bytes(SOCKET(0), 20);
+    owner.stats_update_recv_bytes(SOCKET(0), 7);
+    // Error codes passed as sizes are ignored
+    owner.stats_update_sent_bytes(SOCKET(0), (size_t)NSAPI_ERROR_WOULD_BLOCK);
+
+    // Another SocketStats instance has no cached entry and takes the slow path
+    SocketStats other;
+    other.stats_update_recv_bytes(SOCKET(0), 3);
+
+    mbed_stats_socket_t stats[4];
+    ASSERT_EQ(1u, SocketStats::mbed_stats_socket_get_each(stats, 4));
+    EXPECT_EQ(SOCKET(0), stats[0].reference_id);
+    EXPECT_EQ(NSAPI_UDP, stats[0].proto);
+    EXPECT_EQ(SOCK_OPEN, stats[0].state);
+    EXPECT_EQ(120u, stats[0].sent_bytes);
+    EXPECT_EQ(10u, stats[0].recv_bytes);
+
+    EXPECT_EQ(120u, registered_total("socket.sent_bytes"));
+    EXPECT_EQ(10u, registered_total("socket.recv_bytes"));
+    owner.stats_update_socket_state(SOCKET(0), SOCK_CLOSED);
+}
+
+TEST_F(TestSocketStats, closed_entry_reused)
+{
+    // Socket 0 may already have an entry from another test, it is reopened
+    SocketStats sockets[5];
+    for (int i = 0; i < 4; i++) {
+        sockets[i].stats_new_socket_entry(SOCKET(i));
+        sockets[i].stats_update_socket_state(SOCKET(i), SOCK_OPEN);
+        sockets[i].stats_update_sent_bytes(SOCKET(i), 10 * i);
+    }
+
+    // The table is full; socket 2 closes and socket 4 takes its entry
+    sockets[2].stats_update_socket_state(SOCKET(2), SOCK_CLOSED);
+    sockets[4].stats_new_socket_entry(SOCKET(4));
+    sockets[4].stats_update_sent_bytes(SOCKET(4), 5);
+
+    // The stale cached position of socket 2 no longer matches
+    sockets[2].stats_update_sent_bytes(SOCKET(2), 1000);
+
+    mbed_stats_socket_t stats[4];
+    size_t n = SocketStats::mbed_stats_socket_get_each(stats, 4);
+    ASSERT_EQ(4u, n);
+    bool found = false;
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_NE(SOCKET(2), stats[i].reference_id);
+        if (stats[i].reference_id == SOCKET(4)) {
+            EXPECT_EQ(5u, stats[i].sent_bytes);
+            EXPECT_FALSE(stats[i].peer);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+
+    for (int i = 1; i < 5; i++) {
+        sockets[i].stats_update_socket_state(SOCKET(i), SOCK_CLOSED);
+    }
+}
+
+TEST_F(TestSocketStats, per_packet_overhead)
+{
+    const int packets = 100000;
+    SocketStats owner;
+    SocketStats other;
+    owner.stats_new_socket_entry(SOCKET(5));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < packets; i++) {
+        owner.stats_update_sent_bytes(SOCKET(5), 1);
+    }
+    std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < packets; i++) {
+        other.stats_update_sent_bytes(SOCKET(5), 1);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    std::cout << "[          ] " << packets << " updates: cached entry "
+              << std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count() << " us, locked lookup "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() << " us" << std::endl;
+
+    EXPECT_EQ(2u * packets, registered_total("socket.sent_bytes"));
+    owner.stats_update_socket_state(SOCKET(5), SOCK_CLOSED);
+}
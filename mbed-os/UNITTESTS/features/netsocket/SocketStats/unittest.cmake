@@ -0,0 +1,27 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+  ../features/netsocket/SocketStats.cpp
+  ../features/netsocket/SocketAddress.cpp
+  ../platform/source/StatCounter.cpp
+  ../features/frameworks/nanostack-libservice/source/libip4string/ip4tos.c
+  ../features/frameworks/nanostack-libservice/source/libip6string/ip6tos.c
+  ../features/frameworks/nanostack-libservice/source/libip4string/stoip4.c
+  ../features/frameworks/nanostack-libservice/source/libip6string/stoip6.c
+  ../features/frameworks/nanostack-libservice/source/libBits/common_functions.c
+)
+
+set(unittest-test-sources
+  features/netsocket/SocketStats/test_SocketStats.cpp
+  stubs/Mutex_stub.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_atomic_stub.c
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+  stubs/Kernel_stub.cpp
+  stubs/mbed_error.c
+)
+
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_NSAPI_SOCKET_STATS_ENABLED=1 -DMBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT=4")
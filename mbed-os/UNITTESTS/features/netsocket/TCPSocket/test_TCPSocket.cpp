@@ -18,6 +18,11 @@
 #include "gtest/gtest.h"
 #include "features/netsocket/TCPSocket.h"
 #include "NetworkStack_stub.h"
+#include "NetStackMemoryManager_stub.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
 
 // Control the rtos EventFlags stub. See EventFlags_stub.cpp
 extern std::list<uint32_t> eventFlagsStubNextRetval;
@@ -28,6 +33,53 @@ class TCPSocketFriend : public TCPSocket {
     FRIEND_TEST(TestTCPSocket, get_proto);
 };
 
+/*
+ * Loops sent data back to the receive side, the way a stack does over a
+ * loopback EMAC: copying sockets copy into and out of stack buffers, buffer
+ * sockets pass the stack buffers through.
+ */
+class LoopbackStack : public NetworkStackstub {
+public:
+    std::list<net_stack_mem_buf_t *> frames;
+
+protected:
+    virtual nsapi_size_or_error_t socket_send(nsapi_socket_t handle, const void *data, nsapi_size_t size)
+    {
+        net_stack_mem_buf_t *buf = memory_manager->alloc_pool(size, 0);
+        memory_manager->copy_to_buf(buf, data, size);
+        frames.push_back(buf);
+        return size;
+    }
+    virtual nsapi_size_or_error_t socket_recv(nsapi_socket_t handle, void *data, nsapi_size_t size)
+    {
+        if (frames.empty()) {
+            return NSAPI_ERROR_WOULD_BLOCK;
+        }
+        net_stack_mem_buf_t *buf = frames.front();
+        frames.pop_front();
+        nsapi_size_t len = memory_manager->copy_from_buf(data, size, buf);
+        memory_manager->free(buf);
+        return len;
+    }
+    virtual nsapi_size_or_error_t socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address,
+                                                     net_stack_mem_buf_t *buf, nsapi_size_t offset)
+    {
+        frames.push_back(buf);
+        return memory_manager->get_total_len(buf) - offset;
+    }
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address,
+                                                     net_stack_mem_buf_t **buf)
+    {
+        if (frames.empty()) {
+            *buf = NULL;
+            return NSAPI_ERROR_WOULD_BLOCK;
+        }
+        *buf = frames.front();
+        frames.pop_front();
+        return memory_manager->get_total_len(*buf);
+    }
+};
+
 class TestTCPSocket : public testing::Test {
 public:
     unsigned int dataSize = 10;
@@ -35,10 +87,12 @@ public:
 protected:
     TCPSocket *socket;
     NetworkStackstub stack;
+    NetStackMemoryManagerstub memory_manager;
 
     virtual void SetUp()
     {
         socket = new TCPSocket();
+        stack.memory_manager = &memory_manager;
     }
 
     virtual void TearDown()
@@ -230,6 +284,189 @@ TEST_F(TestTCPSocket, recv_from_null)
     EXPECT_EQ(socket->recvfrom(NULL, dataBuf, dataSize), NSAPI_ERROR_OK);
 }
 
+/* zero-copy send and receive */
+
+TEST_F(TestTCPSocket, send_acquire_no_open)
+{
+    net_stack_mem_buf_t *buf;
+    EXPECT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_NO_SOCKET);
+    EXPECT_TRUE(socket->buffer_manager() == NULL);
+}
+
+TEST_F(TestTCPSocket, send_acquire_unsupported)
+{
+    stack.memory_manager = NULL;
+    socket->open((NetworkStack *)&stack);
+    net_stack_mem_buf_t *buf;
+    EXPECT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_UNSUPPORTED);
+    EXPECT_TRUE(socket->buffer_manager() == NULL);
+}
+
+TEST_F(TestTCPSocket, send_commit_in_one_chunk)
+{
+    socket->open((NetworkStack *)&stack);
+    net_stack_mem_buf_t *buf;
+    ASSERT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_OK);
+    EXPECT_EQ(socket->buffer_manager(), &memory_manager);
+    EXPECT_EQ(memory_manager.get_total_len(buf), dataSize);
+    stack.return_value = dataSize;
+    EXPECT_EQ(socket->send_commit(buf), dataSize);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, send_commit_in_two_chunks)
+{
+    socket->open((NetworkStack *)&stack);
+    net_stack_mem_buf_t *buf;
+    ASSERT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_OK);
+    stack.return_values.push_back(4);
+    stack.return_values.push_back(dataSize - 4);
+    EXPECT_EQ(socket->send_commit(buf), dataSize);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, send_commit_partial_keeps_buffer)
+{
+    socket->open((NetworkStack *)&stack);
+    socket->set_blocking(false);
+    net_stack_mem_buf_t *buf;
+    ASSERT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_OK);
+    stack.return_values.push_back(4);
+    EXPECT_EQ(socket->send_commit(buf), 4);
+    EXPECT_EQ(memory_manager.allocated, 1);
+
+    // The rest is sent from where the first commit stopped
+    stack.return_values.push_back(dataSize - 4);
+    EXPECT_EQ(socket->send_commit(buf, 4), dataSize - 4);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, send_commit_error_keeps_buffer)
+{
+    socket->open((NetworkStack *)&stack);
+    net_stack_mem_buf_t *buf;
+    ASSERT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_OK);
+    stack.return_value = NSAPI_ERROR_NO_MEMORY;
+    EXPECT_EQ(socket->send_commit(buf), NSAPI_ERROR_NO_MEMORY);
+    EXPECT_EQ(memory_manager.allocated, 1);
+    socket->buffer_release(buf);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, send_commit_would_block)
+{
+    socket->open((NetworkStack *)&stack);
+    net_stack_mem_buf_t *buf;
+    ASSERT_EQ(socket->send_acquire(dataSize, &buf), NSAPI_ERROR_OK);
+    stack.return_value = NSAPI_ERROR_WOULD_BLOCK;
+    eventFlagsStubNextRetval.push_back(osFlagsError); // Break the wait loop
+    EXPECT_EQ(socket->send_commit(buf), NSAPI_ERROR_WOULD_BLOCK);
+    socket->buffer_release(buf);
+}
+
+TEST_F(TestTCPSocket, receive_acquire)
+{
+    SocketAddress a("127.0.0.1", 1024);
+    socket->open((NetworkStack *)&stack);
+    EXPECT_EQ(socket->connect(a), NSAPI_ERROR_OK);
+    stack.return_value = dataSize;
+    net_stack_mem_buf_t *buf;
+    SocketAddress b;
+    ASSERT_EQ(socket->receive_acquire(&buf, &b), dataSize);
+    EXPECT_EQ(memory_manager.get_total_len(buf), dataSize);
+    EXPECT_EQ(a, b);
+    socket->buffer_release(buf);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, receive_acquire_would_block)
+{
+    socket->open((NetworkStack *)&stack);
+    stack.return_value = NSAPI_ERROR_WOULD_BLOCK;
+    eventFlagsStubNextRetval.push_back(0);
+    eventFlagsStubNextRetval.push_back(osFlagsError); // Break the wait loop
+    net_stack_mem_buf_t *buf = reinterpret_cast<net_stack_mem_buf_t *>(dataBuf);
+    EXPECT_EQ(socket->receive_acquire(&buf), NSAPI_ERROR_WOULD_BLOCK);
+    EXPECT_EQ(buf, (net_stack_mem_buf_t *)NULL);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, receive_acquire_no_socket)
+{
+    net_stack_mem_buf_t *buf = reinterpret_cast<net_stack_mem_buf_t *>(dataBuf);
+    EXPECT_EQ(socket->receive_acquire(&buf), NSAPI_ERROR_NO_SOCKET);
+    EXPECT_EQ(buf, (net_stack_mem_buf_t *)NULL);
+}
+
+TEST_F(TestTCPSocket, receive_acquire_end_of_stream)
+{
+    socket->open((NetworkStack *)&stack);
+    stack.return_value = 0;
+    net_stack_mem_buf_t *buf = reinterpret_cast<net_stack_mem_buf_t *>(dataBuf);
+    EXPECT_EQ(socket->receive_acquire(&buf), 0);
+    EXPECT_EQ(buf, (net_stack_mem_buf_t *)NULL);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, buffer_release_after_close)
+{
+    socket->open((NetworkStack *)&stack);
+    stack.return_value = dataSize;
+    net_stack_mem_buf_t *buf;
+    ASSERT_EQ(socket->receive_acquire(&buf), dataSize);
+    socket->close();
+    socket->buffer_release(buf);
+    EXPECT_EQ(memory_manager.allocated, 0);
+}
+
+TEST_F(TestTCPSocket, loopback_bytes_copied)
+{
+    const uint32_t payloads = 100000;
+    const uint32_t payload_size = 1024;
+    static uint8_t tx[payload_size];
+    static uint8_t rx[payload_size];
+
+    LoopbackStack loopback;
+    loopback.memory_manager = &memory_manager;
+    socket->open((NetworkStack *)&loopback);
+
+    // Copying: the payload is built in user memory, then sent and received
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < payloads; i++) {
+        memset(tx, i, payload_size);
+        ASSERT_EQ(socket->send(tx, payload_size), payload_size);
+        ASSERT_EQ(socket->recv(rx, payload_size), payload_size);
+        ASSERT_EQ(rx[0], (uint8_t)i);
+    }
+    double copy_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint32_t copy_copied = memory_manager.copied;
+    memory_manager.copied = 0;
+
+    // Zero-copy: the payload is built in the stack buffer, and read from it
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < payloads; i++) {
+        net_stack_mem_buf_t *buf;
+        ASSERT_EQ(socket->send_acquire(payload_size, &buf), NSAPI_ERROR_OK);
+        memset(memory_manager.get_ptr(buf), i, payload_size);
+        ASSERT_EQ(socket->send_commit(buf), payload_size);
+        ASSERT_EQ(socket->receive_acquire(&buf), payload_size);
+        ASSERT_EQ(*static_cast<uint8_t *>(memory_manager.get_ptr(buf)), (uint8_t)i);
+        socket->buffer_release(buf);
+    }
+    double zero_copy_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(2u * payloads * payload_size, copy_copied);
+    EXPECT_EQ(0u, memory_manager.copied);
+    EXPECT_EQ(0, memory_manager.allocated);
+    std::cout << "[          ] copy: " << (double)copy_copied / (payloads * payload_size)
+              << " bytes copied per payload byte, " << static_cast<uint32_t>(payloads / copy_seconds)
+              << " payloads/s" << std::endl;
+    std::cout << "[          ] zero-copy: " << (double)memory_manager.copied / (payloads * payload_size)
+              << " bytes copied per payload byte, " << static_cast<uint32_t>(payloads / zero_copy_seconds)
+              << " payloads/s" << std::endl;
+    socket->close();
+}
+
 /* listen */
 
 TEST_F(TestTCPSocket, listen_no_open)
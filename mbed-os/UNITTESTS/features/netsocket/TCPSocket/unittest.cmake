@@ -6,6 +6,7 @@
 set(unittest-sources
   ../features/netsocket/SocketAddress.cpp
   ../features/netsocket/NetworkStack.cpp
+  ../features/netsocket/NetStackMemoryManager.cpp
   ../features/netsocket/InternetSocket.cpp
   ../features/netsocket/TCPSocket.cpp
   ../features/frameworks/nanostack-libservice/source/libip4string/ip4tos.c
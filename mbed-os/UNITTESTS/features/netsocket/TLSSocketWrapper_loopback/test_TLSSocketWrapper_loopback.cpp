@@ -0,0 +1,852 @@
+/*
+ * Copyright (c) 2020, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "features/netsocket/TLSSocketWrapper.h"
+#include "events/EventQueue.h"
+#include "kvstore_global_api.h"
+#include "mbed_error.h"
+#include "mbedtls/certs.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+mbed_error_status_t mbed_error(mbed_error_status_t error_status, const char *error_msg, unsigned int error_value, const char *filename, int line_number)
+{
+    abort();
+}
+
+// Entropy source for Mbed TLS, see MBEDTLS_ENTROPY_HARDWARE_ALT
+extern "C" int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    static std::mt19937 rng(1);
+    for (size_t i = 0; i < len; i++) {
+        output[i] = rng();
+    }
+    *olen = len;
+    return 0;
+}
+
+// Shared event queue of the coalescing timer, with time advanced by the tests
+extern "C" unsigned int equeue_global_time;
+static events::EventQueue queue(32 * EVENTS_EVENT_SIZE);
+
+namespace mbed {
+events::EventQueue *mbed_event_queue()
+{
+    return &queue;
+}
+}
+
+// KVStore kept in memory, it survives a reset when the cache is cleared
+static std::map<std::string, std::vector<uint8_t> > kv_store;
+
+struct _opaque_kv_key_iterator {
+    std::map<std::string, std::vector<uint8_t> >::iterator next;
+    std::string prefix;
+};
+
+int kv_set(const char *full_name_key, const void *buffer, size_t size, uint32_t create_flags)
+{
+    const uint8_t *data = static_cast<const uint8_t *>(buffer);
+    kv_store[full_name_key].assign(data, data + size);
+    return MBED_SUCCESS;
+}
+
+int kv_get(const char *full_name_key, void *buffer, size_t buffer_size, size_t *actual_size)
+{
+    auto item = kv_store.find(full_name_key);
+    if (item == kv_store.end()) {
+        return MBED_ERROR_ITEM_NOT_FOUND;
+    }
+    *actual_size = std::min(buffer_size, item->second.size());
+    memcpy(buffer, item->second.data(), *actual_size);
+    return MBED_SUCCESS;
+}
+
+int kv_get_info(const char *full_name_key, kv_info_t *info)
+{
+    auto item = kv_store.find(full_name_key);
+    if (item == kv_store.end()) {
+        return MBED_ERROR_ITEM_NOT_FOUND;
+    }
+    info->size = item->second.size();
+    info->flags = 0;
+    return MBED_SUCCESS;
+}
+
+int kv_remove(const char *full_name_key)
+{
+    return kv_store.erase(full_name_key) ? MBED_SUCCESS : MBED_ERROR_ITEM_NOT_FOUND;
+}
+
+int kv_iterator_open(kv_iterator_t *it, const char *full_prefix)
+{
+    *it = new _opaque_kv_key_iterator{kv_store.lower_bound(full_prefix), full_prefix};
+    return MBED_SUCCESS;
+}
+
+int kv_iterator_next(kv_iterator_t it, char *key, size_t key_size)
+{
+    if (it->next == kv_store.end() || it->next->first.compare(0, it->prefix.size(), it->prefix) != 0) {
+        return MBED_ERROR_ITEM_NOT_FOUND;
+    }
+    strncpy(key, it->next->first.c_str(), key_size);
+    ++it->next;
+    return MBED_SUCCESS;
+}
+
+int kv_iterator_close(kv_iterator_t it)
+{
+    delete it;
+    return MBED_SUCCESS;
+}
+
+typedef std::deque<uint8_t> Pipe;
+
+static void pipe_write(Pipe &pipe, const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    pipe.insert(pipe.end(), bytes, bytes + size);
+}
+
+static int pipe_read(Pipe &pipe, void *data, size_t size)
+{
+    size = std::min(size, pipe.size());
+    std::copy(pipe.begin(), pipe.begin() + size, static_cast<uint8_t *>(data));
+    pipe.erase(pipe.begin(), pipe.begin() + size);
+    return size;
+}
+
+// Client end of an in-memory connection
+class LoopbackSocket : public Socket {
+public:
+    LoopbackSocket(Pipe &rx, Pipe &tx) : send_error(NSAPI_ERROR_OK), sends(0), rx(rx), tx(tx) {}
+
+    virtual nsapi_error_t close()
+    {
+        return NSAPI_ERROR_OK;
+    }
+    virtual nsapi_error_t connect(const SocketAddress &address)
+    {
+        return NSAPI_ERROR_OK;
+    }
+    virtual nsapi_size_or_error_t send(const void *data, nsapi_size_t size)
+    {
+        sends++;
+        if (send_error) {
+            return send_error;
+        }
+        pipe_write(tx, data, size);
+        return size;
+    }
+    virtual nsapi_size_or_error_t recv(void *data, nsapi_size_t size)
+    {
+        return rx.empty() ? NSAPI_ERROR_WOULD_BLOCK : pipe_read(rx, data, size);
+    }
+    virtual nsapi_size_or_error_t sendto(const SocketAddress &address, const void *data, nsapi_size_t size)
+    {
+        return send(data, size);
+    }
+    virtual nsapi_size_or_error_t recvfrom(SocketAddress *address, void *data, nsapi_size_t size)
+    {
+        return recv(data, size);
+    }
+    virtual nsapi_error_t bind(const SocketAddress &address)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+    virtual void set_blocking(bool blocking) {}
+    virtual void set_timeout(int timeout) {}
+    virtual void sigio(mbed::Callback<void()> func) {}
+    virtual nsapi_error_t setsockopt(int level, int optname, const void *optval, unsigned optlen)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+    virtual nsapi_error_t getsockopt(int level, int optname, void *optval, unsigned *optlen)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+    virtual Socket *accept(nsapi_error_t *error = NULL)
+    {
+        return NULL;
+    }
+    virtual nsapi_error_t listen(int backlog = 1)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+    virtual nsapi_error_t getpeername(SocketAddress *address)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    // Returned by send() instead of sending, unless NSAPI_ERROR_OK
+    nsapi_error_t send_error;
+    int sends;
+
+private:
+    Pipe &rx;
+    Pipe &tx;
+};
+
+// Mbed TLS server for the other end, resuming sessions from its cache or tickets
+class TestServer {
+public:
+    enum resumption {
+        SESSION_ID,
+        SESSION_TICKET
+    };
+
+    TestServer(Pipe &rx, Pipe &tx, resumption mode) : rx(rx), tx(tx), bytes_sent(0), seconds(0)
+    {
+        mbedtls_entropy_init(&entropy);
+        mbedtls_ctr_drbg_init(&drbg);
+        mbedtls_x509_crt_init(&crt);
+        mbedtls_pk_init(&key);
+        mbedtls_ssl_config_init(&conf);
+        mbedtls_ssl_cache_init(&cache);
+        mbedtls_ssl_ticket_init(&ticket);
+        mbedtls_ssl_init(&ssl);
+
+        EXPECT_EQ(0, mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, NULL, 0));
+        EXPECT_EQ(0, mbedtls_x509_crt_parse(&crt, (const unsigned char *) mbedtls_test_srv_crt_ec, mbedtls_test_srv_crt_ec_len));
+        EXPECT_EQ(0, mbedtls_pk_parse_key(&key, (const unsigned char *) mbedtls_test_srv_key_ec, mbedtls_test_srv_key_ec_len, NULL, 0));
+        EXPECT_EQ(0, mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+        mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+        EXPECT_EQ(0, mbedtls_ssl_conf_own_cert(&conf, &crt, &key));
+        if (mode == SESSION_TICKET) {
+            EXPECT_EQ(0, mbedtls_ssl_ticket_setup(&ticket, mbedtls_ctr_drbg_random, &drbg, MBEDTLS_CIPHER_AES_256_GCM, 86400));
+            mbedtls_ssl_conf_session_tickets_cb(&conf, mbedtls_ssl_ticket_write, mbedtls_ssl_ticket_parse, &ticket);
+        } else {
+            mbedtls_ssl_conf_session_cache(&conf, &cache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+        }
+    }
+
+    ~TestServer()
+    {
+        mbedtls_ssl_free(&ssl);
+        mbedtls_ssl_ticket_free(&ticket);
+        mbedtls_ssl_cache_free(&cache);
+        mbedtls_ssl_config_free(&conf);
+        mbedtls_pk_free(&key);
+        mbedtls_x509_crt_free(&crt);
+        mbedtls_ctr_drbg_free(&drbg);
+        mbedtls_entropy_free(&entropy);
+    }
+
+    void accept()
+    {
+        mbedtls_ssl_free(&ssl);
+        mbedtls_ssl_init(&ssl);
+        EXPECT_EQ(0, mbedtls_ssl_setup(&ssl, &conf));
+        mbedtls_ssl_set_bio(&ssl, this, ssl_send, ssl_recv, NULL);
+        bytes_sent = 0;
+    }
+
+    // Runs the handshake as far as the data from the client allows
+    int step()
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int ret = mbedtls_ssl_handshake(&ssl);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ret == MBEDTLS_ERR_SSL_WANT_READ ? 0 : ret;
+    }
+
+    // Application data received so far
+    std::string read()
+    {
+        std::string data;
+        unsigned char buf[1024];
+        int ret;
+        while ((ret = mbedtls_ssl_read(&ssl, buf, sizeof buf)) > 0) {
+            data.append((const char *) buf, ret);
+        }
+        return data;
+    }
+
+    size_t bytes_sent;
+    double seconds;
+
+private:
+    static int ssl_send(void *ctx, const unsigned char *buf, size_t len)
+    {
+        TestServer *server = static_cast<TestServer *>(ctx);
+        pipe_write(server->tx, buf, len);
+        server->bytes_sent += len;
+        return len;
+    }
+
+    static int ssl_recv(void *ctx, unsigned char *buf, size_t len)
+    {
+        TestServer *server = static_cast<TestServer *>(ctx);
+        return server->rx.empty() ? MBEDTLS_ERR_SSL_WANT_READ : pipe_read(server->rx, buf, len);
+    }
+
+    Pipe &rx;
+    Pipe &tx;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_x509_crt crt;
+    mbedtls_pk_context key;
+    mbedtls_ssl_config conf;
+    mbedtls_ssl_cache_context cache;
+    mbedtls_ssl_ticket_context ticket;
+    mbedtls_ssl_context ssl;
+};
+
+// Verifies the test certificate for other host names than its own
+static int accept_host_name(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags)
+{
+    *flags &= ~MBEDTLS_X509_BADCERT_CN_MISMATCH;
+    return 0;
+}
+
+class TestTLSSocketWrapperLoopback : public testing::Test {
+protected:
+    Pipe to_server;
+    Pipe to_client;
+    double client_seconds;
+
+    virtual void SetUp()
+    {
+        TLSSocketWrapper::clear_session_cache();
+        kv_store.clear();
+        client_seconds = 0;
+    }
+
+    virtual void TearDown()
+    {
+        TLSSocketWrapper::clear_session_cache();
+    }
+
+    // Connects a new client to the server, and returns the server's handshake bytes or the client's error
+    nsapi_size_or_error_t handshake(TestServer &server, const char *host = "localhost", bool verify = true)
+    {
+        LoopbackSocket transport(to_client, to_server);
+        TLSSocketWrapper client(&transport, host, TLSSocketWrapper::TRANSPORT_KEEP);
+        if (!verify) {
+            // Other host names than the one in the test certificate
+            mbedtls_ssl_conf_verify(client.get_ssl_config(), accept_host_name, NULL);
+        }
+        return handshake(server, client);
+    }
+
+    // Connects a client made by the test
+    nsapi_size_or_error_t handshake(TestServer &server, TLSSocketWrapper &client, const char *ca = mbedtls_test_cas_pem)
+    {
+        to_server.clear();
+        to_client.clear();
+        server.accept();
+
+        EXPECT_EQ(NSAPI_ERROR_OK, client.set_root_ca_cert(ca));
+        client.set_blocking(false);
+
+        nsapi_error_t ret = connect(client);
+        while (ret == NSAPI_ERROR_IN_PROGRESS || ret == NSAPI_ERROR_ALREADY) {
+            int server_ret = server.step();
+            if (server_ret != 0) {
+                return server_ret;
+            }
+            ret = connect(client);
+        }
+        return ret == NSAPI_ERROR_OK || ret == NSAPI_ERROR_IS_CONNECTED ? (nsapi_size_or_error_t) server.bytes_sent : ret;
+    }
+
+    nsapi_error_t connect(TLSSocketWrapper &client)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        nsapi_error_t ret = client.connect();
+        client_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ret;
+    }
+
+    // A full handshake sends the certificate, a resumed one only hello, change cipher spec and finished
+    static bool resumed(nsapi_size_or_error_t bytes)
+    {
+        return bytes > 0 && bytes < 300;
+    }
+
+    // Application data records from the client that the server has not read yet
+    size_t records(size_t *largest = NULL)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i + 5 <= to_server.size(); i += 5 + (to_server[i + 3] << 8 | to_server[i + 4])) {
+            if (to_server[i] == MBEDTLS_SSL_MSG_APPLICATION_DATA) {
+                count++;
+                if (largest) {
+                    *largest = std::max<size_t>(*largest, to_server[i + 3] << 8 | to_server[i + 4]);
+                }
+            }
+        }
+        return count;
+    }
+
+    // Runs the coalescing timer
+    static void advance(unsigned ms)
+    {
+        equeue_global_time += ms;
+        queue.dispatch(0);
+    }
+
+    static size_t kv_sessions()
+    {
+        size_t count = 0;
+        for (auto &item : kv_store) {
+            count += item.first.compare(0, 8, "/kv/tls_") == 0;
+        }
+        return count;
+    }
+};
+
+TEST_F(TestTLSSocketWrapperLoopback, resume_with_session_id)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+
+    nsapi_size_or_error_t full = handshake(server);
+    ASSERT_GT(full, 0);
+    EXPECT_FALSE(resumed(full));
+
+    EXPECT_TRUE(resumed(handshake(server)));
+    EXPECT_TRUE(resumed(handshake(server)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, resume_with_ticket)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_TICKET);
+
+    nsapi_size_or_error_t full = handshake(server);
+    ASSERT_GT(full, 0);
+    EXPECT_FALSE(resumed(full));
+
+    EXPECT_TRUE(resumed(handshake(server)));
+    EXPECT_TRUE(resumed(handshake(server)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, unknown_session_full_handshake)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    EXPECT_FALSE(resumed(handshake(server)));
+
+    // The server has forgotten the session
+    TestServer restarted(to_server, to_client, TestServer::SESSION_ID);
+    nsapi_size_or_error_t full = handshake(restarted);
+    ASSERT_GT(full, 0);
+    EXPECT_FALSE(resumed(full));
+
+    EXPECT_TRUE(resumed(handshake(restarted)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, sessions_by_host)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+
+    EXPECT_FALSE(resumed(handshake(server, "a.example.com", false)));
+    EXPECT_FALSE(resumed(handshake(server, "b.example.com", false)));
+    EXPECT_TRUE(resumed(handshake(server, "a.example.com", false)));
+
+    // The least recently used session is replaced
+    EXPECT_FALSE(resumed(handshake(server, "c.example.com", false)));
+    EXPECT_TRUE(resumed(handshake(server, "a.example.com", false)));
+    EXPECT_TRUE(resumed(handshake(server, "c.example.com", false)));
+    EXPECT_FALSE(resumed(handshake(server, "b.example.com", false)));
+    EXPECT_EQ(2u, kv_sessions());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, no_host_name)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+
+    EXPECT_FALSE(resumed(handshake(server, NULL, false)));
+    EXPECT_FALSE(resumed(handshake(server, NULL, false)));
+    EXPECT_EQ(0u, kv_sessions());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, unverified_sessions_not_kept)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+
+    for (int i = 0; i < 2; i++) {
+        LoopbackSocket transport(to_client, to_server);
+        TLSSocketWrapper client(&transport, "a.example.com", TLSSocketWrapper::TRANSPORT_KEEP);
+        // The host name does not match the certificate, which is accepted anyway
+        mbedtls_ssl_conf_authmode(client.get_ssl_config(), MBEDTLS_SSL_VERIFY_OPTIONAL);
+        nsapi_size_or_error_t bytes = handshake(server, client);
+        EXPECT_GT(bytes, 0);
+        EXPECT_FALSE(resumed(bytes));
+    }
+
+    for (int i = 0; i < 2; i++) {
+        LoopbackSocket transport(to_client, to_server);
+        TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+        mbedtls_ssl_conf_authmode(client.get_ssl_config(), MBEDTLS_SSL_VERIFY_NONE);
+        nsapi_size_or_error_t bytes = handshake(server, client);
+        EXPECT_GT(bytes, 0);
+        EXPECT_FALSE(resumed(bytes));
+    }
+    EXPECT_EQ(0u, kv_sessions());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, sessions_by_credentials)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    EXPECT_FALSE(resumed(handshake(server)));
+
+    // Other trusted certificates do not resume the session, and replace it
+    for (int i = 0; i < 2; i++) {
+        LoopbackSocket transport(to_client, to_server);
+        TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+        nsapi_size_or_error_t bytes = handshake(server, client, mbedtls_test_ca_crt_ec);
+        EXPECT_GT(bytes, 0);
+        EXPECT_EQ(i == 1, resumed(bytes));
+    }
+
+    // Neither does a client certificate
+    {
+        LoopbackSocket transport(to_client, to_server);
+        TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+        EXPECT_EQ(NSAPI_ERROR_OK, client.set_client_cert_key(mbedtls_test_cli_crt_ec, mbedtls_test_cli_key_ec));
+        nsapi_size_or_error_t bytes = handshake(server, client, mbedtls_test_ca_crt_ec);
+        EXPECT_GT(bytes, 0);
+        EXPECT_FALSE(resumed(bytes));
+    }
+    EXPECT_EQ(1u, kv_sessions());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, clear_session_cache)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+
+    EXPECT_FALSE(resumed(handshake(server)));
+    EXPECT_FALSE(resumed(handshake(server, "a.example.com", false)));
+
+    TLSSocketWrapper::clear_session_cache("localhost");
+    EXPECT_FALSE(resumed(handshake(server)));
+    EXPECT_TRUE(resumed(handshake(server, "a.example.com", false)));
+
+    TLSSocketWrapper::clear_session_cache();
+    EXPECT_EQ(0u, kv_sessions());
+    EXPECT_FALSE(resumed(handshake(server)));
+    EXPECT_FALSE(resumed(handshake(server, "a.example.com", false)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, resume_after_reset)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_TICKET);
+    EXPECT_FALSE(resumed(handshake(server)));
+    EXPECT_EQ(1u, kv_sessions());
+
+    std::map<std::string, std::vector<uint8_t> > flash = kv_store;
+    TLSSocketWrapper::clear_session_cache();
+    kv_store = flash;
+
+    EXPECT_TRUE(resumed(handshake(server)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, corrupt_stored_session)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_TICKET);
+    EXPECT_FALSE(resumed(handshake(server)));
+
+    std::map<std::string, std::vector<uint8_t> > flash = kv_store;
+    TLSSocketWrapper::clear_session_cache();
+    for (auto &item : flash) {
+        // Session format version after the transport, identity and host name
+        item.second[1 + 4 + strlen("localhost") + 1] ^= 0xff;
+    }
+    kv_store = flash;
+
+    EXPECT_FALSE(resumed(handshake(server)));
+    EXPECT_TRUE(resumed(handshake(server)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, failed_handshake_forgets_session)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    EXPECT_FALSE(resumed(handshake(server)));
+
+    // Fatal handshake_failure alert instead of the server hello
+    const uint8_t alert[] = {0x15, 0x03, 0x03, 0x00, 0x02, 0x02, 0x28};
+    to_server.clear();
+    to_client.clear();
+    pipe_write(to_client, alert, sizeof alert);
+    {
+        LoopbackSocket transport(to_client, to_server);
+        TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+        client.set_root_ca_cert(mbedtls_test_cas_pem);
+        client.set_blocking(false);
+        EXPECT_EQ(NSAPI_ERROR_AUTH_FAILURE, client.connect());
+    }
+    EXPECT_EQ(0u, kv_sessions());
+
+    EXPECT_FALSE(resumed(handshake(server)));
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, handshake_cost)
+{
+    const int count = 5;
+    TestServer server(to_server, to_client, TestServer::SESSION_TICKET);
+
+    size_t full_bytes = 0;
+    double full_client = 0;
+    double full_server = 0;
+    for (int i = 0; i < count; i++) {
+        TLSSocketWrapper::clear_session_cache();
+        client_seconds = 0;
+        server.seconds = 0;
+        nsapi_size_or_error_t bytes = handshake(server);
+        ASSERT_FALSE(resumed(bytes));
+        full_bytes += bytes;
+        full_client += client_seconds;
+        full_server += server.seconds;
+    }
+
+    size_t resumed_bytes = 0;
+    double resumed_client = 0;
+    double resumed_server = 0;
+    for (int i = 0; i < count; i++) {
+        client_seconds = 0;
+        server.seconds = 0;
+        nsapi_size_or_error_t bytes = handshake(server);
+        ASSERT_TRUE(resumed(bytes));
+        resumed_bytes += bytes;
+        resumed_client += client_seconds;
+        resumed_server += server.seconds;
+    }
+
+    EXPECT_LT(resumed_client * 4, full_client);
+    std::cout << "[          ] full handshake: client " << full_client * 1000 / count
+              << " ms, server " << full_server * 1000 / count
+              << " ms, " << full_bytes / count << " bytes from server" << std::endl;
+    std::cout << "[          ] resumed handshake: client " << resumed_client * 1000 / count
+              << " ms, server " << resumed_server * 1000 / count
+              << " ms, " << resumed_bytes / count << " bytes from server" << std::endl;
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, writes_without_coalescing)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    LoopbackSocket transport(to_client, to_server);
+    TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+    EXPECT_EQ(NSAPI_ERROR_OK, client.set_coalescing(0));
+    ASSERT_GT(handshake(server, client), 0);
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(16, client.send("0123456789abcdef", 16));
+    }
+    EXPECT_EQ(10u, records());
+    EXPECT_EQ(160u, server.read().size());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, coalesced_until_delay)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    LoopbackSocket transport(to_client, to_server);
+    TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+    ASSERT_GT(handshake(server, client), 0);
+
+    std::string sent;
+    for (int i = 0; i < 10; i++) {
+        std::string data = "write " + std::to_string(i) + ";";
+        EXPECT_EQ((nsapi_size_or_error_t) data.size(), client.send(data.data(), data.size()));
+        sent += data;
+    }
+    EXPECT_EQ(0u, records());
+
+    advance(19);
+    EXPECT_EQ(0u, records());
+    advance(1);
+    EXPECT_EQ(1u, records());
+    EXPECT_EQ(sent, server.read());
+
+    // Held again by the next write
+    EXPECT_EQ(5, client.send("again", 5));
+    EXPECT_EQ(0u, records());
+    advance(20);
+    EXPECT_EQ(1u, records());
+    EXPECT_EQ("again", server.read());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, coalesced_send_failure_reported)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    LoopbackSocket transport(to_client, to_server);
+    TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+    ASSERT_GT(handshake(server, client), 0);
+
+    // A busy transport is tried again after the delay
+    EXPECT_EQ(4, client.send("data", 4));
+    transport.send_error = NSAPI_ERROR_WOULD_BLOCK;
+    transport.sends = 0;
+    advance(20);
+    EXPECT_EQ(1, transport.sends);
+    advance(20);
+    EXPECT_EQ(2, transport.sends);
+
+    // A failed one is not, and the next call reports it once
+    transport.send_error = NSAPI_ERROR_NO_CONNECTION;
+    advance(20);
+    EXPECT_EQ(3, transport.sends);
+    advance(100);
+    EXPECT_EQ(3, transport.sends);
+    EXPECT_EQ(NSAPI_ERROR_DEVICE_ERROR, client.send("more", 4));
+    EXPECT_EQ(3, transport.sends);
+
+    // The held data is kept for the caller to try again
+    transport.send_error = NSAPI_ERROR_OK;
+    EXPECT_EQ(NSAPI_ERROR_OK, client.flush());
+    EXPECT_EQ("data", server.read());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, coalesced_full_records)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    LoopbackSocket transport(to_client, to_server);
+    TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+    ASSERT_GT(handshake(server, client), 0);
+
+    std::string sent;
+    for (int i = 0; i < 18; i++) {
+        std::string data(64, 'a' + i);
+        EXPECT_EQ(64, client.send(data.data(), data.size()));
+        sent += data;
+    }
+    // Full record of nsapi.tls-coalesce-size sent at once, the rest held
+    size_t largest = 0;
+    EXPECT_EQ(1u, records(&largest));
+    EXPECT_LT(1024u, largest);
+    EXPECT_GT(1024u + 64, largest);
+
+    EXPECT_EQ(NSAPI_ERROR_OK, client.flush());
+    EXPECT_EQ(2u, records());
+    EXPECT_EQ(NSAPI_ERROR_OK, client.flush());
+    EXPECT_EQ(sent, server.read());
+
+    // Writes larger than the buffer are split in full records
+    std::string large(3000, 'x');
+    EXPECT_EQ(3000, client.send(large.data(), large.size()));
+    EXPECT_EQ(2u, records());
+    advance(20);
+    EXPECT_EQ(3u, records());
+    EXPECT_EQ(large, server.read());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, coalesced_sent_by_recv_and_close)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    LoopbackSocket transport(to_client, to_server);
+    TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+    ASSERT_GT(handshake(server, client), 0);
+
+    // The request is sent before waiting for the reply
+    char reply[16];
+    EXPECT_EQ(7, client.send("request", 7));
+    EXPECT_EQ(NSAPI_ERROR_WOULD_BLOCK, client.recv(reply, sizeof reply));
+    EXPECT_EQ(1u, records());
+    EXPECT_EQ("request", server.read());
+
+    EXPECT_EQ(4, client.send("last", 4));
+    EXPECT_EQ(NSAPI_ERROR_OK, client.close());
+    EXPECT_EQ(1u, records());
+    EXPECT_EQ("last", server.read());
+
+    // Timer was cancelled
+    advance(20);
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, max_fragment_length)
+{
+    TestServer server(to_server, to_client, TestServer::SESSION_ID);
+    LoopbackSocket transport(to_client, to_server);
+    TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+    EXPECT_EQ(NSAPI_ERROR_PARAMETER, client.set_max_fragment_length(1000));
+    EXPECT_EQ(NSAPI_ERROR_OK, client.set_max_fragment_length(512));
+    EXPECT_EQ(NSAPI_ERROR_OK, client.set_coalescing(0));
+    ASSERT_GT(handshake(server, client), 0);
+    // Record length does not include the header
+    const size_t expansion = mbedtls_ssl_get_record_expansion(client.get_ssl_context()) - 5;
+
+    // One record at most in non-blocking mode
+    std::string data(3000, 'x');
+    size_t largest = 0;
+    EXPECT_EQ(512, client.send(data.data(), data.size()));
+    EXPECT_EQ(1u, records(&largest));
+    EXPECT_EQ(512 + expansion, largest);
+    EXPECT_EQ(data.substr(0, 512), server.read());
+
+    // All records in blocking mode
+    client.set_blocking(true);
+    EXPECT_EQ(3000, client.send(data.data(), data.size()));
+    EXPECT_EQ(6u, records(&largest));
+    EXPECT_EQ(512 + expansion, largest);
+    EXPECT_EQ(data, server.read());
+
+    // Coalesced records are not larger either
+    client.set_coalescing(20);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(100, client.send(data.data(), 100));
+    }
+    EXPECT_EQ(1u, records(&largest));
+    advance(20);
+    EXPECT_EQ(2u, records(&largest));
+    EXPECT_EQ(512 + expansion, largest);
+    EXPECT_EQ(1000u, server.read().size());
+}
+
+TEST_F(TestTLSSocketWrapperLoopback, record_cost)
+{
+    const int total = 64 * 1024;
+    const int write_sizes[] = {16, 128, 1024};
+
+    for (int write_size : write_sizes) {
+        for (int delay : {0, 20}) {
+            TestServer server(to_server, to_client, TestServer::SESSION_ID);
+            LoopbackSocket transport(to_client, to_server);
+            TLSSocketWrapper client(&transport, "localhost", TLSSocketWrapper::TRANSPORT_KEEP);
+            client.set_coalescing(delay);
+            ASSERT_GT(handshake(server, client), 0);
+            size_t handshake_bytes = to_server.size();
+
+            std::string data(write_size, 'x');
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int sent = 0; sent < total; sent += write_size) {
+                ASSERT_EQ(write_size, client.send(data.data(), data.size()));
+            }
+            ASSERT_EQ(NSAPI_ERROR_OK, client.flush());
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            size_t count = records();
+            size_t wire = to_server.size() - handshake_bytes;
+            EXPECT_EQ((size_t) total, server.read().size());
+            if (delay) {
+                EXPECT_EQ((size_t) total / 1024, count);
+            } else {
+                EXPECT_EQ((size_t) total / write_size, count);
+            }
+            std::cout << "[          ] " << write_size << " byte writes" << (delay ? ", coalesced: " : ": ")
+                      << count << " records, " << (double) wire / total << " bytes and "
+                      << seconds * 1e9 / total << " ns per payload byte" << std::endl;
+        }
+    }
+}
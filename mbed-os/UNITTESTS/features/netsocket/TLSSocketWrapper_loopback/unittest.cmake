@@ -0,0 +1,50 @@
+
+####################
+# UNIT TESTS
+####################
+
+# Handshakes with a real Mbed TLS server over an in-memory transport
+file(GLOB mbedtls-sources "${PROJECT_SOURCE_DIR}/../features/mbedtls/src/*.c")
+
+list(REMOVE_ITEM unittest-includes ${PROJECT_SOURCE_DIR}/target_h/events ${PROJECT_SOURCE_DIR}/target_h/events/equeue)
+
+set(unittest-includes ${unittest-includes}
+  ../features/storage/kvstore/global_api
+  ../events
+)
+
+set(unittest-sources
+  ../features/netsocket/TLSSocketWrapper.cpp
+  ../features/netsocket/SocketAddress.cpp
+  ../features/frameworks/nanostack-libservice/source/libip4string/ip4tos.c
+  ../features/frameworks/nanostack-libservice/source/libip6string/ip6tos.c
+  ../features/frameworks/nanostack-libservice/source/libip4string/stoip4.c
+  ../features/frameworks/nanostack-libservice/source/libip6string/stoip6.c
+  ../features/frameworks/nanostack-libservice/source/libBits/common_functions.c
+  ../events/source/EventQueue.cpp
+  ../events/source/equeue.c
+  ${mbedtls-sources}
+)
+
+set(unittest-test-sources
+  features/netsocket/TLSSocketWrapper_loopback/test_TLSSocketWrapper_loopback.cpp
+  stubs/Mutex_stub.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_atomic_stub.c
+  stubs/mbed_critical_stub.c
+  stubs/EventFlags_stub.cpp
+  stubs/EqueuePosix_stub.c
+)
+
+set(unittest-definitions
+  MBEDTLS_ENTROPY_HARDWARE_ALT
+  MBED_CONF_NSAPI_TLS_SESSION_CACHE_SIZE=2
+  MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE=1
+  "MBED_CONF_NSAPI_TLS_SESSION_CACHE_KVSTORE_PATH=\"/kv/\""
+  MBED_CONF_NSAPI_TLS_MAX_FRAGMENT_LENGTH=0
+  MBED_CONF_NSAPI_TLS_COALESCE_SIZE=1024
+  MBED_CONF_NSAPI_TLS_COALESCE_DELAY=20
+)
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -pthread -DEQUEUE_PLATFORM_POSIX")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -pthread -DEQUEUE_PLATFORM_POSIX")
@@ -20,6 +20,10 @@
 #include "features/netsocket/nsapi_dns.h"
 #include "NetworkStack_stub.h"
 
+#include <chrono>
+#include <iostream>
+#include <utility>
+
 /**
  * This test needs to access a private function
  * which is why it is declared as friend
@@ -31,6 +35,51 @@ class UDPSocketFriend : public UDPSocket {
     FRIEND_TEST(TestUDPSocket, get_proto);
 };
 
+/*
+ * Queues datagrams to receive, and counts calls into the stack. Batches are
+ * sent whole with one call, like a stack with a native batch implementation.
+ */
+class DatagramStack : public NetworkStackstub {
+public:
+    std::list<std::pair<SocketAddress, nsapi_size_t> > incoming;
+    int sendto_calls;
+    int sendto_batch_calls;
+    bool native_batch;
+
+    DatagramStack() : sendto_calls(0), sendto_batch_calls(0), native_batch(true) {}
+
+protected:
+    virtual nsapi_size_or_error_t socket_sendto(nsapi_socket_t handle, const SocketAddress &address,
+                                                const void *data, nsapi_size_t size)
+    {
+        sendto_calls++;
+        return size;
+    }
+    virtual nsapi_size_or_error_t socket_sendto_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams,
+                                                      nsapi_size_t count)
+    {
+        if (!native_batch) {
+            return NetworkStack::socket_sendto_batch(handle, datagrams, count);
+        }
+        sendto_batch_calls++;
+        for (nsapi_size_t i = 0; i < count; i++) {
+            datagrams[i].length = datagrams[i].size;
+        }
+        return count;
+    }
+    virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
+                                                  void *buffer, nsapi_size_t size)
+    {
+        if (incoming.empty()) {
+            return NSAPI_ERROR_WOULD_BLOCK;
+        }
+        *address = incoming.front().first;
+        nsapi_size_t len = incoming.front().second;
+        incoming.pop_front();
+        return len < size ? len : size;
+    }
+};
+
 // Control the rtos EventFlags stub. See EventFlags_stub.cpp
 extern std::list<uint32_t> eventFlagsStubNextRetval;
 
@@ -38,6 +87,7 @@ class TestUDPSocket : public testing::Test {
 protected:
     UDPSocket *socket;
     NetworkStackstub stack;
+    DatagramStack datagram_stack;
     unsigned int dataSize = 10;
     char dataBuf[10];
 
@@ -49,6 +99,8 @@ protected:
 
     virtual void TearDown()
     {
+        stack.return_values.clear();
+        eventFlagsStubNextRetval.clear();
         delete socket;
     }
 };
@@ -152,3 +204,158 @@ TEST_F(TestUDPSocket, unsupported_api)
     EXPECT_EQ(error, NSAPI_ERROR_UNSUPPORTED);
     EXPECT_EQ(socket->listen(1), NSAPI_ERROR_UNSUPPORTED);
 }
+
+/* batched datagrams */
+
+TEST_F(TestUDPSocket, sendto_batch_no_socket)
+{
+    nsapi_datagram_t datagrams[2] = {};
+    EXPECT_EQ(socket->sendto_batch(datagrams, 2), NSAPI_ERROR_NO_SOCKET);
+}
+
+TEST_F(TestUDPSocket, sendto_batch_generic)
+{
+    const nsapi_addr_t addr = {NSAPI_IPv4, {127, 0, 0, 1} };
+    const SocketAddress a(addr, 1024);
+    nsapi_datagram_t datagrams[3];
+    for (int i = 0; i < 3; i++) {
+        datagrams[i].address = a;
+        datagrams[i].data = dataBuf;
+        datagrams[i].size = dataSize;
+        datagrams[i].length = 0;
+    }
+
+    datagram_stack.native_batch = false;
+    socket->open((NetworkStack *)&datagram_stack);
+    EXPECT_EQ(socket->sendto_batch(datagrams, 3), 3);
+    EXPECT_EQ(datagram_stack.sendto_calls, 3);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(datagrams[i].length, dataSize);
+    }
+}
+
+TEST_F(TestUDPSocket, sendto_batch_error)
+{
+    const nsapi_addr_t addr = {NSAPI_IPv4, {127, 0, 0, 1} };
+    const SocketAddress a(addr, 1024);
+    nsapi_datagram_t datagrams[2];
+    for (int i = 0; i < 2; i++) {
+        datagrams[i].address = a;
+        datagrams[i].data = dataBuf;
+        datagrams[i].size = dataSize;
+    }
+
+    socket->open((NetworkStack *)&stack);
+    stack.return_value = NSAPI_ERROR_NO_MEMORY;
+    EXPECT_EQ(socket->sendto_batch(datagrams, 2), NSAPI_ERROR_NO_MEMORY);
+}
+
+TEST_F(TestUDPSocket, sendto_batch_would_block)
+{
+    const nsapi_addr_t addr = {NSAPI_IPv4, {127, 0, 0, 1} };
+    const SocketAddress a(addr, 1024);
+    nsapi_datagram_t datagrams[2];
+    for (int i = 0; i < 2; i++) {
+        datagrams[i].address = a;
+        datagrams[i].data = dataBuf;
+        datagrams[i].size = dataSize;
+    }
+
+    socket->open((NetworkStack *)&stack);
+    stack.return_value = NSAPI_ERROR_WOULD_BLOCK;
+    eventFlagsStubNextRetval.push_back(0);
+    eventFlagsStubNextRetval.push_back(osFlagsError); // Break the wait loop
+    EXPECT_EQ(socket->sendto_batch(datagrams, 2), NSAPI_ERROR_WOULD_BLOCK);
+}
+
+TEST_F(TestUDPSocket, recvfrom_batch_takes_waiting)
+{
+    const nsapi_addr_t addr = {NSAPI_IPv4, {127, 0, 0, 1} };
+    const SocketAddress a(addr, 1024);
+    char bufs[4][10];
+    nsapi_datagram_t datagrams[4];
+    for (int i = 0; i < 4; i++) {
+        datagrams[i].data = bufs[i];
+        datagrams[i].size = sizeof bufs[i];
+    }
+
+    socket->open((NetworkStack *)&datagram_stack);
+    datagram_stack.incoming.push_back(std::make_pair(a, 3));
+    datagram_stack.incoming.push_back(std::make_pair(a, 20));
+    EXPECT_EQ(socket->recvfrom_batch(datagrams, 4), 2);
+    EXPECT_EQ(datagrams[0].length, 3u);
+    EXPECT_EQ(datagrams[1].length, 10u);
+    EXPECT_EQ(datagrams[0].address, a);
+
+    socket->set_blocking(false);
+    EXPECT_EQ(socket->recvfrom_batch(datagrams, 4), NSAPI_ERROR_WOULD_BLOCK);
+}
+
+TEST_F(TestUDPSocket, recvfrom_batch_address_filtering)
+{
+    const nsapi_addr_t addr1 = {NSAPI_IPv4, {127, 0, 0, 1} };
+    const nsapi_addr_t addr2 = {NSAPI_IPv4, {127, 0, 0, 2} };
+    const SocketAddress a1(addr1, 1024);
+    const SocketAddress a2(addr2, 1024);
+    char bufs[3][10];
+    nsapi_datagram_t datagrams[3];
+    for (int i = 0; i < 3; i++) {
+        datagrams[i].data = bufs[i];
+        datagrams[i].size = sizeof bufs[i];
+    }
+
+    socket->open((NetworkStack *)&datagram_stack);
+    EXPECT_EQ(socket->connect(a1), NSAPI_ERROR_OK);
+
+    // Only the datagrams from the peer are kept, in order, in distinct buffers
+    datagram_stack.incoming.push_back(std::make_pair(a2, 1));
+    datagram_stack.incoming.push_back(std::make_pair(a1, 2));
+    datagram_stack.incoming.push_back(std::make_pair(a1, 3));
+    EXPECT_EQ(socket->recvfrom_batch(datagrams, 3), 2);
+    EXPECT_EQ(datagrams[0].length, 2u);
+    EXPECT_EQ(datagrams[1].length, 3u);
+    EXPECT_NE(datagrams[0].data, datagrams[1].data);
+    EXPECT_NE(datagrams[1].data, datagrams[2].data);
+    EXPECT_NE(datagrams[0].data, datagrams[2].data);
+
+    // A batch of datagrams from others only is dropped, and the socket waits
+    datagram_stack.incoming.push_back(std::make_pair(a2, 1));
+    eventFlagsStubNextRetval.push_back(osFlagsError); // Break the wait loop
+    EXPECT_EQ(socket->recvfrom_batch(datagrams, 3), NSAPI_ERROR_WOULD_BLOCK);
+}
+
+TEST_F(TestUDPSocket, sendto_batch_throughput)
+{
+    const uint32_t count = 200000;
+    const uint32_t batch = 32;
+    const nsapi_addr_t addr = {NSAPI_IPv4, {127, 0, 0, 1} };
+    const SocketAddress a(addr, 5683);
+    static char payload[64];
+    nsapi_datagram_t datagrams[batch];
+    for (uint32_t i = 0; i < batch; i++) {
+        datagrams[i].address = a;
+        datagrams[i].data = payload;
+        datagrams[i].size = sizeof payload;
+    }
+
+    socket->open((NetworkStack *)&datagram_stack);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        ASSERT_EQ(socket->sendto(a, payload, sizeof payload), (nsapi_size_or_error_t)sizeof payload);
+    }
+    double single_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i += batch) {
+        ASSERT_EQ(socket->sendto_batch(datagrams, batch), (nsapi_size_or_error_t)batch);
+    }
+    double batch_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(count, (uint32_t)datagram_stack.sendto_calls);
+    EXPECT_EQ(count / batch, (uint32_t)datagram_stack.sendto_batch_calls);
+    std::cout << "[          ] sendto: " << static_cast<uint32_t>(count / single_seconds)
+              << " datagrams/s, " << datagram_stack.sendto_calls << " stack calls" << std::endl;
+    std::cout << "[          ] sendto_batch(" << batch << "): " << static_cast<uint32_t>(count / batch_seconds)
+              << " datagrams/s, " << datagram_stack.sendto_batch_calls << " stack calls" << std::endl;
+}
@@ -31,6 +31,9 @@
 // Control the rtos EventFlags stub. See EventFlags_stub.cpp
 extern std::list<uint32_t> eventFlagsStubNextRetval;
 
+// Control the rtos Kernel stub. See Kernel_stub.cpp
+extern uint64_t kernelStubMsCount;
+
 // This has been copied from test_EthernetInterface
 // with one modification: we don't need to mock add_ethernet_interface
 class NetworkStackMock : public OnboardNetworkStack {
@@ -39,6 +42,7 @@ public:
     MOCK_METHOD1(add_dns_server, nsapi_error_t(const SocketAddress &address));
     MOCK_METHOD3(get_dns_server, nsapi_error_t(int index, SocketAddress *address, const char *interface_name));
     MOCK_METHOD2(call_in, nsapi_error_t(int delay, mbed::Callback<void()> func));
+    MOCK_METHOD0(get_call_in_callback, ::call_in_callback_cb_t());
     MOCK_METHOD2(socket_open, nsapi_error_t(nsapi_socket_t *handle, nsapi_protocol_t proto));
     // No need to mock socket_close really.
     nsapi_error_t socket_close(nsapi_socket_t handle)
@@ -156,6 +160,15 @@ using ::testing::SetArgPointee;
 using ::testing::SetArgReferee;
 using ::testing::DoAll;
 
+// We cannot use SetArgArray, because this is void* type.
+// Use a manual for loop, to avoid depending on local implementation of strncpy (had some issues with it).
+ACTION_P2(SetArg2ToCharPtr, value, size)
+{
+    for (int i = 0; i < size; i++) {
+        static_cast<char *>(arg2)[i] = reinterpret_cast<const char *>(value)[i];
+    }
+}
+
 class Test_nsapi_dns : public testing::Test {
 public:
     static nsapi_error_t call_in(int delay, mbed::Callback<void()> func)
@@ -171,6 +184,8 @@ protected:
     {
         iface = &NetworkInterfaceMock::get_default_instance();
         nsapi_dns_reset();
+        kernelStubMsCount = 20;
+        eventFlagsStubNextRetval.clear();
         eventQueue.clear();
         hostname_cb_result = NSAPI_ERROR_DEVICE_ERROR;
         hostname_cb_address = NULL;
@@ -206,6 +221,32 @@ protected:
         }
     }
 
+    // Expect one blocking query to be sent and answered with the packet
+    void expectQuery(const unsigned char *packet, unsigned int size)
+    {
+        NetworkStackMock *stack = (NetworkStackMock *)iface->get_stack();
+        testing::Mock::VerifyAndClearExpectations(stack);
+
+        EXPECT_CALL(*stack, socket_open(_, NSAPI_UDP))
+        .Times(1)
+        .WillOnce(DoAll(SetArgPointee<0>((void **)&NetworkStackMock::get_instance()), Return(NSAPI_ERROR_OK)));
+        EXPECT_CALL(*stack, get_dns_server(_, _, _)).WillRepeatedly(Return(NSAPI_ERROR_UNSUPPORTED));
+        EXPECT_CALL(*stack, socket_sendto(_, _, _, _)).Times(1).WillOnce(Return(NSAPI_ERROR_OK));
+        EXPECT_CALL(*stack, socket_recvfrom(_, _, _, _))
+        .Times(1)
+        .WillOnce(DoAll(SetArg2ToCharPtr(packet, size), Return(size)));
+    }
+
+    // Expect the answer to come from the cache
+    void expectNoQuery()
+    {
+        NetworkStackMock *stack = (NetworkStackMock *)iface->get_stack();
+        testing::Mock::VerifyAndClearExpectations(stack);
+
+        EXPECT_CALL(*stack, socket_open(_, _)).Times(0);
+        EXPECT_CALL(*stack, socket_sendto(_, _, _, _)).Times(0);
+    }
+
     static int query_id;
 
     static constexpr unsigned int packet_ip4_size = 44;
@@ -214,6 +255,10 @@ protected:
     static const unsigned char packet_ip6[packet_ip6_size];
     static constexpr unsigned int packet_ip4_3addresses_size = 76;
     static const unsigned char packet_ip4_3addresses[packet_ip4_3addresses_size];
+    static constexpr unsigned int packet_nxdomain_size = 66;
+    static const unsigned char packet_nxdomain[packet_nxdomain_size];
+    static constexpr unsigned int packet_nodata_ip6_size = 66;
+    static const unsigned char packet_nodata_ip6[packet_nodata_ip6_size];
 };
 
 std::list<std::future<void>> Test_nsapi_dns::eventQueue;
@@ -316,14 +361,70 @@ const unsigned char Test_nsapi_dns::packet_ip4_3addresses[Test_nsapi_dns::packet
     0x01, 0x02, 0x03, 0x04       // Address bytes
 };
 
-// We cannot use SetArgArray, because this is void* type.
-// Use a manual for loop, to avoid depending on local implementation of strncpy (had some issues with it).
-ACTION_P2(SetArg2ToCharPtr, value, size)
-{
-    for (int i = 0; i < size; i++) {
-        static_cast<char *>(arg2)[i] = reinterpret_cast<const char *>(value)[i];
-    }
-}
+// The name does not exist, the SOA record in the authority section limits the
+// negative answer to be cached for 30 seconds
+const unsigned char Test_nsapi_dns::packet_nxdomain[Test_nsapi_dns::packet_nxdomain_size] = {
+    0x00, 0x01, // ID
+    0x81, 0x83, // Flags, rcode = 3 (NXDOMAIN)
+    0x00, 0x01, // qdcount
+    0x00, 0x00, // ancount
+    0x00, 0x01, // nscount
+    0x00, 0x00, // arcount
+
+    0x06,                               // question, qdcount = 1, first byte is len = 6
+    0x67, 0x6f, 0x6f, 0x67, 0x6c, 0x65, // body of the question
+    0x03,                               // len = 3
+    0x63, 0x6f, 0x6d,                   // body of the question qtype and qclass of the question
+    0x00,                               // len = 0
+    0x00, 0x01,                         // qtype
+    0x00, 0x01,                         // qclass
+
+    0xc0,                        // authority len = 192 (means this is a link)
+    0x0c,                        // this gets scanned away, because of previous byte being link
+    0x00, 0x06,                  // rtype: RR_SOA = 6
+    0x00, 0x01,                  // rclass
+    0x00, 0x00, 0x00, 0x3c,      // ttl = 60
+    0x00, 0x1a,                  // rdlength
+    0x01, 0x61, 0x00,            // mname
+    0x01, 0x62, 0x00,            // rname
+    0x00, 0x00, 0x00, 0x01,      // serial
+    0x00, 0x00, 0x0e, 0x10,      // refresh
+    0x00, 0x00, 0x03, 0x84,      // retry
+    0x00, 0x09, 0x3a, 0x80,      // expire
+    0x00, 0x00, 0x00, 0x1e       // minimum = 30
+};
+
+// Same as previous packet, but the name exists and has no IPv6 address
+const unsigned char Test_nsapi_dns::packet_nodata_ip6[Test_nsapi_dns::packet_nodata_ip6_size] = {
+    0x00, 0x01, // ID
+    0x81, 0x80, // Flags
+    0x00, 0x01, // qdcount
+    0x00, 0x00, // ancount
+    0x00, 0x01, // nscount
+    0x00, 0x00, // arcount
+
+    0x06,                               // question, qdcount = 1, first byte is len = 6
+    0x67, 0x6f, 0x6f, 0x67, 0x6c, 0x65, // body of the question
+    0x03,                               // len = 3
+    0x63, 0x6f, 0x6d,                   // body of the question qtype and qclass of the question
+    0x00,                               // len = 0
+    0x00, 0x1c,                         // qtype
+    0x00, 0x01,                         // qclass
+
+    0xc0,                        // authority len = 192 (means this is a link)
+    0x0c,                        // this gets scanned away, because of previous byte being link
+    0x00, 0x06,                  // rtype: RR_SOA = 6
+    0x00, 0x01,                  // rclass
+    0x00, 0x00, 0x00, 0x3c,      // ttl = 60
+    0x00, 0x1a,                  // rdlength
+    0x01, 0x61, 0x00,            // mname
+    0x01, 0x62, 0x00,            // rname
+    0x00, 0x00, 0x00, 0x01,      // serial
+    0x00, 0x00, 0x0e, 0x10,      // refresh
+    0x00, 0x00, 0x03, 0x84,      // retry
+    0x00, 0x09, 0x3a, 0x80,      // expire
+    0x00, 0x00, 0x00, 0x1e       // minimum = 30
+};
 
 TEST_F(Test_nsapi_dns, single_query)
 {
@@ -436,6 +537,31 @@ TEST_F(Test_nsapi_dns, multiple_queries)
     delete[] addr_cache;
 }
 
+TEST_F(Test_nsapi_dns, truncated_responses)
+{
+    // Make sure socket opens successfully
+    EXPECT_CALL(*((NetworkStackMock *)iface->get_stack()), socket_open(_, NSAPI_UDP))
+    .Times(1)
+    .WillOnce(DoAll(SetArgPointee<0>((void **)&NetworkStackMock::get_instance()), Return(NSAPI_ERROR_OK)));
+
+    EXPECT_CALL(*((NetworkStackMock *)iface->get_stack()), get_dns_server(_, _, _)).WillRepeatedly(Return(NSAPI_ERROR_UNSUPPORTED));
+
+    EXPECT_CALL(*((NetworkStackMock *)iface->get_stack()), socket_sendto(_, _, _, _)).Times(2).WillRepeatedly(Return(NSAPI_ERROR_OK));
+
+    // A response cut in the header is ignored, one cut in the second answer still yields the first address.
+    EXPECT_CALL(*((NetworkStackMock *)iface->get_stack()), socket_recvfrom(_, _, _, _))
+    .Times(2)
+    .WillOnce(DoAll(SetArg2ToCharPtr(Test_nsapi_dns::packet_ip4_3addresses, 8), Return(8)))
+    .WillOnce(DoAll(SetArg2ToCharPtr(Test_nsapi_dns::packet_ip4_3addresses, 50), Return(50)));
+
+    SocketAddress *addr;
+    SocketAddress hints{{NSAPI_UNSPEC}, 443};
+    EXPECT_EQ(1, getaddrinfo((NetworkStackMock *)iface->get_stack(), "www.google.com", hints, &addr));
+    EXPECT_EQ(addr[0].get_ip_version(), NSAPI_IPv4);
+    EXPECT_FALSE(strncmp(addr[0].get_ip_address(), "216.58.207.238", sizeof("216.58.207.238")));
+    delete[] addr;
+}
+
 TEST_F(Test_nsapi_dns, single_query_errors)
 {
     testing::InSequence s;
@@ -454,6 +580,120 @@ TEST_F(Test_nsapi_dns, single_query_errors)
     EXPECT_EQ(NSAPI_ERROR_DEVICE_ERROR, nsapi_dns_query(iface, "www.google.com", &addr));
 }
 
+TEST_F(Test_nsapi_dns, cache_refresh_ahead)
+{
+    NetworkStackMock *stack = (NetworkStackMock *)iface->get_stack();
+    SocketAddress addr;
+
+    expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+
+    // Far from expiry, no refresh is started.
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query_async(stack, "www.google.com", &Test_nsapi_dns::hostbyname_cb, Test_nsapi_dns::call_in, NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_OK, Test_nsapi_dns::hostname_cb_result);
+    delete[] Test_nsapi_dns::hostname_cb_address;
+    EXPECT_EQ(0, eventQueue.size());
+
+    // In the last eighth of the TTL, an address in demand is queried again
+    // while the cached one is still returned.
+    kernelStubMsCount = 20 + 0x22 * 1000 - 1000;
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query_async(stack, "www.google.com", &Test_nsapi_dns::hostbyname_cb, Test_nsapi_dns::call_in, NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_OK, Test_nsapi_dns::hostname_cb_result);
+    delete[] Test_nsapi_dns::hostname_cb_address;
+    size_t events_num = eventQueue.size();
+    EXPECT_LT(0, events_num);
+
+    // Only one refresh is started.
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query_async(stack, "www.google.com", &Test_nsapi_dns::hostbyname_cb, Test_nsapi_dns::call_in, NSAPI_IPv4));
+    delete[] Test_nsapi_dns::hostname_cb_address;
+    EXPECT_EQ(events_num, eventQueue.size());
+
+    testing::Mock::VerifyAndClearExpectations(stack);
+    EXPECT_CALL(*stack, socket_open(_, NSAPI_UDP))
+    .Times(1)
+    .WillOnce(DoAll(SetArgPointee<0>((void **)&NetworkStackMock::get_instance()), Return(NSAPI_ERROR_OK)));
+    EXPECT_CALL(*stack, get_dns_server(_, _, _)).WillRepeatedly(Return(NSAPI_ERROR_UNSUPPORTED));
+    EXPECT_CALL(*stack, socket_sendto(_, _, _, _)).Times(1).WillOnce(Return(NSAPI_ERROR_OK));
+    {
+        testing::InSequence s;
+
+        EXPECT_CALL(*stack, socket_recvfrom(_, _, _, _))
+        .Times(1)
+        .WillOnce(DoAll(SetArg2ToCharPtr(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size), Return(Test_nsapi_dns::packet_ip4_size)));
+
+        EXPECT_CALL(*stack, socket_recvfrom(_, _, _, _))
+        .Times(1)
+        .WillOnce(Return(0));
+    }
+
+    executeEventQueueCallbacks();
+    reinterpret_cast<mbed::Callback<void(void *)> *>(stack->socket_cb)->call((void *)packet_ip4);
+    executeEventQueueCallbacks();
+    executeEventQueueCallbacks();
+
+    // The refreshed address outlives the original entry.
+    kernelStubMsCount = 20 + 0x22 * 1000 + 1000;
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_FALSE(strncmp(addr.get_ip_address(), "216.58.207.238", sizeof("216.58.207.238")));
+}
+
+TEST_F(Test_nsapi_dns, cache_refresh_ahead_blocking)
+{
+    NetworkStackMock *stack = (NetworkStackMock *)iface->get_stack();
+    SocketAddress addr;
+
+    expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+
+    // Blocking lookups refresh in the stack's event context. A refresh that
+    // cannot be started is started again by the next lookup.
+    kernelStubMsCount = 20 + 0x22 * 1000 - 1000;
+    expectNoQuery();
+    EXPECT_CALL(*stack, get_call_in_callback())
+    .Times(2)
+    .WillOnce(Return(call_in_callback_cb_t()))
+    .WillOnce(Return(call_in_callback_cb_t(&Test_nsapi_dns::call_in)));
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_EQ(0, eventQueue.size());
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    size_t events_num = eventQueue.size();
+    EXPECT_LT(0, events_num);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_EQ(events_num, eventQueue.size());
+
+    testing::Mock::VerifyAndClearExpectations(stack);
+    EXPECT_CALL(*stack, socket_open(_, NSAPI_UDP))
+    .Times(1)
+    .WillOnce(DoAll(SetArgPointee<0>((void **)&NetworkStackMock::get_instance()), Return(NSAPI_ERROR_OK)));
+    EXPECT_CALL(*stack, get_dns_server(_, _, _)).WillRepeatedly(Return(NSAPI_ERROR_UNSUPPORTED));
+    EXPECT_CALL(*stack, socket_sendto(_, _, _, _)).Times(1).WillOnce(Return(NSAPI_ERROR_OK));
+    {
+        testing::InSequence s;
+
+        EXPECT_CALL(*stack, socket_recvfrom(_, _, _, _))
+        .Times(1)
+        .WillOnce(DoAll(SetArg2ToCharPtr(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size), Return(Test_nsapi_dns::packet_ip4_size)));
+
+        EXPECT_CALL(*stack, socket_recvfrom(_, _, _, _))
+        .Times(1)
+        .WillOnce(Return(0));
+    }
+
+    executeEventQueueCallbacks();
+    reinterpret_cast<mbed::Callback<void(void *)> *>(stack->socket_cb)->call((void *)packet_ip4);
+    executeEventQueueCallbacks();
+    executeEventQueueCallbacks();
+
+    // The refreshed address outlives the original entry.
+    kernelStubMsCount = 20 + 0x22 * 1000 + 1000;
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_FALSE(strncmp(addr.get_ip_address(), "216.58.207.238", sizeof("216.58.207.238")));
+}
+
 TEST_F(Test_nsapi_dns, simultaneous_query_async)
 {
     // Make sure socket opens successfully
@@ -703,3 +943,97 @@ TEST_F(Test_nsapi_dns, retries_attempts)
 
     EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr));
 }
+
+TEST_F(Test_nsapi_dns, negative_cache_nxdomain)
+{
+    SocketAddress addr;
+
+    expectQuery(Test_nsapi_dns::packet_nxdomain, Test_nsapi_dns::packet_nxdomain_size);
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr));
+
+    // A name that does not exist has no address of any version.
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr, NSAPI_IPv6));
+
+    // Cached for the SOA minimum, which is smaller than its TTL.
+    kernelStubMsCount = 20 + 30 * 1000;
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr));
+
+    kernelStubMsCount++;
+    expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr));
+    EXPECT_FALSE(strncmp(addr.get_ip_address(), "216.58.207.238", sizeof("216.58.207.238")));
+}
+
+TEST_F(Test_nsapi_dns, negative_cache_nodata)
+{
+    SocketAddress addr;
+
+    // Earlier tests may have replaced all IPv6 servers.
+    uint8_t server[NSAPI_IPv6_BYTES] = {0x20, 0x01, 0x48, 0x60, 0x48, 0x60, 0, 0, 0, 0, 0, 0, 0, 0, 0x88, 0x88};
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_add_server(SocketAddress(server, NSAPI_IPv6), NULL));
+
+    expectQuery(Test_nsapi_dns::packet_nodata_ip6, Test_nsapi_dns::packet_nodata_ip6_size);
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr, NSAPI_IPv6));
+
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr, NSAPI_IPv6));
+
+    // The missing IPv6 address does not fail the IPv4 lookup.
+    expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr, NSAPI_IPv4));
+
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, "www.google.com", &addr, NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr, NSAPI_IPv6));
+}
+
+TEST_F(Test_nsapi_dns, negative_cache_without_soa)
+{
+    SocketAddress addr;
+
+    // Without an SOA record the negative answer has no TTL and is not cached.
+    unsigned char packet[28];
+    memcpy(packet, Test_nsapi_dns::packet_nxdomain, sizeof packet);
+    packet[9] = 0; // nscount
+
+    expectQuery(packet, sizeof packet);
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr));
+
+    expectQuery(packet, sizeof packet);
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, nsapi_dns_query(iface, "www.google.com", &addr));
+}
+
+TEST_F(Test_nsapi_dns, cache_expiry_and_eviction)
+{
+    constexpr int DNS_CACHE_SIZE = 5; // This must be kept equal to MBED_CONF_NSAPI_DNS_CACHE_SIZE in unittest.cmake
+    char host[DNS_CACHE_SIZE + 1][16];
+    SocketAddress addr;
+
+    // Fill the cache, each entry expiring a second after the previous one.
+    for (int i = 0; i < DNS_CACHE_SIZE + 1; i++) {
+        snprintf(host[i], sizeof host[i], "host%d.com", i);
+        kernelStubMsCount = 20 + i * 1000;
+        expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+        EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, host[i], &addr));
+    }
+
+    // The entry closest to expiry made room for the last one.
+    expectNoQuery();
+    for (int i = 1; i < DNS_CACHE_SIZE + 1; i++) {
+        EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, host[i], &addr));
+    }
+
+    expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, host[0], &addr));
+
+    // After the TTL of 0x22 seconds, the entries of the first hosts have expired.
+    kernelStubMsCount = 20 + 2 * 1000 + 0x22 * 1000 + 1;
+    expectNoQuery();
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, host[3], &addr));
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, host[0], &addr));
+
+    expectQuery(Test_nsapi_dns::packet_ip4, Test_nsapi_dns::packet_ip4_size);
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(iface, host[2], &addr));
+}
@@ -38,5 +38,13 @@ set(unittest-test-sources
   ../features/netsocket/UDPSocket.cpp
 )
 
-set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME=10000 -DMBED_CONF_NSAPI_DNS_RETRIES=1 -DMBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS=10 -DMBED_CONF_NSAPI_DNS_CACHE_SIZE=5")
-set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME=10000 -DMBED_CONF_NSAPI_DNS_RETRIES=1 -DMBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS=10 -DMBED_CONF_NSAPI_DNS_CACHE_SIZE=5")
\ No newline at end of file
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME=10000 -DMBED_CONF_NSAPI_DNS_RETRIES=1 -DMBED_CONF_NSAPI_DNS_CACHE_SIZE=5 -DMBED_CONF_NSAPI_DNS_CACHE_NEGATIVE_TTL_MAX=300 -DMBED_CONF_NSAPI_DNS_CACHE_REFRESH_AHEAD=1")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME=10000 -DMBED_CONF_NSAPI_DNS_RETRIES=1 -DMBED_CONF_NSAPI_DNS_CACHE_SIZE=5 -DMBED_CONF_NSAPI_DNS_CACHE_NEGATIVE_TTL_MAX=300 -DMBED_CONF_NSAPI_DNS_CACHE_REFRESH_AHEAD=1")
+
+# Compiler flags are shared by all test suites, these differ between suites
+set(unittest-definitions
+  MBED_CONF_NSAPI_DNS_PARALLEL_SERVERS=1
+  MBED_CONF_NSAPI_DNS_PARALLEL_DELAY=0
+  MBED_CONF_NSAPI_DNS_RACE_UNSPEC=0
+  MBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS=10
+)
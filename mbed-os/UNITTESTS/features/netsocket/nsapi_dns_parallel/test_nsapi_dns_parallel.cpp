@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "nsapi_dns.h"
+#include "NetworkStack.h"
+#include "UDPSocket.h"
+#include "SocketAddress.h"
+#include <map>
+#include <vector>
+#include <list>
+
+// Control the rtos EventFlags stub. See EventFlags_stub.cpp
+extern std::list<uint32_t> eventFlagsStubNextRetval;
+
+// Control the rtos Kernel stub. See Kernel_stub.cpp
+extern uint64_t kernelStubMsCount;
+
+#define RR_A 1
+#define RR_AAAA 28
+
+// A network stack whose DNS servers answer queries as scripted, after a
+// latency in simulated time, and an event loop running the resolver.
+class ScriptedDnsStack : public NetworkStack {
+public:
+    struct Server {
+        nsapi_addr_t addr;
+        int latency;       // milliseconds before the answer arrives, -1 never answers
+        bool has_a;        // answers A questions with an address, otherwise no data
+        bool has_aaaa;     // answers AAAA questions with an address, otherwise no data
+    };
+
+    struct Question {
+        int server;        // index in servers, -1 for a server not scripted
+        uint16_t id;
+        uint16_t qtype;
+        uint64_t time;
+    };
+
+    std::vector<Server> servers;
+    std::vector<Question> sent;
+    bool blocking;
+
+    static const nsapi_addr_t address_ip4;
+    static const nsapi_addr_t address_ip6;
+
+    ScriptedDnsStack() : blocking(false), _callback(NULL), _data(NULL)
+    {
+    }
+
+    static ScriptedDnsStack &get_instance()
+    {
+        static ScriptedDnsStack stack;
+        return stack;
+    }
+
+    static nsapi_error_t schedule(int delay, mbed::Callback<void()> func)
+    {
+        ScriptedDnsStack &stack = get_instance();
+        stack._events.insert(std::make_pair(kernelStubMsCount + delay, func));
+        return NSAPI_ERROR_OK;
+    }
+
+    // Runs the events in time order, until none is left
+    void run()
+    {
+        for (int i = 0; i < 10000 && !_events.empty(); i++) {
+            std::multimap<uint64_t, mbed::Callback<void()>>::iterator event = _events.begin();
+            if (event->first > kernelStubMsCount) {
+                kernelStubMsCount = event->first;
+            }
+            mbed::Callback<void()> func = event->second;
+            _events.erase(event);
+            func();
+        }
+    }
+
+    void reset()
+    {
+        servers.clear();
+        sent.clear();
+        blocking = false;
+        _events.clear();
+        _received.clear();
+    }
+
+    virtual nsapi_error_t get_dns_server(int index, SocketAddress *address, const char *interface_name)
+    {
+        if (index >= (int) servers.size()) {
+            return NSAPI_ERROR_NO_ADDRESS;
+        }
+        address->set_addr(servers[index].addr);
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t socket_open(nsapi_socket_t *handle, nsapi_protocol_t proto)
+    {
+        *handle = this;
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t socket_close(nsapi_socket_t handle)
+    {
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t socket_bind(nsapi_socket_t handle, const SocketAddress &address)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    virtual nsapi_error_t socket_listen(nsapi_socket_t handle, int backlog)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    virtual nsapi_error_t socket_connect(nsapi_socket_t handle, const SocketAddress &address)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    virtual nsapi_error_t socket_accept(nsapi_socket_t server, nsapi_socket_t *handle, SocketAddress *address = 0)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    virtual nsapi_size_or_error_t socket_send(nsapi_socket_t handle, const void *data, nsapi_size_t size)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    virtual nsapi_size_or_error_t socket_recv(nsapi_socket_t handle, void *data, nsapi_size_t size)
+    {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    virtual nsapi_size_or_error_t socket_sendto(nsapi_socket_t handle, const SocketAddress &address, const void *data, nsapi_size_t size)
+    {
+        const uint8_t *query = static_cast<const uint8_t *>(data);
+
+        // Skips the header and the name of the question
+        nsapi_size_t pos = 12;
+        while (pos < size && query[pos]) {
+            pos += query[pos] + 1;
+        }
+        pos++;
+
+        Question question;
+        question.server = -1;
+        question.id = (query[0] << 8) | query[1];
+        question.qtype = (query[pos] << 8) | query[pos + 1];
+        question.time = kernelStubMsCount;
+        for (size_t i = 0; i < servers.size(); i++) {
+            if (SocketAddress(servers[i].addr, 53) == address) {
+                question.server = i;
+            }
+        }
+        sent.push_back(question);
+
+        if (question.server >= 0 && servers[question.server].latency >= 0) {
+            const Server &server = servers[question.server];
+            bool found = question.qtype == RR_AAAA ? server.has_aaaa : server.has_a;
+            std::vector<uint8_t> answer = make_answer(query, pos + 4, question.qtype, found);
+            if (blocking) {
+                _received.push_back(answer);
+            } else {
+                _answers.push_back(answer);
+                schedule(server.latency, mbed::callback(this, &ScriptedDnsStack::deliver));
+            }
+        }
+
+        return size;
+    }
+
+    virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address, void *buffer, nsapi_size_t size)
+    {
+        if (_received.empty()) {
+            if (blocking) {
+                // Ends the wait of the blocking socket as timed out
+                eventFlagsStubNextRetval.push_back(osFlagsError);
+            }
+            return NSAPI_ERROR_WOULD_BLOCK;
+        }
+
+        std::vector<uint8_t> answer = _received.front();
+        _received.pop_front();
+        if (answer.size() < size) {
+            size = answer.size();
+        }
+        memcpy(buffer, answer.data(), size);
+        return size;
+    }
+
+    virtual void socket_attach(nsapi_socket_t handle, void (*callback)(void *), void *data)
+    {
+        _callback = callback;
+        _data = data;
+    }
+
+private:
+    // Answers the question of the query, with an address or with no data
+    static std::vector<uint8_t> make_answer(const uint8_t *query, nsapi_size_t question_end, uint16_t qtype, bool found)
+    {
+        std::vector<uint8_t> answer(query, query + question_end);
+        answer[2] = 0x81;       // response, recursion desired
+        answer[3] = 0x80;       // recursion available, no error
+        answer[7] = found;      // ancount
+
+        if (found) {
+            const nsapi_addr_t &addr = qtype == RR_AAAA ? address_ip6 : address_ip4;
+            uint8_t rdlength = qtype == RR_AAAA ? NSAPI_IPv6_BYTES : NSAPI_IPv4_BYTES;
+            const uint8_t record[] = {
+                0xc0, 0x0c,                     // name is the one of the question
+                0x00, (uint8_t) qtype,          // rtype
+                0x00, 0x01,                     // rclass
+                0x00, 0x00, 0x00, 0x3c,         // ttl
+                0x00, rdlength                  // rdlength
+            };
+            answer.insert(answer.end(), record, record + sizeof record);
+            answer.insert(answer.end(), addr.bytes, addr.bytes + rdlength);
+        }
+        return answer;
+    }
+
+    void deliver()
+    {
+        _received.push_back(_answers.front());
+        _answers.pop_front();
+        if (_callback) {
+            _callback(_data);
+        }
+    }
+
+    std::multimap<uint64_t, mbed::Callback<void()>> _events;
+    std::list<std::vector<uint8_t>> _answers;
+    std::list<std::vector<uint8_t>> _received;
+    void (*_callback)(void *);
+    void *_data;
+};
+
+const nsapi_addr_t ScriptedDnsStack::address_ip4 = {NSAPI_IPv4, {10, 0, 0, 1}};
+const nsapi_addr_t ScriptedDnsStack::address_ip6 = {NSAPI_IPv6, {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}};
+
+class Test_nsapi_dns_parallel : public testing::Test {
+protected:
+    ScriptedDnsStack *stack;
+
+    virtual void SetUp()
+    {
+        stack = &ScriptedDnsStack::get_instance();
+        stack->reset();
+        nsapi_dns_reset();
+        kernelStubMsCount = 0;
+        eventFlagsStubNextRetval.clear();
+        hostname_cb_result = NSAPI_ERROR_DEVICE_ERROR;
+        hostname_cb_address = SocketAddress();
+        hostname_cb_time = 0;
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    void add_server(uint8_t last_byte, int latency, bool has_a = true, bool has_aaaa = true)
+    {
+        ScriptedDnsStack::Server server = {{NSAPI_IPv4, {192, 0, 2, last_byte}}, latency, has_a, has_aaaa};
+        stack->servers.push_back(server);
+    }
+
+    nsapi_error_t query_async(const char *host, nsapi_version_t version)
+    {
+        nsapi_value_or_error_t id = nsapi_dns_query_async(stack, host, &Test_nsapi_dns_parallel::hostbyname_cb,
+                                                          &ScriptedDnsStack::schedule, version);
+        stack->run();
+        return id;
+    }
+
+    static nsapi_error_t hostname_cb_result;
+    static SocketAddress hostname_cb_address;
+    static uint64_t hostname_cb_time;
+    static void hostbyname_cb(nsapi_error_t result, SocketAddress *address)
+    {
+        hostname_cb_result = result;
+        if (result >= 0 && address) {
+            hostname_cb_address = *address;
+        }
+        hostname_cb_time = kernelStubMsCount;
+    }
+};
+
+nsapi_error_t Test_nsapi_dns_parallel::hostname_cb_result = NSAPI_ERROR_DEVICE_ERROR;
+SocketAddress Test_nsapi_dns_parallel::hostname_cb_address;
+uint64_t Test_nsapi_dns_parallel::hostname_cb_time = 0;
+
+TEST_F(Test_nsapi_dns_parallel, async_primary_answers)
+{
+    add_server(1, 50);
+    add_server(2, 50);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_OK, hostname_cb_result);
+    EXPECT_EQ(SocketAddress(ScriptedDnsStack::address_ip4), hostname_cb_address);
+    EXPECT_EQ(50, hostname_cb_time);
+
+    // Answered before the parallel delay, the second server is not asked.
+    ASSERT_EQ(1, stack->sent.size());
+    EXPECT_EQ(0, stack->sent[0].server);
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_dead_primary)
+{
+    add_server(1, -1);
+    add_server(2, 50);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_OK, hostname_cb_result);
+    EXPECT_EQ(SocketAddress(ScriptedDnsStack::address_ip4), hostname_cb_address);
+
+    // Answered after the parallel delay and the latency of the second server,
+    // instead of after the response wait time of each try of the first one.
+    EXPECT_EQ(MBED_CONF_NSAPI_DNS_PARALLEL_DELAY + 50, hostname_cb_time);
+
+    ASSERT_EQ(2, stack->sent.size());
+    EXPECT_EQ(0, stack->sent[0].server);
+    EXPECT_EQ(1, stack->sent[1].server);
+    EXPECT_EQ(MBED_CONF_NSAPI_DNS_PARALLEL_DELAY, stack->sent[1].time);
+    EXPECT_EQ(stack->sent[0].id, stack->sent[1].id);
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_first_answer_wins)
+{
+    add_server(1, 500);
+    add_server(2, 50);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_OK, hostname_cb_result);
+    EXPECT_EQ(MBED_CONF_NSAPI_DNS_PARALLEL_DELAY + 50, hostname_cb_time);
+    EXPECT_EQ(2, stack->sent.size());
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_retries_round)
+{
+    add_server(1, -1);
+    add_server(2, -1);
+    add_server(3, 50);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_OK, hostname_cb_result);
+
+    // Both servers of the round are asked again before moving on.
+    ASSERT_EQ(5, stack->sent.size());
+    EXPECT_EQ(0, stack->sent[0].server);
+    EXPECT_EQ(1, stack->sent[1].server);
+    EXPECT_EQ(0, stack->sent[2].server);
+    EXPECT_EQ(1, stack->sent[3].server);
+    EXPECT_EQ(2, stack->sent[4].server);
+    EXPECT_NE(stack->sent[0].id, stack->sent[2].id);
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_last_round_waits_for_answer)
+{
+    add_server(1, -1);
+    add_server(2, -1);
+    add_server(3, 1000);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_IPv4));
+
+    // The attempts run out with the third server alone in its round, which
+    // still gets the full response wait time to answer.
+    ASSERT_EQ(MBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS, stack->sent.size());
+    EXPECT_EQ(2, stack->sent[4].server);
+    EXPECT_EQ(NSAPI_ERROR_OK, hostname_cb_result);
+    EXPECT_EQ(stack->sent[4].time + 1000, hostname_cb_time);
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_last_round_times_out)
+{
+    add_server(1, -1);
+    add_server(2, -1);
+    add_server(3, -1);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_IPv4));
+    EXPECT_EQ(NSAPI_ERROR_TIMEOUT, hostname_cb_result);
+    ASSERT_EQ(MBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS, stack->sent.size());
+    EXPECT_LE(stack->sent[4].time + MBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME, hostname_cb_time);
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_race_unspec)
+{
+    // The server has no IPv4 address for the name.
+    add_server(1, 50, false, true);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_UNSPEC));
+    EXPECT_EQ(NSAPI_ERROR_OK, hostname_cb_result);
+    EXPECT_EQ(SocketAddress(ScriptedDnsStack::address_ip6), hostname_cb_address);
+    EXPECT_EQ(50, hostname_cb_time);
+
+    ASSERT_EQ(2, stack->sent.size());
+    EXPECT_EQ(RR_A, stack->sent[0].qtype);
+    EXPECT_EQ(RR_AAAA, stack->sent[1].qtype);
+    EXPECT_NE(stack->sent[0].id, stack->sent[1].id);
+}
+
+TEST_F(Test_nsapi_dns_parallel, async_race_unspec_not_found)
+{
+    add_server(1, 50, false, false);
+
+    EXPECT_LT(0, query_async("www.example.com", NSAPI_UNSPEC));
+    EXPECT_EQ(NSAPI_ERROR_DNS_FAILURE, hostname_cb_result);
+    EXPECT_EQ(50, hostname_cb_time);
+}
+
+TEST_F(Test_nsapi_dns_parallel, blocking_dead_primary)
+{
+    add_server(1, -1);
+    add_server(2, 50);
+    stack->blocking = true;
+
+    SocketAddress addr;
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(static_cast<NetworkStack *>(stack), "www.example.com", &addr, NSAPI_IPv4));
+    EXPECT_EQ(SocketAddress(ScriptedDnsStack::address_ip4), addr);
+
+    // The second server is asked after a single wait of the parallel delay.
+    ASSERT_EQ(2, stack->sent.size());
+    EXPECT_EQ(0, stack->sent[0].server);
+    EXPECT_EQ(1, stack->sent[1].server);
+}
+
+TEST_F(Test_nsapi_dns_parallel, blocking_race_unspec)
+{
+    add_server(1, 50, false, true);
+    stack->blocking = true;
+
+    SocketAddress addr;
+    EXPECT_EQ(NSAPI_ERROR_OK, nsapi_dns_query(static_cast<NetworkStack *>(stack), "www.example.com", &addr, NSAPI_UNSPEC));
+    EXPECT_EQ(SocketAddress(ScriptedDnsStack::address_ip6), addr);
+
+    ASSERT_EQ(2, stack->sent.size());
+    EXPECT_EQ(RR_A, stack->sent[0].qtype);
+    EXPECT_EQ(RR_AAAA, stack->sent[1].qtype);
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2019 Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "hal/ticker_api.h"
+#include "platform/mbed_critical.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string.h>
+#include <vector>
+
+#if MBED_CONF_PLATFORM_TICKER_EVENT_HEAP
+#define QUEUE_NAME "pairing heap"
+#else
+#define QUEUE_NAME "sorted list"
+#endif
+
+/* 1 MHz 32 bit ticker read from a variable */
+static uint32_t fake_tick;
+
+static void fake_init()
+{
+}
+
+static uint32_t fake_read()
+{
+    return fake_tick;
+}
+
+static void fake_disable_interrupt()
+{
+}
+
+static void fake_clear_interrupt()
+{
+}
+
+static void fake_set_interrupt(timestamp_t timestamp)
+{
+}
+
+static void fake_fire_interrupt()
+{
+}
+
+static void fake_free()
+{
+}
+
+static const ticker_info_t *fake_get_info()
+{
+    static const ticker_info_t info = { 1000000, 32 };
+    return &info;
+}
+
+static const ticker_interface_t fake_interface = {
+    fake_init,
+    fake_read,
+    fake_disable_interrupt,
+    fake_clear_interrupt,
+    fake_set_interrupt,
+    fake_fire_interrupt,
+    fake_free,
+    fake_get_info,
+    false
+};
+
+static ticker_event_queue_t fake_queue;
+static const ticker_data_t fake_ticker = { &fake_interface, &fake_queue };
+
+/* Critical sections are timed to find the longest ones */
+typedef std::chrono::steady_clock Clock;
+
+static int critical_nesting;
+static Clock::time_point critical_start;
+static std::vector<Clock::duration> critical_lengths;
+
+bool core_util_in_critical_section(void)
+{
+    return critical_nesting != 0;
+}
+
+void core_util_critical_section_enter(void)
+{
+    if (critical_nesting++ == 0) {
+        critical_start = Clock::now();
+    }
+}
+
+void core_util_critical_section_exit(void)
+{
+    if (--critical_nesting == 0) {
+        critical_lengths.push_back(Clock::now() - critical_start);
+    }
+}
+
+static std::vector<uint32_t> dispatched;
+static ticker_event_t *reinsert_event;
+static int reinsert_count;
+
+static void handler(uint32_t id)
+{
+    dispatched.push_back(id);
+    if (reinsert_event && reinsert_event->id == id && reinsert_count > 0) {
+        reinsert_count--;
+        ticker_insert_event_us(&fake_ticker, reinsert_event, reinsert_event->timestamp + 100, id);
+    }
+}
+
+class TestTickerApi : public testing::Test {
+protected:
+    void SetUp()
+    {
+        memset(&fake_queue, 0, sizeof fake_queue);
+        fake_tick = 0;
+        dispatched.clear();
+        reinsert_event = NULL;
+        reinsert_count = 0;
+        ticker_set_handler(&fake_ticker, handler);
+    }
+
+    void run_until(uint32_t tick)
+    {
+        fake_tick = tick;
+        ticker_irq_handler(&fake_ticker);
+    }
+};
+
+TEST_F(TestTickerApi, dispatch_order)
+{
+    const uint32_t count = 500;
+    std::vector<ticker_event_t> events(count);
+    std::vector<uint32_t> order(count);
+    std::mt19937 rng(1);
+
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    for (uint32_t i = 0; i < count; i++) {
+        memset(&events[order[i]], 0, sizeof(ticker_event_t));
+        ticker_insert_event_us(&fake_ticker, &events[order[i]], 1000 + 10 * order[i], order[i]);
+    }
+
+    // Remove every third event, in a shuffled order
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < count; i++) {
+        if (order[i] % 3 == 0) {
+            ticker_remove_event(&fake_ticker, &events[order[i]]);
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (i % 3 != 0) {
+            expected.push_back(i);
+        }
+    }
+
+    timestamp_t next;
+    ASSERT_EQ(1, ticker_get_next_timestamp(&fake_ticker, &next));
+    EXPECT_EQ(1010u, next);
+
+    // Dispatch in steps so the queue is consumed in several interrupts
+    for (uint32_t tick = 1000; tick < 1000 + 10 * count; tick += 250) {
+        run_until(tick);
+    }
+    run_until(1000 + 10 * count);
+
+    EXPECT_EQ(expected, dispatched);
+    EXPECT_EQ(0, ticker_get_next_timestamp(&fake_ticker, &next));
+}
+
+TEST_F(TestTickerApi, remove_head_and_absent_events)
+{
+    ticker_event_t first, second, absent;
+    memset(&first, 0, sizeof first);
+    memset(&second, 0, sizeof second);
+    memset(&absent, 0, sizeof absent);
+
+    ticker_insert_event_us(&fake_ticker, &second, 2000, 2);
+    ticker_insert_event_us(&fake_ticker, &first, 1000, 1);
+    ticker_remove_event(&fake_ticker, &absent);
+
+    timestamp_t next;
+    ASSERT_EQ(1, ticker_get_next_timestamp(&fake_ticker, &next));
+    EXPECT_EQ(1000u, next);
+
+    ticker_remove_event(&fake_ticker, &first);
+    ASSERT_EQ(1, ticker_get_next_timestamp(&fake_ticker, &next));
+    EXPECT_EQ(2000u, next);
+
+    // Removing twice leaves the queue alone
+    ticker_remove_event(&fake_ticker, &first);
+    ticker_remove_event(&fake_ticker, &second);
+    EXPECT_EQ(0, ticker_get_next_timestamp(&fake_ticker, &next));
+
+    // Events can be inserted again once removed
+    ticker_insert_event_us(&fake_ticker, &first, 3000, 1);
+    run_until(3000);
+    EXPECT_EQ(std::vector<uint32_t>({1}), dispatched);
+}
+
+TEST_F(TestTickerApi, insert_from_handler)
+{
+    ticker_event_t periodic, other;
+    memset(&periodic, 0, sizeof periodic);
+    memset(&other, 0, sizeof other);
+
+    reinsert_event = &periodic;
+    reinsert_count = 3;
+    ticker_insert_event_us(&fake_ticker, &periodic, 100, 1);
+    ticker_insert_event_us(&fake_ticker, &other, 250, 2);
+
+    // Events re-inserted by the handler in the past are run in the same interrupt
+    run_until(1000);
+    EXPECT_EQ(std::vector<uint32_t>({1, 1, 2, 1, 1}), dispatched);
+}
+
+TEST_F(TestTickerApi, critical_section_length)
+{
+    const int counts[] = { 16, 64, 256, 1024, 4096 };
+    const int operations = 2000;
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<uint32_t> delay(1000, 1000000);
+
+    for (size_t c = 0; c < sizeof counts / sizeof counts[0]; c++) {
+        SetUp();
+        std::vector<ticker_event_t> pending(counts[c]);
+        for (size_t i = 0; i < pending.size(); i++) {
+            memset(&pending[i], 0, sizeof(ticker_event_t));
+            ticker_insert_event_us(&fake_ticker, &pending[i], delay(rng), i);
+        }
+
+        // Move random pending events, like Timeouts being rearmed
+        critical_lengths.clear();
+        critical_lengths.reserve(2 * operations);
+        for (int i = 0; i < operations; i++) {
+            ticker_event_t *event = &pending[rng() % pending.size()];
+            ticker_remove_event(&fake_ticker, event);
+            ticker_insert_event_us(&fake_ticker, event, delay(rng), event->id);
+        }
+
+        // The very longest are host scheduling noise, so report a high percentile too
+        std::sort(critical_lengths.begin(), critical_lengths.end());
+        long long p99 = std::chrono::duration_cast<std::chrono::nanoseconds>(critical_lengths[critical_lengths.size() * 99 / 100]).count();
+        long long longest = std::chrono::duration_cast<std::chrono::nanoseconds>(critical_lengths.back()).count();
+        std::cout << "[          ] " QUEUE_NAME ", " << counts[c] << " pending events: critical section 99th percentile "
+                  << p99 << " ns, longest " << longest << " ns" << std::endl;
+
+        run_until(1000000);
+        EXPECT_EQ(pending.size(), dispatched.size());
+    }
+}
@@ -0,0 +1,20 @@
+
+####################
+# UNIT TESTS
+####################
+set(TEST_SUITE_NAME "ticker_api")
+
+# Source files
+set(unittest-sources
+  ../hal/mbed_ticker_api.c
+)
+
+# Test files
+set(unittest-test-sources
+  hal/ticker_api/test_ticker_api.cpp
+  stubs/mbed_assert_stub.cpp
+)
+
+# defines
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_PLATFORM_TICKER_EVENT_HEAP=1")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_PLATFORM_TICKER_EVENT_HEAP=1")
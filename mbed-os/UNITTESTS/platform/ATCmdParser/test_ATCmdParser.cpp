@@ -189,8 +189,8 @@ TEST_F(test_ATCmdParser, test_ATCmdParser_read)
     filehandle_stub_table_pos = 0;
 
     ATCmdParser at(&fh1, ",");
-    char buf[6];
-    memset(buf, 0, 6);
+    char buf[9];
+    memset(buf, 0, 9);
 
     // TEST EMPTY BUFFER
     // Shouldn't read any byte since buffer is empty
@@ -406,4 +406,111 @@ TEST_F(test_ATCmdParser, test_ATCmdParser_scanf)
 
 }
 
+// Recorded ESP8266 traffic, including echo and unsolicited results
+static const char modem_traffic[] =
+    "AT+CIPSTATUS\r\n"
+    "STATUS:3\r\n"
+    "+CIPSTATUS:0,\"TCP\",\"192.168.1.10\",80,5000,0\r\n"
+    "\r\nOK\r\n"
+    "AT+CIPSEND=0,5\r\n"
+    "\r\nOK\r\n"
+    "> \r\n"
+    "Recv 5 bytes\r\n"
+    "+IPD,0,12:hello world!\r\n"
+    "WIFI DISCONNECT\r\n"
+    "SEND OK\r\n";
+
+class ModemReplay_stub : public FileHandle_stub {
+public:
+    ModemReplay_stub() : pos(0), reads(0)
+    {
+    }
+
+    virtual ssize_t read(void *buffer, size_t size)
+    {
+        size_t left = sizeof(modem_traffic) - 1 - pos;
+        if (size > left) {
+            size = left;
+        }
+        memcpy(buffer, modem_traffic + pos, size);
+        pos += size;
+        reads++;
+        return size;
+    }
+
+    size_t pos;
+    int reads;
+};
+
+static ATCmdParser *replay_parser;
+static int replay_ipd_len;
+static char replay_ipd_data[16];
+static int replay_disconnects;
+static int replay_connects;
+
+static void replay_ipd()
+{
+    int id;
+    ASSERT_TRUE(replay_parser->recv(",%d,%d:", &id, &replay_ipd_len));
+    ASSERT_EQ(replay_ipd_len, replay_parser->read(replay_ipd_data, replay_ipd_len));
+}
 
+static void replay_disconnect()
+{
+    replay_disconnects++;
+}
+
+static void replay_connect()
+{
+    replay_connects++;
+}
+
+TEST_F(test_ATCmdParser, test_ATCmdParser_replay_modem_traffic)
+{
+    ModemReplay_stub fh1;
+    ATCmdParser at(&fh1, "\r\n");
+    replay_parser = &at;
+    replay_ipd_len = 0;
+    replay_disconnects = 0;
+    replay_connects = 0;
+    memset(replay_ipd_data, 0, sizeof(replay_ipd_data));
+
+    at.oob("+IPD", &replay_ipd);
+    at.oob("WIFI DISCONNECT", &replay_disconnect);
+    at.oob("WIFI CONNECTED", &replay_connect);
+
+    mbed_poll_stub::revents_value = POLLIN;
+    mbed_poll_stub::int_value = 1;
+
+    int status;
+    int link_id;
+    char type[4];
+    char ip[16];
+    int remote_port;
+    int local_port;
+    int tetype;
+    EXPECT_TRUE(at.recv("STATUS:%d\n", &status));
+    EXPECT_EQ(3, status);
+    EXPECT_TRUE(at.recv("+CIPSTATUS:%d,\"%3[^\"]\",\"%15[^\"]\",%d,%d,%d\n",
+                        &link_id, type, ip, &remote_port, &local_port, &tetype));
+    EXPECT_EQ(0, link_id);
+    EXPECT_STREQ("TCP", type);
+    EXPECT_STREQ("192.168.1.10", ip);
+    EXPECT_EQ(80, remote_port);
+    EXPECT_EQ(5000, local_port);
+    EXPECT_EQ(0, tetype);
+    EXPECT_TRUE(at.recv("OK\n"));
+
+    EXPECT_TRUE(at.recv("OK\n"));
+    EXPECT_TRUE(at.recv(">"));
+    EXPECT_TRUE(at.recv("SEND OK\n"));
+
+    EXPECT_EQ(12, replay_ipd_len);
+    EXPECT_EQ(0, memcmp(replay_ipd_data, "hello world!", 12));
+    EXPECT_EQ(1, replay_disconnects);
+    EXPECT_EQ(0, replay_connects);
+
+    // Whole traffic consumed with bulk reads instead of one read per byte
+    EXPECT_EQ(sizeof(modem_traffic) - 1, fh1.pos);
+    EXPECT_LE(fh1.reads, (int)(sizeof(modem_traffic) / 16));
+}
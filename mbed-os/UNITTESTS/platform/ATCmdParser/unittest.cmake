@@ -5,6 +5,7 @@
 # Source files
 set(unittest-sources
   ../platform/source/ATCmdParser.cpp
+  ../platform/source/minimal-printf/mbed_printf_implementation.c
 )
 
 # Test files
@@ -14,3 +15,6 @@ set(unittest-test-sources
   stubs/mbed_assert_stub.cpp
   stubs/mbed_poll_stub.cpp
 )
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING=1")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING=1")
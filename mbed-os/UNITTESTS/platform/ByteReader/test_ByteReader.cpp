@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/ByteReader.h"
+
+using mbed::ByteReader;
+using mbed::Span;
+using mbed::make_const_Span;
+
+static const uint8_t data[] = {
+    0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x01, 0x02
+};
+
+TEST(TestByteReader, big_endian)
+{
+    ByteReader reader(make_const_Span(data));
+    EXPECT_EQ(0x12, reader.read_u8());
+    EXPECT_EQ(0x3456, reader.read_be16());
+    EXPECT_EQ(0x789abcdeu, reader.read_be32());
+    EXPECT_EQ(3u, reader.remaining());
+    EXPECT_TRUE(reader.ok());
+
+    reader.seek(0);
+    EXPECT_EQ(0x123456789abcdef0ull, reader.read_be64());
+}
+
+TEST(TestByteReader, little_endian)
+{
+    ByteReader reader(data, sizeof data);
+    EXPECT_EQ(0x3412, reader.read_le16());
+    EXPECT_EQ(0xbc9a7856u, reader.read_le32());
+    reader.seek(2);
+    EXPECT_EQ(0x0201f0debc9a7856ull, reader.read_le64());
+    EXPECT_EQ(0u, reader.remaining());
+    EXPECT_TRUE(reader.ok());
+}
+
+TEST(TestByteReader, overrun_is_sticky)
+{
+    ByteReader reader(data, sizeof data);
+    reader.skip(8);
+    EXPECT_EQ(0u, reader.read_be32());
+    EXPECT_FALSE(reader.ok());
+    // Later reads fail even if they would fit
+    EXPECT_EQ(0, reader.read_u8());
+    EXPECT_EQ(0u, reader.remaining());
+    EXPECT_TRUE(reader.rest().empty());
+    EXPECT_FALSE(reader.seek(0));
+}
+
+TEST(TestByteReader, spans_do_not_copy)
+{
+    ByteReader reader(data, sizeof data);
+    reader.skip(2);
+    Span<const uint8_t> view = reader.read_span(4);
+    EXPECT_EQ(data + 2, view.data());
+    EXPECT_EQ(4, view.size());
+    EXPECT_EQ(data + 6, reader.rest().data());
+
+    uint8_t copy[4];
+    EXPECT_TRUE(reader.read_bytes(copy, sizeof copy));
+    EXPECT_EQ(0, memcmp(copy, data + 6, sizeof copy));
+    EXPECT_FALSE(reader.read_bytes(copy, sizeof copy));
+    EXPECT_TRUE(reader.read_span(1).empty());
+}
+
+TEST(TestByteReader, varint)
+{
+    static const uint8_t encoded[] = {
+        0x00,
+        0x7f,
+        0x80, 0x01,
+        0xac, 0x02,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+    };
+    ByteReader reader(make_const_Span(encoded));
+    EXPECT_EQ(0u, reader.read_varint());
+    EXPECT_EQ(127u, reader.read_varint());
+    EXPECT_EQ(128u, reader.read_varint());
+    EXPECT_EQ(300u, reader.read_varint());
+    EXPECT_EQ(UINT64_MAX, reader.read_varint());
+    EXPECT_TRUE(reader.ok());
+}
+
+TEST(TestByteReader, varint_errors)
+{
+    static const uint8_t truncated[] = { 0x80, 0x80 };
+    ByteReader reader(make_const_Span(truncated));
+    EXPECT_EQ(0u, reader.read_varint());
+    EXPECT_FALSE(reader.ok());
+
+    static const uint8_t too_big[] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02
+    };
+    ByteReader reader2(make_const_Span(too_big));
+    EXPECT_EQ(0u, reader2.read_varint());
+    EXPECT_FALSE(reader2.ok());
+}
+
+TEST(TestByteReader, tlv_iteration)
+{
+    static const uint8_t tlvs[] = {
+        0x01, 0x02, 0xaa, 0xbb,
+        0x02, 0x00,
+        0x03, 0x01, 0xcc,
+    };
+    ByteReader reader(make_const_Span(tlvs));
+    ByteReader::Tlv tlv;
+    uint32_t types = 0;
+    size_t total = 0;
+    while (reader.read_tlv<uint8_t, uint8_t>(tlv)) {
+        types = types * 10 + tlv.type;
+        total += tlv.value.size();
+        EXPECT_GE(tlv.value.data(), tlvs);
+    }
+    EXPECT_TRUE(reader.ok());
+    EXPECT_EQ(123u, types);
+    EXPECT_EQ(3u, total);
+
+    static const uint8_t truncated[] = { 0x00, 0x01, 0x00, 0x05, 0xaa };
+    ByteReader reader2(make_const_Span(truncated));
+    EXPECT_FALSE((reader2.read_tlv<uint16_t, uint16_t>(tlv)));
+    EXPECT_FALSE(reader2.ok());
+}
@@ -0,0 +1,11 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+)
+
+set(unittest-test-sources
+  platform/ByteReader/test_ByteReader.cpp
+  stubs/mbed_assert_stub.cpp
+)
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/ByteWriter.h"
+#include "platform/ByteReader.h"
+
+using mbed::ByteReader;
+using mbed::ByteWriter;
+using mbed::Span;
+using mbed::make_Span;
+using mbed::make_const_Span;
+
+TEST(TestByteWriter, integers)
+{
+    uint8_t buffer[16];
+    ByteWriter writer(make_Span(buffer));
+    writer.write_u8(0x12);
+    writer.write_be16(0x3456);
+    writer.write_le16(0x3456);
+    writer.write_be32(0x789abcde);
+    writer.write_le32(0x789abcde);
+    EXPECT_TRUE(writer.ok());
+    EXPECT_EQ(13u, writer.position());
+
+    static const uint8_t expected[] = {
+        0x12, 0x34, 0x56, 0x56, 0x34, 0x78, 0x9a, 0xbc, 0xde, 0xde, 0xbc, 0x9a, 0x78
+    };
+    EXPECT_EQ(0, memcmp(expected, buffer, sizeof expected));
+    EXPECT_EQ(13, writer.written().size());
+}
+
+TEST(TestByteWriter, round_trip_64)
+{
+    uint8_t buffer[16];
+    ByteWriter writer(buffer, sizeof buffer);
+    writer.write_be64(0x0123456789abcdefull);
+    writer.write_le64(0x0123456789abcdefull);
+    EXPECT_EQ(0u, writer.remaining());
+
+    ByteReader reader(writer.written());
+    EXPECT_EQ(0x0123456789abcdefull, reader.read_be64());
+    EXPECT_EQ(0x0123456789abcdefull, reader.read_le64());
+    EXPECT_TRUE(reader.ok());
+}
+
+TEST(TestByteWriter, overflow_writes_nothing)
+{
+    uint8_t buffer[4] = { 0 };
+    ByteWriter writer(make_Span(buffer));
+    writer.write_be16(0xffff);
+    EXPECT_FALSE(writer.write_be32(0xffffffff));
+    EXPECT_FALSE(writer.ok());
+    EXPECT_EQ(0, buffer[2]);
+    // Later writes fail even if they would fit
+    EXPECT_FALSE(writer.write_u8(1));
+    EXPECT_EQ(2u, writer.position());
+}
+
+TEST(TestByteWriter, varint_round_trip)
+{
+    static const uint64_t values[] = { 0, 1, 127, 128, 300, 16383, 16384, 0xffffffffull, UINT64_MAX };
+    uint8_t buffer[64];
+    ByteWriter writer(make_Span(buffer));
+    for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+        EXPECT_TRUE(writer.write_varint(values[i]));
+    }
+
+    ByteReader reader(writer.written());
+    for (size_t i = 0; i < sizeof values / sizeof values[0]; i++) {
+        EXPECT_EQ(values[i], reader.read_varint());
+    }
+    EXPECT_EQ(0u, reader.remaining());
+    EXPECT_TRUE(reader.ok());
+
+    uint8_t small[2];
+    ByteWriter writer2(make_Span(small));
+    EXPECT_FALSE(writer2.write_varint(16384));
+    EXPECT_EQ(0u, writer2.position());
+}
+
+TEST(TestByteWriter, reserve_and_tlv)
+{
+    static const uint8_t value[] = { 0xaa, 0xbb, 0xcc };
+    uint8_t buffer[12];
+    ByteWriter writer(make_Span(buffer));
+
+    Span<uint8_t> field = writer.reserve(2);
+    EXPECT_TRUE((writer.write_tlv<uint8_t, uint16_t>(7, make_const_Span(value))));
+    // Fill the reserved field afterwards, as with a length prefix
+    field[0] = 0;
+    field[1] = writer.position() - 2;
+
+    ByteReader reader(writer.written());
+    EXPECT_EQ(6, reader.read_be16());
+    ByteReader::Tlv tlv;
+    EXPECT_TRUE((reader.read_tlv<uint8_t, uint16_t>(tlv)));
+    EXPECT_EQ(7u, tlv.type);
+    EXPECT_EQ(3, tlv.value.size());
+    EXPECT_EQ(0, memcmp(value, tlv.value.data(), sizeof value));
+
+    // A value too long for its length field is refused
+    uint8_t big[300] = { 0 };
+    uint8_t out[400];
+    ByteWriter writer2(make_Span(out));
+    EXPECT_FALSE((writer2.write_tlv<uint8_t, uint8_t>(1, make_const_Span(big))));
+    EXPECT_EQ(0u, writer2.position());
+}
@@ -0,0 +1,11 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+)
+
+set(unittest-test-sources
+  platform/ByteWriter/test_ByteWriter.cpp
+  stubs/mbed_assert_stub.cpp
+)
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/internal/FdBuffer.h"
+#include <errno.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+
+using mbed::internal::FdBuffer;
+
+static std::string output;
+static int output_calls;
+static int output_fail;
+
+static ssize_t fake_output(int fd, const void *buffer, size_t size)
+{
+    output_calls++;
+    if (output_fail) {
+        output_fail--;
+        errno = EIO;
+        return -1;
+    }
+    output.append(static_cast<const char *>(buffer), size);
+    return size;
+}
+
+/* Fragments as emitted by a typical mbed-trace line, one write per fragment */
+static const char *const trace_line[] = {
+    "[", "INFO", "]", "[", "main", "]", ": ", "connected to ", "10.0.0.1", " in ", "42", " ms", "\n"
+};
+static const int trace_fragments = sizeof trace_line / sizeof trace_line[0];
+
+static void write_trace(FdBuffer &buf, int lines)
+{
+    for (int i = 0; i < lines; i++) {
+        for (int j = 0; j < trace_fragments; j++) {
+            size_t len = strlen(trace_line[j]);
+            EXPECT_EQ((ssize_t) len, buf.write(1, trace_line[j], len, fake_output));
+        }
+    }
+}
+
+static std::string expected_trace(int lines)
+{
+    std::string s;
+    for (int i = 0; i < lines; i++) {
+        for (int j = 0; j < trace_fragments; j++) {
+            s += trace_line[j];
+        }
+    }
+    return s;
+}
+
+class TestFdBuffer : public testing::Test {
+protected:
+    FdBuffer buf;
+    char storage[128];
+
+    virtual void SetUp()
+    {
+        memset(&buf, 0, sizeof buf);
+        output.clear();
+        output_calls = 0;
+        output_fail = 0;
+    }
+};
+
+TEST_F(TestFdBuffer, zero_initialised_is_unbuffered)
+{
+    EXPECT_FALSE(buf.buffered());
+    write_trace(buf, 10);
+    EXPECT_EQ(10 * trace_fragments, output_calls);
+    EXPECT_EQ(expected_trace(10), output);
+}
+
+TEST_F(TestFdBuffer, no_buffering)
+{
+    buf.setup(storage, _IONBF, sizeof storage);
+    EXPECT_FALSE(buf.buffered());
+    write_trace(buf, 10);
+    EXPECT_EQ(10 * trace_fragments, output_calls);
+}
+
+TEST_F(TestFdBuffer, line_buffering)
+{
+    buf.setup(storage, _IOLBF, sizeof storage);
+    write_trace(buf, 10);
+    // One output call per line instead of one per fragment
+    EXPECT_EQ(10, output_calls);
+    EXPECT_EQ(expected_trace(10), output);
+
+    EXPECT_EQ(5, buf.write(1, "abcde", 5, fake_output));
+    EXPECT_EQ(10, output_calls);
+    EXPECT_EQ(0, buf.flush(1, fake_output));
+    EXPECT_EQ(11, output_calls);
+    EXPECT_EQ(0, buf.flush(1, fake_output));
+    EXPECT_EQ(11, output_calls);
+}
+
+TEST_F(TestFdBuffer, full_buffering)
+{
+    buf.setup(storage, _IOFBF, sizeof storage);
+    write_trace(buf, 10);
+    EXPECT_EQ(0, buf.flush(1, fake_output));
+    size_t total = expected_trace(10).size();
+    EXPECT_EQ(expected_trace(10), output);
+    // Output only happens when the buffer cannot take the next fragment
+    EXPECT_LE(output_calls, (int)(total / (sizeof storage - 16)) + 2);
+    EXPECT_LT(output_calls, 10);
+}
+
+TEST_F(TestFdBuffer, oversized_write_passes_through)
+{
+    char big[300];
+    memset(big, 'x', sizeof big);
+    buf.setup(storage, _IOFBF, sizeof storage);
+
+    EXPECT_EQ(3, buf.write(1, "abc", 3, fake_output));
+    EXPECT_EQ((ssize_t) sizeof big, buf.write(1, big, sizeof big, fake_output));
+    EXPECT_EQ(2, output_calls);
+    EXPECT_EQ("abc" + std::string(big, sizeof big), output);
+}
+
+TEST_F(TestFdBuffer, fills_exactly)
+{
+    buf.setup(storage, _IOFBF, 4);
+    EXPECT_EQ(4, buf.write(1, "abcd", 4, fake_output));
+    EXPECT_EQ(1, output_calls);
+    EXPECT_EQ("abcd", output);
+}
+
+TEST_F(TestFdBuffer, failed_flush_keeps_data)
+{
+    buf.setup(storage, _IOLBF, sizeof storage);
+    output_fail = 1;
+    // Accepted into the buffer, so not reported as failed
+    EXPECT_EQ(5, buf.write(1, "line\n", 5, fake_output));
+    EXPECT_EQ("", output);
+
+    EXPECT_EQ(0, buf.flush(1, fake_output));
+    EXPECT_EQ("line\n", output);
+}
+
+TEST_F(TestFdBuffer, failed_flush_before_write_is_reported)
+{
+    buf.setup(storage, _IOFBF, 4);
+    EXPECT_EQ(3, buf.write(1, "abc", 3, fake_output));
+    output_fail = 1;
+    EXPECT_EQ(-1, buf.write(1, "de", 2, fake_output));
+    EXPECT_EQ(EIO, errno);
+
+    EXPECT_EQ(0, buf.flush(1, fake_output));
+    EXPECT_EQ("abc", output);
+}
+
+TEST_F(TestFdBuffer, syscall_reduction)
+{
+    const int lines = 100;
+
+    buf.setup(storage, _IONBF, 0);
+    write_trace(buf, lines);
+    int unbuffered_calls = output_calls;
+
+    output_calls = 0;
+    buf.setup(storage, _IOLBF, sizeof storage);
+    write_trace(buf, lines);
+    int line_calls = output_calls;
+
+    output_calls = 0;
+    buf.setup(storage, _IOFBF, sizeof storage);
+    write_trace(buf, lines);
+    buf.flush(1, fake_output);
+    int full_calls = output_calls;
+
+    EXPECT_EQ(lines * trace_fragments, unbuffered_calls);
+    EXPECT_EQ(lines, line_calls);
+    EXPECT_LT(full_calls, line_calls);
+    std::cout << "[          ] output calls for " << lines << " trace lines: unbuffered " << unbuffered_calls
+              << ", line buffered " << line_calls << ", fully buffered " << full_calls << std::endl;
+}
+
+using mbed::internal::FdBufferTable;
+
+static FdBufferTable<3> table;
+static const char *nested_write;
+
+/* Output that is preempted by an interrupt handler writing nested_write */
+static ssize_t interrupted_output(int fd, const void *buffer, size_t size)
+{
+    const char *nested = nested_write;
+    if (nested) {
+        nested_write = NULL;
+        table.write(fd, nested, strlen(nested), fake_output, false);
+        table.flush_all(fake_output);
+    }
+    return fake_output(fd, buffer, size);
+}
+
+class TestFdBufferTable : public testing::Test {
+protected:
+    char storage[128];
+
+    virtual void SetUp()
+    {
+        memset(&table, 0, sizeof table);
+        output.clear();
+        output_calls = 0;
+        output_fail = 0;
+        nested_write = NULL;
+    }
+};
+
+TEST_F(TestFdBufferTable, interrupt_write_after_held_data)
+{
+    EXPECT_EQ(0, table.setvbuf(1, storage, _IOFBF, sizeof storage, fake_output));
+    EXPECT_EQ(6, table.write(1, "held, ", 6, fake_output, true));
+    EXPECT_EQ("", output);
+
+    EXPECT_EQ(4, table.write(1, "isr\n", 4, fake_output, false));
+    EXPECT_EQ("held, isr\n", output);
+    EXPECT_EQ(0, table.flush(1, fake_output));
+    EXPECT_EQ(2, output_calls);
+}
+
+TEST_F(TestFdBufferTable, interrupt_during_flush_leaves_buffer_alone)
+{
+    EXPECT_EQ(0, table.setvbuf(1, storage, _IOLBF, sizeof storage, fake_output));
+    EXPECT_EQ(5, table.write(1, "abc, ", 5, fake_output, true));
+
+    // The handler cannot write the held data that is already being written
+    nested_write = "isr ";
+    EXPECT_EQ(4, table.write(1, "def\n", 4, interrupted_output, true));
+    EXPECT_EQ("isr abc, def\n", output);
+
+    EXPECT_EQ(0, table.flush(1, fake_output));
+    EXPECT_EQ("isr abc, def\n", output);
+}
+
+TEST_F(TestFdBufferTable, flush_all)
+{
+    char storage2[16];
+    EXPECT_EQ(0, table.setvbuf(1, storage, _IOFBF, sizeof storage, fake_output));
+    EXPECT_EQ(0, table.setvbuf(2, storage2, _IOFBF, sizeof storage2, fake_output));
+    EXPECT_EQ(4, table.write(1, "out ", 4, fake_output, true));
+    EXPECT_EQ(4, table.write(2, "err ", 4, fake_output, true));
+
+    table.flush_all(fake_output);
+    EXPECT_EQ("out err ", output);
+    table.flush_all(fake_output);
+    EXPECT_EQ(2, output_calls);
+}
+
+TEST_F(TestFdBufferTable, close_makes_unbuffered)
+{
+    EXPECT_EQ(0, table.setvbuf(1, storage, _IOFBF, sizeof storage, fake_output));
+    EXPECT_EQ(4, table.write(1, "abc ", 4, fake_output, true));
+    EXPECT_EQ(0, table.close(1, fake_output));
+    EXPECT_EQ("abc ", output);
+
+    // A file opened with the same descriptor does not get the old buffer
+    EXPECT_EQ(4, table.write(1, "def ", 4, fake_output, true));
+    EXPECT_EQ("abc def ", output);
+    EXPECT_EQ(2, output_calls);
+}
+
+TEST_F(TestFdBufferTable, close_releases_buffer_on_error)
+{
+    EXPECT_EQ(0, table.setvbuf(1, storage, _IOFBF, sizeof storage, fake_output));
+    EXPECT_EQ(4, table.write(1, "abc ", 4, fake_output, true));
+    output_fail = 1;
+    EXPECT_EQ(-1, table.close(1, fake_output));
+
+    EXPECT_EQ(4, table.write(1, "def ", 4, fake_output, true));
+    EXPECT_EQ("def ", output);
+}
+
+TEST_F(TestFdBufferTable, buffered)
+{
+    EXPECT_FALSE(table.buffered(1));
+    EXPECT_EQ(0, table.setvbuf(1, storage, _IOLBF, sizeof storage, fake_output));
+    EXPECT_TRUE(table.buffered(1));
+    EXPECT_FALSE(table.buffered(2));
+    EXPECT_FALSE(table.buffered(3));
+    EXPECT_FALSE(table.buffered(-1));
+    EXPECT_EQ(0, table.close(1, fake_output));
+    EXPECT_FALSE(table.buffered(1));
+}
+
+TEST_F(TestFdBufferTable, bad_descriptor)
+{
+    EXPECT_EQ(-1, table.setvbuf(3, storage, _IOFBF, sizeof storage, fake_output));
+    EXPECT_EQ(EBADF, errno);
+    EXPECT_EQ(4, table.write(3, "abc ", 4, fake_output, true));
+    EXPECT_EQ("abc ", output);
+}
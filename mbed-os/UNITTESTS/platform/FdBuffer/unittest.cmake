@@ -0,0 +1,12 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+  ../platform/source/FdBuffer.cpp
+)
+
+set(unittest-test-sources
+  platform/FdBuffer/test_FdBuffer.cpp
+  stubs/mbed_critical_stub.c
+)
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/SharedPtr.h"
+#include "platform/IntrusivePtr.h"
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <new>
+
+using mbed::SharedPtr;
+using mbed::WeakPtr;
+using mbed::IntrusivePtr;
+using mbed::RefCounted;
+using mbed::make_shared;
+
+/* Count heap allocations made by the code under test */
+static int allocations;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+struct TestStruct {
+    TestStruct(int v = 42): value(v)
+    {
+        s_count++;
+    }
+
+    ~TestStruct()
+    {
+        s_count--;
+    }
+
+    int value;
+    static int s_count;
+};
+
+int TestStruct::s_count = 0;
+
+struct TestIntrusive : public RefCounted<TestIntrusive> {
+    TestIntrusive()
+    {
+        s_count++;
+    }
+
+    ~TestIntrusive()
+    {
+        s_count--;
+    }
+
+    static int s_count;
+};
+
+int TestIntrusive::s_count = 0;
+
+class TestSharedPtr : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        allocations = 0;
+        TestStruct::s_count = 0;
+        TestIntrusive::s_count = 0;
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(0, TestStruct::s_count);
+        EXPECT_EQ(0, TestIntrusive::s_count);
+    }
+};
+
+TEST_F(TestSharedPtr, owning_raw_pointer)
+{
+    {
+        SharedPtr<TestStruct> ptr(new TestStruct);
+        EXPECT_EQ(1, ptr.use_count());
+        SharedPtr<TestStruct> ptr2 = ptr;
+        EXPECT_EQ(2, ptr.use_count());
+        ptr = NULL;
+        EXPECT_EQ(0, ptr.use_count());
+        EXPECT_EQ(1, ptr2.use_count());
+        EXPECT_EQ(1, TestStruct::s_count);
+    }
+    // Object plus separate counter
+    EXPECT_EQ(2, allocations);
+}
+
+TEST_F(TestSharedPtr, make_shared_single_allocation)
+{
+    {
+        SharedPtr<TestStruct> ptr = make_shared<TestStruct>(7);
+        EXPECT_EQ(7, ptr->value);
+        EXPECT_EQ(1, ptr.use_count());
+        SharedPtr<TestStruct> ptr2 = ptr;
+        EXPECT_EQ(2, ptr2.use_count());
+        EXPECT_TRUE(ptr == ptr2);
+    }
+    EXPECT_EQ(1, allocations);
+}
+
+TEST_F(TestSharedPtr, move_and_self_assignment)
+{
+    SharedPtr<TestStruct> ptr = make_shared<TestStruct>();
+    SharedPtr<TestStruct> moved(std::move(ptr));
+    EXPECT_FALSE(ptr);
+    EXPECT_EQ(1, moved.use_count());
+
+    moved = moved;
+    EXPECT_EQ(1, moved.use_count());
+
+    ptr = std::move(moved);
+    EXPECT_EQ(1, ptr.use_count());
+    EXPECT_FALSE(moved);
+
+    ptr.reset();
+    EXPECT_EQ(0, TestStruct::s_count);
+}
+
+TEST_F(TestSharedPtr, weak_pointer)
+{
+    WeakPtr<TestStruct> weak;
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.lock());
+
+    {
+        SharedPtr<TestStruct> ptr = make_shared<TestStruct>();
+        weak = WeakPtr<TestStruct>(ptr);
+        EXPECT_FALSE(weak.expired());
+        EXPECT_EQ(1, ptr.use_count());
+
+        SharedPtr<TestStruct> locked = weak.lock();
+        EXPECT_TRUE(locked == ptr);
+        EXPECT_EQ(2, ptr.use_count());
+    }
+
+    // Object is gone, the counts stay until the weak reference goes too
+    EXPECT_EQ(0, TestStruct::s_count);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.lock());
+    weak.reset();
+}
+
+TEST_F(TestSharedPtr, weak_pointer_from_raw_pointer)
+{
+    SharedPtr<TestStruct> ptr(new TestStruct);
+    WeakPtr<TestStruct> weak(ptr);
+    WeakPtr<TestStruct> weak2(weak);
+    ptr.reset();
+    EXPECT_EQ(0, TestStruct::s_count);
+    EXPECT_TRUE(weak2.expired());
+}
+
+TEST_F(TestSharedPtr, intrusive_pointer)
+{
+    {
+        IntrusivePtr<TestIntrusive> ptr(new TestIntrusive);
+        EXPECT_EQ(1u, ptr->ref_count());
+        IntrusivePtr<TestIntrusive> ptr2 = ptr;
+        EXPECT_EQ(2u, ptr->ref_count());
+
+        // Raw pointers can be turned back into owning ones
+        IntrusivePtr<TestIntrusive> ptr3(ptr.get());
+        EXPECT_EQ(3u, ptr->ref_count());
+
+        ptr2 = ptr2;
+        ptr3.reset();
+        EXPECT_EQ(2u, ptr->ref_count());
+        EXPECT_EQ(1, TestIntrusive::s_count);
+    }
+    EXPECT_EQ(1, allocations);
+}
+
+TEST_F(TestSharedPtr, allocation_and_copy_cost)
+{
+    const int objects = 100;
+    const int copies = 100000;
+
+    allocations = 0;
+    for (int i = 0; i < objects; i++) {
+        SharedPtr<TestStruct> ptr(new TestStruct);
+    }
+    int raw_allocations = allocations;
+
+    allocations = 0;
+    for (int i = 0; i < objects; i++) {
+        SharedPtr<TestStruct> ptr = make_shared<TestStruct>();
+    }
+    int make_shared_allocations = allocations;
+
+    allocations = 0;
+    for (int i = 0; i < objects; i++) {
+        IntrusivePtr<TestIntrusive> ptr(new TestIntrusive);
+    }
+    int intrusive_allocations = allocations;
+
+    EXPECT_EQ(2 * objects, raw_allocations);
+    EXPECT_EQ(objects, make_shared_allocations);
+    EXPECT_EQ(objects, intrusive_allocations);
+
+    SharedPtr<TestStruct> shared = make_shared<TestStruct>();
+    SharedPtr<TestStruct> shared_copy;
+    IntrusivePtr<TestIntrusive> intrusive(new TestIntrusive);
+    IntrusivePtr<TestIntrusive> intrusive_copy;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < copies; i++) {
+        shared_copy = shared;
+        shared_copy.reset();
+    }
+    std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < copies; i++) {
+        intrusive_copy = intrusive;
+        intrusive_copy.reset();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(1, shared.use_count());
+    EXPECT_EQ(1u, intrusive->ref_count());
+
+    std::cout << "[          ] allocations for " << objects << " objects: SharedPtr(new T) " << raw_allocations
+              << ", make_shared " << make_shared_allocations << ", IntrusivePtr " << intrusive_allocations << std::endl;
+    std::cout << "[          ] " << copies << " copy/reset pairs: SharedPtr "
+              << std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count() << " us, IntrusivePtr "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() << " us" << std::endl;
+}
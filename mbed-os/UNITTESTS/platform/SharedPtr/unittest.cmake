@@ -0,0 +1,11 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+)
+
+set(unittest-test-sources
+  platform/SharedPtr/test_SharedPtr.cpp
+  stubs/mbed_atomic_stub.c
+)
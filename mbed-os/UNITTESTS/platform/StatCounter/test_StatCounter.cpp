@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/StatCounter.h"
+
+#include <string.h>
+
+using mbed::StatCounter;
+
+static StatCounter global_counter("test.global");
+
+TEST(TestStatCounter, counts)
+{
+    StatCounter counter;
+    EXPECT_EQ(0u, counter.value());
+    ++counter;
+    counter += 10;
+    counter.add(5);
+    EXPECT_EQ(16u, counter.value());
+    counter.reset();
+    EXPECT_EQ(0u, counter.value());
+    EXPECT_EQ(NULL, counter.name());
+}
+
+TEST(TestStatCounter, unnamed_not_registered)
+{
+    size_t before = StatCounter::registered();
+    StatCounter counter;
+    StatCounter null_name(NULL);
+    EXPECT_EQ(before, StatCounter::registered());
+}
+
+TEST(TestStatCounter, registry)
+{
+    size_t before = StatCounter::registered();
+    mbed_stats_counter_t stats[8];
+    {
+        StatCounter a("test.a");
+        StatCounter b("test.b");
+        a += 3;
+        b += 7;
+        ++global_counter;
+
+        ASSERT_EQ(before + 2, StatCounter::registered());
+        size_t n = StatCounter::get_each(stats, 8);
+        ASSERT_EQ(before + 2, n);
+        // Most recently registered first
+        EXPECT_STREQ("test.b", stats[0].name);
+        EXPECT_EQ(7u, stats[0].value);
+        EXPECT_STREQ("test.a", stats[1].name);
+        EXPECT_EQ(3u, stats[1].value);
+
+        bool found = false;
+        for (size_t i = 0; i < n; i++) {
+            if (strcmp(stats[i].name, "test.global") == 0) {
+                EXPECT_EQ(global_counter.value(), stats[i].value);
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found);
+
+        EXPECT_EQ(1u, StatCounter::get_each(stats, 1));
+
+        StatCounter::reset_all();
+        EXPECT_EQ(0u, a.value());
+        EXPECT_EQ(0u, global_counter.value());
+    }
+    EXPECT_EQ(before, StatCounter::registered());
+}
+
+TEST(TestStatCounter, remove_from_middle)
+{
+    size_t before = StatCounter::registered();
+    StatCounter *a = new StatCounter("test.a");
+    StatCounter *b = new StatCounter("test.b");
+    StatCounter *c = new StatCounter("test.c");
+    delete b;
+    mbed_stats_counter_t stats[8];
+    ASSERT_EQ(before + 2, StatCounter::get_each(stats, 8));
+    EXPECT_STREQ("test.c", stats[0].name);
+    EXPECT_STREQ("test.a", stats[1].name);
+    delete a;
+    delete c;
+    EXPECT_EQ(before, StatCounter::registered());
+}
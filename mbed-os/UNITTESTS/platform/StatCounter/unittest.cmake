@@ -0,0 +1,16 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+  ../platform/source/StatCounter.cpp
+)
+
+set(unittest-test-sources
+  platform/StatCounter/test_StatCounter.cpp
+  stubs/Mutex_stub.cpp
+  stubs/mbed_assert_stub.cpp
+  stubs/mbed_atomic_stub.c
+  stubs/mbed_rtos_rtx_stub.c
+  stubs/rtx_mutex_stub.c
+)
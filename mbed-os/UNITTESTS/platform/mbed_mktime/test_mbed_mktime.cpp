@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/mbed_mktime.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+#include <time.h>
+
+#define SECONDS_BY_DAY 86400
+/* Last valid days: 7th and 6th of February 2106 */
+#define LAST_DAY_FULL 49711
+#define LAST_DAY_4_YEAR 49710
+
+/* Conversion by counting years from the epoch, as done before the year cache */
+static void reference_localtime(uint32_t seconds, struct tm *time_info, rtc_leap_year_support_t support)
+{
+    static const uint16_t days_before_month[2][12] = {
+        { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 },
+        { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 }
+    };
+
+    memset(time_info, 0, sizeof(*time_info));
+    time_info->tm_sec = seconds % 60;
+    seconds /= 60;
+    time_info->tm_min = seconds % 60;
+    seconds /= 60;
+    time_info->tm_hour = seconds % 24;
+    seconds /= 24;
+    time_info->tm_wday = (seconds + 4) % 7;
+
+    time_info->tm_year = 70;
+    while (true) {
+        uint32_t length = _rtc_is_leap_year(time_info->tm_year, support) ? 366 : 365;
+        if (seconds < length) {
+            break;
+        }
+        seconds -= length;
+        time_info->tm_year++;
+    }
+    time_info->tm_yday = seconds;
+
+    bool leap = _rtc_is_leap_year(time_info->tm_year, support);
+    time_info->tm_mon = 11;
+    for (int i = 1; i < 12; i++) {
+        if (seconds < days_before_month[leap][i]) {
+            time_info->tm_mon = i - 1;
+            break;
+        }
+    }
+    time_info->tm_mday = seconds - days_before_month[leap][time_info->tm_mon] + 1;
+}
+
+static void expect_same(const struct tm &expected, const struct tm &actual, uint32_t timestamp)
+{
+    EXPECT_EQ(expected.tm_sec, actual.tm_sec) << timestamp;
+    EXPECT_EQ(expected.tm_min, actual.tm_min) << timestamp;
+    EXPECT_EQ(expected.tm_hour, actual.tm_hour) << timestamp;
+    EXPECT_EQ(expected.tm_mday, actual.tm_mday) << timestamp;
+    EXPECT_EQ(expected.tm_mon, actual.tm_mon) << timestamp;
+    EXPECT_EQ(expected.tm_year, actual.tm_year) << timestamp;
+    EXPECT_EQ(expected.tm_wday, actual.tm_wday) << timestamp;
+    EXPECT_EQ(expected.tm_yday, actual.tm_yday) << timestamp;
+}
+
+static void check_day(uint32_t day, rtc_leap_year_support_t support)
+{
+    static const uint32_t times_of_day[] = { 0, 1, 3599, 43200, SECONDS_BY_DAY - 1 };
+    for (size_t i = 0; i < sizeof times_of_day / sizeof times_of_day[0]; i++) {
+        uint32_t timestamp = day * SECONDS_BY_DAY + times_of_day[i];
+        struct tm expected;
+        struct tm actual;
+        memset(&actual, 0, sizeof actual);
+        reference_localtime(timestamp, &expected, support);
+        ASSERT_TRUE(_rtc_localtime(timestamp, &actual, support));
+        expect_same(expected, actual, timestamp);
+
+        time_t back;
+        ASSERT_TRUE(_rtc_maketime(&actual, &back, support)) << timestamp;
+        EXPECT_EQ(timestamp, (uint32_t)back);
+    }
+}
+
+TEST(TestMktime, every_day_in_order)
+{
+    for (uint32_t day = 0; day <= LAST_DAY_FULL; day++) {
+        check_day(day, RTC_FULL_LEAP_YEAR_SUPPORT);
+    }
+    for (uint32_t day = 0; day <= LAST_DAY_4_YEAR; day++) {
+        check_day(day, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+    }
+}
+
+TEST(TestMktime, every_day_scattered)
+{
+    // Jump around so most conversions miss the cached year, alternating modes
+    for (uint32_t i = 0; i <= LAST_DAY_4_YEAR; i++) {
+        uint32_t day = (i * 7919u) % (LAST_DAY_4_YEAR + 1);
+        check_day(day, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+        check_day(day, RTC_FULL_LEAP_YEAR_SUPPORT);
+    }
+}
+
+TEST(TestMktime, matches_gmtime)
+{
+    // The host C library has full leap year support
+    for (uint32_t day = 0; day <= LAST_DAY_FULL; day += 3) {
+        time_t timestamp = (time_t)day * SECONDS_BY_DAY + 12345;
+        struct tm expected;
+        struct tm actual;
+        ASSERT_TRUE(gmtime_r(&timestamp, &expected) != NULL);
+        ASSERT_TRUE(_rtc_localtime(timestamp, &actual, RTC_FULL_LEAP_YEAR_SUPPORT));
+        expect_same(expected, actual, (uint32_t)timestamp);
+    }
+}
+
+TEST(TestMktime, leap_days)
+{
+    struct tm tm;
+    // 29th of February 2096
+    ASSERT_TRUE(_rtc_localtime(3981312000u, &tm, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ(196, tm.tm_year);
+    EXPECT_EQ(1, tm.tm_mon);
+    EXPECT_EQ(29, tm.tm_mday);
+
+    // 1st of March 2100 in full support, 29th of February with 4 year support
+    ASSERT_TRUE(_rtc_localtime(4107542400u, &tm, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ(200, tm.tm_year);
+    EXPECT_EQ(2, tm.tm_mon);
+    EXPECT_EQ(1, tm.tm_mday);
+    EXPECT_EQ(59, tm.tm_yday);
+    ASSERT_TRUE(_rtc_localtime(4107542400u, &tm, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ(200, tm.tm_year);
+    EXPECT_EQ(1, tm.tm_mon);
+    EXPECT_EQ(29, tm.tm_mday);
+
+    // 31st of December 2100
+    ASSERT_TRUE(_rtc_localtime(4133894400u, &tm, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ(200, tm.tm_year);
+    EXPECT_EQ(11, tm.tm_mon);
+    EXPECT_EQ(31, tm.tm_mday);
+    EXPECT_EQ(364, tm.tm_yday);
+
+    EXPECT_FALSE(_rtc_localtime(0, NULL, RTC_FULL_LEAP_YEAR_SUPPORT));
+}
+
+TEST(TestMktime, benchmark)
+{
+    const int conversions = 1000000;
+    // A timestamp late in the range, where counting years is slowest
+    const uint32_t base = 4000000000u;
+    volatile int sink = 0;
+    struct tm tm;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < conversions; i++) {
+        reference_localtime(base + (i % SECONDS_BY_DAY), &tm, RTC_FULL_LEAP_YEAR_SUPPORT);
+        sink += tm.tm_mday;
+    }
+    std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < conversions; i++) {
+        _rtc_localtime(base + (i % SECONDS_BY_DAY), &tm, RTC_FULL_LEAP_YEAR_SUPPORT);
+        sink += tm.tm_mday;
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    std::cout << "[          ] " << conversions << " conversions: counting years "
+              << std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count() << " us, cached "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() << " us" << std::endl;
+    EXPECT_NE(0, sink);
+}
@@ -0,0 +1,11 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+  ../platform/source/mbed_mktime.c
+)
+
+set(unittest-test-sources
+  platform/mbed_mktime/test_mbed_mktime.cpp
+)
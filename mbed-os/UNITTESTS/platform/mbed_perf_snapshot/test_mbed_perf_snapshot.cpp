@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/mbed_perf_snapshot.h"
+#include <string.h>
+
+/* Statistics reported by the fake stats functions below */
+static mbed_stats_heap_t fake_heap;
+static mbed_stats_cpu_t fake_cpu;
+static mbed_stats_stack_t fake_stacks[10];
+static size_t fake_stack_count;
+
+void mbed_stats_heap_get(mbed_stats_heap_t *stats)
+{
+    *stats = fake_heap;
+}
+
+void mbed_stats_cpu_get(mbed_stats_cpu_t *stats)
+{
+    *stats = fake_cpu;
+}
+
+size_t mbed_stats_stack_get_each(mbed_stats_stack_t *stats, size_t count)
+{
+    size_t n = fake_stack_count < count ? fake_stack_count : count;
+    memset(stats, 0, count * sizeof(mbed_stats_stack_t));
+    memcpy(stats, fake_stacks, n * sizeof(mbed_stats_stack_t));
+    return n;
+}
+
+static void callback_a(void *)
+{
+}
+
+static void callback_b(void *)
+{
+}
+
+class TestPerfSnapshot : public testing::Test {
+protected:
+    /* Stands in for the crash data RAM, which survives a reset */
+    uint64_t retained[(sizeof(mbed_perf_snapshot_t) + 64) / sizeof(uint64_t)];
+    mbed_perf_snapshot_t *region;
+
+    virtual void SetUp()
+    {
+        // Power-on contents of RAM
+        memset(retained, 0xA5, sizeof retained);
+        region = reinterpret_cast<mbed_perf_snapshot_t *>(retained);
+        memset(&fake_heap, 0, sizeof fake_heap);
+        memset(&fake_cpu, 0, sizeof fake_cpu);
+        fake_stack_count = 0;
+    }
+
+    void reboot()
+    {
+        mbed_perf_snapshot_init(retained, sizeof retained);
+    }
+};
+
+TEST_F(TestPerfSnapshot, nothing_after_power_on)
+{
+    mbed_perf_snapshot_t snapshot;
+    reboot();
+    EXPECT_EQ(MBED_ERROR_ITEM_NOT_FOUND, mbed_get_reboot_perf_snapshot(&snapshot));
+    EXPECT_EQ(0u, region->dispatch_sequence);
+    EXPECT_EQ(0u, region->stats_valid);
+}
+
+TEST_F(TestPerfSnapshot, region_too_small)
+{
+    mbed_perf_snapshot_init(retained, sizeof(mbed_perf_snapshot_t) - 1);
+    EXPECT_EQ(0u, mbed_perf_snapshot_dispatch_begin(callback_a, 0));
+    EXPECT_EQ(MBED_ERROR_UNSUPPORTED, mbed_reset_reboot_perf_snapshot());
+}
+
+TEST_F(TestPerfSnapshot, records_dispatches)
+{
+    reboot();
+
+    uint32_t token = mbed_perf_snapshot_dispatch_begin(callback_a, 100);
+    EXPECT_NE(0u, token);
+    mbed_perf_snapshot_dispatch_end(token, 107);
+
+    token = mbed_perf_snapshot_dispatch_begin(callback_b, 110);
+    const mbed_perf_dispatch_t &d = region->dispatches[token % MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES];
+    EXPECT_EQ(MBED_PERF_SNAPSHOT_IN_PROGRESS, d.duration);
+    mbed_perf_snapshot_dispatch_end(token, 111);
+    EXPECT_EQ(1u, d.duration);
+    EXPECT_EQ(110u, d.start);
+    EXPECT_EQ((uint32_t)(uintptr_t) callback_b, d.callback);
+    EXPECT_EQ(2u, region->dispatch_sequence);
+}
+
+TEST_F(TestPerfSnapshot, ring_keeps_latest_dispatches)
+{
+    reboot();
+
+    const uint32_t total = 3 * MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES + 1;
+    for (uint32_t i = 0; i < total; i++) {
+        uint32_t token = mbed_perf_snapshot_dispatch_begin(callback_a, i * 10);
+        mbed_perf_snapshot_dispatch_end(token, i * 10 + i);
+    }
+
+    for (int i = 0; i < MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES; i++) {
+        const mbed_perf_dispatch_t &d = region->dispatches[i];
+        EXPECT_GT(d.sequence, total - MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES);
+        EXPECT_EQ(d.sequence - 1, d.duration);
+    }
+}
+
+TEST_F(TestPerfSnapshot, stale_end_does_not_overwrite)
+{
+    reboot();
+
+    uint32_t slow = mbed_perf_snapshot_dispatch_begin(callback_a, 0);
+    for (int i = 0; i < MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES; i++) {
+        uint32_t token = mbed_perf_snapshot_dispatch_begin(callback_b, 5);
+        mbed_perf_snapshot_dispatch_end(token, 6);
+    }
+    mbed_perf_snapshot_dispatch_end(slow, 1000);
+
+    for (int i = 0; i < MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES; i++) {
+        EXPECT_EQ(1u, region->dispatches[i].duration);
+    }
+}
+
+TEST_F(TestPerfSnapshot, update_stores_stats)
+{
+    reboot();
+
+    fake_heap.current_size = 1000;
+    fake_heap.max_size = 4000;
+    fake_cpu.uptime = 123456789;
+    fake_cpu.idle_time = 100000000;
+    fake_stack_count = 10;
+    for (size_t i = 0; i < fake_stack_count; i++) {
+        fake_stacks[i].thread_id = i + 1;
+        fake_stacks[i].max_size = 100 * i;
+        fake_stacks[i].reserved_size = 1024;
+        fake_stacks[i].stack_cnt = 1;
+    }
+
+    mbed_perf_snapshot_update();
+
+    EXPECT_EQ(1u, region->stats_valid);
+    EXPECT_EQ(4000u, region->heap.max_size);
+    EXPECT_EQ(123456789u, region->cpu.uptime);
+    EXPECT_EQ((uint32_t) MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_THREADS, region->stack_count);
+    EXPECT_EQ(500u, region->stacks[5].max_size);
+}
+
+TEST_F(TestPerfSnapshot, survives_reboot_until_read)
+{
+    reboot();
+    fake_heap.max_size = 2048;
+    mbed_perf_snapshot_update();
+    uint32_t token = mbed_perf_snapshot_dispatch_begin(callback_a, 42);
+    (void) token;
+    // Hang: the dispatch never returns and the watchdog resets the system
+
+    reboot();
+
+    // Not overwritten while held, even over another reset
+    EXPECT_EQ(0u, mbed_perf_snapshot_dispatch_begin(callback_b, 0));
+    mbed_perf_snapshot_update();
+    reboot();
+
+    mbed_perf_snapshot_t snapshot;
+    EXPECT_EQ(MBED_ERROR_INVALID_ARGUMENT, mbed_get_reboot_perf_snapshot(NULL));
+    ASSERT_EQ(MBED_SUCCESS, mbed_get_reboot_perf_snapshot(&snapshot));
+    EXPECT_EQ(1u, snapshot.stats_valid);
+    EXPECT_EQ(2048u, snapshot.heap.max_size);
+    const mbed_perf_dispatch_t &d = snapshot.dispatches[snapshot.dispatch_sequence % MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES];
+    EXPECT_EQ((uint32_t)(uintptr_t) callback_a, d.callback);
+    EXPECT_EQ(MBED_PERF_SNAPSHOT_IN_PROGRESS, d.duration);
+
+    // Reading it starts capture of this run
+    EXPECT_EQ(MBED_ERROR_ITEM_NOT_FOUND, mbed_get_reboot_perf_snapshot(&snapshot));
+    EXPECT_EQ(0u, region->dispatch_sequence);
+    EXPECT_NE(0u, mbed_perf_snapshot_dispatch_begin(callback_b, 0));
+
+    reboot();
+    ASSERT_EQ(MBED_SUCCESS, mbed_get_reboot_perf_snapshot(&snapshot));
+    EXPECT_EQ((uint32_t)(uintptr_t) callback_b, snapshot.dispatches[1].callback);
+}
+
+TEST_F(TestPerfSnapshot, reset_discards_unread)
+{
+    reboot();
+    EXPECT_NE(0u, mbed_perf_snapshot_dispatch_begin(callback_a, 0));
+    reboot();
+
+    EXPECT_EQ(MBED_SUCCESS, mbed_reset_reboot_perf_snapshot());
+    mbed_perf_snapshot_t snapshot;
+    EXPECT_EQ(MBED_ERROR_ITEM_NOT_FOUND, mbed_get_reboot_perf_snapshot(&snapshot));
+    EXPECT_EQ(0u, region->dispatch_sequence);
+    EXPECT_NE(0u, mbed_perf_snapshot_dispatch_begin(callback_b, 0));
+}
+
+TEST_F(TestPerfSnapshot, interrupted_update_is_invalid)
+{
+    reboot();
+    mbed_perf_snapshot_update();
+    // Reset while the statistics were being written
+    region->stats_valid = 0;
+    reboot();
+
+    mbed_perf_snapshot_t snapshot;
+    ASSERT_EQ(MBED_SUCCESS, mbed_get_reboot_perf_snapshot(&snapshot));
+    EXPECT_EQ(0u, snapshot.stats_valid);
+}
@@ -0,0 +1,16 @@
+####################
+# UNIT TESTS
+####################
+
+set(unittest-sources
+  ../platform/source/mbed_perf_snapshot.c
+)
+
+set(unittest-test-sources
+  platform/mbed_perf_snapshot/test_mbed_perf_snapshot.cpp
+  stubs/mbed_atomic_stub.c
+  stubs/mbed_critical_stub.c
+)
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED=1 -DMBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED=1")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED=1 -DMBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED=1")
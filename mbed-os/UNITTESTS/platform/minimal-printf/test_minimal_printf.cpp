@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "platform/source/minimal-printf/mbed_printf_implementation.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static int minimal_snprintf(char *buffer, size_t length, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = mbed_minimal_formatted_string(buffer, length, format, args, NULL);
+    va_end(args);
+    return result;
+}
+
+static int minimal_fprintf(FILE *stream, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = mbed_minimal_formatted_string(NULL, 0, format, args, stream);
+    va_end(args);
+    return result;
+}
+
+// Compare against the host C library
+#define EXPECT_CONFORMS(...)                                                      \
+    do {                                                                          \
+        char expected[256];                                                       \
+        char actual[256];                                                         \
+        int expected_result = snprintf(expected, sizeof(expected), __VA_ARGS__);  \
+        int actual_result = minimal_snprintf(actual, sizeof(actual), __VA_ARGS__);\
+        EXPECT_EQ(expected_result, actual_result);                                \
+        EXPECT_STREQ(expected, actual);                                           \
+    } while (0)
+
+struct recording_sink {
+    int calls;
+    int fail_after;
+    std::string output;
+};
+
+static int record(void *context, const char *data, size_t size)
+{
+    recording_sink *sink = static_cast<recording_sink *>(context);
+    if (sink->fail_after >= 0 && sink->calls >= sink->fail_after) {
+        return -1;
+    }
+    sink->calls++;
+    sink->output.append(data, size);
+    return 0;
+}
+
+static int sink_printf(recording_sink *sink, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = mbed_minimal_formatted_string_to_sink(record, sink, format, args);
+    va_end(args);
+    return result;
+}
+
+class TestMinimalPrintf : public testing::Test {
+};
+
+TEST_F(TestMinimalPrintf, signed_integers)
+{
+    EXPECT_CONFORMS("hhd: %hhd %hhd", SCHAR_MIN, SCHAR_MAX);
+    EXPECT_CONFORMS("hd: %hd %hd", SHRT_MIN, SHRT_MAX);
+    EXPECT_CONFORMS("d: %d %d %i", INT_MIN, INT_MAX, 0);
+    EXPECT_CONFORMS("ld: %ld %ld", LONG_MIN, LONG_MAX);
+    EXPECT_CONFORMS("lld: %lld %lld", LLONG_MIN, LLONG_MAX);
+    EXPECT_CONFORMS("jd: %jd %jd", INTMAX_MIN, INTMAX_MAX);
+    EXPECT_CONFORMS("zd: %zd %td", (size_t)12345, (ptrdiff_t) -12345);
+}
+
+TEST_F(TestMinimalPrintf, unsigned_integers)
+{
+    EXPECT_CONFORMS("hhu: %hhu", UCHAR_MAX);
+    EXPECT_CONFORMS("hu: %hu", USHRT_MAX);
+    EXPECT_CONFORMS("u: %u %u", 0u, UINT_MAX);
+    EXPECT_CONFORMS("lu: %lu", ULONG_MAX);
+    EXPECT_CONFORMS("llu: %llu", ULLONG_MAX);
+    EXPECT_CONFORMS("ju: %ju", UINTMAX_MAX);
+    EXPECT_CONFORMS("zu: %zu", SIZE_MAX);
+    EXPECT_CONFORMS("x: %x %X %llx %hhx", 0xDEADBEEFu, 0xCAFEu, 0x0123456789ABCDEFull, 0x1FF);
+    EXPECT_CONFORMS("o: %o %llo", 0777u, ULLONG_MAX);
+}
+
+TEST_F(TestMinimalPrintf, flags_width_precision)
+{
+    EXPECT_CONFORMS("[%5d] [%-5d] [%05d] [%+d] [% d] [%+d]", 42, 42, -42, 42, 42, -42);
+    EXPECT_CONFORMS("[%.3d] [%8.3d] [%-8.3d] [%08.3d]", 7, -7, 7, 7);
+    EXPECT_CONFORMS("[%.0d] [%5.0d] [%.0x]", 0, 0, 0);
+    EXPECT_CONFORMS("[%#x] [%#X] [%#x] [%#010x] [%#o] [%#o] [%#.0o]", 255, 255, 0, 255, 8, 0, 0);
+    EXPECT_CONFORMS("[%*d] [%-*d] [%*d] [%.*d] [%.*d]", 6, 1, 6, 1, -6, 1, 4, 1, -1, 1);
+    EXPECT_CONFORMS("[%08X] [%-08X] [%8lu]", 0xABCu, 0xABCu, 123456ul);
+}
+
+TEST_F(TestMinimalPrintf, characters_and_strings)
+{
+    EXPECT_CONFORMS("[%c] [%3c] [%-3c]", 'a', 'b', 'c');
+    EXPECT_CONFORMS("[%s] [%10s] [%-10s] [%.2s] [%5.1s]", "hello", "hi", "hi", "hello", "hello");
+    EXPECT_CONFORMS("[%s]", "");
+    EXPECT_CONFORMS("100%% [%%]");
+    EXPECT_CONFORMS("no conversions at all");
+}
+
+TEST_F(TestMinimalPrintf, pointers)
+{
+    int value;
+    EXPECT_CONFORMS("%p", (void *) &value);
+    EXPECT_CONFORMS("[%20p] [%-20p]", (void *) &value, (void *) &value);
+}
+
+TEST_F(TestMinimalPrintf, floating_point)
+{
+    EXPECT_CONFORMS("%f %f %f", 0.0, 1.0, -1.0);
+    EXPECT_CONFORMS("%f %.2f %.0f %.1f", 3.14159265, 2.71828, 9.7, 0.04);
+    EXPECT_CONFORMS("[%10.3f] [%-10.3f] [%010.3f] [%+.2f] [% .2f]", 1.2345, 1.2345, -1.2345, 1.0, 1.0);
+    EXPECT_CONFORMS("%f %f", 0.9999999, 123456789.123);
+    EXPECT_CONFORMS("%#.0f %.0f", 3.0, 3.0);
+    EXPECT_CONFORMS("%f %F %f %f", 1.0 / 0.0, 1.0 / 0.0, -1.0 / 0.0, -0.0);
+}
+
+TEST_F(TestMinimalPrintf, floating_point_ties)
+{
+    EXPECT_CONFORMS("%.0f %.0f %.0f %.0f %.0f", 0.5, 1.5, 2.5, -2.5, 3.5);
+    EXPECT_CONFORMS("%.2f %.2f %.1f %.1f", 0.125, 0.375, 0.25, 9.95);
+    EXPECT_CONFORMS("%.0f %.1f", 2.5000001, 0.2500001);
+}
+
+TEST_F(TestMinimalPrintf, exponent_notation_unsupported)
+{
+    char buffer[64];
+    EXPECT_EQ(13, minimal_snprintf(buffer, sizeof(buffer), "%e %.3G %Lg %d", 1.5, 2.5, 3.5L, 7));
+    EXPECT_STREQ("%e %.3G %Lg 7", buffer);
+}
+
+TEST_F(TestMinimalPrintf, truncation)
+{
+    char buffer[8];
+    memset(buffer, 'x', sizeof(buffer));
+    EXPECT_EQ(11, minimal_snprintf(buffer, sizeof(buffer), "hello %s", "world"));
+    EXPECT_STREQ("hello w", buffer);
+
+    EXPECT_EQ(5, minimal_snprintf(NULL, 0, "%d", 12345));
+
+    memset(buffer, 'x', sizeof(buffer));
+    EXPECT_EQ(3, minimal_snprintf(buffer, 1, "abc"));
+    EXPECT_EQ('\0', buffer[0]);
+    EXPECT_EQ('x', buffer[1]);
+}
+
+TEST_F(TestMinimalPrintf, stdio_stream)
+{
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+
+    char expected[64];
+    int expected_result = snprintf(expected, sizeof(expected), "%s=%d", "value", 42);
+    EXPECT_EQ(expected_result, minimal_fprintf(file, "%s=%d", "value", 42));
+
+    char actual[64] = {0};
+    rewind(file);
+    ASSERT_TRUE(fgets(actual, sizeof(actual), file) != NULL);
+    EXPECT_STREQ(expected, actual);
+    fclose(file);
+}
+
+TEST_F(TestMinimalPrintf, streams_in_chunks)
+{
+    recording_sink sink = {0, -1, ""};
+
+    // Short output is delivered in a single call
+    EXPECT_EQ(9, sink_printf(&sink, "AT+X=%d\r\n", 12));
+    EXPECT_EQ(1, sink.calls);
+    EXPECT_EQ("AT+X=12\r\n", sink.output);
+
+    // Formatted output is staged in chunks of bounded size
+    sink = {0, -1, ""};
+    EXPECT_EQ(200, sink_printf(&sink, "%0200d", 1));
+    EXPECT_EQ((200 + MBED_MINIMAL_PRINTF_CHUNK_SIZE - 1) / MBED_MINIMAL_PRINTF_CHUNK_SIZE, sink.calls);
+    EXPECT_EQ(200u, sink.output.size());
+
+    // Long strings bypass the chunk and reach the sink without a copy
+    std::string payload(500, 'p');
+    sink = {0, -1, ""};
+    EXPECT_EQ(502, sink_printf(&sink, "<%s>", payload.c_str()));
+    EXPECT_EQ(3, sink.calls);
+    EXPECT_EQ("<" + payload + ">", sink.output);
+}
+
+TEST_F(TestMinimalPrintf, sink_failure)
+{
+    recording_sink sink = {0, 1, ""};
+    EXPECT_GT(0, sink_printf(&sink, "%0100d", 1));
+    EXPECT_EQ(1, sink.calls);
+}
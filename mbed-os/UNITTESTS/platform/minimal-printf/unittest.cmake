@@ -0,0 +1,16 @@
+####################
+# UNIT TESTS
+####################
+
+# Source files
+set(unittest-sources
+  ../platform/source/minimal-printf/mbed_printf_implementation.c
+)
+
+# Test files
+set(unittest-test-sources
+  platform/minimal-printf/test_minimal_printf.cpp
+)
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DMBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT=1 -DMBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT=1")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DMBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT=1 -DMBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT=1")
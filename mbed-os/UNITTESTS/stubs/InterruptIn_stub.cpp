@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drivers/InterruptIn.h"
+
+/*
+ * Behaves like the driver, except that the id given to gpio_irq_init is an
+ * index into a table, as pointers do not fit in the uint32_t id on 64 bit
+ * hosts. The test provides the gpio and gpio_irq HAL.
+ */
+
+namespace mbed {
+
+static const uint32_t max_interrupt_ins = 8;
+static InterruptIn *interrupt_ins[max_interrupt_ins];
+
+InterruptIn::InterruptIn(PinName pin) :
+    gpio(),
+    gpio_irq(),
+    _rise(NULL),
+    _fall(NULL)
+{
+    irq_init(pin);
+    gpio_init_in(&gpio, pin);
+}
+
+InterruptIn::InterruptIn(PinName pin, PinMode mode) :
+    gpio(),
+    gpio_irq(),
+    _rise(NULL),
+    _fall(NULL)
+{
+    irq_init(pin);
+    gpio_init_in_ex(&gpio, pin, mode);
+}
+
+void InterruptIn::irq_init(PinName pin)
+{
+    for (uint32_t id = 0; id < max_interrupt_ins; id++) {
+        if (!interrupt_ins[id]) {
+            interrupt_ins[id] = this;
+            gpio_irq_init(&gpio_irq, pin, (&InterruptIn::_irq_handler), id);
+            return;
+        }
+    }
+}
+
+InterruptIn::~InterruptIn()
+{
+    for (uint32_t id = 0; id < max_interrupt_ins; id++) {
+        if (interrupt_ins[id] == this) {
+            interrupt_ins[id] = NULL;
+        }
+    }
+    gpio_irq_free(&gpio_irq);
+}
+
+int InterruptIn::read()
+{
+    return gpio_read(&gpio);
+}
+
+void InterruptIn::mode(PinMode pull)
+{
+    gpio_mode(&gpio, pull);
+}
+
+void InterruptIn::rise(Callback<void()> func)
+{
+    _rise = func;
+    gpio_irq_set(&gpio_irq, IRQ_RISE, func ? 1 : 0);
+}
+
+void InterruptIn::fall(Callback<void()> func)
+{
+    _fall = func;
+    gpio_irq_set(&gpio_irq, IRQ_FALL, func ? 1 : 0);
+}
+
+void InterruptIn::_irq_handler(uint32_t id, gpio_irq_event event)
+{
+    InterruptIn *handler = interrupt_ins[id];
+    if (event == IRQ_RISE && handler->_rise) {
+        handler->_rise();
+    } else if (event == IRQ_FALL && handler->_fall) {
+        handler->_fall();
+    }
+}
+
+void InterruptIn::enable_irq()
+{
+    gpio_irq_enable(&gpio_irq);
+}
+
+void InterruptIn::disable_irq()
+{
+    gpio_irq_disable(&gpio_irq);
+}
+
+InterruptIn::operator int()
+{
+    return read();
+}
+
+} // namespace mbed
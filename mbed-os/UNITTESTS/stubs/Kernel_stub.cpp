@@ -17,10 +17,13 @@
 
 #include "Kernel.h"
 
+/** Store the value to be returned by Kernel::get_ms_count() */
+uint64_t kernelStubMsCount = 20;
+
 namespace rtos {
 
 uint64_t Kernel::get_ms_count()
 {
-    return 20;
+    return kernelStubMsCount;
 }
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2019, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NETSTACKMEMORYMANAGERSTUB_H
+#define NETSTACKMEMORYMANAGERSTUB_H
+
+#include "netsocket/NetStackMemoryManager.h"
+#include <stdlib.h>
+
+/*
+ * Heap backed buffers. Pool allocations are chains of pool_unit sized
+ * segments. Counts buffers in use, and bytes copied in and out of buffers.
+ */
+class NetStackMemoryManagerstub : public NetStackMemoryManager {
+public:
+    uint32_t pool_unit;
+    int allocated;
+    uint32_t copied;
+
+    NetStackMemoryManagerstub() :
+        pool_unit(1536),
+        allocated(0),
+        copied(0)
+    {
+    }
+
+    virtual net_stack_mem_buf_t *alloc_heap(uint32_t size, uint32_t align)
+    {
+        buf_t *buf = static_cast<buf_t *>(malloc(sizeof(buf_t) + size));
+        buf->next = NULL;
+        buf->len = size;
+        allocated++;
+        return buf;
+    }
+
+    virtual net_stack_mem_buf_t *alloc_pool(uint32_t size, uint32_t align)
+    {
+        buf_t *head = NULL;
+        buf_t **tail = &head;
+        do {
+            uint32_t len = size < pool_unit ? size : pool_unit;
+            *tail = static_cast<buf_t *>(alloc_heap(len, align));
+            tail = &(*tail)->next;
+            size -= len;
+        } while (size);
+        return head;
+    }
+
+    virtual uint32_t get_pool_alloc_unit(uint32_t align) const
+    {
+        return pool_unit;
+    }
+
+    virtual void free(net_stack_mem_buf_t *buf)
+    {
+        buf_t *seg = static_cast<buf_t *>(buf);
+        while (seg) {
+            buf_t *next = seg->next;
+            ::free(seg);
+            allocated--;
+            seg = next;
+        }
+    }
+
+    virtual uint32_t get_total_len(const net_stack_mem_buf_t *buf) const
+    {
+        uint32_t len = 0;
+        for (const buf_t *seg = static_cast<const buf_t *>(buf); seg; seg = seg->next) {
+            len += seg->len;
+        }
+        return len;
+    }
+
+    virtual void copy(net_stack_mem_buf_t *to_buf, const net_stack_mem_buf_t *from_buf)
+    {
+    }
+
+    virtual void copy_to_buf(net_stack_mem_buf_t *to_buf, const void *ptr, uint32_t len)
+    {
+        copied += len;
+        NetStackMemoryManager::copy_to_buf(to_buf, ptr, len);
+    }
+
+    virtual uint32_t copy_from_buf(void *ptr, uint32_t len, const net_stack_mem_buf_t *from_buf) const
+    {
+        uint32_t copy_len = NetStackMemoryManager::copy_from_buf(ptr, len, from_buf);
+        const_cast<NetStackMemoryManagerstub *>(this)->copied += copy_len;
+        return copy_len;
+    }
+
+    virtual void cat(net_stack_mem_buf_t *to_buf, net_stack_mem_buf_t *cat_buf)
+    {
+        buf_t *seg = static_cast<buf_t *>(to_buf);
+        while (seg->next) {
+            seg = seg->next;
+        }
+        seg->next = static_cast<buf_t *>(cat_buf);
+    }
+
+    virtual net_stack_mem_buf_t *get_next(const net_stack_mem_buf_t *buf) const
+    {
+        return static_cast<const buf_t *>(buf)->next;
+    }
+
+    virtual void *get_ptr(const net_stack_mem_buf_t *buf) const
+    {
+        return const_cast<buf_t *>(static_cast<const buf_t *>(buf)) + 1;
+    }
+
+    virtual uint32_t get_len(const net_stack_mem_buf_t *buf) const
+    {
+        return static_cast<const buf_t *>(buf)->len;
+    }
+
+    virtual void set_len(net_stack_mem_buf_t *buf, uint32_t len)
+    {
+        static_cast<buf_t *>(buf)->len = len;
+    }
+
+private:
+    struct buf_t {
+        buf_t *next;
+        uint32_t len;
+    };
+};
+
+#endif // NETSTACKMEMORYMANAGERSTUB_H
@@ -84,6 +84,39 @@ call_in_callback_cb_t NetworkStack::get_call_in_callback()
     return NULL;
 }
 
+nsapi_size_or_error_t NetworkStack::socket_sendto_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recvfrom_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_error_t NetworkStack::socket_alloc_buffer(nsapi_socket_t handle, nsapi_size_t size, net_stack_mem_buf_t **buf)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address,
+                                                       net_stack_mem_buf_t *buf, nsapi_size_t offset)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address,
+                                                       net_stack_mem_buf_t **buf)
+{
+    *buf = NULL;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+NetStackMemoryManager *NetworkStack::get_socket_memory_manager()
+{
+    return NULL;
+}
+
 nsapi_error_t NetworkStack::call_in(int delay, mbed::Callback<void()> func)
 {
     return NSAPI_ERROR_UNSUPPORTED;
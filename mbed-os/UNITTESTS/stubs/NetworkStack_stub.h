@@ -19,6 +19,7 @@
 #define NETWORKSTACKSTUB_H
 
 #include "netsocket/NetworkStack.h"
+#include "netsocket/NetStackMemoryManager.h"
 #include <list>
 
 class NetworkStackstub : public NetworkStack {
@@ -26,10 +27,12 @@ public:
     std::list<nsapi_error_t> return_values;
     nsapi_error_t return_value;
     SocketAddress return_socketAddress;
+    NetStackMemoryManager *memory_manager;
 
     NetworkStackstub() :
         return_value(0),
-        return_socketAddress()
+        return_socketAddress(),
+        memory_manager(NULL)
     {
     }
 
@@ -138,6 +141,46 @@ protected:
         }
         return return_value;
     };
+    virtual nsapi_error_t socket_alloc_buffer(nsapi_socket_t handle, nsapi_size_t size, net_stack_mem_buf_t **buf)
+    {
+        if (!memory_manager) {
+            return NSAPI_ERROR_UNSUPPORTED;
+        }
+        *buf = memory_manager->alloc_pool(size, 0);
+        return NSAPI_ERROR_OK;
+    };
+    virtual nsapi_size_or_error_t socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address,
+                                                     net_stack_mem_buf_t *buf, nsapi_size_t offset)
+    {
+        nsapi_size_or_error_t ret = return_value;
+        if (!return_values.empty()) {
+            ret = return_values.front();
+            return_values.pop_front();
+        }
+        // The buffer is taken once all of it is sent
+        if (ret >= 0 && offset + ret >= memory_manager->get_total_len(buf)) {
+            memory_manager->free(buf);
+        }
+        return ret;
+    };
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address,
+                                                     net_stack_mem_buf_t **buf)
+    {
+        nsapi_size_or_error_t ret = return_value;
+        if (!return_values.empty()) {
+            ret = return_values.front();
+            return_values.pop_front();
+        }
+        if (return_socketAddress != SocketAddress()) {
+            *address = return_socketAddress;
+        }
+        *buf = ret > 0 ? memory_manager->alloc_pool(ret, 0) : NULL;
+        return ret;
+    };
+    virtual NetStackMemoryManager *get_socket_memory_manager()
+    {
+        return memory_manager;
+    };
     virtual void socket_attach(nsapi_socket_t handle, void (*callback)(void *), void *data) {};
 
 private:
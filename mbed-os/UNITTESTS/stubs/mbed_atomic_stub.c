@@ -35,7 +35,12 @@ bool core_util_atomic_cas_u16(volatile uint16_t *ptr, uint16_t *expectedCurrentV
 
 bool core_util_atomic_cas_u32(volatile uint32_t *ptr, uint32_t *expectedCurrentValue, uint32_t desiredValue)
 {
-    return false;
+    if (*ptr != *expectedCurrentValue) {
+        *expectedCurrentValue = *ptr;
+        return false;
+    }
+    *ptr = desiredValue;
+    return true;
 }
 
 
@@ -28,23 +28,54 @@ namespace mbed {
 class Ticker {
 
 public:
-    Ticker()
+    Ticker() : _interval(0)
     {
     }
 
     void attach_us(Callback<void()> func, us_timestamp_t t)
     {
-
+        _function = func;
+        _interval = t;
+        last_attached() = this;
     }
 
     void detach()
     {
-
+        _function = nullptr;
+        if (last_attached() == this) {
+            last_attached() = nullptr;
+        }
     }
 
     ~Ticker()
     {
+        detach();
+    }
+
+    /** Call the attached function as if the interval had elapsed */
+    void expire()
+    {
+        if (_function) {
+            _function();
+        }
+    }
+
+    /** Interval given when the ticker was last attached */
+    us_timestamp_t interval() const
+    {
+        return _interval;
+    }
+
+    /** Ticker attached most recently, for tests which cannot reach it */
+    static Ticker *&last_attached()
+    {
+        static Ticker *ticker;
+        return ticker;
     }
+
+private:
+    Callback<void()> _function;
+    us_timestamp_t _interval;
 };
 
 } // namespace mbed
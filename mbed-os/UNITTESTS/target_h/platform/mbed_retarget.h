@@ -24,7 +24,9 @@
 
 #include <time.h>
 
+#ifdef __cplusplus
 namespace mbed {
+#endif
 
 #define NAME_MAX 255
 
@@ -360,6 +362,8 @@ struct pollfd {
     short revents;
 };
 
+#ifdef __cplusplus
 }
+#endif
 
 #endif //RETARGET_H
@@ -507,27 +507,13 @@ spif_bd_error SPIFBlockDevice::_spi_send_read_command(int read_inst, uint8_t *bu
     uint32_t dummy_bytes = _dummy_and_mode_cycles / 8;
     int dummy_byte = 0;
 
+    // Instruction, Address, Dummy Cycles and Data are sent as one batch
+    SPI::Batch batch;
+    batch.command(read_inst).address(addr, _address_size).dummy(dummy_bytes, dummy_byte).read((char *)buffer, size);
+
     // csel must go low for the entire command (Inst, Address and Data)
     _cs = 0;
-
-    // Write 1 byte Instruction
-    _spi.write(read_inst);
-
-    // Write Address (can be either 3 or 4 bytes long)
-    for (int address_shift = ((_address_size - 1) * 8); address_shift >= 0; address_shift -= 8) {
-        _spi.write((addr >> address_shift) & 0xFF);
-    }
-
-    // Write Dummy Cycles Bytes
-    for (uint32_t i = 0; i < dummy_bytes; i++) {
-        _spi.write(dummy_byte);
-    }
-
-    // Read Data
-    for (bd_size_t i = 0; i < size; i++) {
-        buffer[i] = _spi.write(0);
-    }
-
+    _spi.write(batch);
     // csel back to high
     _cs = 1;
     return SPIF_BD_ERROR_OK;
@@ -539,29 +525,14 @@ spif_bd_error SPIFBlockDevice::_spi_send_program_command(int prog_inst, const vo
     // Send Program (write) command to device driver
     uint32_t dummy_bytes = _dummy_and_mode_cycles / 8;
     int dummy_byte = 0;
-    uint8_t *data = (uint8_t *)buffer;
+
+    // Instruction, Address, Dummy Cycles and Data are sent as one batch
+    SPI::Batch batch;
+    batch.command(prog_inst).address(addr, _address_size).dummy(dummy_bytes, dummy_byte).write((const char *)buffer, size);
 
     // csel must go low for the entire command (Inst, Address and Data)
     _cs = 0;
-
-    // Write 1 byte Instruction
-    _spi.write(prog_inst);
-
-    // Write Address (can be either 3 or 4 bytes long)
-    for (int address_shift = ((_address_size - 1) * 8); address_shift >= 0; address_shift -= 8) {
-        _spi.write((addr >> address_shift) & 0xFF);
-    }
-
-    // Write Dummy Cycles Bytes
-    for (uint32_t i = 0; i < dummy_bytes; i++) {
-        _spi.write(dummy_byte);
-    }
-
-    // Write Data
-    for (bd_size_t i = 0; i < size; i++) {
-        _spi.write(data[i]);
-    }
-
+    _spi.write(batch);
     // csel back to high
     _cs = 1;
 
@@ -583,25 +554,21 @@ spif_bd_error SPIFBlockDevice::_spi_send_general_command(int instruction, bd_add
     uint32_t dummy_bytes = _dummy_and_mode_cycles / 8;
     uint8_t dummy_byte = 0x00;
 
-    // csel must go low for the entire command (Inst, Address and Data)
-    _cs = 0;
-
     // Write 1 byte Instruction
-    _spi.write(instruction);
+    SPI::Batch batch;
+    batch.command(instruction);
 
     // Reading SPI Bus registers does not require Flash Address
     if (addr != SPI_NO_ADDRESS_COMMAND) {
-        // Write Address (can be either 3 or 4 bytes long)
-        for (int address_shift = ((_address_size - 1) * 8); address_shift >= 0; address_shift -= 8) {
-            _spi.write((addr >> address_shift) & 0xFF);
-        }
-
-        // Write Dummy Cycles Bytes
-        for (uint32_t i = 0; i < dummy_bytes; i++) {
-            _spi.write(dummy_byte);
-        }
+        // Write Address (can be either 3 or 4 bytes long) and Dummy Cycles Bytes
+        batch.address(addr, _address_size).dummy(dummy_bytes, dummy_byte);
     }
 
+    // csel must go low for the entire command (Inst, Address and Data)
+    _cs = 0;
+
+    _spi.write(batch);
+
     // Read/Write Data
     _spi.write(tx_buffer, (int)tx_length, rx_buffer, (int)rx_length);
 
@@ -0,0 +1,174 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_ANALOGINSAMPLER_H
+#define MBED_ANALOGINSAMPLER_H
+
+#include "platform/platform.h"
+
+#if DEVICE_ANALOGIN || defined(DOXYGEN_ONLY)
+
+#include "drivers/AnalogIn.h"
+#include "drivers/Ticker.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+/**
+ * \defgroup drivers_AnalogInSampler AnalogInSampler class
+ * \ingroup drivers-public-api-gpio
+ * @{
+ */
+
+/** An analog input which also samples at a fixed rate into a buffer
+ *
+ * A block of samples is taken once with sample(), or again and again into
+ * a double buffer with sample_continuous(). Samples are taken without
+ * locking, by the target's timer and DMA where it has them, and from a
+ * ticker interrupt otherwise.
+ *
+ * Callbacks are called in interrupt context.
+ *
+ * read() and read_u16() wait while samples are being taken, so that they do
+ * not use the ADC at the same time, and must not be called by the thread
+ * which is to stop continuous sampling.
+ *
+ * @note Synchronization level: Thread safe, if sampling is started from
+ *       thread context. Other AnalogIns of the same ADC must not be read
+ *       while sampling.
+ *
+ * Example:
+ * @code
+ * // Process 10 kHz samples in blocks of 256
+ *
+ * #include "mbed.h"
+ *
+ * AnalogInSampler vibration(A0);
+ * uint16_t samples[2 * 256];
+ * EventQueue queue;
+ *
+ * void process(const uint16_t *block, size_t count) {
+ *     // Runs in thread context, before the half of the buffer is filled again
+ * }
+ *
+ * void filled(const uint16_t *block, size_t count) {
+ *     queue.call(process, block, count);
+ * }
+ *
+ * int main() {
+ *     vibration.sample_continuous(samples, 2 * 256, 100, filled);
+ *     queue.dispatch_forever();
+ * }
+ * @endcode
+ */
+class AnalogInSampler : public AnalogIn, private NonCopyable<AnalogInSampler> {
+
+public:
+    /** Callback called with samples as they are taken */
+    typedef Callback<void(const uint16_t *samples, size_t count)> sample_callback_t;
+
+    /** Create an AnalogInSampler, connected to the specified pin
+     *
+     * @param pinmap reference to structure which holds static pinmap.
+     */
+    AnalogInSampler(const PinMap &pinmap);
+    AnalogInSampler(const PinMap &&) = delete; // prevent passing of temporary objects
+
+    /** Create an AnalogInSampler, connected to the specified pin
+     *
+     * @param pin AnalogIn pin to connect to
+     */
+    AnalogInSampler(PinName pin);
+
+    virtual ~AnalogInSampler();
+
+    /** Take a block of samples at a fixed rate
+     *
+     * Samples are unsigned shorts in the range [0x0, 0xFFFF], as returned
+     * by read_u16().
+     *
+     * @param buffer    The buffer to fill, valid until the callback is called
+     * @param count     The number of samples to take
+     * @param period_us The time between samples in microseconds
+     * @param callback  The callback called with the buffer once it is full
+     * @returns
+     *   0 if sampling started,
+     *   -1 if already sampling or the arguments are invalid
+     */
+    int sample(uint16_t *buffer, size_t count, uint32_t period_us, sample_callback_t callback);
+
+    /** Take samples at a fixed rate until stopped, into a double buffer
+     *
+     * The buffer is used as two halves. The callback is called with each
+     * half once it is full, and sampling carries on into the other half, so
+     * the samples must be used before that half is full too.
+     *
+     * @param buffer    The buffer to fill, valid until sampling is stopped
+     * @param count     The number of samples in the buffer, an even number
+     * @param period_us The time between samples in microseconds
+     * @param callback  The callback called with each half once it is full
+     * @returns
+     *   0 if sampling started,
+     *   -1 if already sampling or the arguments are invalid
+     */
+    int sample_continuous(uint16_t *buffer, size_t count, uint32_t period_us, sample_callback_t callback);
+
+    /** Stop sampling
+     *
+     * The callback is not called after this returns, and samples taken
+     * since the last callback are dropped. It can be called from the
+     * callback.
+     */
+    void stop();
+
+    /** Check whether samples are being taken
+     *
+     * @returns true if sampling, false otherwise
+     */
+    bool sampling() const
+    {
+        return _active;
+    }
+
+#if !defined(DOXYGEN_ONLY)
+protected:
+    virtual void lock();
+
+private:
+    int start(uint16_t *buffer, size_t count, uint32_t period_us, sample_callback_t callback, bool circular);
+    void stop_sampling();
+    void sample_tick();
+    static void sample_handler(void *context, uint16_t *samples, size_t count);
+
+    Ticker _ticker;
+    sample_callback_t _callback;
+    uint16_t *_buffer;
+    size_t _count;
+    size_t _index;
+    bool _circular;
+    bool _hardware;
+    volatile bool _active;
+#endif //!defined(DOXYGEN_ONLY)
+};
+
+/** @}*/
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -21,6 +21,7 @@
 #include "drivers/DigitalIn.h"
 #include "platform/PlatformMutex.h"
 #include "platform/NonCopyable.h"
+#include "drivers/internal/BusPorts.h"
 
 namespace mbed {
 /**
@@ -30,6 +31,9 @@ namespace mbed {
  */
 
 /** A digital input bus, used for reading the state of a collection of pins
+ *
+ * If the target can tell the GPIO port of each pin and the pins are on at
+ * most 4 ports, the bus is read one port at a time.
  *
  * @note Synchronization level: Thread safe
  */
@@ -114,6 +118,11 @@ public:
 protected:
     DigitalIn *_pin[16];
 
+#if DEVICE_PORTIN
+    /* Pins grouped by port, used instead of _pin when enabled */
+    internal::BusPorts _ports;
+#endif
+
     /* Mask of bus's NC pins
      * If bit[n] is set to 1 - pin is connected
      * if bit[n] is cleared - pin is not connected (NC)
@@ -20,6 +20,7 @@
 #include "drivers/DigitalInOut.h"
 #include "platform/PlatformMutex.h"
 #include "platform/NonCopyable.h"
+#include "drivers/internal/BusPorts.h"
 
 namespace mbed {
 /**
@@ -33,6 +34,10 @@ namespace mbed {
  *  pins without restriction other than being capable of digital input or output
  *  capabilities
  *
+ *  If the target can tell the GPIO port of each pin and the pins are on at
+ *  most 4 ports, the bus is accessed one port at a time, so the pins of a
+ *  port change together.
+ *
  * @note Synchronization level: Thread safe
  */
 class BusInOut : private NonCopyable<BusInOut> {
@@ -86,6 +91,10 @@ public:
     void write(int value);
 
     /** Read the value currently output on the bus
+     *
+     *  When the bus is accessed one port at a time and set as output, this is
+     *  the value held in the ports' output registers rather than the level
+     *  sensed on the pins.
      *
      *  @returns
      *    An integer with each bit corresponding to associated DigitalInOut pin setting
@@ -140,6 +149,11 @@ protected:
     virtual void unlock();
     DigitalInOut *_pin[16];
 
+#if DEVICE_PORTINOUT
+    /* Pins grouped by port, used instead of _pin when enabled */
+    internal::BusPorts _ports;
+#endif
+
     /* Mask of bus's NC pins
      * If bit[n] is set to 1 - pin is connected
      * if bit[n] is cleared - pin is not connected (NC)
@@ -20,6 +20,7 @@
 #include "drivers/DigitalOut.h"
 #include "platform/PlatformMutex.h"
 #include "platform/NonCopyable.h"
+#include "drivers/internal/BusPorts.h"
 
 namespace mbed {
 /**
@@ -29,6 +30,10 @@ namespace mbed {
  */
 
 /** A digital output bus, used for setting the state of a collection of pins
+ *
+ * If the target can tell the GPIO port of each pin and the pins are on at
+ * most 4 ports, the bus is written one port at a time, so the pins of a
+ * port change together.
  */
 class BusOut : private NonCopyable<BusOut> {
 
@@ -79,6 +84,9 @@ public:
     void write(int value);
 
     /** Read the value currently output on the bus
+     *
+     *  When the bus is accessed one port at a time, this is the value held in
+     *  the ports' output registers rather than the level sensed on the pins.
      *
      *  @returns
      *    An integer with each bit corresponding to associated DigitalOut pin setting
@@ -118,6 +126,11 @@ protected:
     virtual void unlock();
     DigitalOut *_pin[16];
 
+#if DEVICE_PORTOUT
+    /* Pins grouped by port, used instead of _pin when enabled */
+    internal::BusPorts _ports;
+#endif
+
     /* Mask of bus's NC pins
      * If bit[n] is set to 1 - pin is connected
      * if bit[n] is cleared - pin is not connected (NC)
@@ -31,6 +31,11 @@
 #include "platform/CThunk.h"
 #include "hal/dma_api.h"
 #include "platform/Callback.h"
+#include "platform/CircularBuffer.h"
+#endif
+
+#ifndef MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+#define MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE 4
 #endif
 
 namespace mbed {
@@ -94,6 +99,18 @@ public:
         ACK   = 1
     };
 
+    /** A message of a multi-message transfer
+     *
+     * Messages of a transfer are sent back to back, with a repeated start
+     * between them and a stop after the last one, like Linux's i2c_msg.
+     */
+    struct message_t {
+        int address;    /**< 8-bit I2C slave address, the bottom bit is set for reads */
+        char *data;     /**< Data to send, or buffer for the data read */
+        int length;     /**< Number of bytes to send or read */
+        bool read;      /**< Whether to read from the slave rather than write */
+    };
+
     /** Create an I2C Master interface, connected to the specified pins
      *
      *  @param sda I2C data line pin
@@ -168,6 +185,19 @@ public:
      */
     int write(int data);
 
+    /** Transfer several messages with repeated starts
+     *
+     * A stop follows the last message, or a message which fails.
+     *
+     *  @param messages The messages to transfer
+     *  @param count    The number of messages
+     *
+     *  @returns
+     *       the number of messages transferred, which is less than count
+     *       on failure (nack)
+     */
+    int transfer(const message_t *messages, int count);
+
     /** Creates a start condition on the I2C bus
      */
     void start(void);
@@ -209,7 +239,28 @@ public:
      */
     int transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t &callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
 
+    /** Start nonblocking transfer of several messages with repeated starts.
+     *
+     * Messages are sent back to back from the transfer interrupt, with a stop
+     * after the last one. A message which fails ends the transfer. A write followed by a read
+     * of the same slave is a single transfer of the HAL. If another transfer
+     * is in progress, the messages are queued and sent once it completes,
+     * or once the lock is released if a thread holds it at that time.
+     *
+     * This function locks the deep sleep until the callback is called.
+     *
+     * @param messages The messages, which must stay valid until the callback is called
+     * @param count    The number of messages
+     * @param callback The event callback function, called once for all the messages
+     * @param event    The logical OR of events to modify
+     *
+     * @returns Zero if the transfer has started or was queued, or -1 if the queue is full
+     */
+    int transfer(const message_t *messages, int count, const event_callback_t &callback, int event = I2C_EVENT_TRANSFER_COMPLETE);
+
     /** Abort the ongoing I2C transfer
+     *
+     * Queued transfers are started once the ongoing one is aborted.
      */
     void abort_transfer();
 
@@ -226,6 +277,47 @@ protected:
     CThunk<I2C> _irq;
     DMAUsage _usage;
     bool _deep_sleep_locked;
+
+private:
+    struct message_transfer_t {
+        const message_t *messages;
+        int count;
+        event_callback_t callback;
+        int event;
+    };
+
+    /** Start a transfer of messages, in a critical section */
+    void start_messages(const message_transfer_t &transfer);
+
+    /** Start the HAL transfer of the next messages */
+    void start_message();
+
+    /** Start the next queued transfer of messages, if any
+     *
+     * @param locked true if the caller holds the lock, false from the transfer interrupt
+     */
+    void dequeue_messages(bool locked);
+
+    /* Messages being transferred, if any */
+    message_transfer_t _messages;
+    /* Index of the message being transferred */
+    int _message_index;
+    /* Number of messages in the HAL transfer, 2 for a write followed by a read */
+    int _message_step;
+#if MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+    /* Transfers of messages waiting for the bus */
+    CircularBuffer<message_transfer_t, MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE> _message_queue;
+    /* Next of the I2Cs whose queued transfer waits for the lock to be released */
+    I2C *_deferred_next;
+
+    /** Start the queued transfers that the transfer interrupt left to unlock() */
+    static void start_deferred();
+
+    /* Number of lock() calls not yet matched by unlock(), from any thread */
+    static int _lock_count;
+    /* First of the I2Cs whose queued transfer waits for the lock to be released */
+    static I2C *_deferred;
+#endif
 #endif
 #endif
 
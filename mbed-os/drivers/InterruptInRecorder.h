@@ -0,0 +1,195 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_INTERRUPTINRECORDER_H
+#define MBED_INTERRUPTINRECORDER_H
+
+#include "platform/platform.h"
+
+#if DEVICE_INTERRUPTIN || defined(DOXYGEN_ONLY)
+
+#include "drivers/InterruptIn.h"
+#include "hal/ticker_api.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+namespace events {
+class EventQueue;
+}
+
+namespace mbed {
+/**
+ * \defgroup drivers_InterruptInRecorder InterruptInRecorder class
+ * \ingroup drivers-public-api-gpio
+ * @{
+ */
+
+/** A digital interrupt input which records the time of each edge
+ *
+ * Instead of calling a function for every edge, the interrupt only stores
+ * the time and direction of the edge in a ring buffer. The edges are read
+ * from thread context later, either by polling with read_edges() or in
+ * batches from an EventQueue with attach(), so fast edge trains cost one
+ * short interrupt each and one callback per batch.
+ *
+ * The ring buffer is lock free, with the interrupt as the only writer and
+ * a single reader. Edges seen while it is full are dropped and counted.
+ *
+ * @note Synchronization level: Interrupt safe for recording. Edges must be
+ *       read from only one thread, either by read_edges() or by attach().
+ *
+ * Example:
+ * @code
+ * // Measure the pulses of a sensor in batches
+ *
+ * #include "mbed.h"
+ *
+ * InterruptInRecorder::Edge edges[64];
+ * InterruptInRecorder sensor(p16, edges, 64);
+ * EventQueue queue;
+ *
+ * void pulses(const InterruptInRecorder::Edge *edges, uint32_t count) {
+ *     // Runs on the queue, for up to 64 edges recorded since the last call
+ * }
+ *
+ * int main() {
+ *     sensor.attach(&queue, pulses, 10);
+ *     sensor.record();
+ *     queue.dispatch_forever();
+ * }
+ * @endcode
+ */
+class InterruptInRecorder : private InterruptIn, private NonCopyable<InterruptInRecorder> {
+
+public:
+    /** An edge seen on the pin */
+    struct Edge {
+        /** Time of the edge in microseconds, from the us ticker */
+        us_timestamp_t timestamp;
+        /** true for a rising edge, false for a falling edge */
+        bool rise;
+    };
+
+    /** Callback called with edges in the order they were seen */
+    typedef Callback<void(const Edge *edges, uint32_t count)> edges_callback_t;
+
+    /** Create an InterruptInRecorder connected to the specified pin
+     *
+     * @param pin    InterruptIn pin to connect to
+     * @param buffer The ring buffer to record edges into, valid for the
+     *               life of the object
+     * @param count  The number of edges in the buffer, a power of two
+     * @param mode   The mode to set the pin to (PullUp/PullDown/etc.)
+     */
+    InterruptInRecorder(PinName pin, Edge *buffer, uint32_t count, PinMode mode = PullDefault);
+
+    /** Destroy the InterruptInRecorder
+     *
+     * Waits for a batch being delivered on another thread to finish.
+     *
+     * @note Do not destroy from the callback, or from another event of the
+     *       queue that delivers the batches
+     */
+    virtual ~InterruptInRecorder();
+
+    /** Start recording edges
+     *
+     * @param rise true to record rising edges
+     * @param fall true to record falling edges
+     */
+    void record(bool rise = true, bool fall = true);
+
+    /** Stop recording edges
+     *
+     * Edges already recorded are kept and can still be read.
+     */
+    void stop();
+
+    /** Read recorded edges without blocking
+     *
+     * @param edges The array to copy edges to
+     * @param count The size of the array
+     * @returns The number of edges copied, the oldest first
+     */
+    uint32_t read_edges(Edge *edges, uint32_t count);
+
+    /** Get the number of edges waiting to be read
+     *
+     * @returns The number of edges in the buffer
+     */
+    uint32_t available() const;
+
+    /** Get the number of edges dropped because the buffer was full
+     *
+     * @returns The number of edges dropped since the object was created
+     */
+    uint32_t dropped() const;
+
+    /** Deliver recorded edges in batches on an event queue
+     *
+     * The first edge recorded posts one event to the queue, after a delay
+     * if given, and the event passes all edges recorded by the time it runs
+     * to the callback. The edges are passed in place, so a batch which
+     * wraps around the end of the buffer takes two calls, and the space is
+     * only reused once the callback returns.
+     *
+     * @param queue    The queue to deliver on, or NULL to stop delivering
+     * @param callback The callback called with each batch of edges
+     * @param delay_ms The time to gather edges for after the first one of a
+     *                 batch, 0 to deliver as soon as the queue runs
+     *
+     * @note Call from the thread dispatching the queue, or while no event
+     *       is pending on it
+     */
+    void attach(events::EventQueue *queue, edges_callback_t callback, int delay_ms = 0);
+
+    using InterruptIn::read;
+    using InterruptIn::mode;
+    using InterruptIn::enable_irq;
+    using InterruptIn::disable_irq;
+    using InterruptIn::operator int;
+
+#if !defined(DOXYGEN_ONLY)
+private:
+    void record_edge(bool rise);
+    void record_rise();
+    void record_fall();
+    void post();
+    void deliver();
+
+    const ticker_data_t *const _ticker;
+    Edge *const _buffer;
+    const uint32_t _mask;
+    volatile uint32_t _head;
+    volatile uint32_t _tail;
+    volatile uint32_t _dropped;
+    volatile bool _posted;
+    volatile bool _delivering;
+    int _event_id;
+    events::EventQueue *_queue;
+    edges_callback_t _callback;
+    int _delay_ms;
+#endif //!defined(DOXYGEN_ONLY)
+};
+
+/** @}*/
+
+} // namespace mbed
+
+#endif
+
+#endif
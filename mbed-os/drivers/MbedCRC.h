@@ -39,6 +39,14 @@ but we check for ( width < 8) before performing shift, so it should not be an is
 #pragma diag_suppress=Pe062  // Shift count is negative
 #endif
 
+#ifndef MBED_CONF_DRIVERS_CRC_GENERATED_TABLES
+#define MBED_CONF_DRIVERS_CRC_GENERATED_TABLES 1
+#endif
+
+#ifndef MBED_CONF_DRIVERS_CRC_SLICES
+#define MBED_CONF_DRIVERS_CRC_SLICES 1
+#endif
+
 namespace mbed {
 /** \addtogroup drivers-public-api */
 /** @{*/
@@ -57,11 +65,13 @@ extern SingletonPtr<PlatformMutex> mbed_crc_mutex;
  *  can be used for computation, but custom ones can affect the performance.
  *
  *  First choice is the hardware mode. The supported polynomials are hardware specific, and
- *  you need to consult your MCU manual to discover them. Next, ROM polynomial tables
- *  are tried (you can find list of supported polynomials here ::crc_polynomial). If the selected
- *  configuration is supported, it will accelerate the software computations. If ROM tables
- *  are not available for the selected polynomial, then CRC is computed at run time bit by bit
- *  for all data input.
+ *  you need to consult your MCU manual to discover them. Otherwise software computations use
+ *  lookup tables generated at compile time for the polynomial. Reflected data is processed
+ *  with a reflected table, and reflected 32-bit CRCs can process several bytes per step
+ *  when `drivers.crc-slices` is 4 or 8. If `drivers.crc-generated-tables` is disabled, ROM
+ *  polynomial tables are tried (you can find list of supported polynomials here ::crc_polynomial),
+ *  and if they are not available for the selected polynomial, then CRC is computed at run time
+ *  bit by bit for all data input.
  *  @note Synchronization level: Thread safe
  *
  *  @tparam  polynomial CRC polynomial value in hex
@@ -257,7 +267,15 @@ public:
         }
 #endif
 
-        *crc = _initial_value;
+        // The reflected table works on a reflected register, and the normal
+        // table on a register aligned to the top of a byte
+        if (_reflected_table && POLY_32BIT_REV_ANSI != polynomial) {
+            *crc = reflect(_initial_value, width);
+        } else if (MBED_CONF_DRIVERS_CRC_GENERATED_TABLES && (width < 8) && (TABLE == _mode)) {
+            *crc = (_initial_value << (8 - width)) & get_crc_mask();
+        } else {
+            *crc = _initial_value;
+        }
         return 0;
     }
 
@@ -282,12 +300,18 @@ public:
         }
 #endif
         uint32_t p_crc = *crc;
-        if ((width < 8) && (NULL == _crc_table)) {
+        if ((width < 8) && (BITWISE == _mode)) {
             p_crc = (uint32_t)(p_crc << (8 - width));
         }
         // Optimized algorithm for 32BitANSI does not need additional reflect_remainder
         if ((TABLE == _mode) && (POLY_32BIT_REV_ANSI == polynomial)) {
             *crc = (p_crc ^ _final_xor) & get_crc_mask();
+        } else if (_reflected_table) {
+            // The register already holds the reflected remainder
+            if (!_reflect_remainder) {
+                p_crc = reflect(p_crc, width < 8 ? 8 : width);
+            }
+            *crc = (p_crc ^ _final_xor) & get_crc_mask();
         } else {
             *crc = (reflect_remainder(p_crc) ^ _final_xor) & get_crc_mask();
         }
@@ -321,6 +345,10 @@ private:
     bool _reflect_remainder;
     uint32_t *_crc_table;
     CrcMode _mode;
+    bool _reflected_table;
+
+    /* Slices of the reflected table, only used for 32-bit CRCs */
+    static const size_t _slices = (width == 32) ? MBED_CONF_DRIVERS_CRC_SLICES : 1;
 
     /** Acquire exclusive access to CRC hardware/software.
      */
@@ -372,6 +400,25 @@ private:
         return (width < 8 ? ((1u << 8) - 1) : (uint32_t)((uint64_t)(1ull << width) - 1));
     }
 
+    /** Reflect the lowest bits of a value.
+     *
+     * @param  data value to be reflected
+     * @param  nBits number of bits to reflect
+     * @return  Reflected value
+     */
+    static uint32_t reflect(uint32_t data, uint8_t nBits)
+    {
+        uint32_t reflection = 0x0;
+
+        for (uint8_t bit = 0; bit < nBits; ++bit) {
+            if (data & 0x01) {
+                reflection |= (1ul << ((nBits - 1) - bit));
+            }
+            data = (data >> 1);
+        }
+        return (reflection);
+    }
+
     /** Final value of CRC is reflected.
      *
      * @param  data final crc value, which should be reflected
@@ -380,16 +427,7 @@ private:
     uint32_t reflect_remainder(uint32_t data) const
     {
         if (_reflect_remainder) {
-            uint32_t reflection = 0x0;
-            uint8_t const nBits = (width < 8 ? 8 : width);
-
-            for (uint8_t bit = 0; bit < nBits; ++bit) {
-                if (data & 0x01) {
-                    reflection |= (1 << ((nBits - 1) - bit));
-                }
-                data = (data >> 1);
-            }
-            return (reflection);
+            return reflect(data, (width < 8 ? 8 : width));
         } else {
             return data;
         }
@@ -476,7 +514,16 @@ private:
         uint32_t p_crc = *crc;
         uint8_t data_byte = 0;
 
-        if (width <= 8) {
+        if (_reflected_table) {
+#if MBED_CONF_DRIVERS_CRC_GENERATED_TABLES
+            // POLY_32BIT_REV_ANSI is the reflected form of POLY_32BIT_ANSI
+            if (POLY_32BIT_REV_ANSI == polynomial) {
+                p_crc = internal::crc_reflected_table_compute<POLY_32BIT_ANSI, 32, _slices>(data, size, p_crc);
+            } else {
+                p_crc = internal::crc_reflected_table_compute<polynomial, width, _slices>(data, size, p_crc);
+            }
+#endif
+        } else if (width <= 8) {
             uint8_t *crc_table = (uint8_t *)_crc_table;
             for (crc_data_size_t byte = 0; byte < size; byte++) {
                 data_byte = reflect_bytes(data[byte]) ^ p_crc;
@@ -512,6 +559,7 @@ private:
     void mbed_crc_ctor(void)
     {
         MBED_STATIC_ASSERT(width <= 32, "Max 32-bit CRC supported");
+        _reflected_table = false;
 
 #if DEVICE_CRC
         if (POLY_32BIT_REV_ANSI != polynomial) {
@@ -530,6 +578,15 @@ private:
         }
 #endif
 
+#if MBED_CONF_DRIVERS_CRC_GENERATED_TABLES
+        if (POLY_32BIT_REV_ANSI == polynomial || _reflect_data) {
+            _crc_table = NULL;
+            _reflected_table = true;
+        } else {
+            _crc_table = (uint32_t *)internal::CrcTable<polynomial, width, false>::table;
+        }
+        _mode = TABLE;
+#else
         switch (polynomial) {
             case POLY_32BIT_ANSI:
                 _crc_table = (uint32_t *)Table_CRC_32bit_ANSI;
@@ -554,6 +611,7 @@ private:
                 break;
         }
         _mode = (_crc_table != NULL) ? TABLE : BITWISE;
+#endif
     }
 #endif
 };
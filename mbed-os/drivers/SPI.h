@@ -236,6 +236,169 @@ public:
       */
     void set_default_write_value(char data);
 
+    /** Phases of a transaction, run with the Slave Select line asserted once
+     *
+     * A command, address and dummy bytes are copied into the batch, and
+     * consecutive ones are sent as a single phase. Data phases refer to
+     * buffers which must stay valid until the batch has run. Frames are 8
+     * bits wide.
+     *
+     * Example of a flash read:
+     * @code
+     * SPI::Batch batch;
+     * batch.command(0x03).address(addr, 3).read(buffer, size);
+     * device.write(batch);
+     * @endcode
+     */
+    class Batch : private NonCopyable<Batch> {
+    public:
+        /** Largest number of phases in a batch */
+        static const int max_phases = 4;
+
+        /** Largest number of command, address and dummy bytes in a batch */
+        static const int max_inline = 16;
+
+        Batch()
+        {
+            clear();
+        }
+
+        /** Add a command byte
+         *
+         * @param command The byte to write
+         * @return this batch
+         */
+        Batch &command(uint8_t command)
+        {
+            return value(command, 1);
+        }
+
+        /** Add an address, most significant byte first
+         *
+         * @param address The address to write
+         * @param bytes   The length of the address in bytes (1 - 4)
+         * @return this batch
+         */
+        Batch &address(uint32_t address, int bytes)
+        {
+            return value(address, bytes);
+        }
+
+        /** Add dummy bytes
+         *
+         * @param count The number of bytes
+         * @param data  The byte written for each of them
+         * @return this batch
+         */
+        Batch &dummy(int count, char data = SPI_FILL_CHAR);
+
+        /** Add a phase writing data, ignoring the response
+         *
+         * @param data   The data to write
+         * @param length The length of the data in bytes
+         * @return this batch
+         */
+        Batch &write(const char *data, int length)
+        {
+            return add(data, NULL, length);
+        }
+
+        /** Add a phase reading data, writing the default write value
+         *
+         * @param data   The buffer for the data read
+         * @param length The length of the data in bytes
+         * @return this batch
+         */
+        Batch &read(char *data, int length)
+        {
+            return add(NULL, data, length);
+        }
+
+        /** Add a phase writing and reading data at once
+         *
+         * @param tx_data The data to write
+         * @param rx_data The buffer for the data read
+         * @param length  The length of both in bytes
+         * @return this batch
+         */
+        Batch &transfer(const char *tx_data, char *rx_data, int length)
+        {
+            return add(tx_data, rx_data, length);
+        }
+
+        /** Remove all phases */
+        void clear()
+        {
+            _count = 0;
+            _inline_used = 0;
+            _length = 0;
+            _valid = true;
+            _last_inline = false;
+        }
+
+        /** Get the number of phases
+         *
+         * @return the number of phases
+         */
+        int phases() const
+        {
+            return _count;
+        }
+
+        /** Get the number of bytes written and read by all phases
+         *
+         * @return the length of the batch in bytes
+         */
+        int length() const
+        {
+            return _length;
+        }
+
+        /** Check that all phases fitted in the batch
+         *
+         * @return false if max_phases or max_inline was exceeded
+         */
+        bool valid() const
+        {
+            return _valid;
+        }
+
+#if !defined(DOXYGEN_ONLY)
+    private:
+        friend class SPI;
+
+        struct phase_t {
+            const char *tx_buffer;
+            char *rx_buffer;
+            int length;
+        };
+
+        Batch &value(uint32_t value, int bytes);
+        Batch &add(const char *tx_buffer, char *rx_buffer, int length);
+        char *add_inline(int length);
+
+        phase_t _phases[max_phases];
+        char _inline[max_inline];
+        int _count;
+        int _inline_used;
+        int _length;
+        bool _valid;
+        bool _last_inline;
+#endif // !defined(DOXYGEN_ONLY)
+    };
+
+    /** Run the phases of a batch with exclusive access to the bus
+     *
+     * The bus is acquired and the Slave Select line is asserted once for
+     * the whole batch, instead of for each write.
+     *
+     * @param batch The batch to run
+     * @return
+     *     The number of bytes written and read by the batch, or -1 if the
+     *     batch is not valid.
+     */
+    int write(const Batch &batch);
+
 #if DEVICE_SPI_ASYNCH
 
     /** Start non-blocking SPI transfer using 8bit buffers.
@@ -265,6 +428,23 @@ public:
         return 0;
     }
 
+    /** Start non-blocking transfer of the phases of a batch.
+     *
+     * The Slave Select line stays asserted from the first phase to the last,
+     * and the callback is called once, when the batch completes or fails.
+     * SPI_EVENT_COMPLETE is reported even if not in the event mask. Like
+     * other transfers, the batch is queued if the peripheral is busy.
+     *
+     * @param batch    The batch, which must stay valid until the callback is called.
+     * @param callback The event callback function.
+     * @param event    The event mask of events to modify. @see spi_api.h for SPI events.
+     *
+     * @return Operation result.
+     * @retval 0 If the transfer has started or was queued.
+     * @retval -1 If the batch is empty or not valid, or the queue is full.
+     */
+    int transfer(const Batch &batch, const event_callback_t &callback, int event = SPI_EVENT_COMPLETE);
+
     /** Abort the on-going SPI transfer, and continue with transfers in the queue, if any.
      */
     void abort_transfer();
@@ -344,6 +524,18 @@ protected:
      */
     void start_transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length, unsigned char bit_width, const event_callback_t &callback, int event);
 
+    /** Start the first phase of a batch.
+     *
+     * @param batch    The batch to transfer.
+     * @param callback The event callback function.
+     * @param event    The event mask of events to modify.
+     */
+    void start_batch(const Batch *batch, const event_callback_t &callback, int event);
+
+    /** Start the phase of the on-going batch given by _batch_phase.
+     */
+    void start_batch_phase();
+
 private:
     /** Lock deep sleep only if it is not yet locked */
     void lock_deep_sleep();
@@ -416,6 +608,12 @@ protected:
     DMAUsage _usage;
     /* Current sate of the sleep manager */
     bool _deep_sleep_locked;
+    /* Batch being transferred, if any */
+    const Batch *_batch;
+    /* Phase of the batch being transferred */
+    int _batch_phase;
+    /* Event mask of the batch */
+    int _batch_event;
 #endif // DEVICE_SPI_ASYNCH
 
     // Configuration.
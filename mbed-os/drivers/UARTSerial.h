@@ -37,6 +37,24 @@
 #define MBED_CONF_DRIVERS_UART_SERIAL_TXBUF_SIZE  256
 #endif
 
+#ifndef MBED_CONF_DRIVERS_UART_SERIAL_ASYNC
+#define MBED_CONF_DRIVERS_UART_SERIAL_ASYNC 0
+#endif
+
+#ifndef MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE
+#define MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE  64
+#endif
+
+#ifndef MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_RX_POLL_US
+#define MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_RX_POLL_US  1000
+#endif
+
+#define UARTSERIAL_ASYNC (DEVICE_SERIAL_ASYNCH && MBED_CONF_DRIVERS_UART_SERIAL_ASYNC)
+
+#if UARTSERIAL_ASYNC
+#include "drivers/Ticker.h"
+#endif
+
 namespace mbed {
 /**
  * \defgroup drivers_UARTSerial UARTSerial class
@@ -225,6 +243,25 @@ public:
      */
     void set_baud(int baud);
 
+#if UARTSERIAL_ASYNC || defined(DOXYGEN_ONLY)
+    /** Move data with the asynchronous serial API instead of one interrupt per character
+     *
+     *  Data is transferred in chunks of `drivers.uart-serial-async-chunk-size` bytes,
+     *  receiving into two buffers in turn so reception restarts as soon as a chunk
+     *  completes. A partly filled chunk is delivered once the line has been idle for
+     *  a period of `drivers.uart-serial-async-rx-poll-us`, which relies on the target
+     *  updating the receive position of the transfer as characters arrive.
+     *
+     *  Only available if the target supports asynchronous serial and
+     *  `drivers.uart-serial-async` is enabled.
+     *
+     *  @param usage   DMA_USAGE_NEVER to handle each character in an interrupt (the default),
+     *                 or the DMA usage for asynchronous transfers
+     *  @return        0 on success, negative error code on failure
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
     // Expose private SerialBase::Parity as UARTSerial::Parity
     using SerialBase::Parity;
     // In C++11, we wouldn't need to also have using directives for each value
@@ -283,6 +320,17 @@ private:
     void update_tx_irq();
     void disable_tx_irq();
 
+#if UARTSERIAL_ASYNC
+    void start_rx_async(size_t pending);
+    void stop_rx_async();
+    void push_rx_async(const uint8_t *data, size_t length);
+    void rx_async_done(int event);
+    void rx_async_poll();
+    void start_tx_async();
+    void tx_async_done(int event);
+    void wait_tx_async();
+#endif
+
     /** Software serial buffers
      *  By default buffer size is 256 for TX and 256 for RX. Configurable through mbed_app.json
      */
@@ -298,6 +346,19 @@ private:
     bool _rx_irq_enabled;
     InterruptIn *_dcd_irq;
 
+#if UARTSERIAL_ASYNC
+    bool _async;
+    bool _rx_async_active;
+    bool _tx_async_active;
+    bool _tx_async_hold;
+    uint8_t _rx_chunk_index;
+    size_t _rx_last_pos;
+    size_t _tx_chunk_length;
+    uint8_t _rx_chunk[2][MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE];
+    uint8_t _tx_chunk[MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE];
+    Ticker _rx_poll;
+#endif
+
     /** Device Hanged up
      *  Determines if the device hanged up on us.
      *
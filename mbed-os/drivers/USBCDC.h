@@ -132,6 +132,64 @@ public:
      */
     void receive_nb(uint8_t *buffer, uint32_t size, uint32_t *actual);
 
+    /**
+     * Set the buffers used to stream data without copying it
+     *
+     * Each buffer is split in two halves, so the application fills or
+     * drains one half while the other is on the bus. Data goes between the
+     * halves and the bulk endpoints directly, as transfers of several
+     * packets. A buffer of NULL stops streaming in that direction.
+     *
+     * Once a receive buffer is set, data is no longer returned by receive()
+     * or receive_nb() but by receive_acquire().
+     *
+     * @param tx_buffer buffer for data sent, or NULL
+     * @param tx_size size of tx_buffer, a multiple of 128 bytes
+     * @param rx_buffer buffer for data received, or NULL
+     * @param rx_size size of rx_buffer, a multiple of 128 bytes
+     * @returns true if successful, false if a streamed transfer is being sent
+     */
+    bool set_stream_buffers(uint8_t *tx_buffer, uint32_t tx_size, uint8_t *rx_buffer, uint32_t rx_size);
+
+    /**
+     * Get a free half of the send stream buffer to fill
+     *
+     * Calling this again before send_commit() returns the same half.
+     *
+     * @param size a pointer to where to store the size of the half
+     * @returns the half to fill, or NULL if both are waiting to be sent or
+     *   the terminal is not connected
+     */
+    uint8_t *send_acquire(uint32_t *size);
+
+    /**
+     * Send data written to the half returned by send_acquire()
+     *
+     * The data is sent as one transfer, ended by a short packet or by a zero
+     * length packet when its size is a multiple of the packet size. data_tx()
+     * is called once the half is free again.
+     *
+     * @param size number of bytes written, 0 to give the half back unsent
+     * @returns true if successful, false if the terminal is not connected
+     */
+    bool send_commit(uint32_t size);
+
+    /**
+     * Get the oldest transfer received in the receive stream buffer
+     *
+     * A transfer ends with a short packet or when a half is full. data_rx()
+     * is called when one has been received.
+     *
+     * @param size a pointer to where to store the number of bytes received
+     * @returns the data received, or NULL if there is none
+     */
+    uint8_t *receive_acquire(uint32_t *size);
+
+    /**
+     * Give the data returned by receive_acquire() back for reception
+     */
+    void receive_release();
+
 protected:
     /*
     * Get device descriptor. Warning: this method has to store the length of the report descriptor in reportLength.
@@ -206,6 +264,9 @@ protected:
     void _receive_isr_start();
     void _receive_isr();
 
+    void _send_stream_start();
+    void _stream_reset();
+
     usb_ep_t _bulk_in;
     usb_ep_t _bulk_out;
     usb_ep_t _int_in;
@@ -228,6 +289,25 @@ protected:
     uint8_t _rx_buffer[64];
     uint8_t *_rx_buf;
     uint32_t _rx_size;
+
+    // Send stream: halves are acquired, committed then sent in turn
+    uint8_t *_tx_stream_buf;
+    uint32_t _tx_stream_half;
+    uint32_t _tx_stream_size[2];
+    uint8_t _tx_stream_acquire;
+    uint8_t _tx_stream_send;
+    uint32_t _tx_stream_sent;
+    uint32_t _tx_stream_packet;
+    bool _tx_stream_sending;
+
+    // Receive stream: halves are filled then acquired in turn
+    uint8_t *_rx_stream_buf;
+    uint32_t _rx_stream_half;
+    uint32_t _rx_stream_size[2];
+    bool _rx_stream_full[2];
+    uint8_t _rx_stream_fill;
+    uint8_t _rx_stream_acquire;
+    bool _rx_stream_reading;
 };
 
 /** @}*/
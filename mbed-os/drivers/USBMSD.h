@@ -236,12 +236,23 @@ private:
     // length of a reading or writing
     uint32_t _length;
 
-    // memory OK (after a memoryVerify)
+    // memory OK (after a memoryVerify or memoryWrite)
     bool _mem_ok;
 
-    // cache in RAM before writing in memory. Useful also to read a block.
+    // cache in RAM of consecutive blocks. Sequential reads are read ahead
+    // into it and the blocks of a write are gathered in it.
     uint8_t *_page;
 
+    // number of blocks _page can hold
+    uint32_t _page_blocks;
+
+    // first block held in _page, and number of blocks held
+    uint32_t _cache_block;
+    uint32_t _cache_count;
+
+    // blocks held in _page still have to be written to the block device
+    bool _cache_dirty;
+
     int _block_size;
     uint64_t _memory_size;
     uint64_t _block_count;
@@ -307,6 +318,9 @@ private:
     bool requestSense(void);
     void memoryVerify(uint8_t *buf, uint16_t size);
     void memoryWrite(uint8_t *buf, uint16_t size);
+    uint8_t *cacheRead(uint32_t block);
+    void cacheStartWrite(void);
+    bool cacheFlush(void);
     void msd_reset();
     void fail();
 };
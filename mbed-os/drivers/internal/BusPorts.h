@@ -0,0 +1,123 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_BUS_PORTS_H
+#define MBED_BUS_PORTS_H
+
+#include "platform/platform.h"
+
+#if DEVICE_PORTIN || DEVICE_PORTOUT
+
+#include <stdint.h>
+#include "hal/port_api.h"
+#include "platform/NonCopyable.h"
+
+#ifndef MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+#define MBED_CONF_DRIVERS_BUS_PORT_ACCESS 1
+#endif
+
+namespace mbed {
+/** \addtogroup drivers-internal-api
+ * @{
+ */
+
+namespace internal {
+
+/** Pins of a bus grouped by GPIO port
+ *
+ * Lets BusIn, BusOut and BusInOut read and write all pins on a port with
+ * one HAL call, so the pins of a port change together. Bus bits are moved
+ * to their port bits with a shift when their order is preserved, and one
+ * bit at a time otherwise.
+ */
+class BusPorts : private NonCopyable<BusPorts> {
+public:
+    /** Largest number of ports a bus can span and use port access */
+    static const int max_ports = 4;
+
+    BusPorts() : _count(0)
+    {
+    }
+
+    /** Group the pins of a bus by port and initialize the ports
+     *
+     * @param pins      pins of the bus, NC for unused bits
+     * @param direction direction to initialize the ports with
+     * @return true if port access can be used, false if the port of a pin
+     *         is not known or the pins span more than max_ports ports
+     */
+    bool init(const PinName pins[16], PinDirection direction);
+
+    /** Whether init() succeeded and port access is used
+     *
+     * @return true if port access is used
+     */
+    bool enabled() const
+    {
+        return _count != 0;
+    }
+
+    /** Write a bus value, one port at a time
+     *
+     * @param value value with bit n for pin n of the bus
+     */
+    void write(int value);
+
+    /** Read a bus value, one port at a time
+     *
+     * @return value with bit n for pin n of the bus
+     */
+    int read();
+
+    /** Set the direction of every port
+     *
+     * @param direction the new direction
+     */
+    void dir(PinDirection direction);
+
+    /** Set the input mode of every port
+     *
+     * @param pull the new mode
+     */
+    void mode(PinMode pull);
+
+private:
+    struct Port {
+        port_t port;
+        uint32_t port_mask;
+        uint16_t bus_mask;
+        int8_t shift;       // port bit minus bus bit, when the same for all pins
+        bool shifted;       // whether shift can be used to convert values
+    };
+
+    uint32_t to_port(const Port &port, int value) const;
+    int from_port(const Port &port, uint32_t value) const;
+
+    Port _ports[max_ports];
+    int8_t _port_bit[16];
+    uint8_t _count;
+};
+
+} // namespace internal
+
+/** @}*/
+
+} // namespace mbed
+
+#endif
+
+#endif
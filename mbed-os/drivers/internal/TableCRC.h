@@ -19,6 +19,7 @@
 #define TABLE_CRC_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 namespace mbed {
 /** \addtogroup drivers-internal-api
@@ -35,6 +36,151 @@ extern const uint16_t Table_CRC_16bit_IBM[MBED_CRC_TABLE_SIZE];
 extern const uint32_t Table_CRC_32bit_ANSI[MBED_CRC_TABLE_SIZE];
 extern const uint32_t Table_CRC_32bit_Rev_ANSI[MBED_OPTIMIZED_CRC_TABLE_SIZE];
 
+namespace internal {
+
+/* Compile time generation of CRC lookup tables.
+ *
+ * A table can be generated for any polynomial and width. Normal tables process
+ * the most significant bit first, with CRCs narrower than 8 bits held in the
+ * top of a byte, which is the layout of the ROM tables above. Reflected tables
+ * process the least significant bit first, so reflected data needs no per-byte
+ * reflection. A table with several slices holds the extra tables used to
+ * process 4 or 8 bytes per step.
+ */
+
+template <size_t... I>
+struct crc_index_list {
+    typedef crc_index_list<I..., (sizeof...(I) + I)...> doubled;
+};
+
+/* Indices [0 : N), N being a power of two */
+template <size_t N>
+struct crc_make_index_list {
+    typedef typename crc_make_index_list<N / 2>::type::doubled type;
+};
+
+template <>
+struct crc_make_index_list<1> {
+    typedef crc_index_list<0> type;
+};
+
+template <uint8_t width, bool narrow = (width <= 8), bool medium = (width <= 16)>
+struct crc_table_type {
+    typedef uint32_t type;
+};
+
+template <uint8_t width, bool medium>
+struct crc_table_type<width, true, medium> {
+    typedef uint8_t type;
+};
+
+template <uint8_t width>
+struct crc_table_type<width, false, true> {
+    typedef uint16_t type;
+};
+
+constexpr uint32_t crc_reflect(uint32_t data, uint8_t bits)
+{
+    return bits == 0 ? 0 : (((data & 1) << (bits - 1)) | crc_reflect(data >> 1, bits - 1));
+}
+
+constexpr uint8_t crc_register_width(uint8_t width)
+{
+    return width < 8 ? 8 : width;
+}
+
+constexpr uint32_t crc_register_mask(uint8_t width)
+{
+    return (uint32_t)((1ull << crc_register_width(width)) - 1);
+}
+
+/* Polynomial as it is applied to the register */
+constexpr uint32_t crc_register_polynomial(uint32_t polynomial, uint8_t width, bool reflected)
+{
+    return reflected ? crc_reflect(polynomial, width) : (polynomial << (crc_register_width(width) - width));
+}
+
+constexpr uint32_t crc_bits(uint32_t poly, uint8_t width, bool reflected, uint32_t crc, uint8_t bits)
+{
+    return bits == 0 ? crc :
+           crc_bits(poly, width, reflected,
+                    reflected ? ((crc & 1) ? ((crc >> 1) ^ poly) : (crc >> 1)) :
+                    (((crc >> (crc_register_width(width) - 1)) & 1) ? ((crc << 1) ^ poly) : (crc << 1)) & crc_register_mask(width),
+                    bits - 1);
+}
+
+constexpr uint32_t crc_table_entry(uint32_t poly, uint8_t width, bool reflected, uint32_t index)
+{
+    return reflected ? crc_bits(poly, width, true, index, 8) :
+           crc_bits(poly, width, false, index << (crc_register_width(width) - 8), 8);
+}
+
+/* Entry of a further slice: the previous slice's entry followed by a zero byte */
+constexpr uint32_t crc_slice_entry(uint32_t poly, uint8_t width, bool reflected, uint32_t value, size_t slice)
+{
+    return slice == 0 ? value :
+           crc_slice_entry(poly, width, reflected,
+                           reflected ? ((value >> 8) ^ crc_table_entry(poly, width, true, value & 0xFF)) :
+                           (((value << 8) & crc_register_mask(width)) ^
+                            crc_table_entry(poly, width, false, value >> (crc_register_width(width) - 8))),
+                           slice - 1);
+}
+
+template <uint32_t polynomial, uint8_t width, bool reflected, size_t slices = 1,
+          typename Indices = typename crc_make_index_list<slices * 256>::type>
+struct CrcTable;
+
+template <uint32_t polynomial, uint8_t width, bool reflected, size_t slices, size_t... I>
+struct CrcTable<polynomial, width, reflected, slices, crc_index_list<I...> > {
+    typedef typename crc_table_type<width>::type value_type;
+
+    static constexpr uint32_t register_polynomial = crc_register_polynomial(polynomial, width, reflected);
+
+    /* Slice n of the table starts at entry n * 256 */
+    static constexpr value_type table[slices * 256] = {
+        (value_type)crc_slice_entry(register_polynomial, width, reflected,
+                                    crc_table_entry(register_polynomial, width, reflected, I % 256), I / 256)...
+    };
+};
+
+template <uint32_t polynomial, uint8_t width, bool reflected, size_t slices, size_t... I>
+constexpr typename CrcTable<polynomial, width, reflected, slices, crc_index_list<I...> >::value_type
+CrcTable<polynomial, width, reflected, slices, crc_index_list<I...> >::table[slices * 256];
+
+/* Process data with a reflected table, least significant bit first.
+ *
+ * With 4 or 8 slices, 32-bit CRCs are computed 4 or 8 bytes per step.
+ */
+template <uint32_t polynomial, uint8_t width, size_t slices>
+uint32_t crc_reflected_table_compute(const uint8_t *data, uint64_t size, uint32_t crc)
+{
+    typedef CrcTable<polynomial, width, true, slices> Table;
+    const typename Table::value_type *table = Table::table;
+
+    if (width == 32 && slices >= 4) {
+        while (size >= slices) {
+            crc ^= (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+            uint32_t next = 0;
+            if (slices == 8) {
+                next = table[3 * 256 + data[4]] ^ table[2 * 256 + data[5]] ^
+                       table[1 * 256 + data[6]] ^ table[0 * 256 + data[7]];
+            }
+            crc = next ^
+                  table[(slices - 1) * 256 + (crc & 0xFF)] ^ table[(slices - 2) * 256 + ((crc >> 8) & 0xFF)] ^
+                  table[(slices - 3) * 256 + ((crc >> 16) & 0xFF)] ^ table[(slices - 4) * 256 + (crc >> 24)];
+            data += slices;
+            size -= slices;
+        }
+    }
+
+    while (size--) {
+        crc = table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+} // namespace internal
+
 /** @}*/
 
 } // namespace mbed
@@ -0,0 +1,172 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drivers/AnalogInSampler.h"
+
+#if DEVICE_ANALOGIN
+
+#include "platform/mbed_critical.h"
+#include "platform/mbed_thread.h"
+
+namespace mbed {
+
+AnalogInSampler::AnalogInSampler(PinName pin) :
+    AnalogIn(pin),
+    _buffer(NULL),
+    _count(0),
+    _index(0),
+    _circular(false),
+    _hardware(false),
+    _active(false)
+{
+}
+
+AnalogInSampler::AnalogInSampler(const PinMap &pinmap) :
+    AnalogIn(pinmap),
+    _buffer(NULL),
+    _count(0),
+    _index(0),
+    _circular(false),
+    _hardware(false),
+    _active(false)
+{
+}
+
+AnalogInSampler::~AnalogInSampler()
+{
+    stop();
+}
+
+int AnalogInSampler::sample(uint16_t *buffer, size_t count, uint32_t period_us, sample_callback_t callback)
+{
+    return start(buffer, count, period_us, callback, false);
+}
+
+int AnalogInSampler::sample_continuous(uint16_t *buffer, size_t count, uint32_t period_us, sample_callback_t callback)
+{
+    if (count % 2 != 0) {
+        return -1;
+    }
+    return start(buffer, count, period_us, callback, true);
+}
+
+int AnalogInSampler::start(uint16_t *buffer, size_t count, uint32_t period_us, sample_callback_t callback, bool circular)
+{
+    if (buffer == NULL || count == 0 || period_us == 0 || !callback) {
+        return -1;
+    }
+
+    // Let a read in progress finish, unless restarted from a callback where the mutex can't be used
+    bool locked = !core_util_is_isr_active();
+    if (locked) {
+        AnalogIn::lock();
+    }
+
+    // A critical section rather than the mutex, as stop() may be called from the callback
+    core_util_critical_section_enter();
+    if (_active) {
+        core_util_critical_section_exit();
+        if (locked) {
+            AnalogIn::unlock();
+        }
+        return -1;
+    }
+
+    _callback = callback;
+    _buffer = buffer;
+    _count = count;
+    _index = 0;
+    _circular = circular;
+    _active = true;
+
+    _hardware = analogin_sample_start(&_adc, buffer, count, period_us, circular, &AnalogInSampler::sample_handler, this);
+    if (!_hardware) {
+        _ticker.attach_us(Callback<void()>(this, &AnalogInSampler::sample_tick), period_us);
+    }
+    core_util_critical_section_exit();
+
+    if (locked) {
+        AnalogIn::unlock();
+    }
+    return 0;
+}
+
+void AnalogInSampler::stop()
+{
+    core_util_critical_section_enter();
+    if (_active) {
+        stop_sampling();
+    }
+    core_util_critical_section_exit();
+}
+
+void AnalogInSampler::lock()
+{
+    AnalogIn::lock();
+    while (_active) {
+        AnalogIn::unlock();
+        thread_sleep_for(1);
+        AnalogIn::lock();
+    }
+}
+
+void AnalogInSampler::stop_sampling()
+{
+    if (_hardware) {
+        analogin_sample_stop(&_adc);
+    } else {
+        _ticker.detach();
+    }
+    _active = false;
+}
+
+void AnalogInSampler::sample_tick()
+{
+    // No lock, as interrupts of this ticker are the only users of the ADC while sampling
+    _buffer[_index++] = analogin_read_u16(&_adc);
+
+    if (!_circular) {
+        if (_index == _count) {
+            stop_sampling();
+            _callback(_buffer, _count);
+        }
+        return;
+    }
+
+    size_t half = _count / 2;
+    if (_index == half) {
+        _callback(_buffer, half);
+    } else if (_index == _count) {
+        _index = 0;
+        _callback(_buffer + half, half);
+    }
+}
+
+void AnalogInSampler::sample_handler(void *context, uint16_t *samples, size_t count)
+{
+    AnalogInSampler *sampler = static_cast<AnalogInSampler *>(context);
+
+    if (!sampler->_circular) {
+        // The target stops once the buffer is full
+        sampler->_active = false;
+    }
+    sampler->_callback(samples, count);
+}
+
+} // namespace mbed
+
+#endif
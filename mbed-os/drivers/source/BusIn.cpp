@@ -31,6 +31,9 @@ BusIn::BusIn(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, PinName
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTIN && MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+    _ports.init(pins, PIN_INPUT);
+#endif
 }
 
 BusIn::BusIn(PinName pins[16])
@@ -43,6 +46,9 @@ BusIn::BusIn(PinName pins[16])
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTIN && MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+    _ports.init(pins, PIN_INPUT);
+#endif
 }
 
 BusIn::~BusIn()
@@ -59,9 +65,16 @@ int BusIn::read()
 {
     int v = 0;
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            v |= _pin[i]->read() << i;
+#if DEVICE_PORTIN
+    if (_ports.enabled()) {
+        v = _ports.read();
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                v |= _pin[i]->read() << i;
+            }
         }
     }
     unlock();
@@ -71,9 +84,16 @@ int BusIn::read()
 void BusIn::mode(PinMode pull)
 {
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->mode(pull);
+#if DEVICE_PORTIN
+    if (_ports.enabled()) {
+        _ports.mode(pull);
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                _pin[i]->mode(pull);
+            }
         }
     }
     unlock();
@@ -31,6 +31,9 @@ BusInOut::BusInOut(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, P
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTINOUT && MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+    _ports.init(pins, PIN_INPUT);
+#endif
 }
 
 BusInOut::BusInOut(PinName pins[16])
@@ -43,6 +46,9 @@ BusInOut::BusInOut(PinName pins[16])
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTINOUT && MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+    _ports.init(pins, PIN_INPUT);
+#endif
 }
 
 BusInOut::~BusInOut()
@@ -58,9 +64,16 @@ BusInOut::~BusInOut()
 void BusInOut::write(int value)
 {
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->write((value >> i) & 1);
+#if DEVICE_PORTINOUT
+    if (_ports.enabled()) {
+        _ports.write(value);
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                _pin[i]->write((value >> i) & 1);
+            }
         }
     }
     unlock();
@@ -70,9 +83,16 @@ int BusInOut::read()
 {
     lock();
     int v = 0;
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            v |= _pin[i]->read() << i;
+#if DEVICE_PORTINOUT
+    if (_ports.enabled()) {
+        v = _ports.read();
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                v |= _pin[i]->read() << i;
+            }
         }
     }
     unlock();
@@ -82,9 +102,16 @@ int BusInOut::read()
 void BusInOut::output()
 {
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->output();
+#if DEVICE_PORTINOUT
+    if (_ports.enabled()) {
+        _ports.dir(PIN_OUTPUT);
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                _pin[i]->output();
+            }
         }
     }
     unlock();
@@ -93,9 +120,16 @@ void BusInOut::output()
 void BusInOut::input()
 {
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->input();
+#if DEVICE_PORTINOUT
+    if (_ports.enabled()) {
+        _ports.dir(PIN_INPUT);
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                _pin[i]->input();
+            }
         }
     }
     unlock();
@@ -104,9 +138,16 @@ void BusInOut::input()
 void BusInOut::mode(PinMode pull)
 {
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->mode(pull);
+#if DEVICE_PORTINOUT
+    if (_ports.enabled()) {
+        _ports.mode(pull);
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                _pin[i]->mode(pull);
+            }
         }
     }
     unlock();
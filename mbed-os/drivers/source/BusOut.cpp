@@ -31,6 +31,9 @@ BusOut::BusOut(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, PinNa
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTOUT && MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+    _ports.init(pins, PIN_OUTPUT);
+#endif
 }
 
 BusOut::BusOut(PinName pins[16])
@@ -43,6 +46,9 @@ BusOut::BusOut(PinName pins[16])
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTOUT && MBED_CONF_DRIVERS_BUS_PORT_ACCESS
+    _ports.init(pins, PIN_OUTPUT);
+#endif
 }
 
 BusOut::~BusOut()
@@ -58,9 +64,16 @@ BusOut::~BusOut()
 void BusOut::write(int value)
 {
     lock();
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            _pin[i]->write((value >> i) & 1);
+#if DEVICE_PORTOUT
+    if (_ports.enabled()) {
+        _ports.write(value);
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                _pin[i]->write((value >> i) & 1);
+            }
         }
     }
     unlock();
@@ -70,9 +83,16 @@ int BusOut::read()
 {
     lock();
     int v = 0;
-    for (int i = 0; i < 16; i++) {
-        if (_pin[i] != 0) {
-            v |= _pin[i]->read() << i;
+#if DEVICE_PORTOUT
+    if (_ports.enabled()) {
+        v = _ports.read();
+    } else
+#endif
+    {
+        for (int i = 0; i < 16; i++) {
+            if (_pin[i] != 0) {
+                v |= _pin[i]->read() << i;
+            }
         }
     }
     unlock();
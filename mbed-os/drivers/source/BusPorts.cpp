@@ -0,0 +1,141 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "drivers/internal/BusPorts.h"
+
+#if DEVICE_PORTIN || DEVICE_PORTOUT
+
+namespace mbed {
+namespace internal {
+
+bool BusPorts::init(const PinName pins[16], PinDirection direction)
+{
+    PortName names[max_ports];
+
+    _count = 0;
+    for (int i = 0; i < 16; i++) {
+        if (pins[i] == NC) {
+            continue;
+        }
+
+        PortName name;
+        int pin_n;
+        if (!port_pin_lookup(pins[i], &name, &pin_n) || pin_n < 0 || pin_n > 31) {
+            _count = 0;
+            return false;
+        }
+
+        int p = 0;
+        while (p < _count && names[p] != name) {
+            p++;
+        }
+        if (p == _count) {
+            if (_count == max_ports) {
+                _count = 0;
+                return false;
+            }
+            names[p] = name;
+            _ports[p].port_mask = 0;
+            _ports[p].bus_mask = 0;
+            _ports[p].shift = pin_n - i;
+            _ports[p].shifted = true;
+            _count++;
+        }
+
+        Port &port = _ports[p];
+        port.port_mask |= 1UL << pin_n;
+        port.bus_mask |= 1U << i;
+        if (pin_n - i != port.shift) {
+            port.shifted = false;
+        }
+        _port_bit[i] = pin_n;
+    }
+
+    for (int p = 0; p < _count; p++) {
+        port_init(&_ports[p].port, names[p], _ports[p].port_mask, direction);
+    }
+
+    return _count != 0;
+}
+
+uint32_t BusPorts::to_port(const Port &port, int value) const
+{
+    uint32_t bits = value & port.bus_mask;
+
+    if (port.shifted) {
+        return port.shift >= 0 ? bits << port.shift : bits >> -port.shift;
+    }
+
+    uint32_t port_value = 0;
+    for (int i = 0; bits != 0; i++, bits >>= 1) {
+        if (bits & 1) {
+            port_value |= 1UL << _port_bit[i];
+        }
+    }
+    return port_value;
+}
+
+int BusPorts::from_port(const Port &port, uint32_t value) const
+{
+    value &= port.port_mask;
+
+    if (port.shifted) {
+        return port.shift >= 0 ? value >> port.shift : value << -port.shift;
+    }
+
+    int bus_value = 0;
+    for (int i = 0; i < 16; i++) {
+        if ((port.bus_mask & (1U << i)) && (value & (1UL << _port_bit[i]))) {
+            bus_value |= 1 << i;
+        }
+    }
+    return bus_value;
+}
+
+void BusPorts::write(int value)
+{
+    for (int p = 0; p < _count; p++) {
+        port_write(&_ports[p].port, to_port(_ports[p], value));
+    }
+}
+
+int BusPorts::read()
+{
+    int value = 0;
+    for (int p = 0; p < _count; p++) {
+        value |= from_port(_ports[p], port_read(&_ports[p].port));
+    }
+    return value;
+}
+
+void BusPorts::dir(PinDirection direction)
+{
+    for (int p = 0; p < _count; p++) {
+        port_dir(&_ports[p].port, direction);
+    }
+}
+
+void BusPorts::mode(PinMode pull)
+{
+    for (int p = 0; p < _count; p++) {
+        port_mode(&_ports[p].port, pull);
+    }
+}
+
+} // namespace internal
+} // namespace mbed
+
+#endif
@@ -22,6 +22,7 @@
 #if DEVICE_I2C
 
 #if DEVICE_I2C_ASYNCH
+#include "platform/mbed_critical.h"
 #include "platform/mbed_power_mgmt.h"
 #endif
 
@@ -29,10 +30,14 @@ namespace mbed {
 
 I2C *I2C::_owner = NULL;
 SingletonPtr<PlatformMutex> I2C::_mutex;
+#if DEVICE_I2C_ASYNCH && MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+int I2C::_lock_count = 0;
+I2C *I2C::_deferred = NULL;
+#endif
 
 I2C::I2C(PinName sda, PinName scl) :
 #if DEVICE_I2C_ASYNCH
-    _irq(this), _usage(DMA_USAGE_NEVER), _deep_sleep_locked(false),
+    _irq(this), _usage(DMA_USAGE_NEVER), _deep_sleep_locked(false), _message_index(0), _message_step(0),
 #endif
     _i2c(), _hz(100000)
 {
@@ -44,12 +49,18 @@ I2C::I2C(PinName sda, PinName scl) :
     i2c_init(&_i2c, _sda, _scl);
     // Used to avoid unnecessary frequency updates
     _owner = this;
+#if DEVICE_I2C_ASYNCH
+    _messages.messages = NULL;
+#if MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+    _deferred_next = NULL;
+#endif
+#endif
     unlock();
 }
 
 I2C::I2C(const i2c_pinmap_t &static_pinmap) :
 #if DEVICE_I2C_ASYNCH
-    _irq(this), _usage(DMA_USAGE_NEVER), _deep_sleep_locked(false),
+    _irq(this), _usage(DMA_USAGE_NEVER), _deep_sleep_locked(false), _message_index(0), _message_step(0),
 #endif
     _i2c(), _hz(100000)
 {
@@ -61,6 +72,12 @@ I2C::I2C(const i2c_pinmap_t &static_pinmap) :
     i2c_init_direct(&_i2c, &static_pinmap);
     // Used to avoid unnecessary frequency updates
     _owner = this;
+#if DEVICE_I2C_ASYNCH
+    _messages.messages = NULL;
+#if MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+    _deferred_next = NULL;
+#endif
+#endif
     unlock();
 }
 
@@ -134,6 +151,33 @@ int I2C::read(int ack)
     return ret;
 }
 
+int I2C::transfer(const message_t *messages, int count)
+{
+    lock();
+    aquire();
+
+    int done;
+    for (done = 0; done < count; done++) {
+        const message_t &message = messages[done];
+        int stop = (done + 1 == count) ? 1 : 0;
+        int length;
+        if (message.read) {
+            length = i2c_read(&_i2c, message.address, message.data, message.length, stop);
+        } else {
+            length = i2c_write(&_i2c, message.address, message.data, message.length, stop);
+        }
+        if (length != message.length) {
+            if (!stop) {
+                i2c_stop(&_i2c);
+            }
+            break;
+        }
+    }
+
+    unlock();
+    return done;
+}
+
 void I2C::start(void)
 {
     lock();
@@ -151,10 +195,23 @@ void I2C::stop(void)
 void I2C::lock()
 {
     _mutex->lock();
+#if DEVICE_I2C_ASYNCH && MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+    core_util_critical_section_enter();
+    _lock_count++;
+    core_util_critical_section_exit();
+#endif
 }
 
 void I2C::unlock()
 {
+#if DEVICE_I2C_ASYNCH && MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+    // The transfer interrupt must not defer a start between the two
+    core_util_critical_section_enter();
+    if (--_lock_count == 0) {
+        start_deferred();
+    }
+    core_util_critical_section_exit();
+#endif
     _mutex->unlock();
 }
 
@@ -209,7 +266,7 @@ int I2C::recover(PinName sda, PinName scl)
 int I2C::transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t &callback, int event, bool repeated)
 {
     lock();
-    if (i2c_active(&_i2c)) {
+    if (i2c_active(&_i2c) || _messages.messages) {
         unlock();
         return -1; // transaction ongoing
     }
@@ -224,23 +281,155 @@ int I2C::transfer(int address, const char *tx_buffer, int tx_length, char *rx_bu
     return 0;
 }
 
+int I2C::transfer(const message_t *messages, int count, const event_callback_t &callback, int event)
+{
+    if (count <= 0) {
+        return -1;
+    }
+
+    message_transfer_t transfer;
+    transfer.messages = messages;
+    transfer.count = count;
+    transfer.callback = callback;
+    transfer.event = event;
+
+    int ret = 0;
+    lock();
+    aquire();
+    // The transfer interrupt starts queued transfers, so it must not run between the check and the push
+    core_util_critical_section_enter();
+    if (_messages.messages || i2c_active(&_i2c)) {
+#if MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+        if (_message_queue.full()) {
+            ret = -1;
+        } else {
+            _message_queue.push(transfer);
+        }
+#else
+        ret = -1;
+#endif
+    } else {
+        start_messages(transfer);
+    }
+    core_util_critical_section_exit();
+    unlock();
+    return ret;
+}
+
+void I2C::start_messages(const message_transfer_t &transfer)
+{
+    lock_deep_sleep();
+    // The lock is held, or no thread holds it when a queued transfer starts from the interrupt
+    if (_owner != this) {
+        i2c_frequency(&_i2c, _hz);
+        _owner = this;
+    }
+    _messages = transfer;
+    _message_index = 0;
+    _irq.callback(&I2C::irq_handler_asynch);
+    start_message();
+}
+
+void I2C::start_message()
+{
+    const message_t &message = _messages.messages[_message_index];
+    const message_t *next = (_message_index + 1 < _messages.count) ? &message + 1 : NULL;
+
+    if (!message.read && next && next->read && (next->address | 1) == (message.address | 1)) {
+        // Register write followed by a read, with a repeated start between them
+        _message_step = 2;
+        i2c_transfer_asynch(&_i2c, message.data, message.length, next->data, next->length, message.address,
+                            _message_index + 2 == _messages.count, _irq.entry(), I2C_EVENT_ALL, _usage);
+    } else {
+        _message_step = 1;
+        i2c_transfer_asynch(&_i2c, message.read ? NULL : message.data, message.read ? 0 : message.length,
+                            message.read ? message.data : NULL, message.read ? message.length : 0, message.address,
+                            _message_index + 1 == _messages.count, _irq.entry(), I2C_EVENT_ALL, _usage);
+    }
+}
+
+void I2C::dequeue_messages(bool locked)
+{
+#if MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+    if (_messages.messages || i2c_active(&_i2c) || _message_queue.empty()) {
+        return;
+    }
+
+    if (!locked && _lock_count) {
+        // A thread may be using the bus or changing its owner, so leave the start to its unlock()
+        for (I2C *i2c = _deferred; i2c != this; i2c = i2c->_deferred_next) {
+            if (i2c == NULL) {
+                _deferred_next = _deferred;
+                _deferred = this;
+                break;
+            }
+        }
+        return;
+    }
+
+    message_transfer_t transfer;
+    _message_queue.pop(transfer);
+    start_messages(transfer);
+#endif
+}
+
+#if MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+void I2C::start_deferred()
+{
+    core_util_critical_section_enter();
+    while (_deferred) {
+        I2C *i2c = _deferred;
+        _deferred = i2c->_deferred_next;
+        i2c->_deferred_next = NULL;
+        i2c->dequeue_messages(true);
+    }
+    core_util_critical_section_exit();
+}
+#endif
+
 void I2C::abort_transfer(void)
 {
     lock();
     i2c_abort_asynch(&_i2c);
     unlock_deep_sleep();
+    core_util_critical_section_enter();
+    _messages.messages = NULL;
+    dequeue_messages(true);
+    core_util_critical_section_exit();
     unlock();
 }
 
 void I2C::irq_handler_asynch(void)
 {
     int event = i2c_irq_handler_asynch(&_i2c);
-    if (_callback && event) {
-        _callback.call(event);
+
+    if (_messages.messages && event) {
+        _message_index += _message_step;
+        if (event == I2C_EVENT_TRANSFER_COMPLETE && _message_index < _messages.count) {
+            // Carry on with the next message, after a repeated start
+            start_message();
+            return;
+        }
+
+        // The next queued transfer starts before the callback, to keep the bus busy
+        event_callback_t callback = _messages.callback;
+        int events = event & _messages.event;
+        _messages.messages = NULL;
+        unlock_deep_sleep();
+        dequeue_messages(false);
+        if (callback && events) {
+            callback.call(events);
+        }
+        return;
     }
 
     if (event) {
         unlock_deep_sleep();
+        dequeue_messages(false);
+    }
+
+    if (_callback && event) {
+        _callback.call(event);
     }
 }
 
@@ -0,0 +1,204 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drivers/InterruptInRecorder.h"
+
+#if DEVICE_INTERRUPTIN
+
+#include "events/EventQueue.h"
+#include "hal/us_ticker_api.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_atomic.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_thread.h"
+
+namespace mbed {
+
+InterruptInRecorder::InterruptInRecorder(PinName pin, Edge *buffer, uint32_t count, PinMode mode) :
+    InterruptIn(pin, mode),
+    _ticker(get_us_ticker_data()),
+    _buffer(buffer),
+    _mask(count - 1),
+    _head(0),
+    _tail(0),
+    _dropped(0),
+    _posted(false),
+    _delivering(false),
+    _event_id(0),
+    _queue(NULL),
+    _callback(NULL),
+    _delay_ms(0)
+{
+    // A power of two size lets the free running indices wrap with a mask
+    MBED_ASSERT(buffer != NULL && count != 0 && (count & (count - 1)) == 0);
+}
+
+InterruptInRecorder::~InterruptInRecorder()
+{
+    stop();
+
+    core_util_critical_section_enter();
+    events::EventQueue *queue = _queue;
+    int id = _event_id;
+    _queue = NULL;
+    core_util_critical_section_exit();
+
+    if (queue && id && queue->cancel(id)) {
+        _posted = false;
+    }
+
+    // An event that can no longer be cancelled has been taken by the
+    // dispatching thread, so wait until it has run and left the buffer
+    while (core_util_atomic_load_bool(&_posted) || core_util_atomic_load_bool(&_delivering)) {
+        thread_sleep_for(1);
+    }
+}
+
+void InterruptInRecorder::record(bool rise, bool fall)
+{
+    InterruptIn::rise(rise ? callback(this, &InterruptInRecorder::record_rise) : Callback<void()>(NULL));
+    InterruptIn::fall(fall ? callback(this, &InterruptInRecorder::record_fall) : Callback<void()>(NULL));
+}
+
+void InterruptInRecorder::stop()
+{
+    InterruptIn::rise(NULL);
+    InterruptIn::fall(NULL);
+}
+
+uint32_t InterruptInRecorder::read_edges(Edge *edges, uint32_t count)
+{
+    uint32_t tail = _tail;
+    uint32_t head = core_util_atomic_load_u32(&_head);
+    uint32_t read = 0;
+    while (read < count && tail != head) {
+        edges[read++] = _buffer[tail & _mask];
+        tail++;
+    }
+    // Hand the space back to the interrupt once the edges are copied out
+    core_util_atomic_store_u32(&_tail, tail);
+    return read;
+}
+
+uint32_t InterruptInRecorder::available() const
+{
+    return core_util_atomic_load_u32(&_head) - core_util_atomic_load_u32(&_tail);
+}
+
+uint32_t InterruptInRecorder::dropped() const
+{
+    return core_util_atomic_load_u32(&_dropped);
+}
+
+void InterruptInRecorder::attach(events::EventQueue *queue, edges_callback_t callback, int delay_ms)
+{
+    core_util_critical_section_enter();
+    events::EventQueue *old_queue = _queue;
+    int old_id = _event_id;
+    _queue = queue;
+    _callback = callback;
+    _delay_ms = delay_ms;
+    _event_id = 0;
+    _posted = false;
+    core_util_critical_section_exit();
+
+    if (old_queue && old_id) {
+        old_queue->cancel(old_id);
+    }
+
+    // Edges recorded before attaching are delivered straight away
+    if (available()) {
+        post();
+    }
+}
+
+void InterruptInRecorder::record_rise()
+{
+    record_edge(true);
+}
+
+void InterruptInRecorder::record_fall()
+{
+    record_edge(false);
+}
+
+void InterruptInRecorder::record_edge(bool rise)
+{
+    // Read the time first so the rest of the handler does not delay it
+    us_timestamp_t timestamp = ticker_read_us(_ticker);
+
+    // Only this handler writes the head, so it needs no atomic read
+    uint32_t head = _head;
+    if (head - core_util_atomic_load_u32(&_tail) > _mask) {
+        core_util_atomic_incr_u32(&_dropped, 1);
+    } else {
+        Edge &edge = _buffer[head & _mask];
+        edge.timestamp = timestamp;
+        edge.rise = rise;
+        // The atomic store orders the edge before the head the reader sees
+        core_util_atomic_store_u32(&_head, head + 1);
+    }
+
+    post();
+}
+
+void InterruptInRecorder::post()
+{
+    core_util_critical_section_enter();
+    if (_queue && !_posted) {
+        if (_delay_ms > 0) {
+            _event_id = _queue->call_in(_delay_ms, this, &InterruptInRecorder::deliver);
+        } else {
+            _event_id = _queue->call(this, &InterruptInRecorder::deliver);
+        }
+        // With the queue out of memory the next edge tries again
+        _posted = _event_id != 0;
+    }
+    core_util_critical_section_exit();
+}
+
+void InterruptInRecorder::deliver()
+{
+    core_util_critical_section_enter();
+    edges_callback_t callback = _callback;
+    // Cleared before reading the head, so any edge not delivered below
+    // posts the next event
+    _posted = false;
+    _event_id = 0;
+    _delivering = true;
+    core_util_critical_section_exit();
+
+    uint32_t tail = _tail;
+    uint32_t head = core_util_atomic_load_u32(&_head);
+    while (callback && tail != head) {
+        // Edges are passed in place, so a wrapped batch takes two calls
+        uint32_t index = tail & _mask;
+        uint32_t count = head - tail;
+        if (count > _mask + 1 - index) {
+            count = _mask + 1 - index;
+        }
+        callback(&_buffer[index], count);
+        tail += count;
+        core_util_atomic_store_u32(&_tail, tail);
+    }
+
+    core_util_atomic_store_bool(&_delivering, false);
+}
+
+} // namespace mbed
+
+#endif
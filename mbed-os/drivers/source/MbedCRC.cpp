@@ -27,7 +27,7 @@ SingletonPtr<PlatformMutex> mbed_crc_mutex;
 template<>
 MbedCRC<POLY_32BIT_ANSI, 32>::MbedCRC():
     _initial_value(~(0x0)), _final_xor(~(0x0)), _reflect_data(true), _reflect_remainder(true),
-    _crc_table((uint32_t *)Table_CRC_32bit_ANSI)
+    _crc_table(NULL)
 {
     mbed_crc_ctor();
 }
@@ -35,7 +35,7 @@ MbedCRC<POLY_32BIT_ANSI, 32>::MbedCRC():
 template<>
 MbedCRC<POLY_32BIT_REV_ANSI, 32>::MbedCRC():
     _initial_value(~(0x0)), _final_xor(~(0x0)), _reflect_data(false), _reflect_remainder(false),
-    _crc_table((uint32_t *)Table_CRC_32bit_Rev_ANSI)
+    _crc_table(NULL)
 {
     mbed_crc_ctor();
 }
@@ -43,7 +43,7 @@ MbedCRC<POLY_32BIT_REV_ANSI, 32>::MbedCRC():
 template<>
 MbedCRC<POLY_16BIT_IBM, 16>::MbedCRC():
     _initial_value(0), _final_xor(0), _reflect_data(true), _reflect_remainder(true),
-    _crc_table((uint32_t *)Table_CRC_16bit_IBM)
+    _crc_table(NULL)
 {
     mbed_crc_ctor();
 }
@@ -51,7 +51,7 @@ MbedCRC<POLY_16BIT_IBM, 16>::MbedCRC():
 template<>
 MbedCRC<POLY_16BIT_CCITT, 16>::MbedCRC():
     _initial_value(~(0x0)), _final_xor(0), _reflect_data(false), _reflect_remainder(false),
-    _crc_table((uint32_t *)Table_CRC_16bit_CCITT)
+    _crc_table(NULL)
 {
     mbed_crc_ctor();
 }
@@ -59,7 +59,7 @@ MbedCRC<POLY_16BIT_CCITT, 16>::MbedCRC():
 template<>
 MbedCRC<POLY_7BIT_SD, 7>::MbedCRC():
     _initial_value(0), _final_xor(0), _reflect_data(false), _reflect_remainder(false),
-    _crc_table((uint32_t *)Table_CRC_7Bit_SD)
+    _crc_table(NULL)
 {
     mbed_crc_ctor();
 }
@@ -67,7 +67,7 @@ MbedCRC<POLY_7BIT_SD, 7>::MbedCRC():
 template<>
 MbedCRC<POLY_8BIT_CCITT, 8>::MbedCRC():
     _initial_value(0), _final_xor(0), _reflect_data(false), _reflect_remainder(false),
-    _crc_table((uint32_t *)Table_CRC_8bit_CCITT)
+    _crc_table(NULL)
 {
     mbed_crc_ctor();
 }
@@ -17,6 +17,8 @@
 #include "drivers/SPI.h"
 #include "platform/mbed_critical.h"
 
+#include <string.h>
+
 #if DEVICE_SPI_ASYNCH
 #include "platform/mbed_power_mgmt.h"
 #endif
@@ -120,6 +122,9 @@ void SPI::_do_construct()
 #if DEVICE_SPI_ASYNCH
     _usage = DMA_USAGE_NEVER;
     _deep_sleep_locked = false;
+    _batch = NULL;
+    _batch_phase = 0;
+    _batch_event = 0;
 #endif
     _select_count = 0;
     _bits = 8;
@@ -276,6 +281,95 @@ void SPI::set_default_write_value(char data)
     unlock();
 }
 
+const int SPI::Batch::max_phases;
+const int SPI::Batch::max_inline;
+
+char *SPI::Batch::add_inline(int length)
+{
+    if (length <= 0 || _inline_used + length > max_inline) {
+        _valid = _valid && length == 0;
+        return NULL;
+    }
+
+    char *data = _inline + _inline_used;
+    if (_last_inline) {
+        // Inline bytes follow each other, so they extend the last phase
+        _phases[_count - 1].length += length;
+    } else {
+        if (_count == max_phases) {
+            _valid = false;
+            return NULL;
+        }
+        _phases[_count].tx_buffer = data;
+        _phases[_count].rx_buffer = NULL;
+        _phases[_count].length = length;
+        _count++;
+        _last_inline = true;
+    }
+    _inline_used += length;
+    _length += length;
+    return data;
+}
+
+SPI::Batch &SPI::Batch::value(uint32_t value, int bytes)
+{
+    if (bytes < 1 || bytes > 4) {
+        _valid = false;
+        return *this;
+    }
+
+    char *data = add_inline(bytes);
+    if (data) {
+        for (int i = 0; i < bytes; i++) {
+            data[i] = (char)(value >> ((bytes - 1 - i) * 8));
+        }
+    }
+    return *this;
+}
+
+SPI::Batch &SPI::Batch::dummy(int count, char data)
+{
+    char *dummy = add_inline(count);
+    if (dummy) {
+        memset(dummy, data, count);
+    }
+    return *this;
+}
+
+SPI::Batch &SPI::Batch::add(const char *tx_buffer, char *rx_buffer, int length)
+{
+    if (length <= 0 || _count == max_phases) {
+        _valid = _valid && length == 0;
+        return *this;
+    }
+
+    _phases[_count].tx_buffer = tx_buffer;
+    _phases[_count].rx_buffer = rx_buffer;
+    _phases[_count].length = length;
+    _count++;
+    _length += length;
+    _last_inline = false;
+    return *this;
+}
+
+int SPI::write(const Batch &batch)
+{
+    if (!batch.valid()) {
+        return -1;
+    }
+
+    select();
+    for (int i = 0; i < batch._count; i++) {
+        const Batch::phase_t &phase = batch._phases[i];
+        spi_master_block_write(&_peripheral->spi,
+                               phase.tx_buffer, phase.tx_buffer ? phase.length : 0,
+                               phase.rx_buffer, phase.rx_buffer ? phase.length : 0,
+                               _write_fill);
+    }
+    deselect();
+    return batch.length();
+}
+
 #if DEVICE_SPI_ASYNCH
 
 int SPI::transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length, unsigned char bit_width, const event_callback_t &callback, int event)
@@ -287,9 +381,23 @@ int SPI::transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_
     return 0;
 }
 
+int SPI::transfer(const Batch &batch, const event_callback_t &callback, int event)
+{
+    if (!batch.valid() || batch.phases() == 0) {
+        return -1;
+    }
+    if (spi_active(&_peripheral->spi)) {
+        // Queued batches are told apart from other transfers by a width of 0
+        return queue_transfer(&batch, 0, NULL, 0, 0, callback, event);
+    }
+    start_batch(&batch, callback, event);
+    return 0;
+}
+
 void SPI::abort_transfer()
 {
     spi_abort_asynch(&_peripheral->spi);
+    _batch = NULL;
     unlock_deep_sleep();
 #if TRANSACTION_QUEUE_SIZE_SPI
     dequeue_transaction();
@@ -353,10 +461,33 @@ void SPI::start_transfer(const void *tx_buffer, int tx_length, void *rx_buffer,
     _acquire();
     _set_ssel(0);
     _callback = callback;
+    _batch = NULL;
     _irq.callback(&SPI::irq_handler_asynch);
     spi_master_transfer(&_peripheral->spi, tx_buffer, tx_length, rx_buffer, rx_length, bit_width, _irq.entry(), event, _usage);
 }
 
+void SPI::start_batch(const Batch *batch, const event_callback_t &callback, int event)
+{
+    lock_deep_sleep();
+    _acquire();
+    _set_ssel(0);
+    _callback = callback;
+    _batch = batch;
+    _batch_phase = 0;
+    _batch_event = event | SPI_EVENT_COMPLETE;
+    _irq.callback(&SPI::irq_handler_asynch);
+    start_batch_phase();
+}
+
+void SPI::start_batch_phase()
+{
+    const Batch::phase_t &phase = _batch->_phases[_batch_phase];
+    spi_master_transfer(&_peripheral->spi,
+                        phase.tx_buffer, phase.tx_buffer ? phase.length : 0,
+                        phase.rx_buffer, phase.rx_buffer ? phase.length : 0,
+                        8, _irq.entry(), _batch_event, _usage);
+}
+
 void SPI::lock_deep_sleep()
 {
     if (_deep_sleep_locked == false) {
@@ -377,6 +508,10 @@ void SPI::unlock_deep_sleep()
 
 void SPI::start_transaction(transaction_t *data)
 {
+    if (data->width == 0) {
+        start_batch(static_cast<const Batch *>(data->tx_buffer), data->callback, data->event);
+        return;
+    }
     start_transfer(data->tx_buffer, data->tx_length, data->rx_buffer, data->rx_length, data->width, data->callback, data->event);
 }
 
@@ -395,6 +530,15 @@ void SPI::dequeue_transaction()
 void SPI::irq_handler_asynch(void)
 {
     int event = spi_irq_handler_asynch(&_peripheral->spi);
+    if (_batch && (event & SPI_EVENT_ALL) == SPI_EVENT_COMPLETE && _batch_phase + 1 < _batch->_count) {
+        // Carry on with the next phase, with the Slave Select line still asserted
+        _batch_phase++;
+        start_batch_phase();
+        return;
+    }
+    if (event & SPI_EVENT_ALL) {
+        _batch = NULL;
+    }
     if (_callback && (event & SPI_EVENT_ALL)) {
         _set_ssel(1);
         unlock_deep_sleep();
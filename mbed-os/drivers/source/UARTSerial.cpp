@@ -29,6 +29,16 @@ UARTSerial::UARTSerial(PinName tx, PinName rx, int baud) :
     _tx_irq_enabled(false),
     _rx_irq_enabled(false),
     _dcd_irq(NULL)
+#if UARTSERIAL_ASYNC
+    ,
+    _async(false),
+    _rx_async_active(false),
+    _tx_async_active(false),
+    _tx_async_hold(false),
+    _rx_chunk_index(0),
+    _rx_last_pos(0),
+    _tx_chunk_length(0)
+#endif
 {
     /* Attatch IRQ routines to the serial device. */
     update_rx_irq();
@@ -40,6 +50,16 @@ UARTSerial::UARTSerial(const serial_pinmap_t &static_pinmap, int baud) :
     _tx_irq_enabled(false),
     _rx_irq_enabled(false),
     _dcd_irq(NULL)
+#if UARTSERIAL_ASYNC
+    ,
+    _async(false),
+    _rx_async_active(false),
+    _tx_async_active(false),
+    _tx_async_hold(false),
+    _rx_chunk_index(0),
+    _rx_last_pos(0),
+    _tx_chunk_length(0)
+#endif
 {
     /* Attatch IRQ routines to the serial device. */
     update_rx_irq();
@@ -47,6 +67,11 @@ UARTSerial::UARTSerial(const serial_pinmap_t &static_pinmap, int baud) :
 
 UARTSerial::~UARTSerial()
 {
+#if UARTSERIAL_ASYNC
+    _rx_poll.detach();
+    abort_read();
+    abort_write();
+#endif
     delete _dcd_irq;
 }
 
@@ -60,6 +85,47 @@ void UARTSerial::set_baud(int baud)
     SerialBase::baud(baud);
 }
 
+#if UARTSERIAL_ASYNC
+int UARTSerial::set_dma_usage(DMAUsage usage)
+{
+    int result = 0;
+
+    api_lock();
+
+    /* Let the chunk taken from the buffer finish, anything still buffered is sent in the new mode */
+    _tx_async_hold = true;
+    wait_tx_async();
+
+    core_util_critical_section_enter();
+    stop_rx_async();
+    if (_rx_irq_enabled) {
+        disable_rx_irq();
+    }
+    if (_tx_irq_enabled) {
+        disable_tx_irq();
+    }
+    if (SerialBase::set_dma_usage_tx(usage) != 0 || SerialBase::set_dma_usage_rx(usage) != 0) {
+        result = -1;
+    } else {
+        _async = usage != DMA_USAGE_NEVER;
+    }
+    _tx_async_hold = false;
+    update_rx_irq();
+    update_tx_irq();
+    core_util_critical_section_exit();
+
+    if (_async) {
+        _rx_poll.attach_us(callback(this, &UARTSerial::rx_async_poll), MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_RX_POLL_US);
+    } else {
+        _rx_poll.detach();
+    }
+
+    api_unlock();
+
+    return result;
+}
+#endif
+
 void UARTSerial::set_data_carrier_detect(PinName dcd_pin, bool active_high)
 {
     delete _dcd_irq;
@@ -122,6 +188,10 @@ int UARTSerial::sync()
         api_lock();
     }
 
+#if UARTSERIAL_ASYNC
+    wait_tx_async();
+#endif
+
     api_unlock();
 
     return 0;
@@ -145,6 +215,22 @@ void UARTSerial::sigio(Callback<void()> func)
  */
 ssize_t UARTSerial::write_unbuffered(const char *buf_ptr, size_t length)
 {
+#if UARTSERIAL_ASYNC
+    /* Interrupts may be off, so finish the chunk by hand from where the transfer got to */
+    if (_tx_chunk_length) {
+        size_t sent = 0;
+        if (_tx_async_active) {
+            sent = _serial.tx_buff.pos;
+            abort_write();
+            _tx_async_active = false;
+        }
+        while (sent < _tx_chunk_length) {
+            SerialBase::_base_putc(_tx_chunk[sent++]);
+        }
+        _tx_chunk_length = 0;
+    }
+#endif
+
     while (!_txbuf.empty()) {
         tx_irq();
     }
@@ -337,6 +423,11 @@ void UARTSerial::tx_irq(void)
 void UARTSerial::update_rx_irq()
 {
     core_util_critical_section_enter();
+#if UARTSERIAL_ASYNC
+    if (_async) {
+        start_rx_async(0);
+    } else
+#endif
     if (_rx_enabled && !_rx_irq_enabled) {
         UARTSerial::rx_irq();
         if (!_rxbuf.full()) {
@@ -357,6 +448,11 @@ void UARTSerial::disable_rx_irq()
 void UARTSerial::update_tx_irq()
 {
     core_util_critical_section_enter();
+#if UARTSERIAL_ASYNC
+    if (_async) {
+        start_tx_async();
+    } else
+#endif
     if (_tx_enabled && !_tx_irq_enabled) {
         UARTSerial::tx_irq();
         if (!_txbuf.empty()) {
@@ -377,6 +473,13 @@ void UARTSerial::disable_tx_irq()
 int UARTSerial::enable_input(bool enabled)
 {
     api_lock();
+#if UARTSERIAL_ASYNC
+    if (!enabled) {
+        core_util_critical_section_enter();
+        stop_rx_async();
+        core_util_critical_section_exit();
+    }
+#endif
     SerialBase::enable_input(enabled);
     update_rx_irq(); // Eventually enable rx-interrupt to handle incoming data
     api_unlock();
@@ -387,13 +490,161 @@ int UARTSerial::enable_input(bool enabled)
 int UARTSerial::enable_output(bool enabled)
 {
     api_lock();
+#if UARTSERIAL_ASYNC
+    if (!enabled) {
+        // Let the chunk taken from the buffer finish, the rest stays buffered
+        _tx_async_hold = true;
+        wait_tx_async();
+    }
+#endif
     SerialBase::enable_output(enabled);
+#if UARTSERIAL_ASYNC
+    _tx_async_hold = false;
+#endif
     update_tx_irq(); // Eventually enable tx-interrupt to flush buffered data
     api_unlock();
 
     return 0;
 }
 
+#if UARTSERIAL_ASYNC
+/* Wait for the chunk taken from the buffer to be sent, retrying its transfer
+ * if it could not be started. Called with the API lock held. */
+void UARTSerial::wait_tx_async()
+{
+    while (_tx_async_active || _tx_chunk_length) {
+        core_util_critical_section_enter();
+        start_tx_async();
+        core_util_critical_section_exit();
+        api_unlock();
+        thread_sleep_for(1);
+        api_lock();
+    }
+}
+
+/* Asynchronous transfers. These are called from critical section or interrupt context */
+
+void UARTSerial::start_rx_async(size_t pending)
+{
+    /* Only receive into a chunk that will fit in the buffer together with the pending data */
+    if (!_rx_enabled || _rx_async_active ||
+            MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE - _rxbuf.size() < pending + MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE) {
+        return;
+    }
+
+    /* Alternate the chunks so a completed one can be copied out after the next has started */
+    _rx_chunk_index ^= 1;
+    _rx_last_pos = 0;
+    if (SerialBase::read(_rx_chunk[_rx_chunk_index], MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE,
+                         callback(this, &UARTSerial::rx_async_done), SERIAL_EVENT_RX_ALL) == 0) {
+        _rx_async_active = true;
+    }
+}
+
+void UARTSerial::stop_rx_async()
+{
+    if (!_rx_async_active) {
+        return;
+    }
+
+    /* Some targets reset the position when aborting */
+    size_t received = _serial.rx_buff.pos;
+    abort_read();
+    if (_serial.rx_buff.pos > received) {
+        received = _serial.rx_buff.pos;
+    }
+    _rx_async_active = false;
+
+    push_rx_async(_rx_chunk[_rx_chunk_index], received);
+}
+
+void UARTSerial::push_rx_async(const uint8_t *data, size_t length)
+{
+    bool was_empty = _rxbuf.empty();
+
+    if (length > MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE) {
+        length = MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE;
+    }
+    for (size_t i = 0; i < length; i++) {
+        _rxbuf.push(data[i]);
+    }
+
+    /* Report the File handler that data is ready to be read from the buffer. */
+    if (was_empty && !_rxbuf.empty()) {
+        wake();
+    }
+}
+
+void UARTSerial::rx_async_done(int event)
+{
+    const uint8_t *data = _rx_chunk[_rx_chunk_index];
+    size_t received = _serial.rx_buff.pos;
+
+    if (event & SERIAL_EVENT_RX_COMPLETE) {
+        received = MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE;
+    }
+    _rx_async_active = false;
+
+    start_rx_async(received);
+    push_rx_async(data, received);
+}
+
+/* There is no idle line event in the HAL, so reception is idle if nothing
+ * has arrived in the chunk for a whole poll period. */
+void UARTSerial::rx_async_poll()
+{
+    core_util_critical_section_enter();
+    if (_rx_async_active) {
+        size_t pos = _serial.rx_buff.pos;
+        if (pos != 0 && pos == _rx_last_pos) {
+            stop_rx_async();
+            start_rx_async(0);
+        } else {
+            _rx_last_pos = pos;
+        }
+    }
+    start_tx_async();
+    core_util_critical_section_exit();
+}
+
+/* The chunk keeps what was taken from the buffer until its transfer completes,
+ * so a transfer that fails to start is retried with the same data first. */
+void UARTSerial::start_tx_async()
+{
+    if (!_tx_enabled || _tx_async_active) {
+        return;
+    }
+
+    size_t length = _tx_chunk_length;
+    char data;
+    while (!_tx_async_hold && length < MBED_CONF_DRIVERS_UART_SERIAL_ASYNC_CHUNK_SIZE && _txbuf.pop(data)) {
+        _tx_chunk[length++] = data;
+    }
+    if (length == 0) {
+        return;
+    }
+
+    _tx_chunk_length = length;
+    if (SerialBase::write(_tx_chunk, length, callback(this, &UARTSerial::tx_async_done), SERIAL_EVENT_TX_COMPLETE) == 0) {
+        _tx_async_active = true;
+    }
+}
+
+void UARTSerial::tx_async_done(int event)
+{
+    bool was_full = _txbuf.full();
+
+    _tx_async_active = false;
+    _tx_chunk_length = 0;
+    start_tx_async();
+
+    /* Report the File handler that data can be written to peripheral. */
+    if (was_full && !_txbuf.full() && !hup()) {
+        wake();
+    }
+}
+#endif
+
 } //namespace mbed
 
 #endif //(DEVICE_SERIAL && DEVICE_INTERRUPTIN)
@@ -187,6 +187,31 @@ void USBCDC::_init()
     _rx_in_progress = false;
     _rx_buf = _rx_buffer;
     _rx_size = 0;
+
+    _tx_stream_buf = NULL;
+    _tx_stream_half = 0;
+    _rx_stream_buf = NULL;
+    _rx_stream_half = 0;
+    _stream_reset();
+}
+
+void USBCDC::_stream_reset()
+{
+    _tx_stream_size[0] = 0;
+    _tx_stream_size[1] = 0;
+    _tx_stream_acquire = 0;
+    _tx_stream_send = 0;
+    _tx_stream_sent = 0;
+    _tx_stream_packet = 0;
+    _tx_stream_sending = false;
+
+    _rx_stream_size[0] = 0;
+    _rx_stream_size[1] = 0;
+    _rx_stream_full[0] = false;
+    _rx_stream_full[1] = false;
+    _rx_stream_fill = 0;
+    _rx_stream_acquire = 0;
+    _rx_stream_reading = false;
 }
 
 void USBCDC::callback_reset()
@@ -295,8 +320,9 @@ void USBCDC::callback_set_configuration(uint8_t configuration)
         endpoint_add(_bulk_in, CDC_MAX_PACKET_SIZE, USB_EP_TYPE_BULK, &USBCDC::_send_isr);
         endpoint_add(_bulk_out, CDC_MAX_PACKET_SIZE, USB_EP_TYPE_BULK, &USBCDC::_receive_isr);
 
-        read_start(_bulk_out, _rx_buf, sizeof(_rx_buffer));
-        _rx_in_progress = true;
+        _rx_in_progress = false;
+        _rx_stream_reading = false;
+        _receive_isr_start();
 
         ret = true;
     }
@@ -328,7 +354,7 @@ void USBCDC::_change_terminal_connected(bool connected)
 
         // Abort RX
         if (_rx_in_progress) {
-            endpoint_abort(_bulk_in);
+            endpoint_abort(_bulk_out);
             _rx_in_progress = false;
         }
         _rx_buf = _rx_buffer;
@@ -336,6 +362,9 @@ void USBCDC::_change_terminal_connected(bool connected)
         _rx_list.process();
         MBED_ASSERT(_rx_list.empty());
 
+        // Streamed data is dropped
+        _stream_reset();
+
     }
     _connected_list.process();
 }
@@ -400,13 +429,30 @@ void USBCDC::_send_isr_start()
 {
     assert_locked();
 
-    if (!_tx_in_progress && _tx_size) {
-        if (USBDevice::write_start(_bulk_in, _tx_buffer, _tx_size)) {
-            _tx_in_progress = true;
+    if (!_tx_in_progress) {
+        if (_tx_stream_size[_tx_stream_send]) {
+            _send_stream_start();
+        } else if (_tx_size) {
+            if (USBDevice::write_start(_bulk_in, _tx_buffer, _tx_size)) {
+                _tx_in_progress = true;
+            }
         }
     }
 }
 
+void USBCDC::_send_stream_start()
+{
+    assert_locked();
+
+    uint32_t remaining = _tx_stream_size[_tx_stream_send] - _tx_stream_sent;
+    _tx_stream_packet = remaining > CDC_MAX_PACKET_SIZE ? CDC_MAX_PACKET_SIZE : remaining;
+    uint8_t *packet = _tx_stream_buf + _tx_stream_send * _tx_stream_half + _tx_stream_sent;
+    if (USBDevice::write_start(_bulk_in, packet, _tx_stream_packet)) {
+        _tx_in_progress = true;
+        _tx_stream_sending = true;
+    }
+}
+
 /*
 * Called by when CDC data is sent
 * Warning: Called in ISR
@@ -416,12 +462,31 @@ void USBCDC::_send_isr()
     assert_locked();
 
     write_finish(_bulk_in);
-    _tx_buf = _tx_buffer;
-    _tx_size = 0;
     _tx_in_progress = false;
 
+    bool released = false;
+    if (_tx_stream_sending) {
+        _tx_stream_sending = false;
+        _tx_stream_sent += _tx_stream_packet;
+
+        // A transfer ends with a short packet, of zero length if need be
+        if ((_tx_stream_sent < _tx_stream_size[_tx_stream_send]) || (_tx_stream_packet == CDC_MAX_PACKET_SIZE)) {
+            _send_stream_start();
+            return;
+        }
+
+        _tx_stream_size[_tx_stream_send] = 0;
+        _tx_stream_send ^= 1;
+        _tx_stream_sent = 0;
+        released = true;
+    } else {
+        _tx_buf = _tx_buffer;
+        _tx_size = 0;
+    }
+
     _tx_list.process();
-    if (!_tx_in_progress) {
+    _send_isr_start();
+    if (!_tx_in_progress || released) {
         data_tx();
     }
 }
@@ -460,12 +525,130 @@ void USBCDC::receive_nb(uint8_t *buffer, uint32_t size,  uint32_t *size_read)
     }
 }
 
+bool USBCDC::set_stream_buffers(uint8_t *tx_buffer, uint32_t tx_size, uint8_t *rx_buffer, uint32_t rx_size)
+{
+    MBED_ASSERT(!tx_buffer || (tx_size && !(tx_size % (2 * CDC_MAX_PACKET_SIZE))));
+    MBED_ASSERT(!rx_buffer || (rx_size && !(rx_size % (2 * CDC_MAX_PACKET_SIZE))));
+
+    lock();
+
+    if (_tx_stream_size[0] || _tx_stream_size[1]) {
+        unlock();
+        return false;
+    }
+
+    _tx_stream_buf = tx_buffer;
+    _tx_stream_half = tx_size / 2;
+    _tx_stream_acquire = 0;
+    _tx_stream_send = 0;
+
+    // A read in progress is restarted into the new buffer
+    bool restart = _rx_in_progress;
+    if (_rx_in_progress) {
+        endpoint_abort(_bulk_out);
+        _rx_in_progress = false;
+    }
+
+    _rx_stream_buf = rx_buffer;
+    _rx_stream_half = rx_size / 2;
+    _rx_stream_size[0] = 0;
+    _rx_stream_size[1] = 0;
+    _rx_stream_full[0] = false;
+    _rx_stream_full[1] = false;
+    _rx_stream_fill = 0;
+    _rx_stream_acquire = 0;
+    _rx_stream_reading = false;
+
+    if (restart) {
+        _receive_isr_start();
+    }
+
+    unlock();
+    return true;
+}
+
+uint8_t *USBCDC::send_acquire(uint32_t *size)
+{
+    lock();
+
+    uint8_t *buffer = NULL;
+    *size = 0;
+    if (_terminal_connected && _tx_stream_buf && !_tx_stream_size[_tx_stream_acquire]) {
+        buffer = _tx_stream_buf + _tx_stream_acquire * _tx_stream_half;
+        *size = _tx_stream_half;
+    }
+
+    unlock();
+    return buffer;
+}
+
+bool USBCDC::send_commit(uint32_t size)
+{
+    lock();
+
+    if (!_terminal_connected || !_tx_stream_buf) {
+        unlock();
+        return false;
+    }
+
+    MBED_ASSERT(size <= _tx_stream_half);
+    if (size > 0) {
+        MBED_ASSERT(!_tx_stream_size[_tx_stream_acquire]);
+        _tx_stream_size[_tx_stream_acquire] = size;
+        _tx_stream_acquire ^= 1;
+        _send_isr_start();
+    }
+
+    unlock();
+    return true;
+}
+
+uint8_t *USBCDC::receive_acquire(uint32_t *size)
+{
+    lock();
+
+    uint8_t *buffer = NULL;
+    *size = 0;
+    if (_rx_stream_buf && _rx_stream_full[_rx_stream_acquire]) {
+        buffer = _rx_stream_buf + _rx_stream_acquire * _rx_stream_half;
+        *size = _rx_stream_size[_rx_stream_acquire];
+    }
+
+    unlock();
+    return buffer;
+}
+
+void USBCDC::receive_release()
+{
+    lock();
+
+    if (_rx_stream_buf && _rx_stream_full[_rx_stream_acquire]) {
+        _rx_stream_full[_rx_stream_acquire] = false;
+        _rx_stream_size[_rx_stream_acquire] = 0;
+        _rx_stream_acquire ^= 1;
+        _receive_isr_start();
+    }
+
+    unlock();
+}
+
 void USBCDC::_receive_isr_start()
 {
     if ((_rx_size == 0) && !_rx_in_progress) {
-        // Refill the buffer
-        read_start(_bulk_out, _rx_buffer, sizeof(_rx_buffer));
-        _rx_in_progress = true;
+        if (_rx_stream_buf) {
+            // Reception waits while both halves are held by the application
+            if (!_rx_stream_full[_rx_stream_fill]) {
+                uint8_t *packet = _rx_stream_buf + _rx_stream_fill * _rx_stream_half + _rx_stream_size[_rx_stream_fill];
+                if (read_start(_bulk_out, packet, CDC_MAX_PACKET_SIZE)) {
+                    _rx_in_progress = true;
+                    _rx_stream_reading = true;
+                }
+            }
+        } else {
+            // Refill the buffer
+            read_start(_bulk_out, _rx_buffer, sizeof(_rx_buffer));
+            _rx_in_progress = true;
+        }
     }
 }
 
@@ -477,6 +660,27 @@ void USBCDC::_receive_isr()
 {
     assert_locked();
 
+    if (_rx_stream_reading) {
+        uint32_t size = read_finish(_bulk_out);
+        _rx_in_progress = false;
+        _rx_stream_reading = false;
+
+        // A short packet or a full half ends the transfer
+        uint32_t *filled = &_rx_stream_size[_rx_stream_fill];
+        *filled += size;
+        bool received = ((size < CDC_MAX_PACKET_SIZE) || (*filled == _rx_stream_half)) && (*filled > 0);
+        if (received) {
+            _rx_stream_full[_rx_stream_fill] = true;
+            _rx_stream_fill ^= 1;
+        }
+
+        _receive_isr_start();
+        if (received) {
+            data_rx();
+        }
+        return;
+    }
+
     MBED_ASSERT(_rx_size == 0);
     _rx_buf = _rx_buffer;
     _rx_size = read_finish(_bulk_out);
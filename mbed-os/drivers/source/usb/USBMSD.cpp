@@ -20,6 +20,7 @@
 #include "USBMSD.h"
 #include "EndpointResolver.h"
 #include "usb_phy_api.h"
+#include "platform/mbed_assert.h"
 
 #define DISK_OK         0x00
 #define NO_INIT         0x01
@@ -47,6 +48,7 @@
 #define WRITE12                    0xAA
 #define MODE_SELECT10              0x55
 #define MODE_SENSE10               0x5A
+#define SYNCHRONIZE_CACHE10        0x35
 
 // MSC class specific requests
 #define MSC_REQUEST_RESET          0xFF
@@ -57,6 +59,13 @@
 // max packet size
 #define MAX_PACKET  64
 
+#ifndef MBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS
+#define MBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS 1
+#endif
+
+MBED_STATIC_ASSERT((MBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS >= 1) && (MBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS <= 255),
+                   "drivers-usb.msd-buffer-blocks must be between 1 and 255");
+
 // CSW Status
 enum Status {
     CSW_PASSED,
@@ -67,7 +76,8 @@ enum Status {
 USBMSD::USBMSD(BlockDevice *bd, bool connect_blocking, uint16_t vendor_id, uint16_t product_id, uint16_t product_release)
     : USBDevice(get_usb_phy(), vendor_id, product_id, product_release),
       _initialized(false), _media_removed(false), _in_task(&_queue), _out_task(&_queue), _reset_task(&_queue), _control_task(&_queue), _configure_task(&_queue), _bd(bd),
-      _addr(0), _length(0), _mem_ok(false), _block_size(0), _memory_size(0), _block_count(0), _out_ready(false), _in_ready(false), _bulk_out_size(0)
+      _addr(0), _length(0), _mem_ok(false), _block_size(0), _memory_size(0), _block_count(0),
+      _page_blocks(0), _cache_block(0), _cache_count(0), _cache_dirty(false), _out_ready(false), _in_ready(false), _bulk_out_size(0)
 {
     _init();
     if (connect_blocking) {
@@ -80,7 +90,8 @@ USBMSD::USBMSD(BlockDevice *bd, bool connect_blocking, uint16_t vendor_id, uint1
 USBMSD::USBMSD(USBPhy *phy, BlockDevice *bd, uint16_t vendor_id, uint16_t product_id, uint16_t product_release)
     : USBDevice(phy, vendor_id, product_id, product_release),
       _initialized(false), _media_removed(false), _in_task(&_queue), _out_task(&_queue), _reset_task(&_queue), _control_task(&_queue), _configure_task(&_queue), _bd(bd),
-      _addr(0), _length(0), _mem_ok(false), _block_size(0), _memory_size(0), _block_count(0), _out_ready(false), _in_ready(false), _bulk_out_size(0)
+      _addr(0), _length(0), _mem_ok(false), _block_size(0), _memory_size(0), _block_count(0),
+      _page_blocks(0), _cache_block(0), _cache_count(0), _cache_dirty(false), _out_ready(false), _in_ready(false), _bulk_out_size(0)
 {
     _init();
 }
@@ -147,7 +158,15 @@ bool USBMSD::connect()
         _block_size = _memory_size / _block_count;
         if (_block_size != 0) {
             free(_page);
-            _page = (uint8_t *)malloc(_block_size * sizeof(uint8_t));
+            // fewer blocks are staged if the heap can't take them all
+            _page_blocks = MBED_CONF_DRIVERS_USB_MSD_BUFFER_BLOCKS;
+            _page = (uint8_t *)malloc(_page_blocks * _block_size * sizeof(uint8_t));
+            while ((_page == NULL) && (_page_blocks > 1)) {
+                _page_blocks /= 2;
+                _page = (uint8_t *)malloc(_page_blocks * _block_size * sizeof(uint8_t));
+            }
+            _cache_count = 0;
+            _cache_dirty = false;
             if (_page == NULL) {
                 _mutex.unlock();
                 _mutex_init.unlock();
@@ -194,6 +213,9 @@ void USBMSD::disconnect()
 
     _mutex.lock();
 
+    // Write any blocks still held before the cache goes away
+    cacheFlush();
+
     //De-allocate MSD page size:
     free(_page);
     _page = NULL;
@@ -579,16 +601,22 @@ void USBMSD::memoryWrite(uint8_t *buf, uint16_t size)
         endpoint_stall(_bulk_out);
     }
 
-    // we fill an array in RAM of 1 block before writing it in memory
-    for (int i = 0; i < size; i++) {
-        _page[_addr % _block_size + i] = buf[i];
+    // blocks are gathered in the cache, which is written in memory once full
+    // and at the end of the transfer
+    uint32_t block = _addr / _block_size;
+    if (block - _cache_block == _page_blocks) {
+        if (!cacheFlush()) {
+            _mem_ok = false;
+        }
+        _cache_block = block;
+        _cache_count = 0;
     }
 
-    // if the array is filled, write it in memory
+    memcpy(&_page[(block - _cache_block) * _block_size + _addr % _block_size], buf, size);
+
     if (!((_addr + size) % _block_size)) {
-        if (!(disk_status() & WRITE_PROTECT)) {
-            disk_write(_page, _addr / _block_size, 1);
-        }
+        _cache_count = block - _cache_block + 1;
+        _cache_dirty = true;
     }
 
     _addr += size;
@@ -596,7 +624,11 @@ void USBMSD::memoryWrite(uint8_t *buf, uint16_t size)
     _csw.DataResidue -= size;
 
     if ((!_length) || (_stage != PROCESS_CBW)) {
-        _csw.Status = (_stage == ERROR) ? CSW_FAILED : CSW_PASSED;
+        // the host may remove the media as soon as it has the status
+        if (!cacheFlush()) {
+            _mem_ok = false;
+        }
+        _csw.Status = ((_stage == ERROR) || !_mem_ok) ? CSW_FAILED : CSW_PASSED;
         sendCSW();
     }
 }
@@ -611,16 +643,15 @@ void USBMSD::memoryVerify(uint8_t *buf, uint16_t size)
         endpoint_stall(_bulk_out);
     }
 
-    // beginning of a new block -> load a whole block in RAM
-    if (!(_addr % _block_size)) {
-        disk_read(_page, _addr / _block_size, 1);
+    uint8_t *block = cacheRead(_addr / _block_size);
+    if (block == NULL) {
+        _mem_ok = false;
     }
 
     // info are in RAM -> no need to re-read memory
-    for (n = 0; n < size; n++) {
-        if (_page[_addr % _block_size + n] != buf[n]) {
+    for (n = 0; _mem_ok && (n < size); n++) {
+        if (block[_addr % _block_size + n] != buf[n]) {
             _mem_ok = false;
-            break;
         }
     }
 
@@ -814,6 +845,8 @@ void USBMSD::CBWDecode(uint8_t *buf, uint16_t size)
                         if (infoTransfer()) {
                             if (!(_cbw.Flags & 0x80)) {
                                 _stage = PROCESS_CBW;
+                                _mem_ok = true;
+                                cacheStartWrite();
                             } else {
                                 endpoint_stall(_bulk_in);
                                 _csw.Status = CSW_ERROR;
@@ -846,6 +879,11 @@ void USBMSD::CBWDecode(uint8_t *buf, uint16_t size)
                     case MODE_SENSE10:
                         modeSense10();
                         break;
+                    case SYNCHRONIZE_CACHE10:
+                        // writes are in memory before their status is sent
+                        _csw.Status = CSW_PASSED;
+                        sendCSW();
+                        break;
                     default:
                         fail();
                         break;
@@ -883,13 +921,16 @@ void USBMSD::memoryRead(void)
     }
 
     if (n > 0) {
-        // we read an entire block
-        if (!(_addr % _block_size)) {
-            disk_read(_page, _addr / _block_size, 1);
+        uint8_t *block = cacheRead(_addr / _block_size);
+        if (block == NULL) {
+            // the packet is still sent, and the transfer fails
+            memset(_page, 0, _block_size);
+            block = _page;
+            _stage = ERROR;
         }
 
         // write data which are in RAM
-        _write_next(&_page[_addr % _block_size], MAX_PACKET);
+        _write_next(&block[_addr % _block_size], MAX_PACKET);
 
         _addr += n;
         _length -= n;
@@ -957,7 +998,64 @@ bool USBMSD::infoTransfer(void)
     return true;
 }
 
+uint8_t *USBMSD::cacheRead(uint32_t block)
+{
+    if ((block < _cache_block) || (block - _cache_block >= _cache_count)) {
+        if (!cacheFlush()) {
+            return NULL;
+        }
+
+        // A read carrying on from the blocks held fills the cache, reading
+        // ahead of the host. Other reads stop at the end of the transfer.
+        uint32_t count = (_addr % _block_size + _length + _block_size - 1) / _block_size;
+        if ((block == _cache_block + _cache_count) || (count > _page_blocks)) {
+            count = _page_blocks;
+        }
+        if (count > _block_count - block) {
+            count = _block_count - block;
+        }
+
+        _cache_count = 0;
+        if (disk_read(_page, block, count) != 0) {
+            return NULL;
+        }
+        _cache_block = block;
+        _cache_count = count;
+    }
+
+    return &_page[(block - _cache_block) * _block_size];
+}
+
+void USBMSD::cacheStartWrite()
+{
+    if (!cacheFlush()) {
+        _mem_ok = false;
+    }
+    _cache_block = _addr / _block_size;
+    _cache_count = 0;
+}
+
+bool USBMSD::cacheFlush()
+{
+    if (!_cache_dirty) {
+        return true;
+    }
+    _cache_dirty = false;
+
+    if (disk_status() & WRITE_PROTECT) {
+        return true;
+    }
+
+    if (disk_write(_page, _cache_block, _cache_count) != 0) {
+        _cache_count = 0;
+        return false;
+    }
+    return true;
+}
+
 void USBMSD::msd_reset()
 {
+    // Write any blocks still held, the host may be going away
+    cacheFlush();
     _stage = READ_CBW;
 }
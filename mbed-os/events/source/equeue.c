@@ -21,6 +21,11 @@
 #include <stdint.h>
 #include <string.h>
 
+#if defined(EQUEUE_PLATFORM_MBED) && MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+#include "platform/mbed_perf_snapshot.h"
+#define EQUEUE_PERF_SNAPSHOT 1
+#endif
+
 // check if the event is allocaded by user - event address is outside queues internal buffer address range
 #define EQUEUE_IS_USER_ALLOCATED_EVENT(e) ((q->buffer == NULL) || ((uintptr_t)(e) < (uintptr_t)q->buffer) || ((uintptr_t)(e) > ((uintptr_t)q->slab.data)))
 
@@ -498,7 +503,13 @@ void equeue_dispatch(equeue_t *q, int ms)
             // actually dispatch the callbacks
             void (*cb)(void *) = e->cb;
             if (cb) {
+#ifdef EQUEUE_PERF_SNAPSHOT
+                uint32_t record = mbed_perf_snapshot_dispatch_begin(cb, equeue_tick());
+                cb(e + 1);
+                mbed_perf_snapshot_dispatch_end(record, equeue_tick());
+#else
                 cb(e + 1);
+#endif
             }
 
             // reenqueue periodic events or deallocate
@@ -426,13 +426,10 @@ nsapi_size_or_error_t LWIP::socket_recv(nsapi_socket_t handle, void *data, nsapi
 #endif
 }
 
-nsapi_size_or_error_t LWIP::socket_sendto(nsapi_socket_t handle, const SocketAddress &address, const void *data, nsapi_size_t size)
+nsapi_error_t LWIP::convert_sendto_addr(struct mbed_lwip_socket *s, const SocketAddress &address, ip_addr_t *ip_addr)
 {
-    struct mbed_lwip_socket *s = (struct mbed_lwip_socket *)handle;
-    ip_addr_t ip_addr;
-
     nsapi_addr_t addr = address.get_addr();
-    if (!convert_mbed_addr_to_lwip(&ip_addr, &addr)) {
+    if (!convert_mbed_addr_to_lwip(ip_addr, &addr)) {
         return NSAPI_ERROR_PARAMETER;
     }
     struct netif *netif_ = netif_get_by_index(s->conn->pcb.ip->netif_idx);
@@ -445,6 +442,18 @@ nsapi_size_or_error_t LWIP::socket_sendto(nsapi_socket_t handle, const SocketAdd
             return NSAPI_ERROR_PARAMETER;
         }
     }
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t LWIP::socket_sendto(nsapi_socket_t handle, const SocketAddress &address, const void *data, nsapi_size_t size)
+{
+    struct mbed_lwip_socket *s = (struct mbed_lwip_socket *)handle;
+    ip_addr_t ip_addr;
+
+    nsapi_error_t ret = convert_sendto_addr(s, address, &ip_addr);
+    if (ret != NSAPI_ERROR_OK) {
+        return ret;
+    }
     struct netbuf *buf = netbuf_new();
 
     err_t err = netbuf_ref(buf, data, (u16_t)size);
@@ -485,6 +494,242 @@ nsapi_size_or_error_t LWIP::socket_recvfrom(nsapi_socket_t handle, SocketAddress
     return recv;
 }
 
+nsapi_size_or_error_t LWIP::socket_sendto_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    struct mbed_lwip_socket *s = (struct mbed_lwip_socket *)handle;
+
+    if (NETCONNTYPE_GROUP(s->conn->type) != NETCONN_UDP) {
+        return NetworkStack::socket_sendto_batch(handle, datagrams, count);
+    }
+
+    // Hold the core lock over the batch and go to the UDP pcb directly,
+    // rather than through a netconn API message per datagram
+    nsapi_size_or_error_t ret = NSAPI_ERROR_OK;
+    nsapi_size_t sent;
+    LOCK_TCPIP_CORE();
+    for (sent = 0; sent < count; sent++) {
+        nsapi_datagram_t *d = &datagrams[sent];
+        ip_addr_t ip_addr;
+
+        ret = convert_sendto_addr(s, d->address, &ip_addr);
+        if (ret != NSAPI_ERROR_OK) {
+            break;
+        }
+        if (d->size > 0xFFFF) {
+            ret = NSAPI_ERROR_PARAMETER;
+            break;
+        }
+
+        // Refer to the data as netbuf_ref() does for socket_sendto()
+        struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)d->size, PBUF_REF);
+        if (!p) {
+            ret = NSAPI_ERROR_NO_MEMORY;
+            break;
+        }
+        p->payload = d->data;
+
+        err_t err = udp_sendto(s->conn->pcb.udp, p, &ip_addr, d->address.get_port());
+        pbuf_free(p);
+        if (err != ERR_OK) {
+            ret = err_remap(err);
+            break;
+        }
+        d->length = d->size;
+    }
+    UNLOCK_TCPIP_CORE();
+
+    return sent ? (nsapi_size_or_error_t)sent : ret;
+}
+
+nsapi_size_or_error_t LWIP::socket_recvfrom_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    struct mbed_lwip_socket *s = (struct mbed_lwip_socket *)handle;
+
+    if (NETCONNTYPE_GROUP(s->conn->type) != NETCONN_UDP) {
+        return NetworkStack::socket_recvfrom_batch(handle, datagrams, count);
+    }
+
+    // Drain the receive mailbox in one pass. Only the first fetch waits for
+    // the receive timeout; the batch ends as soon as the mailbox is empty,
+    // where a socket_recvfrom() per datagram would wait once more.
+    err_t err = ERR_OK;
+    nsapi_size_t received;
+    for (received = 0; received < count; received++) {
+        nsapi_datagram_t *d = &datagrams[received];
+        struct netbuf *buf;
+
+        err = netconn_recv_udp_raw_netbuf_flags(s->conn, &buf, received ? NETCONN_DONTBLOCK : 0);
+        if (err != ERR_OK) {
+            break;
+        }
+
+        nsapi_addr_t addr;
+        convert_lwip_addr_to_mbed(&addr, netbuf_fromaddr(buf));
+        d->address.set_addr(addr);
+        d->address.set_port(netbuf_fromport(buf));
+
+        d->length = netbuf_copy(buf, d->data, (u16_t)d->size);
+        netbuf_delete(buf);
+    }
+
+    return received ? (nsapi_size_or_error_t)received : err_remap(err);
+}
+
+nsapi_error_t LWIP::socket_alloc_buffer(nsapi_socket_t handle, nsapi_size_t size, net_stack_mem_buf_t **buf)
+{
+    if (size > 0xFFFF) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    // One pbuf, with room in front for the headers of every layer
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)size, PBUF_RAM);
+    if (!p) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    *buf = p;
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t LWIP::socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address, net_stack_mem_buf_t *buf, nsapi_size_t offset)
+{
+    struct mbed_lwip_socket *s = (struct mbed_lwip_socket *)handle;
+    struct pbuf *p = static_cast<struct pbuf *>(buf);
+
+    if (offset > p->tot_len) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+#if LWIP_TCP
+    if (NETCONNTYPE_GROUP(s->conn->type) == NETCONN_TCP) {
+        // TCP keeps data until it is acknowledged, in segments of its own, so
+        // it is copied once here rather than from a buffer of the caller
+        size_t sent = 0;
+        u16_t q_offset;
+        struct pbuf *q = pbuf_skip(p, (u16_t)offset, &q_offset);
+        while (q) {
+            size_t written = 0;
+            u8_t flags = NETCONN_COPY | (q->next ? NETCONN_MORE : 0);
+            err_t err = netconn_write_partly(s->conn, (u8_t *)q->payload + q_offset, q->len - q_offset, flags, &written);
+            if (err != ERR_OK) {
+                if (sent == 0) {
+                    return err_remap(err);
+                }
+                break;
+            }
+            sent += written;
+            if (written < (size_t)(q->len - q_offset)) {
+                break;
+            }
+            q = q->next;
+            q_offset = 0;
+        }
+
+        if (offset + sent >= p->tot_len) {
+            pbuf_free(p);
+        }
+        return (nsapi_size_or_error_t)sent;
+    }
+#endif
+
+    // A datagram is sent whole
+    if (offset != 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    ip_addr_t ip_addr;
+    if (address) {
+        nsapi_error_t ret = convert_sendto_addr(s, *address, &ip_addr);
+        if (ret != NSAPI_ERROR_OK) {
+            return ret;
+        }
+    }
+
+    // The netbuf only lends the pbuf to lwIP, which adds the headers in front of the data
+    struct netbuf *nbuf = netbuf_new();
+    if (!nbuf) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    nbuf->p = nbuf->ptr = p;
+
+    err_t err;
+    if (address) {
+        err = netconn_sendto(s->conn, nbuf, &ip_addr, address->get_port());
+    } else {
+        err = netconn_send(s->conn, nbuf);
+    }
+    nbuf->p = nbuf->ptr = NULL;
+    netbuf_delete(nbuf);
+    if (err != ERR_OK) {
+        return err_remap(err);
+    }
+
+    nsapi_size_t size = p->tot_len;
+    pbuf_free(p);
+    return size;
+}
+
+nsapi_size_or_error_t LWIP::socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address, net_stack_mem_buf_t **buf)
+{
+    struct mbed_lwip_socket *s = (struct mbed_lwip_socket *)handle;
+    *buf = NULL;
+
+#if LWIP_TCP
+    if (NETCONNTYPE_GROUP(s->conn->type) == NETCONN_TCP) {
+        if (!s->buf) {
+            err_t err = netconn_recv_tcp_pbuf(s->conn, &s->buf);
+            s->offset = 0;
+
+            if (err != ERR_OK) {
+                return err_remap(err);
+            }
+        }
+
+        // Hand over what socket_recv() has not read yet
+        struct pbuf *p = s->buf;
+        if (s->offset) {
+            p = pbuf_free_header(p, s->offset);
+        }
+        s->buf = 0;
+        s->offset = 0;
+
+        *buf = p;
+        return p->tot_len;
+    }
+#endif
+
+    struct netbuf *nbuf;
+    err_t err = netconn_recv(s->conn, &nbuf);
+    if (err != ERR_OK) {
+        return err_remap(err);
+    }
+
+    if (address) {
+        nsapi_addr_t addr;
+        convert_lwip_addr_to_mbed(&addr, netbuf_fromaddr(nbuf));
+        address->set_addr(addr);
+        address->set_port(netbuf_fromport(nbuf));
+    }
+
+    struct pbuf *p = nbuf->p;
+    nbuf->p = nbuf->ptr = NULL;
+    netbuf_delete(nbuf);
+
+    // An empty datagram leaves the caller nothing to free
+    if (p->tot_len == 0) {
+        pbuf_free(p);
+        return 0;
+    }
+
+    *buf = p;
+    return p->tot_len;
+}
+
+NetStackMemoryManager *LWIP::get_socket_memory_manager()
+{
+    return &memory_manager;
+}
+
 int32_t LWIP::find_multicast_member(const struct mbed_lwip_socket *s, const nsapi_ip_mreq_t *imr)
 {
     uint32_t count = 0;
@@ -491,6 +491,84 @@ protected:
     virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
                                                   void *buffer, nsapi_size_t size);
 
+    /** Send a batch of packets over a UDP socket
+     *
+     *  UDP datagrams are sent to the pcb under one core lock. Other
+     *  sockets send them one at a time through socket_sendto().
+     *
+     *  @param handle    Socket handle
+     *  @param datagrams Datagrams to send
+     *  @param count     Number of datagrams
+     *  @return          Number of sent datagrams on success, negative error
+     *                   code on failure to send the first one
+     */
+    virtual nsapi_size_or_error_t socket_sendto_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams,
+                                                      nsapi_size_t count);
+
+    /** Receive a batch of packets over a UDP socket
+     *
+     *  UDP datagrams are taken from the netconn receive mailbox in one
+     *  pass, which ends without waiting once the mailbox is empty. Other
+     *  sockets receive them one at a time through socket_recvfrom().
+     *
+     *  @param handle    Socket handle
+     *  @param datagrams Destinations for the received datagrams
+     *  @param count     Number of datagrams
+     *  @return          Number of received datagrams on success, negative
+     *                   error code on failure to receive the first one
+     */
+    virtual nsapi_size_or_error_t socket_recvfrom_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams,
+                                                        nsapi_size_t count);
+
+    /** Allocate a buffer to send over a socket without copying
+     *
+     *  The buffer is a single pbuf with room for the protocol headers.
+     *
+     *  @param handle   Socket handle
+     *  @param size     Size of the buffer in bytes
+     *  @param buf      Destination for the buffer
+     *  @return         NSAPI_ERROR_OK on success, negative error code on failure
+     */
+    virtual nsapi_error_t socket_alloc_buffer(nsapi_socket_t handle, nsapi_size_t size,
+                                              net_stack_mem_buf_t **buf);
+
+    /** Send a buffer over a socket without copying
+     *
+     *  UDP sends the buffer itself, with the headers added in front of it.
+     *  TCP copies the data into its segments with NETCONN_COPY, which it
+     *  keeps until they are acknowledged: sending the buffer itself would
+     *  need it kept until then too, and netconn leaves no hook for the
+     *  acknowledgement to release it.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination address, or NULL for a connected socket
+     *  @param buf      Buffer from socket_alloc_buffer()
+     *  @param offset   Offset in the buffer of the first byte to send
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address,
+                                                     net_stack_mem_buf_t *buf, nsapi_size_t offset);
+
+    /** Receive data over a socket without copying
+     *
+     *  Passes on the pbufs received by lwIP.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination for the source address or NULL
+     *  @param buf      Destination for the received pbuf chain
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address,
+                                                     net_stack_mem_buf_t **buf);
+
+    /** Get the memory manager of zero-copy socket buffers
+     *
+     *  @return         Memory manager
+     */
+    virtual NetStackMemoryManager *get_socket_memory_manager();
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
@@ -632,6 +710,7 @@ private:
         s->multicast_memberships_registry &= ~(0x0001 << index);
     }
     static int32_t find_multicast_member(const struct mbed_lwip_socket *s, const nsapi_ip_mreq_t *imr);
+    nsapi_error_t convert_sendto_addr(struct mbed_lwip_socket *s, const SocketAddress &address, ip_addr_t *ip_addr);
 
     static void socket_callback(struct netconn *nc, enum netconn_evt eh, u16_t len);
 
@@ -15,10 +15,21 @@
  */
 
 #include "nsdynmemLIB.h"
+#include <stdint.h>
 #include <string.h>
 #include "mbed_assert.h"
+#include "mbed_critical.h"
+#include "mbed_toolchain.h"
 #include "NanostackMemoryManager.h"
 
+#ifndef MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNIT_SIZE
+#define MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNIT_SIZE 1536
+#endif
+
+#ifndef MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS
+#define MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS 0
+#endif
+
 struct ns_stack_mem_t {
     ns_stack_mem_t *next;
     void *payload;
@@ -26,6 +37,46 @@ struct ns_stack_mem_t {
     uint8_t mem[];
 };
 
+#if MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS
+
+// Each pool unit is a buffer header followed by the payload, both padded so
+// that every payload starts POOL_ALIGN aligned
+#define POOL_ALIGN          8
+#define POOL_ROUND(x)       (((x) + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1))
+#define POOL_HEADER_SIZE    POOL_ROUND(sizeof(ns_stack_mem_t))
+#define POOL_UNIT_SIZE      POOL_ROUND(MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNIT_SIZE)
+#define POOL_STRIDE         (POOL_HEADER_SIZE + POOL_UNIT_SIZE)
+
+// Shared by all memory managers. Units are handed out from the end of the
+// untouched part first, so the pool needs no initialisation, and then from
+// the free list. Both are O(1) under a critical section, so buffers can be
+// allocated and freed from interrupts.
+MBED_ALIGN(POOL_ALIGN) static uint8_t pool_mem[MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS * POOL_STRIDE];
+static ns_stack_mem_t *pool_free_list;
+static uint32_t pool_untouched = MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS;
+static uint32_t pool_available = MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS;
+
+static bool pool_contains(const ns_stack_mem_t *mem)
+{
+    const uint8_t *ptr = reinterpret_cast<const uint8_t *>(mem);
+    return ptr >= pool_mem && ptr < pool_mem + sizeof pool_mem;
+}
+
+// Called in a critical section, with a unit known to be available
+static ns_stack_mem_t *pool_take()
+{
+    ns_stack_mem_t *mem = pool_free_list;
+    if (mem) {
+        pool_free_list = mem->next;
+    } else {
+        pool_untouched--;
+        mem = reinterpret_cast<ns_stack_mem_t *>(pool_mem + pool_untouched * POOL_STRIDE);
+    }
+    return mem;
+}
+
+#endif
+
 emac_mem_buf_t *NanostackMemoryManager::alloc_heap(uint32_t size, uint32_t align)
 {
     ns_stack_mem_t *buf = static_cast<ns_stack_mem_t *>(ns_dyn_mem_temporary_alloc(sizeof(ns_stack_mem_t) + size + align));
@@ -38,7 +89,7 @@ emac_mem_buf_t *NanostackMemoryManager::alloc_heap(uint32_t size, uint32_t align
     buf->len = size;
 
     if (align) {
-        uint32_t remainder = reinterpret_cast<uint32_t>(buf->payload) % align;
+        uint32_t remainder = reinterpret_cast<uintptr_t>(buf->payload) % align;
         if (remainder) {
             uint32_t offset = align - remainder;
             if (offset >= align) {
@@ -54,17 +105,77 @@ emac_mem_buf_t *NanostackMemoryManager::alloc_heap(uint32_t size, uint32_t align
 
 emac_mem_buf_t *NanostackMemoryManager::alloc_pool(uint32_t size, uint32_t align)
 {
+#if MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS
+    uint32_t unit = get_pool_alloc_unit(align);
+    uint32_t count = size ? (size + unit - 1) / unit : 1;
+    ns_stack_mem_t *head = NULL;
+
+    core_util_critical_section_enter();
+    if (count <= pool_available) {
+        pool_available -= count;
+        for (uint32_t i = 0; i < count; i++) {
+            ns_stack_mem_t *mem = pool_take();
+            mem->next = head;
+            head = mem;
+        }
+    }
+    core_util_critical_section_exit();
+
+    if (head) {
+        uint32_t remaining = size;
+        for (ns_stack_mem_t *mem = head; mem; mem = mem->next) {
+            uintptr_t payload = reinterpret_cast<uintptr_t>(mem) + POOL_HEADER_SIZE;
+            if (align > POOL_ALIGN) {
+                payload = (payload + align - 1) & ~static_cast<uintptr_t>(align - 1);
+            }
+            mem->payload = reinterpret_cast<void *>(payload);
+            mem->len = remaining < unit ? remaining : unit;
+            remaining -= mem->len;
+        }
+        return static_cast<emac_mem_buf_t *>(head);
+    }
+#endif
+
+    // Pool disabled or exhausted
     return alloc_heap(size, align);
 }
 
 uint32_t NanostackMemoryManager::get_pool_alloc_unit(uint32_t align) const
 {
-    return 1536; // arbitrary nicely-aligned number big enough for Ethernet
+#if MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS
+    // Payloads start POOL_ALIGN aligned, so a larger alignment costs at
+    // most the difference
+    if (align > POOL_ALIGN) {
+        MBED_ASSERT(align - POOL_ALIGN < POOL_UNIT_SIZE);
+        return POOL_UNIT_SIZE - (align - POOL_ALIGN);
+    }
+    return POOL_UNIT_SIZE;
+#else
+    // Heap buffers are contiguous, so this is only the size drivers use
+    return MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNIT_SIZE;
+#endif
 }
 
-void NanostackMemoryManager::free(emac_mem_buf_t *mem)
+void NanostackMemoryManager::free(emac_mem_buf_t *buf)
 {
-    ns_dyn_mem_free(mem);
+    ns_stack_mem_t *mem = static_cast<ns_stack_mem_t *>(buf);
+
+    while (mem) {
+        ns_stack_mem_t *next = mem->next;
+#if MBED_CONF_NANOSTACK_INTERFACE_MEMORY_POOL_UNITS
+        if (pool_contains(mem)) {
+            core_util_critical_section_enter();
+            mem->next = pool_free_list;
+            pool_free_list = mem;
+            pool_available++;
+            core_util_critical_section_exit();
+        } else
+#endif
+        {
+            ns_dyn_mem_free(mem);
+        }
+        mem = next;
+    }
 }
 
 uint32_t NanostackMemoryManager::get_total_len(const emac_mem_buf_t *buf) const
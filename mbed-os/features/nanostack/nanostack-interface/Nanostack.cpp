@@ -47,6 +47,7 @@
 #define NANOSTACK_ISDIGIT(c)    ((c) >= '0' && (c) <= '9')
 
 #define NS_INTERFACE_SOCKETS_MAX  16  //same as NanoStack SOCKET_MAX
+#define NANOSTACK_SOCKET_BUFFER_IOV  8  //segments of a zero-copy buffer per sendmsg/recvmsg
 
 #define MALLOC  ns_dyn_mem_alloc
 #define FREE    ns_dyn_mem_free
@@ -723,6 +724,14 @@ nsapi_error_t Nanostack::socket_close(void *handle)
 }
 
 nsapi_size_or_error_t Nanostack::do_sendto(void *handle, const ns_address_t *address, const void *data, nsapi_size_t size)
+{
+    ns_iovec_t iov;
+    iov.iov_base = const_cast<void *>(data);
+    iov.iov_len = size;
+    return do_sendmsg(handle, address, &iov, 1);
+}
+
+nsapi_size_or_error_t Nanostack::do_sendmsg(void *handle, const ns_address_t *address, ns_iovec_t *iov, uint_fast16_t iovlen)
 {
     // Validate parameters
     NanostackSocket *socket = static_cast<NanostackSocket *>(handle);
@@ -747,27 +756,20 @@ nsapi_size_or_error_t Nanostack::do_sendto(void *handle, const ns_address_t *add
     }
 
     int retcode;
-#if 0
-    retcode = ::socket_sendto(socket->socket_id, address,
-                              data, size);
-#else
-    // Use sendmsg purely to get the new return style
+    // Use sendmsg to get the new return style
     // of returning data written rather than 0 on success,
     // which means TCP can do partial writes. (Sadly,
     // it's the only call which takes flags so we can
-    // leave the NS_MSG_LEGACY0 flag clear).
+    // leave the NS_MSG_LEGACY0 flag clear). It also
+    // takes the segments of a buffer chain.
     ns_msghdr_t msg;
-    ns_iovec_t iov;
-    iov.iov_base = const_cast<void *>(data);
-    iov.iov_len = size;
     msg.msg_name = const_cast<ns_address_t *>(address);
     msg.msg_namelen = address ? sizeof * address : 0;
-    msg.msg_iov = &iov;
-    msg.msg_iovlen = 1;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovlen;
     msg.msg_control = NULL;
     msg.msg_controllen = 0;
     retcode = ::socket_sendmsg(socket->socket_id, &msg, 0);
-#endif
 
     /*
      * \return length if entire amount written (which could be 0)
@@ -873,6 +875,179 @@ out:
     return ret;
 }
 
+nsapi_error_t Nanostack::socket_alloc_buffer(void *handle, nsapi_size_t size, net_stack_mem_buf_t **buf)
+{
+    *buf = memory_manager.alloc_pool(size ? size : 1, 0);
+    if (!*buf) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    if (!size) {
+        memory_manager.set_len(*buf, 0);
+    }
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t Nanostack::socket_send_buffer(void *handle, const SocketAddress *address, net_stack_mem_buf_t *buf, nsapi_size_t offset)
+{
+    NanostackSocket *socket = static_cast<NanostackSocket *>(handle);
+    if (handle == NULL) {
+        MBED_ASSERT(false);
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    ns_address_t ns_address;
+    if (address) {
+        if (address->get_ip_version() != NSAPI_IPv6) {
+            return NSAPI_ERROR_PARAMETER;
+        }
+        convert_mbed_addr_to_ns(&ns_address, address);
+    }
+
+    // Nanostack copies the segments into its own buffer, as it does for socket_send()
+    ns_iovec_t iov[NANOSTACK_SOCKET_BUFFER_IOV];
+    uint_fast16_t iovlen = 0;
+    nsapi_size_t size = 0;
+    bool whole = true;
+    for (net_stack_mem_buf_t *seg = buf; seg; seg = memory_manager.get_next(seg)) {
+        uint32_t len = memory_manager.get_len(seg);
+        if (offset >= len) {
+            offset -= len;
+            continue;
+        }
+        if (iovlen == NANOSTACK_SOCKET_BUFFER_IOV) {
+            // Streams send the rest later, datagrams have to go whole
+            if (socket->proto != SOCKET_TCP) {
+                return NSAPI_ERROR_PARAMETER;
+            }
+            whole = false;
+            break;
+        }
+        iov[iovlen].iov_base = static_cast<uint8_t *>(memory_manager.get_ptr(seg)) + offset;
+        iov[iovlen].iov_len = len - offset;
+        size += len - offset;
+        offset = 0;
+        iovlen++;
+    }
+    if (offset) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    /*No lock gaurd needed here as do_sendmsg() will handle locks.*/
+    nsapi_size_or_error_t ret = do_sendmsg(handle, address ? &ns_address : NULL, iov, iovlen);
+    if (whole && ret >= 0 && (nsapi_size_t)ret == size) {
+        memory_manager.free(buf);
+    }
+    return ret;
+}
+
+nsapi_size_or_error_t Nanostack::socket_recv_buffer(void *handle, SocketAddress *address, net_stack_mem_buf_t **buf)
+{
+    // Validate parameters
+    NanostackSocket *socket = static_cast<NanostackSocket *>(handle);
+    if (handle == NULL) {
+        MBED_ASSERT(false);
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    nsapi_size_or_error_t ret;
+    net_stack_mem_buf_t *mem = NULL;
+    *buf = NULL;
+
+    NanostackLockGuard lock;
+
+    if (socket->closed()) {
+        ret = NSAPI_ERROR_NO_CONNECTION;
+        goto out;
+    }
+
+    {
+        // A datagram is sized by peeking at it, a stream is read a pool unit at a time
+        nsapi_size_t size;
+        if (socket->proto == SOCKET_TCP) {
+            size = memory_manager.get_pool_alloc_unit(0);
+        } else {
+            int16_t peeked = ::socket_recvfrom(socket->socket_id, NULL, 0, NS_MSG_PEEK | NS_MSG_TRUNC, NULL);
+            if (peeked == NS_EWOULDBLOCK) {
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                goto out;
+            } else if (peeked < 0) {
+                ret = NSAPI_ERROR_PARAMETER;
+                goto out;
+            }
+            size = peeked;
+        }
+
+        // A chain longer than the iovec array is taken from the heap in one piece
+        if (size > NANOSTACK_SOCKET_BUFFER_IOV * memory_manager.get_pool_alloc_unit(0)) {
+            mem = memory_manager.alloc_heap(size, 0);
+        } else {
+            mem = memory_manager.alloc_pool(size ? size : 1, 0);
+        }
+        if (!mem) {
+            ret = NSAPI_ERROR_NO_MEMORY;
+            goto out;
+        }
+
+        // Nanostack copies out of its own buffer, as it does for socket_recv()
+        ns_iovec_t iov[NANOSTACK_SOCKET_BUFFER_IOV];
+        uint_fast16_t iovlen = 0;
+        for (net_stack_mem_buf_t *seg = mem; seg && iovlen < NANOSTACK_SOCKET_BUFFER_IOV; seg = memory_manager.get_next(seg)) {
+            iov[iovlen].iov_base = memory_manager.get_ptr(seg);
+            iov[iovlen].iov_len = memory_manager.get_len(seg);
+            iovlen++;
+        }
+
+        ns_address_t ns_address;
+        ns_msghdr_t msg;
+        msg.msg_name = &ns_address;
+        msg.msg_namelen = sizeof ns_address;
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovlen;
+        msg.msg_control = NULL;
+        msg.msg_controllen = 0;
+        int16_t retcode = ::socket_recvmsg(socket->socket_id, &msg, 0);
+
+        if (retcode == NS_EWOULDBLOCK) {
+            ret = NSAPI_ERROR_WOULD_BLOCK;
+        } else if (retcode < 0) {
+            ret = NSAPI_ERROR_PARAMETER;
+        } else {
+            ret = retcode;
+            if (address != NULL) {
+                convert_ns_addr_to_mbed(address, &ns_address);
+            }
+
+            // Cut the chain down to the data received
+            nsapi_size_t remaining = retcode;
+            for (net_stack_mem_buf_t *seg = mem; seg; seg = memory_manager.get_next(seg)) {
+                uint32_t len = memory_manager.get_len(seg);
+                if (len > remaining) {
+                    memory_manager.set_len(seg, remaining);
+                }
+                remaining -= remaining < len ? remaining : len;
+            }
+            // An empty datagram or end of stream is freed below
+            if (retcode > 0) {
+                *buf = mem;
+                mem = NULL;
+            }
+        }
+    }
+
+out:
+    if (mem) {
+        memory_manager.free(mem);
+    }
+    tr_debug("socket_recv_buffer(socket=%p) sock_id=%d, ret=%i", socket, socket->socket_id, ret);
+
+    return ret;
+}
+
+NetStackMemoryManager *Nanostack::get_socket_memory_manager()
+{
+    return &memory_manager;
+}
+
 nsapi_error_t Nanostack::socket_bind(void *handle, const SocketAddress &address)
 {
     // Validate parameters
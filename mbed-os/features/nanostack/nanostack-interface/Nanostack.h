@@ -25,6 +25,7 @@
 #include "eventOS_event.h"
 
 struct ns_address;
+struct ns_iovec;
 
 class Nanostack : public OnboardNetworkStack, private mbed::NonCopyable<Nanostack> {
 public:
@@ -261,6 +262,50 @@ protected:
      */
     virtual nsapi_size_or_error_t socket_recvfrom(void *handle, SocketAddress *address, void *buffer, nsapi_size_t size);
 
+    /** Allocate a buffer to send over a socket without copying
+     *
+     *  The buffer comes from the memory manager's pool.
+     *
+     *  @param handle   Socket handle
+     *  @param size     Size of the buffer in bytes
+     *  @param buf      Destination for the buffer
+     *  @return         NSAPI_ERROR_OK on success, negative error code on failure
+     */
+    virtual nsapi_error_t socket_alloc_buffer(void *handle, nsapi_size_t size, net_stack_mem_buf_t **buf);
+
+    /** Send a buffer over a socket without copying
+     *
+     *  The segments of the buffer are passed to socket_sendmsg(), which
+     *  copies them into a Nanostack buffer as for socket_send().
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination address, or NULL for a connected socket
+     *  @param buf      Buffer from socket_alloc_buffer()
+     *  @param offset   Offset in the buffer of the first byte to send
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_send_buffer(void *handle, const SocketAddress *address, net_stack_mem_buf_t *buf, nsapi_size_t offset);
+
+    /** Receive data over a socket without copying
+     *
+     *  Data is read with socket_recvmsg() into a buffer from the memory
+     *  manager's pool, sized to the datagram for UDP.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination for the source address or NULL
+     *  @param buf      Destination for the received buffer chain
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recv_buffer(void *handle, SocketAddress *address, net_stack_mem_buf_t **buf);
+
+    /** Get the memory manager of zero-copy socket buffers
+     *
+     *  @return         Memory manager
+     */
+    virtual NetStackMemoryManager *get_socket_memory_manager();
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
@@ -344,6 +389,7 @@ private:
     };
 
     nsapi_size_or_error_t do_sendto(void *handle, const struct ns_address *address, const void *data, nsapi_size_t size);
+    nsapi_size_or_error_t do_sendmsg(void *handle, const struct ns_address *address, struct ns_iovec *iov, uint_fast16_t iovlen);
     static void call_event_tasklet_main(arm_event_s *event);
     char text_ip_address[40];
     NanostackMemoryManager memory_manager;
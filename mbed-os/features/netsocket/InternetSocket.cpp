@@ -15,6 +15,7 @@
  */
 
 #include "InternetSocket.h"
+#include "NetStackMemoryManager.h"
 #include "platform/mbed_critical.h"
 #include "platform/Callback.h"
 
@@ -24,7 +25,7 @@ InternetSocket::InternetSocket()
     : _stack(0), _socket(0), _timeout(osWaitForever),
       _remote_peer(),
       _readers(0), _writers(0),
-      _factory_allocated(false)
+      _factory_allocated(false), _buffer_manager(NULL)
 {
     core_util_atomic_flag_clear(&_pending);
     _socket_stats.stats_new_socket_entry(this);
@@ -281,3 +282,188 @@ nsapi_error_t InternetSocket::getpeername(SocketAddress *address)
     *address = _remote_peer;
     return NSAPI_ERROR_OK;
 }
+
+NetStackMemoryManager *InternetSocket::buffer_manager()
+{
+    _lock.lock();
+    NetStackMemoryManager *manager = NULL;
+
+    if (_socket) {
+        manager = _stack->get_socket_memory_manager();
+    }
+
+    _lock.unlock();
+    return manager;
+}
+
+nsapi_error_t InternetSocket::send_acquire(nsapi_size_t size, net_stack_mem_buf_t **buf)
+{
+    _lock.lock();
+    nsapi_error_t ret;
+
+    if (!_socket) {
+        ret = NSAPI_ERROR_NO_SOCKET;
+    } else {
+        ret = _stack->socket_alloc_buffer(_socket, size, buf);
+        if (ret == NSAPI_ERROR_OK) {
+            _buffer_manager = _stack->get_socket_memory_manager();
+        }
+    }
+
+    _lock.unlock();
+    return ret;
+}
+
+nsapi_size_or_error_t InternetSocket::send_commit(net_stack_mem_buf_t *buf, nsapi_size_t offset)
+{
+    // Datagram sockets are connected only on this side, so they are given the peer
+    return commit_buffer(_remote_peer ? &_remote_peer : NULL, buf, offset);
+}
+
+nsapi_size_or_error_t InternetSocket::sendto_commit(const SocketAddress &address, net_stack_mem_buf_t *buf)
+{
+    return commit_buffer(&address, buf, 0);
+}
+
+nsapi_size_or_error_t InternetSocket::commit_buffer(const SocketAddress *address, net_stack_mem_buf_t *buf, nsapi_size_t offset)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+    nsapi_size_t written = 0;
+
+    // If this assert is hit then there are two threads
+    // performing a send at the same time which is undefined
+    // behavior
+    MBED_ASSERT(_writers == 0);
+    _writers++;
+
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        _buffer_manager = _stack->get_socket_memory_manager();
+        if (!_buffer_manager) {
+            ret = NSAPI_ERROR_UNSUPPORTED;
+            break;
+        }
+
+        core_util_atomic_flag_clear(&_pending);
+        nsapi_size_t remaining = _buffer_manager->get_total_len(buf) - offset - written;
+        ret = _stack->socket_send_buffer(_socket, address, buf, offset + written);
+        if (ret >= 0) {
+            written += ret;
+            if ((nsapi_size_t)ret >= remaining) {
+                // The stack owns the buffer now
+                break;
+            }
+        }
+        if (_timeout == 0) {
+            break;
+        } else if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+            uint32_t flag;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            flag = _event_flag.wait_any(WRITE_FLAG, _timeout);
+            _lock.lock();
+
+            if (flag & osFlagsError) {
+                // Timeout break
+                break;
+            }
+        } else if (ret < 0) {
+            break;
+        }
+    }
+
+    _writers--;
+    if (!_socket) {
+        _event_flag.set(FINISHED_FLAG);
+    }
+
+    _lock.unlock();
+    // Report any progress, so that the caller knows where to commit from again
+    if (written == 0 && ret < 0) {
+        return ret;
+    }
+    _socket_stats.stats_update_sent_bytes(this, written);
+    return written;
+}
+
+nsapi_size_or_error_t InternetSocket::receive_acquire(net_stack_mem_buf_t **buf, SocketAddress *address)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+    SocketAddress from;
+    *buf = NULL;
+
+    // If this assert is hit then there are two threads
+    // performing a recv at the same time which is undefined
+    // behavior
+    MBED_ASSERT(_readers == 0);
+    _readers++;
+
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        core_util_atomic_flag_clear(&_pending);
+        from = _remote_peer;
+        ret = _stack->socket_recv_buffer(_socket, &from, buf);
+
+        // Filter incoming datagrams using connected peer address
+        if (ret >= 0) {
+            _buffer_manager = _stack->get_socket_memory_manager();
+            if (get_proto() != NSAPI_TCP && _remote_peer && _remote_peer != from) {
+                buffer_release(*buf);
+                *buf = NULL;
+                continue;
+            }
+        }
+
+        if ((_timeout == 0) || (ret != NSAPI_ERROR_WOULD_BLOCK)) {
+            if (ret >= 0) {
+                _socket_stats.stats_update_recv_bytes(this, ret);
+            }
+            break;
+        } else {
+            uint32_t flag;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            flag = _event_flag.wait_any(READ_FLAG, _timeout);
+            _lock.lock();
+
+            if (flag & osFlagsError) {
+                // Timeout break
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _readers--;
+    if (!_socket) {
+        _event_flag.set(FINISHED_FLAG);
+    }
+
+    _lock.unlock();
+    if (ret >= 0 && address) {
+        *address = from;
+    }
+    return ret;
+}
+
+void InternetSocket::buffer_release(net_stack_mem_buf_t *buf)
+{
+    // The manager is kept past close(), so buffers can be given back after it
+    if (_buffer_manager && buf) {
+        _buffer_manager->free(buf);
+    }
+}
@@ -194,10 +194,86 @@ public:
         attach(mbed::callback(obj, method));
     }
 
+    /** Get the memory manager of the socket's zero-copy buffers.
+     *
+     *  Buffers from send_acquire() are filled, and buffers from
+     *  receive_acquire() read, through this memory manager.
+     *
+     *  @return         Memory manager, or NULL if the socket is not open or
+     *                  the stack has no zero-copy sockets.
+     */
+    NetStackMemoryManager *buffer_manager();
+
+    /** Acquire a stack buffer to send without copying.
+     *
+     *  The buffer, which may be a chain, is filled through buffer_manager()
+     *  and then passed to send_commit() or sendto_commit(), or given back
+     *  with buffer_release().
+     *
+     *  @param size     Size of the buffer in bytes.
+     *  @param buf      Destination for the buffer.
+     *  @retval         NSAPI_ERROR_OK on success.
+     *  @retval         NSAPI_ERROR_NO_SOCKET if socket is not open.
+     *  @retval         NSAPI_ERROR_UNSUPPORTED if the stack has no zero-copy sockets.
+     *  @retval         int other negative error codes for stack-related failures.
+     *                  See @ref NetworkStack::socket_alloc_buffer.
+     */
+    nsapi_error_t send_acquire(nsapi_size_t size, net_stack_mem_buf_t **buf);
+
+    /** Send a buffer from send_acquire() to the connected peer.
+     *
+     *  Blocks like send() until the data of the buffer from the offset is
+     *  sent. The stack then owns the buffer. If less was sent, because of an
+     *  error or timeout, the buffer stays with the caller, which can commit
+     *  it again with the offset moved on by the returned count.
+     *
+     *  @note Over TCP, lwIP copies the data once into its own segments, which
+     *  it keeps until they are acknowledged, so only datagrams are sent
+     *  without any copy.
+     *
+     *  @param buf      Buffer from send_acquire().
+     *  @param offset   Offset in the buffer of the first byte to send.
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure. See @ref NetworkStack::socket_send_buffer.
+     */
+    nsapi_size_or_error_t send_commit(net_stack_mem_buf_t *buf, nsapi_size_t offset = 0);
+
+    /** Send a buffer from send_acquire() to an address.
+     *
+     *  As send_commit(), for unconnected datagram sockets.
+     *
+     *  @param address  Remote address.
+     *  @param buf      Buffer from send_acquire().
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure. See @ref NetworkStack::socket_send_buffer.
+     */
+    nsapi_size_or_error_t sendto_commit(const SocketAddress &address, net_stack_mem_buf_t *buf);
+
+    /** Receive data in the stack's own buffers, without copying.
+     *
+     *  Blocks like recv() until data is received. The received chain is
+     *  read through buffer_manager() and given back with buffer_release().
+     *  A datagram socket receives one datagram.
+     *
+     *  @param buf      Destination for the received buffer chain, set to
+     *                  NULL when the return value is 0 or less.
+     *  @param address  Destination for the source address or NULL.
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure. See @ref NetworkStack::socket_recv_buffer.
+     */
+    nsapi_size_or_error_t receive_acquire(net_stack_mem_buf_t **buf, SocketAddress *address = NULL);
+
+    /** Give back a buffer from send_acquire() or receive_acquire().
+     *
+     *  @param buf      Buffer to free.
+     */
+    void buffer_release(net_stack_mem_buf_t *buf);
+
 #if !defined(DOXYGEN_ONLY)
 
 protected:
     InternetSocket();
+    nsapi_size_or_error_t commit_buffer(const SocketAddress *address, net_stack_mem_buf_t *buf, nsapi_size_t offset);
     virtual nsapi_protocol_t get_proto() = 0;
     virtual void event();
     int modify_multicast_group(const SocketAddress &address, nsapi_socket_option_t socketopt);
@@ -222,6 +298,7 @@ protected:
 
     friend class DTLSSocket;  // Allow DTLSSocket::connect() to do name resolution on the _stack
     SocketStats _socket_stats;
+    NetStackMemoryManager *_buffer_manager;
 
 #endif //!defined(DOXYGEN_ONLY)
 };
@@ -143,6 +143,57 @@ nsapi_error_t NetworkStack::getsockopt(void *handle, int level, int optname, voi
     return NSAPI_ERROR_UNSUPPORTED;
 }
 
+nsapi_size_or_error_t NetworkStack::socket_sendto_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    nsapi_size_t sent;
+    for (sent = 0; sent < count; sent++) {
+        nsapi_size_or_error_t ret = socket_sendto(handle, datagrams[sent].address,
+                                                  datagrams[sent].data, datagrams[sent].size);
+        if (ret < 0) {
+            return sent ? (nsapi_size_or_error_t)sent : ret;
+        }
+        datagrams[sent].length = ret;
+    }
+    return sent;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recvfrom_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    nsapi_size_t received;
+    for (received = 0; received < count; received++) {
+        nsapi_size_or_error_t ret = socket_recvfrom(handle, &datagrams[received].address,
+                                                    datagrams[received].data, datagrams[received].size);
+        if (ret < 0) {
+            return received ? (nsapi_size_or_error_t)received : ret;
+        }
+        datagrams[received].length = ret;
+    }
+    return received;
+}
+
+nsapi_error_t NetworkStack::socket_alloc_buffer(nsapi_socket_t handle, nsapi_size_t size, net_stack_mem_buf_t **buf)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address,
+                                                       net_stack_mem_buf_t *buf, nsapi_size_t offset)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address,
+                                                       net_stack_mem_buf_t **buf)
+{
+    *buf = NULL;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+NetStackMemoryManager *NetworkStack::get_socket_memory_manager()
+{
+    return NULL;
+}
+
 nsapi_error_t NetworkStack::call_in(int delay, mbed::Callback<void()> func)
 {
     static events::EventQueue *event_queue = mbed::mbed_event_queue();
@@ -29,6 +29,17 @@
 
 // Predeclared classes
 class OnboardNetworkStack;
+class NetStackMemoryManager;
+typedef void net_stack_mem_buf_t;
+
+/** Datagram of a batch, for sendto_batch() and recvfrom_batch()
+ */
+struct nsapi_datagram_t {
+    SocketAddress address;  /*!< Destination address, or source address of a received datagram */
+    void *data;             /*!< Data to send, or destination buffer for received data */
+    nsapi_size_t size;      /*!< Size of the data, or of the destination buffer */
+    nsapi_size_t length;    /*!< Number of bytes sent or received */
+};
 
 /** NetworkStack class
  *
@@ -207,6 +218,7 @@ protected:
     friend class InternetDatagramSocket;
     friend class TCPSocket;
     friend class TCPServer;
+    friend class UDPSocket;
 
     /** Opens a socket
      *
@@ -357,6 +369,115 @@ protected:
     virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
                                                   void *buffer, nsapi_size_t size) = 0;
 
+    /** Send a batch of packets over a UDP socket
+     *
+     *  Sends the datagrams in order, each to its own address, until one
+     *  fails. The number of bytes sent of each datagram is stored in its
+     *  length.
+     *
+     *  The default implementation calls socket_sendto() for each datagram.
+     *  Stacks override it to send the whole batch with one call into the
+     *  stack.
+     *
+     *  This call is non-blocking. If sendto would block before any
+     *  datagram is sent, NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle    Socket handle
+     *  @param datagrams Datagrams to send
+     *  @param count     Number of datagrams
+     *  @return          Number of sent datagrams on success, negative error
+     *                   code on failure to send the first one
+     */
+    virtual nsapi_size_or_error_t socket_sendto_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams,
+                                                      nsapi_size_t count);
+
+    /** Receive a batch of packets over a UDP socket
+     *
+     *  Receives the datagrams that are waiting, up to count. The source
+     *  address and the number of bytes received of each datagram are
+     *  stored in its address and length.
+     *
+     *  The default implementation calls socket_recvfrom() until it would
+     *  block. Stacks override it to take the waiting datagrams in one pass.
+     *
+     *  This call is non-blocking. If no datagram is waiting,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle    Socket handle
+     *  @param datagrams Destinations for the received datagrams
+     *  @param count     Number of datagrams
+     *  @return          Number of received datagrams on success, negative
+     *                   error code on failure to receive the first one
+     */
+    virtual nsapi_size_or_error_t socket_recvfrom_batch(nsapi_socket_t handle, nsapi_datagram_t *datagrams,
+                                                        nsapi_size_t count);
+
+    /** Allocate a buffer to send over a socket without copying
+     *
+     *  The buffer is filled through the memory manager returned by
+     *  get_socket_memory_manager(), then sent with socket_send_buffer() or
+     *  freed through the memory manager.
+     *
+     *  @param handle   Socket handle
+     *  @param size     Size of the buffer in bytes
+     *  @param buf      Destination for the buffer, which may be a chain
+     *  @return         NSAPI_ERROR_OK on success, NSAPI_ERROR_UNSUPPORTED if
+     *                  the stack has no zero-copy sockets, negative error
+     *                  code on other failures
+     */
+    virtual nsapi_error_t socket_alloc_buffer(nsapi_socket_t handle, nsapi_size_t size,
+                                              net_stack_mem_buf_t **buf);
+
+    /** Send a buffer over a socket without copying
+     *
+     *  Sends the data of the buffer from the offset to its end. The stack
+     *  takes the buffer once it has taken all of that data, and otherwise
+     *  leaves it with the caller. Only stream sockets take part of the data.
+     *
+     *  A stack may still copy the data of stream sockets once, into segments
+     *  it keeps until they are acknowledged, as lwIP does for TCP. Only the
+     *  copy from a buffer of the caller into the stack's buffer is saved.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination address, or NULL for a connected socket
+     *  @param buf      Buffer from socket_alloc_buffer()
+     *  @param offset   Offset in the buffer of the first byte to send
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_send_buffer(nsapi_socket_t handle, const SocketAddress *address,
+                                                     net_stack_mem_buf_t *buf, nsapi_size_t offset);
+
+    /** Receive data over a socket without copying
+     *
+     *  Passes received data to the caller in the stack's own buffers, which
+     *  are read and freed through the memory manager returned by
+     *  get_socket_memory_manager(). A datagram socket receives one datagram.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination for the source address or NULL
+     *  @param buf      Destination for the received buffer chain, set to
+     *                  NULL when no bytes are received, so that nothing is
+     *                  left to free when the return value is 0 or less
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t handle, SocketAddress *address,
+                                                     net_stack_mem_buf_t **buf);
+
+    /** Get the memory manager of zero-copy socket buffers
+     *
+     *  @return         Memory manager, or NULL if the stack has no zero-copy
+     *                  sockets
+     */
+    virtual NetStackMemoryManager *get_socket_memory_manager();
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
@@ -412,6 +533,9 @@ private:
       */
     typedef mbed::Callback<nsapi_error_t (int delay_ms, mbed::Callback<void()> user_cb)> call_in_callback_cb_t;
 
+    /* Lets DNS refresh cached addresses for blocking lookups in the stack context */
+    friend call_in_callback_cb_t nsapi_dns_get_call_in_callback(NetworkStack *stack);
+
     /** Get a call in callback
      *
      *  Get a call in callback from the network stack context.
@@ -26,8 +26,10 @@
 
 #if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
 SingletonPtr<PlatformMutex> SocketStats::_mutex;
-mbed_stats_socket_t SocketStats::_stats[MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT];
+SocketStats::socket_entry_t SocketStats::_stats[MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT];
 uint32_t SocketStats::_size = 0;
+mbed::StatCounter SocketStats::_total_sent_bytes("socket.sent_bytes");
+mbed::StatCounter SocketStats::_total_recv_bytes("socket.recv_bytes");
 
 int SocketStats::get_entry_position(const Socket *const reference_id)
 {
@@ -38,6 +40,30 @@ int SocketStats::get_entry_position(const Socket *const reference_id)
     }
     return -1;
 }
+
+SocketStats::socket_entry_t *SocketStats::get_entry(const Socket *const reference_id)
+{
+    // An entry is only reused once its socket is closed, so the cached
+    // position is valid for as long as it still names this socket
+    if ((_position >= 0) && (_stats[_position].reference_id == reference_id)) {
+        return &_stats[_position];
+    }
+    _mutex->lock();
+    int position = get_entry_position(reference_id);
+    _mutex->unlock();
+    return (position >= 0) ? &_stats[position] : NULL;
+}
+
+void SocketStats::reset_entry(socket_entry_t &entry)
+{
+    entry.reference_id = NULL;
+    entry.peer = SocketAddress();
+    entry.state = SOCK_CLOSED;
+    entry.proto = NSAPI_TCP;
+    entry.sent_bytes.reset();
+    entry.recv_bytes.reset();
+    entry.last_change_tick = 0;
+}
 #endif
 
 size_t SocketStats::mbed_stats_socket_get_each(mbed_stats_socket_t *stats, size_t count)
@@ -47,9 +73,15 @@ size_t SocketStats::mbed_stats_socket_get_each(mbed_stats_socket_t *stats, size_
 #if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
     memset(stats, 0, count * sizeof(mbed_stats_socket_t));
     _mutex->lock();
-    for (uint32_t j = 0; j < count; j++) {
+    for (uint32_t j = 0; j < _size && i < count; j++) {
         if (_stats[j].reference_id) {
-            memcpy(&stats[i], &_stats[j], sizeof(mbed_stats_socket_t));
+            stats[i].reference_id = _stats[j].reference_id;
+            stats[i].peer = _stats[j].peer;
+            stats[i].state = _stats[j].state;
+            stats[i].proto = _stats[j].proto;
+            stats[i].sent_bytes = _stats[j].sent_bytes.value();
+            stats[i].recv_bytes = _stats[j].recv_bytes.value();
+            stats[i].last_change_tick = _stats[j].last_change_tick;
             i++;
         }
     }
@@ -59,6 +91,9 @@ size_t SocketStats::mbed_stats_socket_get_each(mbed_stats_socket_t *stats, size_
 }
 
 SocketStats::SocketStats()
+#if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
+    : _position(-1)
+#endif
 {
 }
 
@@ -68,10 +103,11 @@ void SocketStats::stats_new_socket_entry(const Socket *const reference_id)
     _mutex->lock();
     if (get_entry_position(reference_id) >= 0) {
         // Duplicate entry
-        MBED_WARNING1(MBED_MAKE_ERROR(MBED_MODULE_NETWORK_STATS, MBED_ERROR_CODE_INVALID_INDEX), "Duplicate socket Reference ID ", reference_id);
+        MBED_WARNING1(MBED_MAKE_ERROR(MBED_MODULE_NETWORK_STATS, MBED_ERROR_CODE_INVALID_INDEX), "Duplicate socket Reference ID ", (uintptr_t)reference_id);
     } else if (_size < MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT) {
         // Add new entry
         _stats[_size].reference_id = (Socket *)reference_id;
+        _position = _size;
         _size++;
     } else {
         int position = -1;
@@ -88,8 +124,9 @@ void SocketStats::stats_new_socket_entry(const Socket *const reference_id)
         if (-1 == position) {
             MBED_ERROR(MBED_MAKE_ERROR(MBED_MODULE_NETWORK_STATS, MBED_ERROR_CODE_OUT_OF_RESOURCES), "List full with all open sockets");
         }
-        memset(&_stats[position], 0, sizeof(mbed_stats_socket_t));
+        reset_entry(_stats[position]);
         _stats[position].reference_id = (Socket *)reference_id;
+        _position = position;
     }
     _mutex->unlock();
 #endif
@@ -138,23 +175,27 @@ void SocketStats::stats_update_proto(const Socket *const reference_id, nsapi_pro
 void SocketStats::stats_update_sent_bytes(const Socket *const reference_id, size_t sent_bytes)
 {
 #if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
-    _mutex->lock();
-    int position = get_entry_position(reference_id);
-    if ((position >= 0) && ((int32_t)sent_bytes > 0)) {
-        _stats[position].sent_bytes += sent_bytes;
+    if ((int32_t)sent_bytes <= 0) {
+        return;
+    }
+    socket_entry_t *entry = get_entry(reference_id);
+    if (entry) {
+        entry->sent_bytes += sent_bytes;
+        _total_sent_bytes += sent_bytes;
     }
-    _mutex->unlock();
 #endif
 }
 
 void SocketStats::stats_update_recv_bytes(const Socket *const reference_id, size_t recv_bytes)
 {
 #if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
-    _mutex->lock();
-    int position = get_entry_position(reference_id);
-    if ((position >= 0) && ((int32_t)recv_bytes > 0)) {
-        _stats[position].recv_bytes += recv_bytes;
+    if ((int32_t)recv_bytes <= 0) {
+        return;
+    }
+    socket_entry_t *entry = get_entry(reference_id);
+    if (entry) {
+        entry->recv_bytes += recv_bytes;
+        _total_recv_bytes += recv_bytes;
     }
-    _mutex->unlock();
 #endif
 }
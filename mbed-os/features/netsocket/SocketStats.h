@@ -19,6 +19,7 @@
 
 #include "platform/SingletonPtr.h"
 #include "platform/PlatformMutex.h"
+#include "platform/StatCounter.h"
 #include "netsocket/Socket.h"
 #include "SocketAddress.h"
 #include "hal/ticker_api.h"
@@ -145,9 +146,25 @@ public:
 
 #if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
 private:
-    static mbed_stats_socket_t _stats[MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT];
+    /* Internal form of mbed_stats_socket_t, with byte counts updated without the mutex */
+    struct socket_entry_t {
+        Socket *reference_id;
+        SocketAddress peer;
+        socket_state state;
+        nsapi_protocol_t proto;
+        mbed::StatCounter sent_bytes;
+        mbed::StatCounter recv_bytes;
+        us_timestamp_t last_change_tick;
+    };
+
+    static socket_entry_t _stats[MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT];
     static SingletonPtr<PlatformMutex> _mutex;
     static uint32_t _size;
+    static mbed::StatCounter _total_sent_bytes;
+    static mbed::StatCounter _total_recv_bytes;
+
+    /* Entry of the owning socket, cached by stats_new_socket_entry() */
+    int _position;
 
     /** Internal function to scan the array and get the position of the element in the list.
      *
@@ -155,6 +172,20 @@ private:
      *
      */
     int get_entry_position(const Socket *const reference_id);
+
+    /** Internal function to find the entry of a socket, using the cached
+     *  position when it still refers to the socket.
+     *
+     *  @param reference_id   ID to identify the socket in the data array.
+     *  @return               entry of the socket, or NULL if it has none.
+     */
+    socket_entry_t *get_entry(const Socket *const reference_id);
+
+    /** Internal function to clear an entry before reuse.
+     *
+     *  @param entry   entry to clear.
+     */
+    static void reset_entry(socket_entry_t &entry);
 #endif
 #endif
 };
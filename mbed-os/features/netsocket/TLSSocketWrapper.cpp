@@ -30,6 +30,275 @@
 // This class requires Mbed TLS SSL/TLS client code
 #if defined(MBEDTLS_SSL_CLI_C)
 
+#if MBED_CONF_NSAPI_TLS_COALESCE_SIZE > 0
+#define TLS_COALESCE
+
+#include <algorithm>
+#include <new>
+
+// Set when the coalescing timer has run without the lock, see close()
+#define TLS_COALESCE_FLAG 2
+#endif
+
+// Sessions are kept by host name, which is only known with hostname verification
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_SIZE > 0 && defined(MBEDTLS_X509_CRT_PARSE_C) && !defined(MBEDTLS_X509_REMOVE_HOSTNAME_VERIFICATION)
+#define TLS_SESSION_CACHE
+
+#include <new>
+#include "PlatformMutex.h"
+#include "SingletonPtr.h"
+#include "mbedtls/ssl_internal.h"
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+#include <stdio.h>
+#include "kvstore_global_api.h"
+
+#define TLS_SESSION_KV_PREFIX MBED_CONF_NSAPI_TLS_SESSION_CACHE_KVSTORE_PATH "tls_"
+#define TLS_SESSION_KV_KEY_SIZE (sizeof(TLS_SESSION_KV_PREFIX) + 8)
+#endif
+
+struct TLS_SESSION {
+    uint8_t *data;      /*!< transport, identity, host name and serialized session, NULL if the entry is free */
+    size_t size;        /*!< size of data */
+    uint32_t hash;      /*!< hash of transport and host name */
+    uint32_t used;      /*!< tls_session_clock when last stored or resumed */
+};
+
+static TLS_SESSION tls_session_cache[MBED_CONF_NSAPI_TLS_SESSION_CACHE_SIZE];
+static uint32_t tls_session_clock;
+// Protects cache shared by all sockets
+static SingletonPtr<PlatformMutex> tls_session_mutex;
+
+// Data starts with the transport, the identity and the NUL terminated host name
+#define TLS_SESSION_HOST_OFFSET (1 + sizeof(uint32_t))
+
+static size_t tls_session_key_size(const char *host)
+{
+    return TLS_SESSION_HOST_OFFSET + strlen(host) + 1;
+}
+
+// FNV-1a
+static uint32_t tls_session_fnv(uint32_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    while (size--) {
+        hash = (hash ^ *bytes++) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t tls_session_hash(uint8_t transport, const char *host)
+{
+    return tls_session_fnv(tls_session_fnv(2166136261u, &transport, 1), host, strlen(host));
+}
+
+// Hash of the certificates the server was verified with and the client sent,
+// so that a session is only resumed with the credentials it was made with
+static uint32_t tls_session_identity(const mbedtls_ssl_config *conf)
+{
+    // Each certificate is tagged with its use
+    const uint8_t ca = 1, own = 2;
+    uint32_t hash = 2166136261u;
+    for (const mbedtls_x509_crt *crt = conf->ca_chain; crt; crt = crt->next) {
+        hash = tls_session_fnv(tls_session_fnv(hash, &ca, 1), crt->raw.p, crt->raw.len);
+    }
+#if defined(MBEDTLS_X509_CRL_PARSE_C)
+    const uint8_t revoked = 3;
+    for (const mbedtls_x509_crl *crl = conf->ca_crl; crl; crl = crl->next) {
+        hash = tls_session_fnv(tls_session_fnv(hash, &revoked, 1), crl->raw.p, crl->raw.len);
+    }
+#endif
+    for (const mbedtls_ssl_key_cert *key_cert = conf->key_cert; key_cert; key_cert = key_cert->next) {
+        hash = tls_session_fnv(tls_session_fnv(hash, &own, 1), key_cert->cert->raw.p, key_cert->cert->raw.len);
+    }
+    return hash;
+}
+
+// Sessions are found by transport and host name, the identity is checked on use
+static bool tls_session_matches(const uint8_t *data, size_t size, uint8_t transport, const char *host)
+{
+    size_t key_size = tls_session_key_size(host);
+    return size > key_size && data[0] == transport &&
+           memcmp(data + TLS_SESSION_HOST_OFFSET, host, key_size - TLS_SESSION_HOST_OFFSET) == 0;
+}
+
+static TLS_SESSION *tls_session_find(uint32_t hash, uint8_t transport, const char *host)
+{
+    for (TLS_SESSION &session : tls_session_cache) {
+        if (session.data && session.hash == hash && tls_session_matches(session.data, session.size, transport, host)) {
+            return &session;
+        }
+    }
+    return NULL;
+}
+
+// Free entry, or the least recently used one
+static TLS_SESSION *tls_session_victim()
+{
+    TLS_SESSION *victim = &tls_session_cache[0];
+    for (TLS_SESSION &session : tls_session_cache) {
+        if (!session.data) {
+            return &session;
+        }
+        if ((int32_t)(session.used - victim->used) < 0) {
+            victim = &session;
+        }
+    }
+    return victim;
+}
+
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+static void tls_session_kv_key(char *key, uint32_t hash)
+{
+    snprintf(key, TLS_SESSION_KV_KEY_SIZE, TLS_SESSION_KV_PREFIX "%08lx", (unsigned long) hash);
+}
+
+static void tls_session_kv_remove(uint32_t hash)
+{
+    char key[TLS_SESSION_KV_KEY_SIZE];
+    tls_session_kv_key(key, hash);
+    kv_remove(key);
+}
+#endif
+
+static void tls_session_replace(TLS_SESSION *session, uint8_t *data, size_t size, uint32_t hash)
+{
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+    // Evicted sessions are not kept across resets either
+    if (session->data && session->hash != hash) {
+        tls_session_kv_remove(session->hash);
+    }
+#endif
+    delete[] session->data;
+    session->data = data;
+    session->size = size;
+    session->hash = hash;
+    session->used = ++tls_session_clock;
+}
+
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+
+// Reads a session kept before a reset into the cache
+static TLS_SESSION *tls_session_kv_load(uint32_t hash, uint8_t transport, const char *host)
+{
+    char key[TLS_SESSION_KV_KEY_SIZE];
+    tls_session_kv_key(key, hash);
+
+    kv_info_t info;
+    if (kv_get_info(key, &info) != MBED_SUCCESS) {
+        return NULL;
+    }
+
+    uint8_t *data = new (std::nothrow) uint8_t[info.size];
+    if (!data) {
+        return NULL;
+    }
+
+    size_t size = 0;
+    if (kv_get(key, data, info.size, &size) != MBED_SUCCESS || !tls_session_matches(data, size, transport, host)) {
+        delete[] data;
+        return NULL;
+    }
+
+    TLS_SESSION *session = tls_session_victim();
+    tls_session_replace(session, data, size, hash);
+    return session;
+}
+#endif
+
+static void tls_session_remove(TLS_SESSION *session)
+{
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+    tls_session_kv_remove(session->hash);
+#endif
+    delete[] session->data;
+    session->data = NULL;
+}
+
+static void tls_session_cache_add(uint8_t transport, uint32_t identity, const char *host, const mbedtls_ssl_session *ssl_session)
+{
+    size_t key_size = tls_session_key_size(host);
+    size_t session_size = 0;
+    if (!ssl_session || mbedtls_ssl_session_save(ssl_session, NULL, 0, &session_size) != MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL) {
+        return;
+    }
+
+    uint8_t *data = new (std::nothrow) uint8_t[key_size + session_size];
+    if (!data) {
+        return;
+    }
+    data[0] = transport;
+    memcpy(data + 1, &identity, sizeof(identity));
+    memcpy(data + TLS_SESSION_HOST_OFFSET, host, key_size - TLS_SESSION_HOST_OFFSET);
+    if (mbedtls_ssl_session_save(ssl_session, data + key_size, session_size, &session_size) != 0) {
+        delete[] data;
+        return;
+    }
+
+    size_t size = key_size + session_size;
+    uint32_t hash = tls_session_hash(transport, host);
+
+    tls_session_mutex->lock();
+    TLS_SESSION *session = tls_session_find(hash, transport, host);
+    if (session && session->size == size && memcmp(session->data, data, size) == 0) {
+        // Resumed without a new ticket
+        session->used = ++tls_session_clock;
+        delete[] data;
+    } else {
+        tls_session_replace(session ? session : tls_session_victim(), data, size, hash);
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+        char key[TLS_SESSION_KV_KEY_SIZE];
+        tls_session_kv_key(key, hash);
+        int ret = kv_set(key, data, size, KV_REQUIRE_CONFIDENTIALITY_FLAG);
+        if (ret != MBED_SUCCESS) {
+            tr_warn("Failed to store TLS session: %d", ret);
+        }
+#endif
+    }
+    tls_session_mutex->unlock();
+}
+
+static void tls_session_cache_remove(uint8_t transport, const char *host)
+{
+    tls_session_mutex->lock();
+    TLS_SESSION *session = tls_session_find(tls_session_hash(transport, host), transport, host);
+    if (session) {
+        tls_session_remove(session);
+    }
+    tls_session_mutex->unlock();
+}
+
+static bool tls_session_cache_get(uint8_t transport, uint32_t identity, const char *host, mbedtls_ssl_session *ssl_session)
+{
+    uint32_t hash = tls_session_hash(transport, host);
+    int ret = -1;
+
+    tls_session_mutex->lock();
+    TLS_SESSION *session = tls_session_find(hash, transport, host);
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+    if (!session) {
+        session = tls_session_kv_load(hash, transport, host);
+    }
+#endif
+    if (session && memcmp(session->data + 1, &identity, sizeof(identity)) != 0) {
+        // Made with other credentials, it is replaced after the full handshake
+        session = NULL;
+    }
+    if (session) {
+        size_t key_size = tls_session_key_size(host);
+        ret = mbedtls_ssl_session_load(ssl_session, session->data + key_size, session->size - key_size);
+        if (ret == 0) {
+            session->used = ++tls_session_clock;
+        } else {
+            // Saved by an incompatible Mbed TLS version or configuration
+            tls_session_remove(session);
+        }
+    }
+    tls_session_mutex->unlock();
+
+    return ret == 0;
+}
+#endif /* TLS_SESSION_CACHE */
+
 TLSSocketWrapper::TLSSocketWrapper(Socket *transport, const char *hostname, control_transport control) :
     _transport(transport),
     _timeout(-1),
@@ -38,6 +307,15 @@ TLSSocketWrapper::TLSSocketWrapper(Socket *transport, const char *hostname, cont
     _clicert(NULL),
 #endif
     _ssl_conf(NULL),
+#ifdef TLS_COALESCE
+    _coalesce_buf(NULL),
+    _coalesce_len(0),
+    _coalesce_sending(0),
+    _coalesce_size(0),
+    _coalesce_delay(MBED_CONF_NSAPI_TLS_COALESCE_DELAY),
+    _coalesce_event_id(0),
+    _coalesce_error(NSAPI_ERROR_OK),
+#endif
     _connect_transport(control == TRANSPORT_CONNECT || control == TRANSPORT_CONNECT_AND_CLOSE),
     _close_transport(control == TRANSPORT_CLOSE || control == TRANSPORT_CONNECT_AND_CLOSE),
     _tls_initialized(false),
@@ -86,6 +364,35 @@ TLSSocketWrapper::~TLSSocketWrapper()
 #endif /* MBEDTLS_PLATFORM_C */
 }
 
+void TLSSocketWrapper::clear_session_cache(MBED_UNUSED const char *hostname)
+{
+#ifdef TLS_SESSION_CACHE
+    tls_session_mutex->lock();
+    for (TLS_SESSION &session : tls_session_cache) {
+        if (session.data && (!hostname || strcmp((const char *) session.data + TLS_SESSION_HOST_OFFSET, hostname) == 0)) {
+            tls_session_remove(&session);
+        }
+    }
+#if MBED_CONF_NSAPI_TLS_SESSION_CACHE_USE_KVSTORE
+    // Sessions kept before a reset may not be in the cache
+    if (hostname) {
+        tls_session_kv_remove(tls_session_hash(MBEDTLS_SSL_TRANSPORT_STREAM, hostname));
+        tls_session_kv_remove(tls_session_hash(MBEDTLS_SSL_TRANSPORT_DATAGRAM, hostname));
+    } else {
+        kv_iterator_t it;
+        if (kv_iterator_open(&it, TLS_SESSION_KV_PREFIX) == MBED_SUCCESS) {
+            char key[sizeof(MBED_CONF_NSAPI_TLS_SESSION_CACHE_KVSTORE_PATH) + KV_MAX_KEY_LENGTH];
+            while (kv_iterator_next(it, key, sizeof(key)) == MBED_SUCCESS) {
+                kv_remove(key);
+            }
+            kv_iterator_close(it);
+        }
+    }
+#endif
+    tls_session_mutex->unlock();
+#endif /* TLS_SESSION_CACHE */
+}
+
 void TLSSocketWrapper::set_hostname(const char *hostname)
 {
 #if defined(MBEDTLS_X509_CRT_PARSE_C) && !defined(MBEDTLS_X509_REMOVE_HOSTNAME_VERIFICATION)
@@ -234,6 +541,22 @@ nsapi_error_t TLSSocketWrapper::start_handshake(bool first_call)
     mbedtls_ssl_set_bio_ctx(&_ssl, this);
 #endif /* !defined(MBEDTLS_SSL_CONF_RECV) && !defined(MBEDTLS_SSL_CONF_SEND) && !defined(MBEDTLS_SSL_CONF_RECV_TIMEOUT) */
 
+#ifdef TLS_SESSION_CACHE
+    if (_ssl.hostname) {
+        // The server decides whether the session is resumed, or a full handshake is done
+        mbedtls_ssl_session session;
+        mbedtls_ssl_session_init(&session);
+        if (tls_session_cache_get(_ssl.conf->transport, tls_session_identity(_ssl.conf), _ssl.hostname, &session)) {
+            if ((ret = mbedtls_ssl_set_session(&_ssl, &session)) != 0) {
+                print_mbedtls_error("mbedtls_ssl_set_session", ret);
+            } else {
+                tr_debug("Resuming TLS session with %s", _ssl.hostname);
+            }
+        }
+        mbedtls_ssl_session_free(&session);
+    }
+#endif
+
     _tls_initialized = true;
 
     ret = continue_handshake();
@@ -278,6 +601,12 @@ nsapi_error_t TLSSocketWrapper::continue_handshake()
         if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
             return NSAPI_ERROR_ALREADY;
         } else {
+#ifdef TLS_SESSION_CACHE
+            // Not offered again, in case it caused the failure
+            if (_ssl.hostname) {
+                tls_session_cache_remove(_ssl.conf->transport, _ssl.hostname);
+            }
+#endif
             return NSAPI_ERROR_AUTH_FAILURE;
         }
     }
@@ -309,6 +638,14 @@ nsapi_error_t TLSSocketWrapper::continue_handshake()
     delete[] buf;
 #endif
 
+#ifdef TLS_SESSION_CACHE
+    // Only a server verified against the host name can skip verification later
+    if (_ssl.hostname && _ssl.conf->authmode == MBEDTLS_SSL_VERIFY_REQUIRED && mbedtls_ssl_get_verify_result(&_ssl) == 0) {
+        tls_session_cache_add(_ssl.conf->transport, tls_session_identity(_ssl.conf), _ssl.hostname,
+                              mbedtls_ssl_get_session_pointer(&_ssl));
+    }
+#endif
+
     _handshake_completed = true;
     return NSAPI_ERROR_IS_CONNECTED;
 }
@@ -323,24 +660,50 @@ nsapi_error_t TLSSocketWrapper::send(const void *data, nsapi_size_t size)
     }
 
     tr_debug("send %d", size);
-    while (true) {
-        if (!_handshake_completed) {
-            ret = continue_handshake();
-            if (ret != NSAPI_ERROR_IS_CONNECTED) {
-                if (ret == NSAPI_ERROR_ALREADY) {
-                    ret = NSAPI_ERROR_WOULD_BLOCK;
-                }
-                return ret;
+    if (!_handshake_completed) {
+        ret = continue_handshake();
+        if (ret != NSAPI_ERROR_IS_CONNECTED) {
+            if (ret == NSAPI_ERROR_ALREADY) {
+                ret = NSAPI_ERROR_WOULD_BLOCK;
             }
+            return ret;
         }
+    }
 
-        ret = mbedtls_ssl_write(&_ssl, (const unsigned char *) data, size);
+#ifdef TLS_COALESCE
+    _mutex.lock();
+    ret = take_coalesce_error();
+    if (ret == NSAPI_ERROR_OK) {
+        if (_coalesce_delay > 0 && _ssl.conf->transport == MBEDTLS_SSL_TRANSPORT_STREAM) {
+            ret = coalesce((const unsigned char *) data, size);
+        } else if ((ret = flush_coalesced(_timeout)) == NSAPI_ERROR_OK) {
+            ret = write_records((const unsigned char *) data, size, _timeout);
+        }
+    }
+    _mutex.unlock();
+    return ret;
+#else
+    return write_records((const unsigned char *) data, size, _timeout);
+#endif
+}
 
-        if (_timeout == 0) {
-            break;
-        } else if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+nsapi_size_or_error_t TLSSocketWrapper::write_records(const unsigned char *data, size_t size, int timeout)
+{
+    size_t sent = 0;
+    int ret;
+
+    while (true) {
+        ret = mbedtls_ssl_write(&_ssl, data + sent, size - sent);
+
+        if (ret >= 0) {
+            sent += ret;
+            // In blocking mode, data larger than a record is sent in several
+            if (sent == size || timeout == 0 || ret == 0) {
+                break;
+            }
+        } else if (timeout != 0 && (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ)) {
             uint32_t flag;
-            flag = _event_flag.wait_any(1, _timeout);
+            flag = _event_flag.wait_any(1, timeout);
             if (flag & osFlagsError) {
                 // Timeout break
                 break;
@@ -350,6 +713,10 @@ nsapi_error_t TLSSocketWrapper::send(const void *data, nsapi_size_t size)
         }
     }
 
+    if (sent) {
+        return sent;
+    }
+
     if (ret == MBEDTLS_ERR_SSL_WANT_WRITE ||
             ret == MBEDTLS_ERR_SSL_WANT_READ) {
         // translate to socket error
@@ -363,6 +730,160 @@ nsapi_error_t TLSSocketWrapper::send(const void *data, nsapi_size_t size)
     return ret; // Assume "non negative errorcode" to be propagated from Socket layer
 }
 
+#ifdef TLS_COALESCE
+nsapi_size_or_error_t TLSSocketWrapper::coalesce(const unsigned char *data, size_t size)
+{
+    if (!_coalesce_buf) {
+        // Not larger than a record, with the negotiated maximum fragment length
+        int payload = mbedtls_ssl_get_max_out_record_payload(&_ssl);
+        _coalesce_size = MBED_CONF_NSAPI_TLS_COALESCE_SIZE;
+        if (payload > 0 && (size_t) payload < _coalesce_size) {
+            _coalesce_size = payload;
+        }
+        _coalesce_buf = new (std::nothrow) unsigned char[_coalesce_size];
+        if (!_coalesce_buf) {
+            return write_records(data, size, _timeout);
+        }
+    }
+
+    size_t sent = 0;
+    while (sent < size) {
+        if (_coalesce_len == _coalesce_size || _coalesce_sending) {
+            nsapi_error_t ret = flush_coalesced(_timeout);
+            if (ret != NSAPI_ERROR_OK) {
+                return sent ? (nsapi_size_or_error_t) sent : ret;
+            }
+        }
+        size_t len = std::min(size - sent, _coalesce_size - _coalesce_len);
+        memcpy(_coalesce_buf + _coalesce_len, data + sent, len);
+        _coalesce_len += len;
+        sent += len;
+    }
+
+    // Full records are not held, the timer retries if the transport is busy
+    if (_coalesce_len == _coalesce_size) {
+        flush_coalesced(_timeout);
+    }
+    if (_coalesce_len && !_coalesce_event_id) {
+        schedule_flush();
+    }
+    return sent;
+}
+
+nsapi_error_t TLSSocketWrapper::flush_coalesced(int timeout)
+{
+    while (_coalesce_len) {
+        // Mbed TLS expects the same length again after WANT_WRITE, even if more data was collected since
+        size_t len = _coalesce_sending ? _coalesce_sending : _coalesce_len;
+        nsapi_size_or_error_t ret = write_records(_coalesce_buf, len, timeout);
+        if (ret < 0) {
+            if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+                _coalesce_sending = len;
+            }
+            return ret;
+        }
+        _coalesce_sending = len - ret;
+        _coalesce_len -= ret;
+        memmove(_coalesce_buf, _coalesce_buf + ret, _coalesce_len);
+    }
+    return NSAPI_ERROR_OK;
+}
+
+void TLSSocketWrapper::schedule_flush()
+{
+    _coalesce_event_id = mbed::mbed_event_queue()->call_in(std::max(_coalesce_delay, 1), this, &TLSSocketWrapper::coalesce_timeout);
+}
+
+void TLSSocketWrapper::coalesce_timeout()
+{
+    if (!_mutex.trylock()) {
+        // Rather than blocking the shared event queue for a call in progress, try again later.
+        // The ID is replaced without passing 0, for close() to cancel it.
+        schedule_flush();
+        _event_flag.set(TLS_COALESCE_FLAG);
+        return;
+    }
+    _coalesce_event_id = 0;
+    if (_transport && _coalesce_len) {
+        nsapi_error_t ret = flush_coalesced(0);
+        if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+            schedule_flush();
+        } else if (ret != NSAPI_ERROR_OK) {
+            // Not retried, the next call of the user reports it
+            _coalesce_error = ret;
+        }
+    }
+    _mutex.unlock();
+}
+
+nsapi_error_t TLSSocketWrapper::take_coalesce_error()
+{
+    nsapi_error_t ret = _coalesce_error;
+    _coalesce_error = NSAPI_ERROR_OK;
+    return ret;
+}
+#endif /* TLS_COALESCE */
+
+nsapi_error_t TLSSocketWrapper::flush()
+{
+    if (!_transport) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+#ifdef TLS_COALESCE
+    _mutex.lock();
+    nsapi_error_t ret = take_coalesce_error();
+    if (ret == NSAPI_ERROR_OK) {
+        ret = flush_coalesced(_timeout);
+    }
+    _mutex.unlock();
+    return ret;
+#else
+    return NSAPI_ERROR_OK;
+#endif
+}
+
+nsapi_error_t TLSSocketWrapper::set_coalescing(MBED_UNUSED int delay)
+{
+#ifdef TLS_COALESCE
+    _mutex.lock();
+    _coalesce_delay = delay;
+    _mutex.unlock();
+    return NSAPI_ERROR_OK;
+#else
+    return NSAPI_ERROR_UNSUPPORTED;
+#endif
+}
+
+nsapi_error_t TLSSocketWrapper::set_max_fragment_length(nsapi_size_t size)
+{
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    unsigned char mfl_code;
+    switch (size) {
+        case 0:
+            mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+            break;
+        case 512:
+            mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+            break;
+        case 1024:
+            mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+            break;
+        case 2048:
+            mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+            break;
+        case 4096:
+            mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+            break;
+        default:
+            return NSAPI_ERROR_PARAMETER;
+    }
+    mbedtls_ssl_conf_max_frag_len(get_ssl_config(), mfl_code);
+    return NSAPI_ERROR_OK;
+#else
+    return size ? NSAPI_ERROR_UNSUPPORTED : NSAPI_ERROR_OK;
+#endif
+}
+
 nsapi_size_or_error_t TLSSocketWrapper::sendto(const SocketAddress &, const void *data, nsapi_size_t size)
 {
     // Ignore the SocketAddress
@@ -388,6 +909,20 @@ nsapi_size_or_error_t TLSSocketWrapper::recv(void *data, nsapi_size_t size)
             }
         }
 
+#ifdef TLS_COALESCE
+        _mutex.lock();
+        // Data held by coalescing is usually what the peer has to answer
+        ret = take_coalesce_error();
+        if (ret == NSAPI_ERROR_OK) {
+            ret = flush_coalesced(_timeout);
+        }
+        _mutex.unlock();
+        if (ret != NSAPI_ERROR_OK && ret != NSAPI_ERROR_WOULD_BLOCK) {
+            return ret;
+        }
+        // Reading leaves the coalesced data alone, so it is done unlocked
+        // and sends from other threads do not wait for it
+#endif
         ret = mbedtls_ssl_read(&_ssl, (unsigned char *) data, size);
 
         if (_timeout == 0) {
@@ -592,6 +1127,9 @@ mbedtls_ssl_config *TLSSocketWrapper::get_ssl_config()
          * MBEDTLS_SSL_VERIFY_NONE in the call to mbedtls_ssl_conf_authmode()
          */
         mbedtls_ssl_conf_authmode(get_ssl_config(), MBEDTLS_SSL_VERIFY_REQUIRED);
+#if MBED_CONF_NSAPI_TLS_MAX_FRAGMENT_LENGTH
+        set_max_fragment_length(MBED_CONF_NSAPI_TLS_MAX_FRAGMENT_LENGTH);
+#endif
     }
     return _ssl_conf;
 }
@@ -619,9 +1157,22 @@ nsapi_error_t TLSSocketWrapper::close()
 
     tr_info("Closing TLS");
 
+#ifdef TLS_COALESCE
+    _mutex.lock();
+    while (_coalesce_event_id && !mbed::mbed_event_queue()->cancel(_coalesce_event_id)) {
+        // The timer is running without the lock, and schedules itself again
+        _event_flag.wait_any(TLS_COALESCE_FLAG);
+    }
+    _coalesce_event_id = 0;
+#endif
+
     int ret = 0;
     if (_handshake_completed) {
         _transport->set_blocking(true);
+#ifdef TLS_COALESCE
+        // Data held by coalescing is sent before the alert
+        flush_coalesced(-1);
+#endif
         ret = mbedtls_ssl_close_notify(&_ssl);
         if (ret) {
             print_mbedtls_error("mbedtls_ssl_close_notify", ret);
@@ -638,6 +1189,15 @@ nsapi_error_t TLSSocketWrapper::close()
 
     _transport = NULL;
 
+#ifdef TLS_COALESCE
+    delete[] _coalesce_buf;
+    _coalesce_buf = NULL;
+    _coalesce_len = 0;
+    _coalesce_sending = 0;
+    _coalesce_error = NSAPI_ERROR_OK;
+    _mutex.unlock();
+#endif
+
     return ret;
 }
 
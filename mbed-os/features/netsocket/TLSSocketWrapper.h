@@ -24,6 +24,7 @@
 
 #include "netsocket/Socket.h"
 #include "rtos/EventFlags.h"
+#include "rtos/Mutex.h"
 #include "platform/Callback.h"
 #include "mbedtls/platform.h"
 #include "mbedtls/ssl.h"
@@ -134,10 +135,55 @@ public:
      */
     nsapi_error_t set_client_cert_key(const char *client_cert_pem, const char *client_private_key_pem);
 
+    /** Sets the largest TLS record payload negotiated with the server.
+     *
+     * Smaller records need less RAM for Mbed TLS buffers, when it is built with
+     * MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH or smaller MBEDTLS_SSL_OUT_CONTENT_LEN
+     * and MBEDTLS_SSL_IN_CONTENT_LEN, but more records for the same data.
+     * Default is nsapi.tls-max-fragment-length.
+     *
+     * @note Must be called before calling connect()
+     *
+     * @param size    512, 1024, 2048 or 4096 bytes, or 0 for the largest records.
+     * @retval NSAPI_ERROR_OK on success.
+     * @retval NSAPI_ERROR_PARAMETER in case the size is not one of these.
+     * @retval NSAPI_ERROR_UNSUPPORTED in case Mbed TLS is built without MBEDTLS_SSL_MAX_FRAGMENT_LENGTH.
+     */
+    nsapi_error_t set_max_fragment_length(nsapi_size_t size);
+
+    /** Sets how long data of small writes is held to send it in fewer TLS records.
+     *
+     * Every record costs a header and authentication tag, typically 29 bytes,
+     * and its own encryption. With record coalescing (see nsapi.tls-coalesce-size),
+     * send() collects data until a record is full, flush() or recv() is called,
+     * or the delay has passed. Default is nsapi.tls-coalesce-delay. Records of
+     * DTLS are always sent as they are written. If held data fails to be sent
+     * after the delay, the next send(), recv() or flush() returns the error.
+     *
+     * @param delay   Longest time in milliseconds that data is held, 0 sends each write in its own records.
+     * @retval NSAPI_ERROR_OK on success.
+     * @retval NSAPI_ERROR_UNSUPPORTED in case record coalescing is disabled.
+     */
+    nsapi_error_t set_coalescing(int delay);
+
+    /** Sends data held by record coalescing.
+     *
+     *  @retval         NSAPI_ERROR_OK on success, or if no data was held.
+     *  @retval         NSAPI_ERROR_NO_SOCKET in case socket was not created correctly.
+     *  @retval         NSAPI_ERROR_WOULD_BLOCK in case non-blocking mode is enabled
+     *                  and the data cannot be sent immediately.
+     *  @retval         NSAPI_ERROR_DEVICE_ERROR in case of tls-related errors.
+     *                  See @ref mbedtls_ssl_write.
+     */
+    nsapi_error_t flush();
+
     /** Send data over a TLS socket.
      *
      *  The socket must be connected to a remote host. Returns the number of
-     *  bytes sent from the buffer.
+     *  bytes sent from the buffer. In blocking mode, data larger than a record
+     *  is sent in as many records as needed; in non-blocking mode, one record
+     *  at most is sent. With record coalescing, data may be held to be sent
+     *  later, see @ref set_coalescing.
      *
      *  @param data     Buffer of data to send to the host.
      *  @param size     Size of the buffer in bytes.
@@ -237,6 +283,21 @@ public:
      */
     mbedtls_ssl_context *get_ssl_context();
 
+    /** Forget TLS sessions kept for resuming connections.
+     *
+     * After a successful handshake with a server whose certificate was verified
+     * with MBEDTLS_SSL_VERIFY_REQUIRED, the session is kept by host name (see
+     * nsapi.tls-session-cache-size), and later handshakes with the same host
+     * offer it to the server to skip certificate verification and key exchange.
+     * Sessions are shared by all sockets, and only offered with the same
+     * trusted certificates, revocation lists and client certificate as they
+     * were made with, so forgetting them is only needed to force a full
+     * handshake.
+     *
+     * @param hostname Host name whose session is forgotten, or NULL for all sessions.
+     */
+    static void clear_session_cache(const char *hostname = NULL);
+
 protected:
 #ifndef DOXYGEN_ONLY
     /** Initiates TLS Handshake.
@@ -270,6 +331,26 @@ protected:
 private:
     /** Continue already initialized handshake */
     nsapi_error_t continue_handshake();
+
+    /** Write data in records, waiting up to timeout for the transport */
+    nsapi_size_or_error_t write_records(const unsigned char *data, size_t size, int timeout);
+
+#if MBED_CONF_NSAPI_TLS_COALESCE_SIZE > 0
+    /** Collect data to be sent in full records */
+    nsapi_size_or_error_t coalesce(const unsigned char *data, size_t size);
+
+    /** Send collected data, waiting up to timeout for the transport */
+    nsapi_error_t flush_coalesced(int timeout);
+
+    /** Send collected data after the delay from the shared event queue */
+    void schedule_flush();
+
+    /** Delay of collected data passed */
+    void coalesce_timeout();
+
+    /** Take the error of sending collected data after the delay, if any */
+    nsapi_error_t take_coalesce_error();
+#endif
     /**
      * Helper for pretty-printing Mbed TLS error codes
      */
@@ -321,6 +402,19 @@ private:
 #endif
     mbedtls_ssl_config *_ssl_conf;
 
+#if MBED_CONF_NSAPI_TLS_COALESCE_SIZE > 0
+    // Serializes Mbed TLS writes of the user and of the shared event queue;
+    // reads are not held up by it
+    rtos::Mutex _mutex;
+    unsigned char *_coalesce_buf;
+    size_t _coalesce_len;
+    size_t _coalesce_sending;
+    size_t _coalesce_size;
+    int _coalesce_delay;
+    int _coalesce_event_id;
+    nsapi_error_t _coalesce_error;
+#endif
+
     bool _connect_transport: 1;
     bool _close_transport: 1;
     bool _tls_initialized: 1;
@@ -27,3 +27,136 @@ nsapi_protocol_t UDPSocket::get_proto()
 {
     return NSAPI_UDP;
 }
+
+nsapi_size_or_error_t UDPSocket::sendto_batch(nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    _writers++;
+    if (_socket) {
+        _socket_stats.stats_update_socket_state(this, SOCK_OPEN);
+    }
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        core_util_atomic_flag_clear(&_pending);
+        nsapi_size_or_error_t sent = _stack->socket_sendto_batch(_socket, datagrams, count);
+        if ((0 == _timeout) || (NSAPI_ERROR_WOULD_BLOCK != sent)) {
+            if (sent > 0) {
+                nsapi_size_t bytes = 0;
+                for (nsapi_size_or_error_t i = 0; i < sent; i++) {
+                    bytes += datagrams[i].length;
+                }
+                _socket_stats.stats_update_sent_bytes(this, bytes);
+                _socket_stats.stats_update_peer(this, datagrams[sent - 1].address);
+            }
+            ret = sent;
+            break;
+        } else {
+            uint32_t flag;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            flag = _event_flag.wait_any(WRITE_FLAG, _timeout);
+            _lock.lock();
+
+            if (flag & osFlagsError) {
+                // Timeout break
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _writers--;
+    if (!_socket || !_writers) {
+        _event_flag.set(FINISHED_FLAG);
+    }
+    _lock.unlock();
+    return ret;
+}
+
+nsapi_size_or_error_t UDPSocket::recvfrom_batch(nsapi_datagram_t *datagrams, nsapi_size_t count)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    _readers++;
+
+    if (_socket) {
+        _socket_stats.stats_update_socket_state(this, SOCK_OPEN);
+    }
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        core_util_atomic_flag_clear(&_pending);
+        nsapi_size_or_error_t recv = _stack->socket_recvfrom_batch(_socket, datagrams, count);
+
+        // Filter incomming packets using connected peer address
+        if (recv > 0 && _remote_peer) {
+            nsapi_size_or_error_t kept = 0;
+            for (nsapi_size_or_error_t i = 0; i < recv; i++) {
+                if (_remote_peer != datagrams[i].address) {
+                    continue;
+                }
+                if (kept != i) {
+                    // The buffers are swapped, so each buffer is given back once
+                    void *data = datagrams[kept].data;
+                    nsapi_size_t size = datagrams[kept].size;
+                    datagrams[kept] = datagrams[i];
+                    datagrams[i].data = data;
+                    datagrams[i].size = size;
+                }
+                kept++;
+            }
+            if (kept == 0) {
+                continue;
+            }
+            recv = kept;
+        }
+
+        _socket_stats.stats_update_peer(this, _remote_peer);
+        // Non-blocking sockets always return. Blocking only returns when success or errors other than WOULD_BLOCK
+        if ((0 == _timeout) || (NSAPI_ERROR_WOULD_BLOCK != recv)) {
+            if (recv > 0) {
+                nsapi_size_t bytes = 0;
+                for (nsapi_size_or_error_t i = 0; i < recv; i++) {
+                    bytes += datagrams[i].length;
+                }
+                _socket_stats.stats_update_recv_bytes(this, bytes);
+            }
+            ret = recv;
+            break;
+        } else {
+            uint32_t flag;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            flag = _event_flag.wait_any(READ_FLAG, _timeout);
+            _lock.lock();
+
+            if (flag & osFlagsError) {
+                // Timeout break
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _readers--;
+    if (!_socket || !_readers) {
+        _event_flag.set(FINISHED_FLAG);
+    }
+
+    _lock.unlock();
+    return ret;
+}
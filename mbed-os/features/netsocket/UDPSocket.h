@@ -55,6 +55,49 @@ public:
         open(stack);
     }
 
+    /** Send a batch of datagrams, each to its own address.
+     *
+     *  Locks the socket and enters the stack once for the whole batch,
+     *  rather than once per datagram as sendto() does. The number of bytes
+     *  sent of each datagram is stored in its length.
+     *
+     *  By default, sendto_batch blocks until the first datagram can be
+     *  sent, and then sends all it can without blocking.
+     *
+     *  @param datagrams Datagrams to send.
+     *  @param count     Number of datagrams.
+     *  @retval          int Number of sent datagrams on success.
+     *  @retval          NSAPI_ERROR_NO_SOCKET in case socket was not created correctly.
+     *  @retval          NSAPI_ERROR_WOULD_BLOCK in case non-blocking mode is enabled
+     *                   and send cannot be performed immediately.
+     *  @retval          int Other negative error codes for stack-related failures.
+     *                   See \ref NetworkStack::socket_sendto_batch.
+     */
+    nsapi_size_or_error_t sendto_batch(nsapi_datagram_t *datagrams, nsapi_size_t count);
+
+    /** Receive a batch of datagrams.
+     *
+     *  By default, recvfrom_batch blocks until a datagram is received, and
+     *  then receives those that are waiting, up to count. The source
+     *  address and the number of bytes received of each datagram are stored
+     *  in its address and length.
+     *
+     *  @note If a datagram is larger than its buffer, the excess data is silently discarded.
+     *
+     *  @note If socket is connected, only packets coming from connected peer address
+     *  are accepted.
+     *
+     *  @param datagrams Destinations for the received datagrams.
+     *  @param count     Number of datagrams.
+     *  @retval          int Number of received datagrams on success.
+     *  @retval          NSAPI_ERROR_NO_SOCKET in case socket was not created correctly.
+     *  @retval          NSAPI_ERROR_WOULD_BLOCK in case non-blocking mode is enabled
+     *                   and no datagram is waiting.
+     *  @retval          int Other negative error codes for stack-related failures.
+     *                   See \ref NetworkStack::socket_recvfrom_batch.
+     */
+    nsapi_size_or_error_t recvfrom_batch(nsapi_datagram_t *datagrams, nsapi_size_t count);
+
 #if !defined(DOXYGEN_ONLY)
 
 protected:
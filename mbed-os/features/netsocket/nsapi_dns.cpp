@@ -30,12 +30,24 @@
 #include "Kernel.h"
 #include "PlatformMutex.h"
 #include "SingletonPtr.h"
+#include "platform/mbed_assert.h"
+#include "platform/ByteReader.h"
+#include "platform/ByteWriter.h"
+
+using mbed::ByteReader;
+using mbed::ByteWriter;
+using mbed::Span;
+using mbed::make_Span;
+using mbed::make_const_Span;
 
 #define CLASS_IN 1
 
 #define RR_A 1
+#define RR_SOA 6
 #define RR_AAAA 28
 
+#define RCODE_NXDOMAIN 3
+
 // DNS options
 #define DNS_BUFFER_SIZE 512
 #define DNS_SERVERS_SIZE 5
@@ -45,11 +57,23 @@
 #define DNS_HOST_NAME_MAX_LEN 255
 #define DNS_TIMER_TIMEOUT 100
 
+// DNS cache options
+#define DNS_CACHE_NONE 0xFF
+#define DNS_CACHE_REFRESH_HITS 2     // hits that make an entry worth refreshing
+#define DNS_CACHE_REFRESH_DIVISOR 8  // refreshed in the last 1/8 of its time to live
+
 struct DNS_CACHE {
     nsapi_addr_t address;
-    char *host;
-    uint64_t expires;      /*!< time to live in milliseconds */
-    uint64_t accessed;     /*!< last accessed */
+    char *host;              /*!< NULL if the entry is free */
+    uint64_t expires;        /*!< time to live in milliseconds */
+    uint32_t ttl;            /*!< time to live in seconds when added */
+    uint32_t hash;           /*!< hash of host */
+    uint16_t hits;           /*!< lookups since added */
+    uint8_t next;            /*!< next entry in hash bucket or free list */
+    uint8_t heap_index;      /*!< position in expiry heap */
+    nsapi_version_t version; /*!< address version, or NSAPI_UNSPEC for a name that does not exist */
+    bool negative;           /*!< name or address of version does not exist */
+    bool refreshing;         /*!< refresh query started */
 };
 
 struct SOCKET_CB_DATA {
@@ -77,10 +101,15 @@ struct DNS_QUERY {
     SOCKET_CB_DATA *socket_cb_data;
     nsapi_addr_t *addrs;
     uint32_t ttl;
+    nsapi_version_t negative_version;
     uint32_t total_timeout;
     uint32_t socket_timeout;
     uint16_t dns_message_id;
+    uint16_t dns_message_id_aaaa; /*!< AAAA question when racing A and AAAA, otherwise 0 */
     uint8_t dns_server;
+    uint8_t round_start;          /*!< first server asked in this round */
+    uint8_t round_sent;           /*!< servers asked in this round */
+    uint8_t negative;             /*!< questions answered negatively when racing */
     uint8_t retries;
     uint8_t total_attempts;
     uint8_t send_success;
@@ -89,11 +118,18 @@ struct DNS_QUERY {
 };
 
 static void nsapi_dns_cache_add(const char *host, nsapi_addr_t *address, uint32_t ttl);
-static nsapi_size_or_error_t nsapi_dns_cache_find(const char *host, nsapi_version_t version, nsapi_addr_t *address);
+static void nsapi_dns_cache_add_negative(const char *host, nsapi_version_t version, uint32_t ttl);
+static nsapi_size_or_error_t nsapi_dns_cache_find(const char *host, nsapi_version_t version, nsapi_addr_t *address, bool *refresh = NULL);
+static void nsapi_dns_cache_refresh(NetworkStack *stack, const char *host, nsapi_version_t version, call_in_callback_cb_t call_in_cb);
+call_in_callback_cb_t nsapi_dns_get_call_in_callback(NetworkStack *stack);
 static void nsapi_dns_cache_reset();
 
 static nsapi_error_t nsapi_dns_get_server_addr(NetworkStack *stack, uint8_t *index, uint8_t *total_attempts, uint8_t *send_success, SocketAddress *dns_addr, const char *interface_name);
 
+static nsapi_value_or_error_t nsapi_dns_query_async_start(NetworkStack *stack, const char *host,
+                                                          NetworkStack::hostbyname_cb_t callback, nsapi_size_t addr_count,
+                                                          call_in_callback_cb_t call_in_cb, const char *interface_name,
+                                                          nsapi_version_t version, bool refresh);
 static void nsapi_dns_query_async_create(void *ptr);
 static nsapi_error_t nsapi_dns_query_async_delete(intptr_t unique_id);
 static void nsapi_dns_query_async_send(void *ptr);
@@ -117,7 +153,24 @@ static nsapi_addr_t dns_servers[DNS_SERVERS_SIZE] = {
 // *INDENT-ON*
 
 #if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
-static DNS_CACHE *dns_cache[MBED_CONF_NSAPI_DNS_CACHE_SIZE];
+MBED_STATIC_ASSERT(MBED_CONF_NSAPI_DNS_CACHE_SIZE < DNS_CACHE_NONE, "DNS cache entries are indexed by a byte");
+
+// Smallest power of two that is at least n
+static constexpr unsigned dns_cache_buckets(unsigned n, unsigned buckets = 1)
+{
+    return buckets >= n ? buckets : dns_cache_buckets(n, buckets * 2);
+}
+
+#define DNS_CACHE_BUCKETS dns_cache_buckets(MBED_CONF_NSAPI_DNS_CACHE_SIZE)
+
+// Entries are looked up by host hash, and expired or evicted in the
+// order of a min-heap on expiry time
+static DNS_CACHE dns_cache[MBED_CONF_NSAPI_DNS_CACHE_SIZE];
+static uint8_t dns_cache_bucket[DNS_CACHE_BUCKETS];
+static uint8_t dns_cache_heap[MBED_CONF_NSAPI_DNS_CACHE_SIZE];
+static uint8_t dns_cache_count;
+static uint8_t dns_cache_free;
+static bool dns_cache_initialized;
 // Protects cache shared between blocking and asynchronous calls
 static SingletonPtr<PlatformMutex> dns_cache_mutex;
 #endif
@@ -149,140 +202,149 @@ extern "C" nsapi_error_t nsapi_dns_add_server(nsapi_addr_t addr, const char *int
 
 
 // DNS packet parsing
-static void dns_append_byte(uint8_t **p, uint8_t byte)
+static int dns_append_question(const Span<uint8_t> &packet, uint16_t id, const char *host, nsapi_version_t version)
 {
-    *(*p)++ = byte;
-}
+    ByteWriter writer(packet);
 
-static void dns_append_word(uint8_t **p, uint16_t word)
-{
+    // fill the header
+    writer.write_be16(id);      // id      = 1
+    writer.write_be16(0x0100);  // flags   = recursion required
+    writer.write_be16(1);       // qdcount = 1
+    writer.write_be16(0);       // ancount = 0
+    writer.write_be16(0);       // nscount = 0
+    writer.write_be16(0);       // arcount = 0
 
-    dns_append_byte(p, 0xff & (word >> 8));
-    dns_append_byte(p, 0xff & (word >> 0));
-}
+    // fill out the question names
+    while (host[0]) {
+        size_t label_len = strcspn(host, ".");
+        writer.write_u8(label_len);
+        writer.write_bytes(host, label_len);
+        host += label_len + (host[label_len] == '.');
+    }
 
-static void dns_append_name(uint8_t **p, const char *name, uint8_t len)
-{
-    dns_append_byte(p, len);
-    memcpy(*p, name, len);
-    *p += len;
-}
+    writer.write_u8(0);
 
-static uint8_t dns_scan_byte(const uint8_t **p)
-{
-    return *(*p)++;
+    // fill out question footer
+    if (version != NSAPI_IPv6) {
+        writer.write_be16(RR_A);        // qtype  = ipv4
+    } else {
+        writer.write_be16(RR_AAAA);     // qtype  = ipv6
+    }
+    writer.write_be16(CLASS_IN);
+
+    return writer.ok() ? (int) writer.position() : NSAPI_ERROR_PARAMETER;
 }
 
-static uint16_t dns_scan_word(const uint8_t **p)
+// Whether a lookup asks for A and AAAA records together
+static bool dns_race(nsapi_version_t version)
 {
-    uint16_t a = dns_scan_byte(p);
-    uint16_t b = dns_scan_byte(p);
-    return (a << 8) | b;
+    return MBED_CONF_NSAPI_DNS_RACE_UNSPEC && version == NSAPI_UNSPEC;
 }
 
-static uint32_t dns_scan_word32(const uint8_t **p)
+static uint16_t nsapi_dns_next_message_id()
 {
-    uint32_t value = dns_scan_byte(p) << 24;
-    value |= dns_scan_byte(p) << 16;
-    value |= dns_scan_byte(p) << 8;
-    value |= dns_scan_byte(p);
-
-    return value;
+    uint16_t id = dns_message_id++;
+    if (dns_message_id == 0) {
+        dns_message_id = 1;
+    }
+    return id;
 }
 
-static int dns_append_question(uint8_t *ptr, uint16_t id, const char *host, nsapi_version_t version)
+// Sends the question to the server, followed by the AAAA question if id_aaaa is set
+static nsapi_size_or_error_t dns_send_question(UDPSocket *socket, const Span<uint8_t> &packet, const SocketAddress &dns_addr,
+                                               const char *host, uint16_t id, uint16_t id_aaaa)
 {
-    uint8_t *s_ptr = ptr;
-    uint8_t **p = &ptr;
-
-    // fill the header
-    dns_append_word(p, id);     // id      = 1
-    dns_append_word(p, 0x0100); // flags   = recursion required
-    dns_append_word(p, 1);      // qdcount = 1
-    dns_append_word(p, 0);      // ancount = 0
-    dns_append_word(p, 0);      // nscount = 0
-    dns_append_word(p, 0);      // arcount = 0
+    int len = dns_append_question(packet, id, host, id_aaaa ? NSAPI_IPv4 : dns_addr.get_ip_version());
+    nsapi_size_or_error_t err = socket->sendto(dns_addr, packet.data(), len);
 
-    // fill out the question names
-    while (host[0]) {
-        size_t label_len = strcspn(host, ".");
-        dns_append_name(p, host, label_len);
-        host += label_len + (host[label_len] == '.');
+    if (err >= 0 && id_aaaa) {
+        len = dns_append_question(packet, id_aaaa, host, NSAPI_IPv6);
+        err = socket->sendto(dns_addr, packet.data(), len);
     }
 
-    dns_append_byte(p, 0);
+    return err;
+}
 
-    // fill out question footer
-    if (version != NSAPI_IPv6) {
-        dns_append_word(p, RR_A);       // qtype  = ipv4
-    } else {
-        dns_append_word(p, RR_AAAA);    // qtype  = ipv6
-    }
-    dns_append_word(p, CLASS_IN);
+static void dns_skip_name(ByteReader &reader)
+{
+    while (true) {
+        uint8_t len = reader.read_u8();
+        if (len == 0) {
+            break;
+        } else if ((len & 0xc0) == 0xc0) { // this is link
+            reader.skip(1);
+            break;
+        }
 
-    return *p - s_ptr;
+        reader.skip(len);
+    }
 }
 
-static int dns_scan_response(const uint8_t *ptr, uint16_t exp_id, uint32_t *ttl, nsapi_addr_t *addr, unsigned addr_count)
+// Returns the number of addresses, or -1 if the response does not answer the query.
+// A response without addresses gives in ttl how long its negative answer can be
+// cached (RFC 2308), or 0 if it cannot, and in negative_version the version that
+// does not exist, or NSAPI_UNSPEC if the name does not exist at all.
+static int dns_scan_response(const Span<const uint8_t> &response, uint16_t exp_id, uint32_t *ttl, nsapi_addr_t *addr, unsigned addr_count, nsapi_version_t *negative_version)
 {
-    const uint8_t **p = &ptr;
+    ByteReader reader(response);
 
     // scan header
-    uint16_t id    = dns_scan_word(p);
-    uint16_t flags = dns_scan_word(p);
+    uint16_t id    = reader.read_be16();
+    uint16_t flags = reader.read_be16();
     bool    qr     = 0x1 & (flags >> 15);
     uint8_t opcode = 0xf & (flags >> 11);
     uint8_t rcode  = 0xf & (flags >>  0);
 
-    uint16_t qdcount = dns_scan_word(p); // qdcount
-    uint16_t ancount = dns_scan_word(p); // ancount
-    dns_scan_word(p);                    // nscount
-    dns_scan_word(p);                    // arcount
+    uint16_t qdcount = reader.read_be16(); // qdcount
+    uint16_t ancount = reader.read_be16(); // ancount
+    uint16_t nscount = reader.read_be16(); // nscount
+    reader.skip(sizeof(uint16_t));         // arcount
 
     // verify header is response to query
-    if (!(id == exp_id && qr && opcode == 0)) {
+    if (!reader.ok() || !(id == exp_id && qr && opcode == 0)) {
         return -1;
     }
 
-    if (rcode != 0) {
+    *ttl = 0;
+    *negative_version = NSAPI_UNSPEC;
+
+    // Server failures are not cached
+    if (rcode != 0 && rcode != RCODE_NXDOMAIN) {
         return 0;
     }
 
     // skip questions
-    for (int i = 0; i < qdcount; i++) {
-        while (true) {
-            uint8_t len = dns_scan_byte(p);
-            if (len == 0) {
-                break;
-            }
-
-            *p += len;
+    uint16_t qtype = RR_A;
+    for (int i = 0; i < qdcount && reader.ok(); i++) {
+        dns_skip_name(reader);
+        uint16_t type = reader.read_be16(); // qtype
+        reader.skip(sizeof(uint16_t));      // qclass
+        if (i == 0) {
+            qtype = type;
         }
-
-        dns_scan_word(p); // qtype
-        dns_scan_word(p); // qclass
     }
 
     // scan each response
     unsigned count = 0;
 
     for (int i = 0; i < ancount && count < addr_count; i++) {
-        while (true) {
-            uint8_t len = dns_scan_byte(p);
-            if (len == 0) {
-                break;
-            } else if (len & 0xc0) { // this is link
-                dns_scan_byte(p);
-                break;
-            }
+        dns_skip_name(reader);
+
+        uint16_t rtype    = reader.read_be16();    // rtype
+        uint16_t rclass   = reader.read_be16();    // rclass
+        uint32_t ttl_val  = reader.read_be32();    // ttl
+        uint16_t rdlength = reader.read_be16();    // rdlength
+        Span<const uint8_t> rdata = reader.read_span(rdlength);
 
-            *p += len;
+        // Keep the records parsed before any truncation
+        if (!reader.ok()) {
+            break;
         }
 
-        uint16_t rtype    = dns_scan_word(p);    // rtype
-        uint16_t rclass   = dns_scan_word(p);    // rclass
-        uint32_t ttl_val  = dns_scan_word32(p);  // ttl
-        uint16_t rdlength = dns_scan_word(p);    // rdlength
+        if (rcode != 0) {
+            // CNAME records of a name that does not exist
+            continue;
+        }
 
         if (i == 0) {
             // Is interested only on first address that is stored to cache
@@ -295,107 +357,309 @@ static int dns_scan_response(const uint8_t *ptr, uint16_t exp_id, uint32_t *ttl,
         if (rtype == RR_A && rclass == CLASS_IN && rdlength == NSAPI_IPv4_BYTES) {
             // accept A record
             addr->version = NSAPI_IPv4;
-            for (int i = 0; i < NSAPI_IPv4_BYTES; i++) {
-                addr->bytes[i] = dns_scan_byte(p);
-            }
-
-            addr += 1;
-            count += 1;
         } else if (rtype == RR_AAAA && rclass == CLASS_IN && rdlength == NSAPI_IPv6_BYTES) {
             // accept AAAA record
             addr->version = NSAPI_IPv6;
-            for (int i = 0; i < NSAPI_IPv6_BYTES; i++) {
-                addr->bytes[i] = dns_scan_byte(p);
-            }
-
-            addr += 1;
-            count += 1;
         } else {
             // skip unrecognized records
-            *p += rdlength;
+            continue;
         }
+
+        memcpy(addr->bytes, rdata.data(), rdlength);
+        addr += 1;
+        count += 1;
     }
 
-    return count;
+    if (count == 0 && !reader.ok()) {
+        return -1;
+    }
+
+    if (count > 0) {
+        return count;
+    }
+
+    // RFC 2308: a negative answer is cached for the smaller of the TTL and
+    // the MINIMUM field of the SOA record in the authority section, if any
+    *ttl = 0;
+    *negative_version = rcode == RCODE_NXDOMAIN ? NSAPI_UNSPEC : (qtype == RR_AAAA ? NSAPI_IPv6 : NSAPI_IPv4);
+
+    for (int i = 0; i < nscount; i++) {
+        dns_skip_name(reader);
+
+        uint16_t rtype    = reader.read_be16();    // rtype
+        reader.skip(sizeof(uint16_t));             // rclass
+        uint32_t ttl_val  = reader.read_be32();    // ttl
+        uint16_t rdlength = reader.read_be16();    // rdlength
+        Span<const uint8_t> rdata = reader.read_span(rdlength);
+
+        if (!reader.ok()) {
+            break;
+        }
+
+        if (rtype == RR_SOA) {
+            ByteReader soa(rdata);
+            dns_skip_name(soa);                    // mname
+            dns_skip_name(soa);                    // rname
+            soa.skip(4 * sizeof(uint32_t));        // serial, refresh, retry, expire
+            uint32_t minimum = soa.read_be32();    // minimum
+            if (soa.ok()) {
+                if (minimum < ttl_val) {
+                    ttl_val = minimum;
+                }
+                if (ttl_val > MBED_CONF_NSAPI_DNS_CACHE_NEGATIVE_TTL_MAX) {
+                    ttl_val = MBED_CONF_NSAPI_DNS_CACHE_NEGATIVE_TTL_MAX;
+                }
+                *ttl = ttl_val;
+            }
+            break;
+        }
+    }
+
+    return 0;
 }
 
-static void nsapi_dns_cache_add(const char *host, nsapi_addr_t *address, uint32_t ttl)
-{
 #if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
-    // RFC 1034: if TTL is zero, entry is not added to cache
-    if (ttl == 0) {
-        return;
+// FNV-1a
+static uint32_t nsapi_dns_cache_hash(const char *host)
+{
+    uint32_t hash = 2166136261u;
+    while (*host) {
+        hash = (hash ^ (uint8_t) *host++) * 16777619u;
     }
+    return hash;
+}
 
-    // Checks if already cached
-    if (nsapi_dns_cache_find(host, address->version, NULL) == NSAPI_ERROR_OK) {
+static void nsapi_dns_cache_init()
+{
+    if (dns_cache_initialized) {
         return;
     }
+    memset(dns_cache_bucket, DNS_CACHE_NONE, sizeof dns_cache_bucket);
+    for (int i = 0; i < MBED_CONF_NSAPI_DNS_CACHE_SIZE; i++) {
+        dns_cache[i].host = NULL;
+        dns_cache[i].next = i + 1 < MBED_CONF_NSAPI_DNS_CACHE_SIZE ? i + 1 : DNS_CACHE_NONE;
+    }
+    dns_cache_free = 0;
+    dns_cache_count = 0;
+    dns_cache_initialized = true;
+}
 
-    dns_cache_mutex->lock();
+static void nsapi_dns_cache_heap_swap(uint8_t a, uint8_t b)
+{
+    uint8_t entry = dns_cache_heap[a];
+    dns_cache_heap[a] = dns_cache_heap[b];
+    dns_cache_heap[b] = entry;
+    dns_cache[dns_cache_heap[a]].heap_index = a;
+    dns_cache[dns_cache_heap[b]].heap_index = b;
+}
 
-    int index = -1;
-    uint64_t accessed = UINT64_MAX;
+// Moves an entry whose expiry time changed to its place in the heap
+static void nsapi_dns_cache_heap_fix(uint8_t index)
+{
+    while (index > 0) {
+        uint8_t parent = (index - 1) / 2;
+        if (dns_cache[dns_cache_heap[parent]].expires <= dns_cache[dns_cache_heap[index]].expires) {
+            break;
+        }
+        nsapi_dns_cache_heap_swap(parent, index);
+        index = parent;
+    }
 
-    // Finds free or last accessed entry
-    for (int i = 0; i < MBED_CONF_NSAPI_DNS_CACHE_SIZE; i++) {
-        if (!dns_cache[i]) {
-            index = i;
+    while (true) {
+        uint8_t smallest = index;
+        for (unsigned child = 2 * index + 1; child <= 2u * index + 2 && child < dns_cache_count; child++) {
+            if (dns_cache[dns_cache_heap[child]].expires < dns_cache[dns_cache_heap[smallest]].expires) {
+                smallest = child;
+            }
+        }
+        if (smallest == index) {
             break;
-        } else if (dns_cache[i]->accessed <= accessed) {
-            accessed = dns_cache[i]->accessed;
-            index = i;
         }
+        nsapi_dns_cache_heap_swap(smallest, index);
+        index = smallest;
     }
+}
 
-    if (index < 0) {
-        dns_cache_mutex->unlock();
+static void nsapi_dns_cache_remove(uint8_t entry)
+{
+    DNS_CACHE *cache = &dns_cache[entry];
+
+    // Unlinks from bucket
+    uint8_t *link = &dns_cache_bucket[cache->hash & (DNS_CACHE_BUCKETS - 1)];
+    while (*link != entry) {
+        link = &dns_cache[*link].next;
+    }
+    *link = cache->next;
+
+    // Replaces with last heap entry
+    uint8_t index = cache->heap_index;
+    dns_cache_count--;
+    if (index != dns_cache_count) {
+        nsapi_dns_cache_heap_swap(index, dns_cache_count);
+        nsapi_dns_cache_heap_fix(index);
+    }
+
+    delete[] cache->host;
+    cache->host = NULL;
+    cache->next = dns_cache_free;
+    dns_cache_free = entry;
+}
+
+static void nsapi_dns_cache_expire(uint64_t ms_count)
+{
+    while (dns_cache_count && ms_count > dns_cache[dns_cache_heap[0]].expires) {
+        nsapi_dns_cache_remove(dns_cache_heap[0]);
+    }
+}
+
+// Adds or replaces the entry of host and version
+static DNS_CACHE *nsapi_dns_cache_insert(const char *host, nsapi_version_t version, bool negative, uint32_t ttl)
+{
+    uint64_t ms_count = rtos::Kernel::get_ms_count();
+    uint32_t hash = nsapi_dns_cache_hash(host);
+    uint8_t *bucket = &dns_cache_bucket[hash & (DNS_CACHE_BUCKETS - 1)];
+
+    nsapi_dns_cache_init();
+    nsapi_dns_cache_expire(ms_count);
+
+    // Removes entries that the new one replaces or contradicts: any entry of
+    // a name that does not exist, and those of the same version
+    uint8_t entry = *bucket;
+    while (entry != DNS_CACHE_NONE) {
+        DNS_CACHE *cache = &dns_cache[entry];
+        uint8_t next = cache->next;
+        if (cache->hash == hash && strcmp(cache->host, host) == 0 &&
+                (cache->version == version || cache->version == NSAPI_UNSPEC || version == NSAPI_UNSPEC)) {
+            nsapi_dns_cache_remove(entry);
+        }
+        entry = next;
+    }
+
+    char *host_copy = new (std::nothrow) char[strlen(host) + 1];
+    if (!host_copy) {
+        return NULL;
+    }
+    strcpy(host_copy, host);
+
+    // Takes a free entry, or evicts the one closest to expiry
+    if (dns_cache_free == DNS_CACHE_NONE) {
+        nsapi_dns_cache_remove(dns_cache_heap[0]);
+    }
+    entry = dns_cache_free;
+    DNS_CACHE *cache = &dns_cache[entry];
+    dns_cache_free = cache->next;
+
+    cache->host = host_copy;
+    cache->hash = hash;
+    cache->version = version;
+    cache->negative = negative;
+    cache->refreshing = false;
+    cache->hits = 0;
+    cache->ttl = ttl;
+    cache->expires = ms_count + (uint64_t) ttl * 1000;
+
+    cache->next = *bucket;
+    *bucket = entry;
+
+    cache->heap_index = dns_cache_count;
+    dns_cache_heap[dns_cache_count++] = entry;
+    nsapi_dns_cache_heap_fix(cache->heap_index);
+
+    return cache;
+}
+#endif
+
+static void nsapi_dns_cache_add(const char *host, nsapi_addr_t *address, uint32_t ttl)
+{
+#if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
+    // RFC 1034: if TTL is zero, entry is not added to cache
+    if (ttl == 0) {
         return;
     }
 
-    // Allocates in case entry is free, otherwise reuses
-    if (!dns_cache[index]) {
-        dns_cache[index] = new (std::nothrow) DNS_CACHE;
-    } else {
-        delete dns_cache[index]->host;
+    dns_cache_mutex->lock();
+
+    DNS_CACHE *cache = nsapi_dns_cache_insert(host, address->version, false, ttl);
+    if (cache) {
+        cache->address = *address;
     }
 
-    if (dns_cache[index]) {
-        dns_cache[index]->address = *address;
-        dns_cache[index]->host = new (std::nothrow) char[strlen(host) + 1];
-        strcpy(dns_cache[index]->host, host);
-        uint64_t ms_count = rtos::Kernel::get_ms_count();
-        dns_cache[index]->expires = ms_count + (uint64_t) ttl * 1000;
-        dns_cache[index]->accessed = ms_count;
+    dns_cache_mutex->unlock();
+#endif
+}
+
+static void nsapi_dns_cache_add_negative(const char *host, nsapi_version_t version, uint32_t ttl)
+{
+#if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
+    if (ttl == 0) {
+        return;
+    }
+
+    dns_cache_mutex->lock();
+
+    DNS_CACHE *cache = nsapi_dns_cache_insert(host, version, true, ttl);
+    if (cache) {
+        memset(&cache->address, 0, sizeof cache->address);
     }
 
     dns_cache_mutex->unlock();
 #endif
 }
 
-static nsapi_error_t nsapi_dns_cache_find(const char *host, nsapi_version_t version, nsapi_addr_t *address)
+// Returns NSAPI_ERROR_OK for a cached address, NSAPI_ERROR_DNS_FAILURE for a
+// cached negative answer, and NSAPI_ERROR_NO_ADDRESS if nothing is cached.
+// Sets refresh if the address is in demand and about to expire, so that the
+// caller refreshes it with nsapi_dns_cache_refresh(). The entry is marked as
+// refreshing at once so that concurrent lookups do not start the refresh too.
+static nsapi_error_t nsapi_dns_cache_find(const char *host, nsapi_version_t version, nsapi_addr_t *address, bool *refresh)
 {
     nsapi_error_t ret_val = NSAPI_ERROR_NO_ADDRESS;
 
+    if (refresh) {
+        *refresh = false;
+    }
+
 #if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
     dns_cache_mutex->lock();
 
-    for (int i = 0; i < MBED_CONF_NSAPI_DNS_CACHE_SIZE; i++) {
-        if (dns_cache[i]) {
-            uint64_t ms_count = rtos::Kernel::get_ms_count();
-            // Checks all entries for expired entries
-            if (ms_count > dns_cache[i]->expires) {
-                delete dns_cache[i]->host;
-                delete dns_cache[i];
-                dns_cache[i] = NULL;
-            } else if ((version == NSAPI_UNSPEC || version == dns_cache[i]->address.version) &&
-                       strcmp(dns_cache[i]->host, host) == 0) {
-                if (address) {
-                    *address = dns_cache[i]->address;
-                }
-                dns_cache[i]->accessed = ms_count;
-                ret_val = NSAPI_ERROR_OK;
+    nsapi_dns_cache_init();
+    uint64_t ms_count = rtos::Kernel::get_ms_count();
+    nsapi_dns_cache_expire(ms_count);
+
+    uint32_t hash = nsapi_dns_cache_hash(host);
+    uint8_t entry = dns_cache_bucket[hash & (DNS_CACHE_BUCKETS - 1)];
+
+    while (entry != DNS_CACHE_NONE) {
+        DNS_CACHE *cache = &dns_cache[entry];
+        entry = cache->next;
+
+        if (cache->hash != hash || strcmp(cache->host, host) != 0) {
+            continue;
+        }
+
+        if (cache->negative) {
+            // Any lookup of a name that does not exist fails, but a missing
+            // address of one version does not fail a lookup of either
+            if (cache->version == NSAPI_UNSPEC || (version != NSAPI_UNSPEC && cache->version == version)) {
+                ret_val = NSAPI_ERROR_DNS_FAILURE;
+                break;
+            }
+        } else if (version == NSAPI_UNSPEC || version == cache->version) {
+            if (address) {
+                *address = cache->address;
             }
+            if (cache->hits < UINT16_MAX) {
+                cache->hits++;
+            }
+#if MBED_CONF_NSAPI_DNS_CACHE_REFRESH_AHEAD
+            if (refresh && !cache->refreshing && cache->hits >= DNS_CACHE_REFRESH_HITS &&
+                    (cache->expires - ms_count) * DNS_CACHE_REFRESH_DIVISOR <= (uint64_t) cache->ttl * 1000) {
+                cache->refreshing = true;
+                *refresh = true;
+            }
+#endif
+            ret_val = NSAPI_ERROR_OK;
+            break;
         }
     }
 
@@ -405,18 +669,61 @@ static nsapi_error_t nsapi_dns_cache_find(const char *host, nsapi_version_t vers
     return ret_val;
 }
 
-static void nsapi_dns_cache_reset()
+static void nsapi_dns_cache_refresh_cb(nsapi_error_t result, SocketAddress *address)
+{
+    // The response has been added to the cache
+}
+
+// Lets a later lookup refresh an entry whose refresh could not be started
+static void nsapi_dns_cache_refresh_failed(const char *host, nsapi_version_t version)
 {
 #if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
     dns_cache_mutex->lock();
-    for (int i = 0; i < MBED_CONF_NSAPI_DNS_CACHE_SIZE; i++) {
-        if (dns_cache[i]) {
-            delete[] dns_cache[i]->host;
-            dns_cache[i]->host = NULL;
-            delete dns_cache[i];
-            dns_cache[i] = NULL;
+
+    uint32_t hash = nsapi_dns_cache_hash(host);
+    uint8_t entry = dns_cache_bucket[hash & (DNS_CACHE_BUCKETS - 1)];
+
+    while (entry != DNS_CACHE_NONE) {
+        DNS_CACHE *cache = &dns_cache[entry];
+        entry = cache->next;
+
+        if (cache->hash == hash && strcmp(cache->host, host) == 0 && !cache->negative &&
+                (version == NSAPI_UNSPEC || version == cache->version)) {
+            cache->refreshing = false;
+            break;
         }
     }
+
+    dns_cache_mutex->unlock();
+#endif
+}
+
+call_in_callback_cb_t nsapi_dns_get_call_in_callback(NetworkStack *stack)
+{
+    return stack->get_call_in_callback();
+}
+
+// Queries again an address found in the cache, replacing it there when answered.
+// Without an event context from the caller, the stack's own one is used.
+static void nsapi_dns_cache_refresh(NetworkStack *stack, const char *host, nsapi_version_t version, call_in_callback_cb_t call_in_cb)
+{
+    if (!call_in_cb) {
+        call_in_cb = nsapi_dns_get_call_in_callback(stack);
+    }
+    if ((!call_in_cb && !*dns_call_in.get()) ||
+            nsapi_dns_query_async_start(stack, host, nsapi_dns_cache_refresh_cb, 0, call_in_cb, NULL, version, true) < 0) {
+        nsapi_dns_cache_refresh_failed(host, version);
+    }
+}
+
+static void nsapi_dns_cache_reset()
+{
+#if (MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0)
+    dns_cache_mutex->lock();
+    nsapi_dns_cache_init();
+    while (dns_cache_count) {
+        nsapi_dns_cache_remove(dns_cache_heap[0]);
+    }
     dns_cache_mutex->unlock();
 #endif
 }
@@ -468,8 +775,15 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
     }
 
     // check cache
-    if (nsapi_dns_cache_find(host, version, addr) == NSAPI_ERROR_OK) {
+    bool refresh;
+    nsapi_error_t cached = nsapi_dns_cache_find(host, version, addr, &refresh);
+    if (refresh) {
+        nsapi_dns_cache_refresh(stack, host, version, NULL);
+    }
+    if (cached == NSAPI_ERROR_OK) {
         return 1;
+    } else if (cached == NSAPI_ERROR_DNS_FAILURE) {
+        return NSAPI_ERROR_DNS_FAILURE;
     }
 
     // create a udp socket
@@ -496,47 +810,85 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
     uint8_t index = 0;
     uint8_t total_attempts = MBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS;
     uint8_t send_success = 0;
+    uint8_t round_start = 0;
+    uint8_t round_sent = 0;
+    uint8_t negative = 0;
+    uint16_t id_aaaa = dns_race(version) ? 2 : 0;
 
     // check against each dns server
     while (true) {
         SocketAddress dns_addr;
+        bool round_done;
         err = nsapi_dns_get_server_addr(stack, &index, &total_attempts, &send_success, &dns_addr, interface_name);
         if (err != NSAPI_ERROR_OK) {
-            break;
-        }
+            if (round_sent == 0) {
+                break;
+            }
+            // no server is left to complete the round, so the servers
+            // already asked get the full response time
+            round_done = true;
+        } else {
+            if (version != NSAPI_UNSPEC && (dns_addr.get_ip_version() != version)) {
+                retries = MBED_CONF_NSAPI_DNS_RETRIES;
+                index++;
+                continue;
+            }
+            // send the question
+            err = dns_send_question(&socket, make_Span(packet, DNS_BUFFER_SIZE), dns_addr, host, 1, id_aaaa);
+            // send may fail for various reasons, including wrong address type - move on
+            if (err < 0) {
+                // goes to next dns server
+                retries = MBED_CONF_NSAPI_DNS_RETRIES;
+                index++;
+                continue;
+            }
 
-        if (version != NSAPI_UNSPEC && (dns_addr.get_ip_version() != version)) {
-            retries = MBED_CONF_NSAPI_DNS_RETRIES;
-            index++;
-            continue;
-        }
-        // send the question
-        int len = dns_append_question(packet, 1, host, dns_addr.get_ip_version());
+            send_success++;
 
-        err = socket.sendto(dns_addr, packet, len);
-        // send may fail for various reasons, including wrong address type - move on
-        if (err < 0) {
-            // goes to next dns server
-            retries = MBED_CONF_NSAPI_DNS_RETRIES;
-            index++;
-            continue;
-        }
+            if (total_attempts) {
+                total_attempts--;
+            }
 
-        send_success++;
+            if (round_sent++ == 0) {
+                round_start = index;
+            }
 
-        if (total_attempts) {
-            total_attempts--;
+            // waits for the next server of the round only the parallel delay
+            round_done = round_sent >= MBED_CONF_NSAPI_DNS_PARALLEL_SERVERS;
         }
+        socket.set_timeout(round_done ? MBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME : MBED_CONF_NSAPI_DNS_PARALLEL_DELAY);
+
+        // recv the response, until both are negative when racing
+        int resp = 0;
+        uint32_t ttl;
+        nsapi_version_t negative_version;
+        do {
+            err = socket.recvfrom(NULL, packet, DNS_BUFFER_SIZE);
+            if (err < 0) {
+                break;
+            }
+
+            uint16_t id = err >= 2 && ((packet[0] << 8) | packet[1]) == id_aaaa ? id_aaaa : 1;
+            resp = dns_scan_response(make_const_Span(packet, err), id, &ttl, addr, addr_count, &negative_version);
+            if (resp == 0) {
+                nsapi_dns_cache_add_negative(host, negative_version, ttl);
+                negative |= negative_version == NSAPI_UNSPEC ? 0x3 : (id == 1 ? 0x1 : 0x2);
+            }
+        } while (resp == 0 && id_aaaa && negative != 0x3);
 
-        // recv the response
-        err = socket.recvfrom(NULL, packet, DNS_BUFFER_SIZE);
         if (err == NSAPI_ERROR_WOULD_BLOCK) {
-            if (retries) {
+            if (!round_done) {
+                // asks the next server of the round
+                index++;
+            } else if (retries) {
                 // retries
                 retries--;
+                round_sent = 0;
+                index = round_start;
             } else {
                 // goes to next dns server
                 retries = MBED_CONF_NSAPI_DNS_RETRIES;
+                round_sent = 0;
                 index++;
             }
             continue;
@@ -545,9 +897,6 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
             break;
         }
 
-        const uint8_t *response = packet;
-        uint32_t ttl;
-        int resp = dns_scan_response(response, 1, &ttl, addr, addr_count);
         if (resp > 0) {
             nsapi_dns_cache_add(host, addr, ttl);
             result = resp;
@@ -661,6 +1010,14 @@ nsapi_error_t nsapi_dns_call_in(call_in_callback_cb_t cb, int delay, mbed::Callb
 nsapi_value_or_error_t nsapi_dns_query_multiple_async(NetworkStack *stack, const char *host,
                                                       NetworkStack::hostbyname_cb_t callback, nsapi_size_t addr_count,
                                                       call_in_callback_cb_t call_in_cb, const char *interface_name, nsapi_version_t version)
+{
+    return nsapi_dns_query_async_start(stack, host, callback, addr_count, call_in_cb, interface_name, version, false);
+}
+
+static nsapi_value_or_error_t nsapi_dns_query_async_start(NetworkStack *stack, const char *host,
+                                                          NetworkStack::hostbyname_cb_t callback, nsapi_size_t addr_count,
+                                                          call_in_callback_cb_t call_in_cb, const char *interface_name,
+                                                          nsapi_version_t version, bool refresh)
 {
     dns_mutex->lock();
 
@@ -675,11 +1032,21 @@ nsapi_value_or_error_t nsapi_dns_query_multiple_async(NetworkStack *stack, const
         return NSAPI_ERROR_PARAMETER;
     }
 
+    // A refresh replaces what is cached
     nsapi_addr address;
-    if (nsapi_dns_cache_find(host, version, &address) == NSAPI_ERROR_OK) {
+    bool refresh_cached;
+    nsapi_error_t cached = refresh ? NSAPI_ERROR_NO_ADDRESS : nsapi_dns_cache_find(host, version, &address, &refresh_cached);
+    if (cached == NSAPI_ERROR_OK) {
         SocketAddress addr(address);
         dns_mutex->unlock();
         callback(NSAPI_ERROR_OK, &addr);
+        if (refresh_cached) {
+            nsapi_dns_cache_refresh(stack, host, version, call_in_cb);
+        }
+        return NSAPI_ERROR_OK;
+    } else if (cached == NSAPI_ERROR_DNS_FAILURE) {
+        dns_mutex->unlock();
+        callback(NSAPI_ERROR_DNS_FAILURE, NULL);
         return NSAPI_ERROR_OK;
     }
 
@@ -725,6 +1092,10 @@ nsapi_value_or_error_t nsapi_dns_query_multiple_async(NetworkStack *stack, const
     query->total_attempts =  MBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS;
     query->send_success = 0;
     query->dns_message_id = 0;
+    query->dns_message_id_aaaa = 0;
+    query->round_start = 0;
+    query->round_sent = 0;
+    query->negative = 0;
     query->socket_timeout = 0;
     query->total_timeout = MBED_CONF_NSAPI_DNS_TOTAL_ATTEMPTS * MBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME + 500;
     query->count = 0;
@@ -1019,22 +1390,29 @@ static void nsapi_dns_query_async_send(void *ptr)
         }
     }
 
-    if (!query || query->state != DNS_INITIATED) {
-        // Cancel has been called
+    if (!query || query->state != DNS_INITIATED || query->status != NSAPI_ERROR_TIMEOUT) {
+        // Cancel has been called, or answer received
         dns_mutex->unlock();
         return;
     }
 
-    if (query->retries) {
-        query->retries--;
-    } else {
+    if (query->round_sent > 0 && query->round_sent < MBED_CONF_NSAPI_DNS_PARALLEL_SERVERS) {
+        // Asks the next server of the round with the same question
         query->dns_server++;
-        query->retries = MBED_CONF_NSAPI_DNS_RETRIES;
-    }
+    } else {
+        if (query->retries) {
+            query->retries--;
+            query->dns_server = query->round_start;
+        } else {
+            query->dns_server++;
+            query->retries = MBED_CONF_NSAPI_DNS_RETRIES;
+        }
+        query->round_sent = 0;
 
-    query->dns_message_id = dns_message_id++;
-    if (dns_message_id == 0) {
-        dns_message_id = 1;
+        query->dns_message_id = nsapi_dns_next_message_id();
+        if (dns_race(query->version)) {
+            query->dns_message_id_aaaa = nsapi_dns_next_message_id();
+        }
     }
 
     // create network packet
@@ -1048,8 +1426,16 @@ static void nsapi_dns_query_async_send(void *ptr)
         SocketAddress dns_addr;
         nsapi_size_or_error_t err = nsapi_dns_get_server_addr(query->stack, &(query->dns_server), &(query->total_attempts), &(query->send_success), &dns_addr, query->interface_name);
         if (err != NSAPI_ERROR_OK) {
-            nsapi_dns_query_async_resp(query, NSAPI_ERROR_TIMEOUT, NULL);
             free(packet);
+            if (query->round_sent == 0) {
+                nsapi_dns_query_async_resp(query, NSAPI_ERROR_TIMEOUT, NULL);
+                return;
+            }
+            // No server is left to complete the round, so the servers
+            // already asked get the full response time
+            query->round_sent = MBED_CONF_NSAPI_DNS_PARALLEL_SERVERS;
+            query->socket_timeout = MBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME;
+            dns_mutex->unlock();
             return;
         }
 
@@ -1058,9 +1444,8 @@ static void nsapi_dns_query_async_send(void *ptr)
             continue;
         }
         // send the question
-        int len = dns_append_question(packet, query->dns_message_id, query->host, dns_addr.get_ip_version());
-
-        err = query->socket->sendto(dns_addr, packet, len);
+        err = dns_send_question(query->socket, make_Span(packet, DNS_BUFFER_SIZE), dns_addr, query->host,
+                                query->dns_message_id, query->dns_message_id_aaaa);
 
         if (err < 0) {
             if (err == NSAPI_ERROR_WOULD_BLOCK) {
@@ -1082,9 +1467,19 @@ static void nsapi_dns_query_async_send(void *ptr)
         query->total_attempts--;
     }
 
+    if (query->round_sent++ == 0) {
+        query->round_start = query->dns_server;
+    }
+
     free(packet);
 
-    query->socket_timeout = MBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME;
+    if (query->round_sent < MBED_CONF_NSAPI_DNS_PARALLEL_SERVERS) {
+        // Asks the next server of the round after the parallel delay, unless answered
+        query->socket_timeout = 0;
+        nsapi_dns_call_in(query->call_in_cb, MBED_CONF_NSAPI_DNS_PARALLEL_DELAY, mbed::callback(nsapi_dns_query_async_send, ptr));
+    } else {
+        query->socket_timeout = MBED_CONF_NSAPI_DNS_RESPONSE_WAIT_TIME;
+    }
 
     dns_mutex->unlock();
 }
@@ -1133,13 +1528,14 @@ static void nsapi_dns_query_async_socket_callback_handle(NetworkStack *stack)
             DNS_QUERY *query = NULL;
 
             for (int i = 0; i < DNS_QUERY_QUEUE_SIZE; i++) {
-                if (dns_query_queue[i] && dns_query_queue[i]->dns_message_id == id) {
+                if (dns_query_queue[i] && (dns_query_queue[i]->dns_message_id == id || dns_query_queue[i]->dns_message_id_aaaa == id)) {
                     query = dns_query_queue[i];
                     break;
                 }
             }
 
-            if (!query || query->state != DNS_INITIATED) {
+            // Ignores answers of other servers once answered
+            if (!query || query->state != DNS_INITIATED || query->status != NSAPI_ERROR_TIMEOUT) {
                 continue;
             }
 
@@ -1150,7 +1546,16 @@ static void nsapi_dns_query_async_socket_callback_handle(NetworkStack *stack)
 
             query->addrs = new (std::nothrow) nsapi_addr_t[requested_count];
 
-            int resp = dns_scan_response(packet, id, &(query->ttl), query->addrs, requested_count);
+            int resp = dns_scan_response(make_const_Span(packet, size), id, &(query->ttl), query->addrs, requested_count, &(query->negative_version));
+
+            if (resp == 0 && query->dns_message_id_aaaa) {
+                // When racing, fails only when neither A nor AAAA is found
+                query->negative |= query->negative_version == NSAPI_UNSPEC ? 0x3 : (id == query->dns_message_id ? 0x1 : 0x2);
+                if (query->negative != 0x3) {
+                    nsapi_dns_cache_add_negative(query->host, query->negative_version, query->ttl);
+                    resp = -1;
+                }
+            }
 
             // Ignore invalid responses
             if (resp < 0) {
@@ -1203,6 +1608,9 @@ static void nsapi_dns_query_async_response(void *ptr)
             if (query->addr_count > 0) {
                 status = query->count;
             }
+        } else if (query->addrs) {
+            // Answered without addresses
+            nsapi_dns_cache_add_negative(query->host, query->negative_version, query->ttl);
         }
 
         nsapi_dns_query_async_resp(query, status, addresses);
@@ -20,6 +20,8 @@
 #ifndef MBED_ANALOGIN_API_H
 #define MBED_ANALOGIN_API_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "device.h"
 #include "pinmap.h"
 
@@ -98,6 +100,44 @@ float analogin_read(analogin_t *obj);
  */
 uint16_t analogin_read_u16(analogin_t *obj);
 
+/** Handler of hardware timed sampling, called in interrupt context
+ *
+ * @param context The context given to ::analogin_sample_start
+ * @param samples The samples converted since the last call
+ * @param count   The number of samples
+ */
+typedef void (*analogin_sample_handler_t)(void *context, uint16_t *samples, size_t count);
+
+/** Start converting at a fixed rate into a buffer without the CPU, with a timer and DMA
+ *
+ * Samples are unsigned 16bit values, as returned by ::analogin_read_u16. A
+ * single buffer is filled once, then sampling stops. A circular buffer is
+ * filled again and again, and the handler is called as each half is filled.
+ *
+ * The default implementation returns false, and AnalogInSampler samples from
+ * a ticker interrupt instead.
+ *
+ * @param obj       The analogin object
+ * @param buffer    The buffer of samples
+ * @param count     The number of samples in the buffer, even if circular
+ * @param period_us The time between samples in microseconds
+ * @param circular  Whether to fill the buffer again once full
+ * @param handler   The handler called as the buffer, or half of it, is filled
+ * @param context   The context passed to the handler
+ * @return true if sampling started, false if the target cannot sample this way
+ */
+bool analogin_sample_start(analogin_t *obj, uint16_t *buffer, size_t count, uint32_t period_us, bool circular,
+                           analogin_sample_handler_t handler, void *context);
+
+/** Stop sampling started by ::analogin_sample_start
+ *
+ * The handler is not called after this returns. This may be called from the
+ * handler.
+ *
+ * @param obj The analogin object
+ */
+void analogin_sample_stop(analogin_t *obj);
+
 /** Get the pins that support analogin
  *
  * Return a PinMap array of pins that support analogin. The
@@ -19,6 +19,7 @@
 #include "i2c_api.h"
 #include "spi_api.h"
 #include "gpio_api.h"
+#include "port_api.h"
 #include "mbed_toolchain.h"
 
 // To be re-implemented in the target layer if required
@@ -27,6 +28,14 @@ MBED_WEAK void gpio_free(gpio_t *obj)
     // Do nothing
 }
 
+#if DEVICE_PORTIN || DEVICE_PORTOUT
+// To be re-implemented in the target layer if required
+MBED_WEAK bool port_pin_lookup(PinName pin, PortName *port, int *pin_n)
+{
+    return false;
+}
+#endif
+
 #if DEVICE_I2C
 // To be re-implemented in the target layer if required
 MBED_WEAK void i2c_free(i2c_t *obj)
@@ -41,6 +50,19 @@ MBED_WEAK void analogin_free(analogin_t *obj)
 {
     // Do nothing
 }
+
+// To be re-implemented in the target layer if required
+MBED_WEAK bool analogin_sample_start(analogin_t *obj, uint16_t *buffer, size_t count, uint32_t period_us, bool circular,
+                                     analogin_sample_handler_t handler, void *context)
+{
+    return false;
+}
+
+// To be re-implemented in the target layer if required
+MBED_WEAK void analogin_sample_stop(analogin_t *obj)
+{
+    // Do nothing
+}
 #endif
 
 #if DEVICE_SPI
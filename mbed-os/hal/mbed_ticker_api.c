@@ -24,6 +24,194 @@
 static void schedule_interrupt(const ticker_data_t *const ticker);
 static void update_present_time(const ticker_data_t *const ticker);
 
+#if MBED_CONF_PLATFORM_TICKER_EVENT_HEAP
+/*
+ * Pending events are kept in a pairing heap rooted at queue->head, so the
+ * head is always the earliest event. Children of an event are linked through
+ * next, and prev points to the previous sibling, or to the parent for the
+ * first child. Events which are not in the heap have a NULL prev.
+ *
+ * Insertion is constant time and removal is amortized O(log n), so the time
+ * spent in critical sections does not grow with the number of pending events
+ * as it does with the sorted list.
+ */
+
+/*
+ * Meld two heaps, both roots must have no siblings. Returns the new root.
+ */
+static ticker_event_t *heap_meld(ticker_event_t *a, ticker_event_t *b)
+{
+    // keep a on top for equal timestamps, a is the event queued first
+    if (b->timestamp < a->timestamp) {
+        ticker_event_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    b->prev = a;
+    b->next = a->child;
+    if (a->child) {
+        a->child->prev = b;
+    }
+    a->child = b;
+
+    return a;
+}
+
+/*
+ * Meld a list of sibling heaps into one heap, in pairs from the left then
+ * from the right. Returns the new root or NULL for an empty list.
+ */
+static ticker_event_t *heap_merge_pairs(ticker_event_t *first)
+{
+    ticker_event_t *pairs = NULL;
+
+    // first pass: meld adjacent pairs, collecting them in reverse through next
+    while (first) {
+        ticker_event_t *a = first;
+        ticker_event_t *b = first->next;
+        a->prev = NULL;
+        if (b == NULL) {
+            a->next = pairs;
+            pairs = a;
+            break;
+        }
+        first = b->next;
+        a->next = NULL;
+        b->prev = NULL;
+        b->next = NULL;
+        a = heap_meld(a, b);
+        a->next = pairs;
+        pairs = a;
+    }
+
+    if (pairs == NULL) {
+        return NULL;
+    }
+
+    // second pass: meld the pairs from the right
+    ticker_event_t *root = pairs;
+    pairs = pairs->next;
+    root->next = NULL;
+    while (pairs) {
+        ticker_event_t *p = pairs;
+        pairs = p->next;
+        p->next = NULL;
+        root = heap_meld(root, p);
+    }
+
+    return root;
+}
+#endif
+
+/*
+ * Add an event to the queue. Returns true if it is the new head.
+ */
+static bool queue_insert(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+#if MBED_CONF_PLATFORM_TICKER_EVENT_HEAP
+    obj->next = NULL;
+    obj->child = NULL;
+    obj->prev = NULL;
+    queue->head = queue->head ? heap_meld(queue->head, obj) : obj;
+
+    return queue->head == obj;
+#else
+    /* Go through the list until we either reach the end, or find
+       an element this should come before (which is possibly the
+       head). */
+    ticker_event_t *prev = NULL, *p = queue->head;
+    while (p != NULL) {
+        /* check if we come before p */
+        if (obj->timestamp < p->timestamp) {
+            break;
+        }
+        /* go to the next element */
+        prev = p;
+        p = p->next;
+    }
+
+    /* if we're at the end p will be NULL, which is correct */
+    obj->next = p;
+
+    /* if prev is NULL we're at the head */
+    if (prev == NULL) {
+        queue->head = obj;
+    } else {
+        prev->next = obj;
+    }
+
+    return prev == NULL;
+#endif
+}
+
+/*
+ * Remove the head of the queue, which must not be empty.
+ */
+static void queue_pop(ticker_event_queue_t *queue)
+{
+    ticker_event_t *p = queue->head;
+
+#if MBED_CONF_PLATFORM_TICKER_EVENT_HEAP
+    queue->head = heap_merge_pairs(p->child);
+    p->child = NULL;
+    p->next = NULL;
+    p->prev = NULL;
+#else
+    queue->head = p->next;
+#endif
+}
+
+/*
+ * Remove an event from the queue if it is in it. Returns true if it was the head.
+ */
+static bool queue_remove(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+    if (queue->head == obj) {
+        // first in the queue, so just drop me
+        queue_pop(queue);
+        return true;
+    }
+
+#if MBED_CONF_PLATFORM_TICKER_EVENT_HEAP
+    if (obj->prev == NULL) {
+        // not queued
+        return false;
+    }
+
+    // unlink from the parent or previous sibling
+    if (obj->prev->child == obj) {
+        obj->prev->child = obj->next;
+    } else {
+        obj->prev->next = obj->next;
+    }
+    if (obj->next) {
+        obj->next->prev = obj->prev;
+    }
+    obj->next = NULL;
+    obj->prev = NULL;
+
+    // my children go back in the heap, none of them can be earlier than the head
+    if (obj->child) {
+        ticker_event_t *children = heap_merge_pairs(obj->child);
+        obj->child = NULL;
+        queue->head = heap_meld(queue->head, children);
+    }
+#else
+    // find the object before me, then drop me
+    ticker_event_t *p = queue->head;
+    while (p != NULL) {
+        if (p->next == obj) {
+            p->next = obj->next;
+            break;
+        }
+        p = p->next;
+    }
+#endif
+
+    return false;
+}
+
 /*
  * Initialize a ticker instance.
  */
@@ -328,7 +516,7 @@ void ticker_irq_handler(const ticker_data_t *const ticker)
             // This event was in the past:
             //      point to the following one and execute its handler
             ticker_event_t *p = ticker->queue->head;
-            ticker->queue->head = ticker->queue->head->next;
+            queue_pop(ticker->queue);
             if (ticker->queue->event_handler != NULL) {
                 (*ticker->queue->event_handler)(p->id); // NOTE: the handler can set new events
             }
@@ -376,31 +564,9 @@ void ticker_insert_event_us(const ticker_data_t *const ticker, ticker_event_t *o
     obj->timestamp = timestamp;
     obj->id = id;
 
-    /* Go through the list until we either reach the end, or find
-       an element this should come before (which is possibly the
-       head). */
-    ticker_event_t *prev = NULL, *p = ticker->queue->head;
-    while (p != NULL) {
-        /* check if we come before p */
-        if (timestamp < p->timestamp) {
-            break;
-        }
-        /* go to the next element */
-        prev = p;
-        p = p->next;
-    }
-
-    /* if we're at the end p will be NULL, which is correct */
-    obj->next = p;
+    bool is_head = queue_insert(ticker->queue, obj);
 
-    /* if prev is NULL we're at the head */
-    if (prev == NULL) {
-        ticker->queue->head = obj;
-    } else {
-        prev->next = obj;
-    }
-
-    if (prev == NULL || timestamp <= ticker->queue->present_time) {
+    if (is_head || timestamp <= ticker->queue->present_time) {
         schedule_interrupt(ticker);
     }
 
@@ -411,21 +577,9 @@ void ticker_remove_event(const ticker_data_t *const ticker, ticker_event_t *obj)
 {
     core_util_critical_section_enter();
 
-    // remove this object from the list
-    if (ticker->queue->head == obj) {
-        // first in the list, so just drop me
-        ticker->queue->head = obj->next;
+    // remove this object from the queue
+    if (queue_remove(ticker->queue, obj)) {
         schedule_interrupt(ticker);
-    } else {
-        // find the object before me, then drop me
-        ticker_event_t *p = ticker->queue->head;
-        while (p != NULL) {
-            if (p->next == obj) {
-                p->next = obj->next;
-                break;
-            }
-            p = p->next;
-        }
     }
 
     core_util_critical_section_exit();
@@ -20,6 +20,7 @@
 #ifndef MBED_PORTMAP_H
 #define MBED_PORTMAP_H
 
+#include <stdbool.h>
 #include "device.h"
 
 #if DEVICE_PORTIN || DEVICE_PORTOUT
@@ -45,6 +46,20 @@ typedef struct port_s port_t;
  */
 PinName port_pin(PortName port, int pin_n);
 
+/** Get the port and the port's pin number of a pin, the reverse of port_pin
+ *
+ * The default implementation returns false. Targets which implement it let
+ * BusIn, BusOut and BusInOut access their pins one port at a time, so their
+ * port_write must leave the pins outside the mask untouched even when another
+ * context changes them at the same time.
+ *
+ * @param pin   The pin name
+ * @param port  Holder for the port name
+ * @param pin_n Holder for the pin number within the port
+ * @return true on success, false if the port of the pin is not known
+ */
+bool port_pin_lookup(PinName pin, PortName *port, int *pin_n);
+
 /** Initilize the port
  *
  * @param obj  The port object to initialize
@@ -43,7 +43,11 @@ typedef uint64_t us_timestamp_t;
 typedef struct ticker_event_s {
     us_timestamp_t         timestamp; /**< Event's timestamp */
     uint32_t               id;        /**< TimerEvent object */
-    struct ticker_event_s *next;      /**< Next event in the queue */
+    struct ticker_event_s *next;      /**< Next event in the queue, or next sibling in the event heap */
+#if MBED_CONF_PLATFORM_TICKER_EVENT_HEAP
+    struct ticker_event_s *child;     /**< First child in the event heap */
+    struct ticker_event_s *prev;      /**< Previous sibling in the event heap, or parent of a first child */
+#endif
 } ticker_event_t;
 
 typedef void (*ticker_event_handler)(uint32_t id);
@@ -74,7 +78,7 @@ typedef struct {
  */
 typedef struct {
     ticker_event_handler event_handler; /**< Event handler */
-    ticker_event_t *head;               /**< A pointer to head */
+    ticker_event_t *head;               /**< A pointer to head, the earliest event */
     uint32_t frequency;                 /**< Frequency of the timer in Hz */
     uint32_t bitmask;                   /**< Mask to be applied to time values read */
     uint32_t max_delta;                 /**< Largest delta in ticks that can be used when scheduling */
@@ -121,6 +125,9 @@ void ticker_irq_handler(const ticker_data_t *const ticker);
  *
  * @param ticker The ticker object.
  * @param obj  The event object to be removed from the queue
+ *
+ * @note If platform.ticker-event-heap is enabled, an event which has never
+ * been inserted must be zero initialized before it is removed.
  */
 void ticker_remove_event(const ticker_data_t *const ticker, ticker_event_t *obj);
 
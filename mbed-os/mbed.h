@@ -60,6 +60,7 @@
 #include "drivers/PortInOut.h"
 #include "drivers/PortOut.h"
 #include "drivers/AnalogIn.h"
+#include "drivers/AnalogInSampler.h"
 #include "drivers/AnalogOut.h"
 #include "drivers/PwmOut.h"
 #include "drivers/Serial.h"
@@ -86,6 +87,7 @@
 #include "drivers/LowPowerTimer.h"
 #include "platform/LocalFileSystem.h"
 #include "drivers/InterruptIn.h"
+#include "drivers/InterruptInRecorder.h"
 #include "platform/mbed_wait_api.h"
 #include "platform/mbed_thread.h"
 #include "hal/sleep_api.h"
@@ -71,6 +71,11 @@ private:
     bool _dbg_on;
     bool _aborted;
 
+    // Receive buffer, filled in bulk from the file handle
+    char _recv_buff[32];
+    int _recv_len;
+    int _recv_pos;
+
     struct oob {
         unsigned len;
         const char *prefix;
@@ -79,6 +84,25 @@ private:
     };
     oob *_oobs;
 
+    // Trie of the out-of-band prefixes, so that every received character
+    // is matched against all of them in a single step
+    struct oob_node {
+        char c;
+        oob *match;
+        oob_node *child;
+        oob_node *sibling;
+    };
+    oob_node *_oob_root;
+
+    /**
+     * Fill the receive buffer from the file handle
+     *
+     * @return true if at least one byte was received before timeout
+     */
+    bool fill_buffer();
+
+    void free_oob_nodes(oob_node *node);
+
     /**
      * Receive an AT response
      *
@@ -110,7 +134,8 @@ public:
      */
     ATCmdParser(FileHandle *fh, const char *output_delimiter = "\r",
                 int buffer_size = 256, int timeout = 8000, bool debug = false)
-        : _fh(fh), _buffer_size(buffer_size), _oob_cb_count(0), _in_prev(0), _aborted(false), _oobs(NULL)
+        : _fh(fh), _buffer_size(buffer_size), _oob_cb_count(0), _in_prev(0), _aborted(false),
+          _recv_len(0), _recv_pos(0), _oobs(NULL), _oob_root(NULL)
     {
         _buffer = new char[buffer_size];
         set_timeout(timeout);
@@ -128,6 +153,7 @@ public:
             _oobs = oob->next;
             delete oob;
         }
+        free_oob_nodes(_oob_root);
         delete[] _buffer;
     }
 
@@ -0,0 +1,333 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_BYTEREADER_H
+#define MBED_BYTEREADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform/Span.h"
+
+namespace mbed {
+
+/** \addtogroup platform-public-api */
+/** @{*/
+
+/**
+ * \defgroup platform_ByteReader ByteReader class
+ * @{
+ */
+
+/** Bounds-checked reader of binary data held in a Span.
+ *
+ * Reads advance through the data without copying it. A read past the end
+ * fails, returns zero and puts the reader in an error state in which all
+ * further reads fail too, so a parser can make a series of reads and check
+ * ok() once at the end.
+ *
+ * @code
+ * ByteReader reader(packet, packet_size);
+ * uint16_t id = reader.read_be16();
+ * uint16_t flags = reader.read_be16();
+ * Span<const uint8_t> payload = reader.read_span(reader.read_be16());
+ * if (!reader.ok()) {
+ *     return -1;
+ * }
+ * @endcode
+ */
+class ByteReader {
+public:
+    /** TLV element as returned by read_tlv() */
+    struct Tlv {
+        uint32_t type;                  /**< Type field */
+        Span<const uint8_t> value;      /**< View of the value field */
+    };
+
+    /** Create a reader over data
+     *
+     * @param data Data to read, which must outlive the reader and any Span obtained from it
+     */
+    ByteReader(const Span<const uint8_t> &data) :
+        _data(data.data()), _size(data.size()), _pos(0), _ok(true)
+    {
+    }
+
+    /** Create a reader over a buffer
+     *
+     * @param data Pointer to the data
+     * @param size Number of bytes
+     */
+    ByteReader(const uint8_t *data, size_t size) :
+        _data(data), _size(size), _pos(0), _ok(true)
+    {
+    }
+
+    /** Check that no read has failed
+     *
+     * @return true if every read so far was within bounds
+     */
+    bool ok() const
+    {
+        return _ok;
+    }
+
+    /** Get the number of bytes not yet read
+     *
+     * @return Remaining bytes, 0 after a failed read
+     */
+    size_t remaining() const
+    {
+        return _ok ? _size - _pos : 0;
+    }
+
+    /** Get the offset of the next read from the start of the data
+     *
+     * @return Current position
+     */
+    size_t position() const
+    {
+        return _pos;
+    }
+
+    /** Get a view of the data not yet read
+     *
+     * @return Span of the remaining bytes
+     */
+    Span<const uint8_t> rest() const
+    {
+        return Span<const uint8_t>(_data + _pos, remaining());
+    }
+
+    /** Move to an absolute position, for example to follow an offset stored in the data
+     *
+     * @param position Offset from the start of the data
+     * @return true on success, false if out of bounds
+     */
+    bool seek(size_t position)
+    {
+        if (!_ok || position > _size) {
+            return fail();
+        }
+        _pos = position;
+        return true;
+    }
+
+    /** Skip bytes
+     *
+     * @param count Number of bytes to skip
+     * @return true on success, false if out of bounds
+     */
+    bool skip(size_t count)
+    {
+        if (!check(count)) {
+            return false;
+        }
+        _pos += count;
+        return true;
+    }
+
+    /** Read a byte
+     *
+     * @return The byte, or 0 on failure
+     */
+    uint8_t read_u8()
+    {
+        if (!check(1)) {
+            return 0;
+        }
+        return _data[_pos++];
+    }
+
+    /** Read a big-endian (network order) integer
+     *
+     * @tparam T Unsigned integer type to read
+     * @return The value, or 0 on failure
+     */
+    template<typename T>
+    T read_be()
+    {
+        if (!check(sizeof(T))) {
+            return 0;
+        }
+        const uint8_t *p = _data + _pos;
+        _pos += sizeof(T);
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value = (T)((value << 8) | p[i]);
+        }
+        return value;
+    }
+
+    /** Read a little-endian integer
+     *
+     * @tparam T Unsigned integer type to read
+     * @return The value, or 0 on failure
+     */
+    template<typename T>
+    T read_le()
+    {
+        if (!check(sizeof(T))) {
+            return 0;
+        }
+        const uint8_t *p = _data + _pos;
+        _pos += sizeof(T);
+        T value = 0;
+        for (size_t i = sizeof(T); i > 0; i--) {
+            value = (T)((value << 8) | p[i - 1]);
+        }
+        return value;
+    }
+
+    /** Read a big-endian 16-bit integer */
+    uint16_t read_be16()
+    {
+        return read_be<uint16_t>();
+    }
+
+    /** Read a big-endian 32-bit integer */
+    uint32_t read_be32()
+    {
+        return read_be<uint32_t>();
+    }
+
+    /** Read a big-endian 64-bit integer */
+    uint64_t read_be64()
+    {
+        return read_be<uint64_t>();
+    }
+
+    /** Read a little-endian 16-bit integer */
+    uint16_t read_le16()
+    {
+        return read_le<uint16_t>();
+    }
+
+    /** Read a little-endian 32-bit integer */
+    uint32_t read_le32()
+    {
+        return read_le<uint32_t>();
+    }
+
+    /** Read a little-endian 64-bit integer */
+    uint64_t read_le64()
+    {
+        return read_le<uint64_t>();
+    }
+
+    /** Read an unsigned LEB128 variable-length integer, as used by protobuf and CBOR-like encodings
+     *
+     * @return The value, or 0 on failure, including values not fitting 64 bits
+     */
+    uint64_t read_varint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = read_u8();
+            if (!_ok) {
+                return 0;
+            }
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                if (shift == 63 && byte > 1) {
+                    break;
+                }
+                return value;
+            }
+        }
+        fail();
+        return 0;
+    }
+
+    /** Get a view of the next bytes without copying them
+     *
+     * @param count Number of bytes
+     * @return Span of the bytes, empty on failure
+     */
+    Span<const uint8_t> read_span(size_t count)
+    {
+        if (!check(count)) {
+            return Span<const uint8_t>();
+        }
+        Span<const uint8_t> span(_data + _pos, count);
+        _pos += count;
+        return span;
+    }
+
+    /** Copy the next bytes out
+     *
+     * @param dest Destination buffer
+     * @param count Number of bytes
+     * @return true on success, false if out of bounds, in which case dest is untouched
+     */
+    bool read_bytes(void *dest, size_t count)
+    {
+        if (!check(count)) {
+            return false;
+        }
+        memcpy(dest, _data + _pos, count);
+        _pos += count;
+        return true;
+    }
+
+    /** Read a type-length-value element with big-endian type and length fields
+     *
+     * @tparam TypeT Unsigned integer type of the type field
+     * @tparam LengthT Unsigned integer type of the length field
+     * @param tlv Element read, its value a view into the data
+     * @return true on success, false at the end of the data or if the element is truncated
+     */
+    template<typename TypeT, typename LengthT>
+    bool read_tlv(Tlv &tlv)
+    {
+        if (remaining() == 0) {
+            return false;
+        }
+        tlv.type = read_be<TypeT>();
+        tlv.value = read_span(read_be<LengthT>());
+        return _ok;
+    }
+
+private:
+    bool check(size_t count)
+    {
+        if (!_ok || count > _size - _pos) {
+            return fail();
+        }
+        return true;
+    }
+
+    bool fail()
+    {
+        _ok = false;
+        return false;
+    }
+
+    const uint8_t *_data;
+    size_t _size;
+    size_t _pos;
+    bool _ok;
+};
+
+/** @}*/
+
+/** @}*/
+
+} // namespace mbed
+
+#endif // MBED_BYTEREADER_H
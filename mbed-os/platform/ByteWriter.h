@@ -0,0 +1,302 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_BYTEWRITER_H
+#define MBED_BYTEWRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform/Span.h"
+
+namespace mbed {
+
+/** \addtogroup platform-public-api */
+/** @{*/
+
+/**
+ * \defgroup platform_ByteWriter ByteWriter class
+ * @{
+ */
+
+/** Bounds-checked writer of binary data into a Span.
+ *
+ * The counterpart of ByteReader. A write that does not fit fails, writes
+ * nothing and puts the writer in an error state in which all further writes
+ * fail too, so ok() only needs checking once the message is complete.
+ *
+ * @code
+ * ByteWriter writer(make_Span(packet));
+ * writer.write_be16(id);
+ * writer.write_be16(flags);
+ * if (!writer.ok()) {
+ *     return -1;
+ * }
+ * send(packet, writer.position());
+ * @endcode
+ */
+class ByteWriter {
+public:
+    /** Create a writer into a buffer
+     *
+     * @param buffer Buffer to fill, which must outlive the writer
+     */
+    ByteWriter(const Span<uint8_t> &buffer) :
+        _data(buffer.data()), _size(buffer.size()), _pos(0), _ok(true)
+    {
+    }
+
+    /** Create a writer into a buffer
+     *
+     * @param data Pointer to the buffer
+     * @param size Size of the buffer
+     */
+    ByteWriter(uint8_t *data, size_t size) :
+        _data(data), _size(size), _pos(0), _ok(true)
+    {
+    }
+
+    /** Check that no write has failed
+     *
+     * @return true if every write so far fitted
+     */
+    bool ok() const
+    {
+        return _ok;
+    }
+
+    /** Get the number of bytes written
+     *
+     * @return Current position
+     */
+    size_t position() const
+    {
+        return _pos;
+    }
+
+    /** Get the space left
+     *
+     * @return Bytes that can still be written, 0 after a failed write
+     */
+    size_t remaining() const
+    {
+        return _ok ? _size - _pos : 0;
+    }
+
+    /** Get a view of what has been written
+     *
+     * @return Span of the bytes written
+     */
+    Span<const uint8_t> written() const
+    {
+        return Span<const uint8_t>(_data, _pos);
+    }
+
+    /** Write a byte
+     *
+     * @param value Byte to write
+     * @return true on success
+     */
+    bool write_u8(uint8_t value)
+    {
+        if (!check(1)) {
+            return false;
+        }
+        _data[_pos++] = value;
+        return true;
+    }
+
+    /** Write a big-endian (network order) integer
+     *
+     * @tparam T Unsigned integer type to write
+     * @param value Value to write
+     * @return true on success
+     */
+    template<typename T>
+    bool write_be(T value)
+    {
+        if (!check(sizeof(T))) {
+            return false;
+        }
+        uint8_t *p = _data + _pos;
+        _pos += sizeof(T);
+        for (size_t i = sizeof(T); i > 0; i--) {
+            p[i - 1] = (uint8_t) value;
+            value = (T)(value >> 8);
+        }
+        return true;
+    }
+
+    /** Write a little-endian integer
+     *
+     * @tparam T Unsigned integer type to write
+     * @param value Value to write
+     * @return true on success
+     */
+    template<typename T>
+    bool write_le(T value)
+    {
+        if (!check(sizeof(T))) {
+            return false;
+        }
+        uint8_t *p = _data + _pos;
+        _pos += sizeof(T);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            p[i] = (uint8_t) value;
+            value = (T)(value >> 8);
+        }
+        return true;
+    }
+
+    /** Write a big-endian 16-bit integer */
+    bool write_be16(uint16_t value)
+    {
+        return write_be<uint16_t>(value);
+    }
+
+    /** Write a big-endian 32-bit integer */
+    bool write_be32(uint32_t value)
+    {
+        return write_be<uint32_t>(value);
+    }
+
+    /** Write a big-endian 64-bit integer */
+    bool write_be64(uint64_t value)
+    {
+        return write_be<uint64_t>(value);
+    }
+
+    /** Write a little-endian 16-bit integer */
+    bool write_le16(uint16_t value)
+    {
+        return write_le<uint16_t>(value);
+    }
+
+    /** Write a little-endian 32-bit integer */
+    bool write_le32(uint32_t value)
+    {
+        return write_le<uint32_t>(value);
+    }
+
+    /** Write a little-endian 64-bit integer */
+    bool write_le64(uint64_t value)
+    {
+        return write_le<uint64_t>(value);
+    }
+
+    /** Write an unsigned LEB128 variable-length integer
+     *
+     * @param value Value to write
+     * @return true on success, false if it does not fit, in which case nothing is written
+     */
+    bool write_varint(uint64_t value)
+    {
+        size_t length = 1;
+        for (uint64_t v = value >> 7; v; v >>= 7) {
+            length++;
+        }
+        if (!check(length)) {
+            return false;
+        }
+        while (value >= 0x80) {
+            _data[_pos++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        _data[_pos++] = (uint8_t) value;
+        return true;
+    }
+
+    /** Copy bytes in
+     *
+     * @param data Bytes to write
+     * @param count Number of bytes
+     * @return true on success
+     */
+    bool write_bytes(const void *data, size_t count)
+    {
+        if (!check(count)) {
+            return false;
+        }
+        memcpy(_data + _pos, data, count);
+        _pos += count;
+        return true;
+    }
+
+    /** Reserve space to be filled in place, avoiding a staging copy
+     *
+     * @param count Number of bytes
+     * @return Span of the reserved bytes, empty on failure
+     */
+    Span<uint8_t> reserve(size_t count)
+    {
+        if (!check(count)) {
+            return Span<uint8_t>();
+        }
+        Span<uint8_t> span(_data + _pos, count);
+        _pos += count;
+        return span;
+    }
+
+    /** Write a type-length-value element with big-endian type and length fields
+     *
+     * @tparam TypeT Unsigned integer type of the type field
+     * @tparam LengthT Unsigned integer type of the length field
+     * @param type Type of the element
+     * @param value Value of the element
+     * @return true on success, false if it does not fit, in which case nothing is written
+     */
+    template<typename TypeT, typename LengthT>
+    bool write_tlv(TypeT type, const Span<const uint8_t> &value)
+    {
+        size_t length = value.size();
+        if ((LengthT) length != length || !check(sizeof(TypeT) + sizeof(LengthT) + length)) {
+            return fail();
+        }
+        write_be<TypeT>(type);
+        write_be<LengthT>((LengthT) length);
+        return write_bytes(value.data(), length);
+    }
+
+private:
+    bool check(size_t count)
+    {
+        if (!_ok || count > _size - _pos) {
+            return fail();
+        }
+        return true;
+    }
+
+    bool fail()
+    {
+        _ok = false;
+        return false;
+    }
+
+    uint8_t *_data;
+    size_t _size;
+    size_t _pos;
+    bool _ok;
+};
+
+/** @}*/
+
+/** @}*/
+
+} // namespace mbed
+
+#endif // MBED_BYTEWRITER_H
@@ -0,0 +1,259 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_INTRUSIVEPTR_H
+#define MBED_INTRUSIVEPTR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "platform/mbed_atomic.h"
+
+namespace mbed {
+
+/** Base class embedding an atomic reference count in an object.
+  *
+  * Derive from RefCounted<Class> to manage instances with IntrusivePtr. The
+  * object is deleted when the last reference is released.
+  *
+  * @code
+  * class MyObject : public RefCounted<MyObject> {
+  * public:
+  *     int a;
+  * };
+  *
+  * IntrusivePtr<MyObject> ptr(new MyObject);
+  * @endcode
+  */
+template <class T>
+class RefCounted {
+public:
+    /**
+     * @brief Take a reference to the object.
+     */
+    void add_ref() const
+    {
+        core_util_atomic_incr_u32(&_ref_count, 1);
+    }
+
+    /**
+     * @brief Drop a reference, deleting the object if it was the last one.
+     */
+    void release_ref() const
+    {
+        if (core_util_atomic_decr_u32(&_ref_count, 1) == 0) {
+            delete static_cast<const T *>(this);
+        }
+    }
+
+    /**
+     * @brief Reference count accessor.
+     * @return Reference count.
+     */
+    uint32_t ref_count() const
+    {
+        return core_util_atomic_load_u32(&_ref_count);
+    }
+
+protected:
+    RefCounted(): _ref_count(0)
+    {
+    }
+
+    /* Copies are new objects and start without references */
+    RefCounted(const RefCounted &): _ref_count(0)
+    {
+    }
+
+    RefCounted &operator=(const RefCounted &)
+    {
+        return *this;
+    }
+
+    ~RefCounted()
+    {
+    }
+
+private:
+    mutable uint32_t _ref_count;
+};
+
+/** Intrusive shared pointer class.
+  *
+  * Like SharedPtr, but the reference count lives in the object itself, which
+  * must provide add_ref() and release_ref(), for example by deriving from
+  * RefCounted. Taking ownership allocates nothing, the pointer is a single word
+  * and a raw pointer can be turned back into an IntrusivePtr at any time.
+  */
+template <class T>
+class IntrusivePtr {
+public:
+    /**
+     * @brief Create empty IntrusivePtr not pointing to anything.
+     */
+    IntrusivePtr(): _ptr(NULL)
+    {
+    }
+
+    /**
+     * @brief Create new IntrusivePtr
+     * @param ptr Pointer to take a reference to
+     */
+    IntrusivePtr(T *ptr): _ptr(ptr)
+    {
+        if (_ptr != NULL) {
+            _ptr->add_ref();
+        }
+    }
+
+    /**
+     * @brief Copy constructor.
+     * @param source Object being copied from.
+     */
+    IntrusivePtr(const IntrusivePtr &source): _ptr(source._ptr)
+    {
+        if (_ptr != NULL) {
+            _ptr->add_ref();
+        }
+    }
+
+    /**
+     * @brief Move constructor.
+     * @param source Object being moved from, left empty.
+     */
+    IntrusivePtr(IntrusivePtr &&source): _ptr(source._ptr)
+    {
+        source._ptr = NULL;
+    }
+
+    /**
+     * @brief Destructor.
+     * @details Drop the reference held, deleting the object if it was the last.
+     */
+    ~IntrusivePtr()
+    {
+        if (_ptr != NULL) {
+            _ptr->release_ref();
+        }
+    }
+
+    /**
+     * @brief Assignment operator.
+     * @param source Object being assigned from.
+     * @return Object being assigned.
+     */
+    IntrusivePtr &operator=(const IntrusivePtr &source)
+    {
+        reset(source._ptr);
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment operator.
+     * @param source Object being moved from, left empty.
+     * @return Object being assigned.
+     */
+    IntrusivePtr &operator=(IntrusivePtr &&source)
+    {
+        if (this != &source) {
+            T *old = _ptr;
+            _ptr = source._ptr;
+            source._ptr = NULL;
+            if (old != NULL) {
+                old->release_ref();
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Replace the managed pointer.
+     * @param[in] ptr the new raw pointer to take a reference to.
+     */
+    void reset(T *ptr = NULL)
+    {
+        // Take the new reference first in case ptr is only kept alive by the old one
+        if (ptr != NULL) {
+            ptr->add_ref();
+        }
+        T *old = _ptr;
+        _ptr = ptr;
+        if (old != NULL) {
+            old->release_ref();
+        }
+    }
+
+    /**
+     * @brief Raw pointer accessor.
+     * @return Pointer.
+     */
+    T *get() const
+    {
+        return _ptr;
+    }
+
+    /**
+     * @brief Dereference object operator.
+     */
+    T &operator*() const
+    {
+        return *_ptr;
+    }
+
+    /**
+     * @brief Dereference object member operator.
+     */
+    T *operator->() const
+    {
+        return _ptr;
+    }
+
+    /**
+     * @brief Boolean conversion operator.
+     * @return Whether or not the pointer is NULL.
+     */
+    operator bool() const
+    {
+        return (_ptr != NULL);
+    }
+
+private:
+    T *_ptr;
+};
+
+/** Non-member relational operators.
+  */
+template <class T, class U>
+bool operator== (const IntrusivePtr<T> &lhs, const IntrusivePtr<U> &rhs)
+{
+    return (lhs.get() == rhs.get());
+}
+
+template <class T, class U>
+bool operator!= (const IntrusivePtr<T> &lhs, const IntrusivePtr<U> &rhs)
+{
+    return (lhs.get() != rhs.get());
+}
+
+} /* namespace mbed */
+
+#ifndef MBED_NO_GLOBAL_USING_DIRECTIVE
+using mbed::IntrusivePtr;
+using mbed::RefCounted;
+#endif
+
+#endif // MBED_INTRUSIVEPTR_H
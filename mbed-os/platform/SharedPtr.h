@@ -23,10 +23,146 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <new>
+#include <utility>
+
 #include "platform/mbed_atomic.h"
 
 namespace mbed {
 
+template <class T>
+class WeakPtr;
+
+namespace internal {
+
+/** Reference counts shared by all SharedPtr and WeakPtr instances of an object.
+ *
+ * The object is destroyed when the shared count drops to zero, the block itself
+ * when the weak count does. The shared owners collectively hold one weak count.
+ */
+class SharedPtrControl {
+public:
+    SharedPtrControl(): _shared(1), _weak(1)
+    {
+    }
+
+    void acquire()
+    {
+        core_util_atomic_incr_u32(&_shared, 1);
+    }
+
+    /** Take a shared reference unless the object is already gone.
+     * @return true if a reference was taken.
+     */
+    bool try_acquire()
+    {
+        uint32_t count = core_util_atomic_load_u32(&_shared);
+        while (count != 0) {
+            if (core_util_atomic_cas_u32(&_shared, &count, count + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void release()
+    {
+        if (core_util_atomic_decr_u32(&_shared, 1) == 0) {
+            dispose();
+            release_weak();
+        }
+    }
+
+    void acquire_weak()
+    {
+        core_util_atomic_incr_u32(&_weak, 1);
+    }
+
+    void release_weak()
+    {
+        if (core_util_atomic_decr_u32(&_weak, 1) == 0) {
+            destroy();
+        }
+    }
+
+    uint32_t use_count() const
+    {
+        return core_util_atomic_load_u32(&_shared);
+    }
+
+protected:
+    /** Destroy the managed object. */
+    virtual void dispose() = 0;
+
+    /** Free this control block. */
+    virtual void destroy() = 0;
+
+private:
+    uint32_t _shared;
+    uint32_t _weak;
+};
+
+/** Control block for an object allocated separately by the caller. */
+template <class T>
+class SharedPtrControlPtr : public SharedPtrControl {
+public:
+    SharedPtrControlPtr(T *ptr): _ptr(ptr)
+    {
+    }
+
+protected:
+    virtual void dispose()
+    {
+        delete _ptr;
+    }
+
+    virtual void destroy()
+    {
+        delete this;
+    }
+
+private:
+    T *_ptr;
+};
+
+/** Control block with the object stored inline, used by make_shared. */
+template <class T>
+class SharedPtrControlInplace : public SharedPtrControl {
+public:
+    template <typename... Args>
+    SharedPtrControlInplace(Args &&... args)
+    {
+        new (&_object) T(std::forward<Args>(args)...);
+    }
+
+    ~SharedPtrControlInplace()
+    {
+    }
+
+    T *object()
+    {
+        return &_object;
+    }
+
+protected:
+    virtual void dispose()
+    {
+        _object.~T();
+    }
+
+    virtual void destroy()
+    {
+        delete this;
+    }
+
+private:
+    union {
+        T _object;
+    };
+};
+
+} // namespace internal
+
 /** Shared pointer class.
   *
   * A shared pointer is a "smart" pointer that retains ownership of an object using
@@ -47,21 +183,34 @@ namespace mbed {
   *     ptr = NULL; // Reference to the struct instance is still held by ptr2
   *
   *     ptr2 = NULL; // The raw pointer is freed
+  *
+  *     // Object and reference counts in a single allocation
+  *     SharedPtr<MyStruct> ptr3 = make_shared<MyStruct>();
+  *
+  *     // Observe without keeping the object alive
+  *     WeakPtr<MyStruct> weak( ptr3 );
+  *     if (SharedPtr<MyStruct> locked = weak.lock()) {
+  *         locked->a = 1;
+  *     }
   * }
   * @endcode
   *
   *
   * It is similar to the std::shared_ptr class introduced in C++11;
-  * however, this is not a compatible implementation (no weak pointer, no make_shared, no custom deleters and so on.)
+  * however, this is not a compatible implementation (no custom deleters,
+  * no aliasing or conversions between pointer types and so on.)
   *
-  * Usage: SharedPtr<Class> ptr(new Class())
+  * Usage: SharedPtr<Class> ptr(new Class()) or make_shared<Class>()
   *
   * When ptr is passed around by value, the copy constructor and
   * destructor manages the reference count of the raw pointer.
   * If the counter reaches zero, delete is called on the raw pointer.
   *
-  * To avoid loops, use "weak" references by calling the original
-  * pointer directly through ptr.get().
+  * Taking ownership of a raw pointer allocates a separate control block for
+  * the reference counts; make_shared() allocates the object and the counts
+  * together. For objects carrying their own counter, see IntrusivePtr.
+  *
+  * To avoid loops, use WeakPtr for the back references.
   */
 
 template <class T>
@@ -71,7 +220,7 @@ public:
      * @brief Create empty SharedPtr not pointing to anything.
      * @details Used for variable declaration.
      */
-    SharedPtr(): _ptr(NULL), _counter(NULL)
+    SharedPtr(): _ptr(NULL), _control(NULL)
     {
     }
 
@@ -79,12 +228,11 @@ public:
      * @brief Create new SharedPtr
      * @param ptr Pointer to take control over
      */
-    SharedPtr(T *ptr): _ptr(ptr), _counter(NULL)
+    SharedPtr(T *ptr): _ptr(ptr), _control(NULL)
     {
         // Allocate counter on the heap, so it can be shared
         if (_ptr != NULL) {
-            _counter = new uint32_t;
-            *_counter = 1;
+            _control = new internal::SharedPtrControlPtr<T>(ptr);
         }
     }
 
@@ -103,34 +251,65 @@ public:
      *          copying pointer to original object and pointer to counter.
      * @param source Object being copied from.
      */
-    SharedPtr(const SharedPtr &source): _ptr(source._ptr), _counter(source._counter)
+    SharedPtr(const SharedPtr &source): _ptr(source._ptr), _control(source._control)
     {
         // Increment reference counter
         if (_ptr != NULL) {
-            core_util_atomic_incr_u32(_counter, 1);
+            _control->acquire();
         }
     }
 
+    /**
+     * @brief Move constructor.
+     * @details Take over the reference held by source without touching the counter.
+     * @param source Object being moved from, left empty.
+     */
+    SharedPtr(SharedPtr &&source): _ptr(source._ptr), _control(source._control)
+    {
+        source._ptr = NULL;
+        source._control = NULL;
+    }
+
     /**
      * @brief Assignment operator.
      * @details Cleanup previous reference and assign new pointer and counter.
      * @param source Object being assigned from.
      * @return Object being assigned.
      */
-    SharedPtr operator=(const SharedPtr &source)
+    SharedPtr &operator=(const SharedPtr &source)
     {
         if (this != &source) {
+            // Increment new counter first in case source is owned by our object
+            if (source._ptr != NULL) {
+                source._control->acquire();
+            }
+
             // Clean up by decrementing counter
             decrement_counter();
 
             // Assign new values
-            _ptr = source.get();
-            _counter = source.get_counter();
+            _ptr = source._ptr;
+            _control = source._control;
+        }
 
-            // Increment new counter
-            if (_ptr != NULL) {
-                core_util_atomic_incr_u32(_counter, 1);
-            }
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment operator.
+     * @details Cleanup previous reference and take over the one held by source.
+     * @param source Object being moved from, left empty.
+     * @return Object being assigned.
+     */
+    SharedPtr &operator=(SharedPtr &&source)
+    {
+        if (this != &source) {
+            decrement_counter();
+
+            _ptr = source._ptr;
+            _control = source._control;
+            source._ptr = NULL;
+            source._control = NULL;
         }
 
         return *this;
@@ -148,10 +327,9 @@ public:
         _ptr = ptr;
         if (ptr != NULL) {
             // Allocate counter on the heap, so it can be shared
-            _counter = new uint32_t;
-            *_counter = 1;
+            _control = new internal::SharedPtrControlPtr<T>(ptr);
         } else {
-            _counter = NULL;
+            _control = NULL;
         }
     }
 
@@ -180,7 +358,7 @@ public:
     uint32_t use_count() const
     {
         if (_ptr != NULL) {
-            return core_util_atomic_load_u32(_counter);
+            return _control->use_count();
         } else {
             return 0;
         }
@@ -214,28 +392,29 @@ public:
     }
 
 private:
+    template <class U, typename... Args>
+    friend SharedPtr<U> make_shared(Args &&... args);
+
+    friend class WeakPtr<T>;
+
     /**
-     * @brief Get pointer to reference counter.
-     * @return Pointer to reference counter.
+     * @brief Adopt a reference already counted in control.
      */
-    uint32_t *get_counter() const
+    SharedPtr(T *ptr, internal::SharedPtrControl *control): _ptr(ptr), _control(control)
     {
-        return _counter;
     }
 
     /**
      * @brief Decrement reference counter.
-     * @details If count reaches zero, free counter and delete object pointed to.
+     * @details If count reaches zero, delete object pointed to, and free counter
+     * once no weak references remain.
      * Does not modify our own pointers - assumption is they will be overwritten
      * or destroyed immediately afterwards.
      */
     void decrement_counter()
     {
         if (_ptr != NULL) {
-            if (core_util_atomic_decr_u32(_counter, 1) == 0) {
-                delete _counter;
-                delete _ptr;
-            }
+            _control->release();
         }
     }
 
@@ -243,8 +422,130 @@ private:
     // Pointer to shared object
     T *_ptr;
 
-    // Pointer to shared reference counter
-    uint32_t *_counter;
+    // Pointer to shared reference counts
+    internal::SharedPtrControl *_control;
+};
+
+/** Create an object managed by a SharedPtr
+ *
+ * The object and its reference counts share one heap allocation, halving the
+ * allocations compared to SharedPtr<T>(new T) and keeping the counts next to
+ * the object.
+ *
+ * @param args Arguments for the constructor of T.
+ * @return SharedPtr owning the new object.
+ */
+template <class T, typename... Args>
+SharedPtr<T> make_shared(Args &&... args)
+{
+    internal::SharedPtrControlInplace<T> *control = new internal::SharedPtrControlInplace<T>(std::forward<Args>(args)...);
+    return SharedPtr<T>(control->object(), control);
+}
+
+/** Weak pointer class.
+  *
+  * Refers to an object managed by SharedPtr without keeping it alive. Use
+  * lock() to obtain a SharedPtr while the object still exists.
+  */
+template <class T>
+class WeakPtr {
+public:
+    /**
+     * @brief Create empty WeakPtr not pointing to anything.
+     */
+    WeakPtr(): _ptr(NULL), _control(NULL)
+    {
+    }
+
+    /**
+     * @brief Create WeakPtr observing the object of a SharedPtr.
+     * @param source SharedPtr to observe.
+     */
+    WeakPtr(const SharedPtr<T> &source): _ptr(source._ptr), _control(source._control)
+    {
+        if (_control != NULL) {
+            _control->acquire_weak();
+        }
+    }
+
+    /**
+     * @brief Copy constructor.
+     * @param source Object being copied from.
+     */
+    WeakPtr(const WeakPtr &source): _ptr(source._ptr), _control(source._control)
+    {
+        if (_control != NULL) {
+            _control->acquire_weak();
+        }
+    }
+
+    /**
+     * @brief Destructor.
+     * @details Release the reference counts once nothing else refers to them.
+     */
+    ~WeakPtr()
+    {
+        if (_control != NULL) {
+            _control->release_weak();
+        }
+    }
+
+    /**
+     * @brief Assignment operator.
+     * @param source Object being assigned from.
+     * @return Object being assigned.
+     */
+    WeakPtr &operator=(const WeakPtr &source)
+    {
+        if (this != &source) {
+            if (source._control != NULL) {
+                source._control->acquire_weak();
+            }
+            if (_control != NULL) {
+                _control->release_weak();
+            }
+            _ptr = source._ptr;
+            _control = source._control;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Stop observing the object.
+     */
+    void reset()
+    {
+        if (_control != NULL) {
+            _control->release_weak();
+        }
+        _ptr = NULL;
+        _control = NULL;
+    }
+
+    /**
+     * @brief Check if the object has been destroyed.
+     * @return true if there is no object to lock.
+     */
+    bool expired() const
+    {
+        return _control == NULL || _control->use_count() == 0;
+    }
+
+    /**
+     * @brief Get a SharedPtr to the object.
+     * @return SharedPtr to the object, or an empty SharedPtr if it has been destroyed.
+     */
+    SharedPtr<T> lock() const
+    {
+        if (_control != NULL && _control->try_acquire()) {
+            return SharedPtr<T>(_ptr, _control);
+        }
+        return SharedPtr<T>();
+    }
+
+private:
+    T *_ptr;
+    internal::SharedPtrControl *_control;
 };
 
 /** Non-member relational operators.
@@ -291,6 +592,7 @@ bool operator!= (U lhs, const SharedPtr<T> &rhs)
 
 #ifndef MBED_NO_GLOBAL_USING_DIRECTIVE
 using mbed::SharedPtr;
+using mbed::WeakPtr;
 #endif
 
 #endif // __SHAREDPTR_H__
@@ -0,0 +1,167 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_STATCOUNTER_H
+#define MBED_STATCOUNTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "platform/mbed_atomic.h"
+#include "platform/NonCopyable.h"
+#include "platform/SingletonPtr.h"
+#include "platform/PlatformMutex.h"
+
+/** \addtogroup platform-public-api */
+/** @{*/
+
+/**
+ * \defgroup platform_StatCounter StatCounter class
+ * @{
+ */
+
+/**
+ * struct mbed_stats_counter_t definition
+ */
+typedef struct {
+    const char *name;   /**< Name the counter was registered with */
+    uint32_t value;     /**< Value of the counter when it was read */
+} mbed_stats_counter_t;
+
+namespace mbed {
+
+/** Statistics counter updated without locks.
+ *
+ * Increments are relaxed atomic additions, so they can be made from any
+ * thread or interrupt without taking a mutex or entering a critical section
+ * on cores with exclusive access instructions. Nothing orders a counter
+ * against other memory; it is only meant for statistics.
+ *
+ * A counter constructed with a name is added to a global registry, which can
+ * be read in one call with StatCounter::get_each(). The name must outlive
+ * the counter.
+ *
+ * @code
+ * static StatCounter rx_packets("eth.rx_packets");
+ *
+ * void on_receive()
+ * {
+ *     ++rx_packets;
+ * }
+ * @endcode
+ */
+class StatCounter : private NonCopyable<StatCounter> {
+public:
+    /** Create a counter which is not registered. */
+    StatCounter() : _value(0), _name(NULL), _next(NULL)
+    {
+    }
+
+    /** Create a counter and add it to the registry.
+     *
+     * @param name  name reported by get_each(), or NULL to not register
+     */
+    explicit StatCounter(const char *name);
+
+    /** Remove the counter from the registry. */
+    ~StatCounter();
+
+    /** Add to the counter.
+     *
+     * @param delta amount to add
+     */
+    void add(uint32_t delta)
+    {
+        core_util_atomic_fetch_add_explicit_u32(&_value, delta, mbed_memory_order_relaxed);
+    }
+
+    /** Increment the counter by one. */
+    StatCounter &operator++()
+    {
+        add(1);
+        return *this;
+    }
+
+    /** Add to the counter.
+     *
+     * @param delta amount to add
+     */
+    StatCounter &operator+=(uint32_t delta)
+    {
+        add(delta);
+        return *this;
+    }
+
+    /** Read the counter.
+     *
+     * @return current value
+     */
+    uint32_t value() const
+    {
+        return core_util_atomic_load_explicit_u32(&_value, mbed_memory_order_relaxed);
+    }
+
+    /** Reset the counter to zero. */
+    void reset()
+    {
+        core_util_atomic_store_explicit_u32(&_value, 0, mbed_memory_order_relaxed);
+    }
+
+    /** Name of the counter.
+     *
+     * @return name passed to the constructor, or NULL
+     */
+    const char *name() const
+    {
+        return _name;
+    }
+
+    /** Fill the passed array with the name and value of each registered counter.
+     *
+     * Counters are reported most recently registered first.
+     *
+     * @param stats  array of mbed_stats_counter_t structures to fill
+     * @param count  number of structures in the array
+     * @return       number of structures filled, at most count
+     */
+    static size_t get_each(mbed_stats_counter_t *stats, size_t count);
+
+    /** Number of registered counters.
+     *
+     * @return counters in the registry
+     */
+    static size_t registered();
+
+    /** Reset every registered counter to zero. */
+    static void reset_all();
+
+private:
+    volatile uint32_t _value;
+    const char *const _name;
+    StatCounter *_next;
+
+    static StatCounter *_head;
+    static SingletonPtr<PlatformMutex> _mutex;
+};
+
+} // namespace mbed
+
+/**@}*/
+
+/**@}*/
+
+#endif
@@ -0,0 +1,255 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_FD_BUFFER_H
+#define MBED_FD_BUFFER_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "platform/mbed_retarget.h"
+#include "platform/mbed_critical.h"
+
+namespace mbed {
+namespace internal {
+
+/**
+ * \defgroup platform_FdBuffer FdBuffer class
+ * \ingroup platform-internal-api
+ * @{
+ */
+
+/** Unbuffered output function a buffer drains into
+ *
+ * Has the semantics of POSIX write(), returning -1 and setting errno on error.
+ */
+typedef ssize_t (*FdOutput)(int fd, const void *buffer, size_t size);
+
+/** Userspace output buffer for a retargeted file descriptor
+ *
+ * Provides setvbuf()-like behaviour below the C library, so that it applies
+ * to POSIX write() and to C streams that are themselves unbuffered.
+ *
+ * Has no constructor so that static instances are zero initialised, which
+ * leaves them unbuffered. Not thread safe, the owner must serialise calls.
+ */
+class FdBuffer {
+public:
+    /** Select the buffering mode
+     *
+     * Any data held in the previous buffer must be flushed first.
+     *
+     * @param buffer    storage for the buffer, owned by the caller
+     * @param mode      _IONBF, _IOLBF or _IOFBF
+     * @param size      size of the storage
+     */
+    void setup(char *buffer, int mode, size_t size);
+
+    /** Check if data written is currently held back
+     *
+     * @return true if writes go through the buffer
+     */
+    bool buffered() const
+    {
+        return _buffer && _mode != _IONBF;
+    }
+
+    /** Write data, buffering it according to the mode
+     *
+     * @param fd        file descriptor passed to output
+     * @param data      data to write
+     * @param size      number of bytes to write
+     * @param output    function writing to the file handle
+     * @return          number of bytes accepted, or -1 on error
+     *
+     * Once the data is in the buffer it is accepted: if writing it out then
+     * fails, it stays held and the error is reported by a later write or flush.
+     */
+    ssize_t write(int fd, const void *data, size_t size, FdOutput output);
+
+    /** Write out everything held in the buffer
+     *
+     * @param fd        file descriptor passed to output
+     * @param output    function writing to the file handle
+     * @return          0 on success, -1 on error
+     */
+    int flush(int fd, FdOutput output);
+
+private:
+    char *_buffer;
+    size_t _size;
+    size_t _used;
+    int _mode;
+};
+
+/** Output buffers of a table of file descriptors
+ *
+ * Threads must serialise calls, normally with a mutex. Interrupt and error
+ * handlers cannot wait for one: what they write goes out unbuffered, after
+ * the data held for the descriptor so that it does not overtake it. If they
+ * preempted a call in progress, the buffers are left alone and the preempted
+ * call writes out what they hold once it resumes.
+ *
+ * Has no constructor so that static instances are zero initialised, which
+ * leaves all descriptors unbuffered.
+ *
+ * @tparam N    number of file descriptors
+ */
+template <int N>
+class FdBufferTable {
+public:
+    /** Write data to a file descriptor
+     *
+     * @param fd        file descriptor
+     * @param data      data to write
+     * @param size      number of bytes to write
+     * @param output    function writing to the file handle
+     * @param thread    true if called from a thread, false from interrupt or error context
+     * @return          number of bytes accepted, or -1 on error
+     */
+    ssize_t write(int fd, const void *data, size_t size, FdOutput output, bool thread)
+    {
+        if (fd < 0 || fd >= N || !acquire()) {
+            return output(fd, data, size);
+        }
+        ssize_t ret;
+        if (thread) {
+            ret = _buffers[fd].write(fd, data, size, output);
+        } else {
+            _buffers[fd].flush(fd, output);
+            ret = output(fd, data, size);
+        }
+        release();
+        return ret;
+    }
+
+    /** Check if data written to a file descriptor is currently held back
+     *
+     * Not serialised with the other calls, so the answer is only stable
+     * while setvbuf() and close() are not running for the descriptor.
+     *
+     * @param fd        file descriptor
+     * @return          true if writes go through a buffer
+     */
+    bool buffered(int fd) const
+    {
+        return fd >= 0 && fd < N && _buffers[fd].buffered();
+    }
+
+    /** Write out the data held for a file descriptor
+     *
+     * @param fd        file descriptor
+     * @param output    function writing to the file handle
+     * @return          0 on success, -1 on error
+     */
+    int flush(int fd, FdOutput output)
+    {
+        if (fd < 0 || fd >= N || !acquire()) {
+            return 0;
+        }
+        int err = _buffers[fd].flush(fd, output);
+        release();
+        return err;
+    }
+
+    /** Write out the data held for all file descriptors, ignoring errors
+     *
+     * @param output    function writing to the file handle
+     */
+    void flush_all(FdOutput output)
+    {
+        if (!acquire()) {
+            return;
+        }
+        for (int fd = 0; fd < N; fd++) {
+            _buffers[fd].flush(fd, output);
+        }
+        release();
+    }
+
+    /** Flush a file descriptor and select its buffering mode
+     *
+     * @param fd        file descriptor
+     * @param buffer    storage for the buffer, owned by the caller
+     * @param mode      _IONBF, _IOLBF or _IOFBF
+     * @param size      size of the storage
+     * @param output    function writing to the file handle
+     * @return          0 on success, -1 on error
+     */
+    int setvbuf(int fd, char *buffer, int mode, size_t size, FdOutput output)
+    {
+        if (fd < 0 || fd >= N) {
+            errno = EBADF;
+            return -1;
+        }
+        if (!acquire()) {
+            errno = EBUSY;
+            return -1;
+        }
+        int err = _buffers[fd].flush(fd, output);
+        if (err == 0) {
+            _buffers[fd].setup(buffer, mode, size);
+        }
+        release();
+        return err;
+    }
+
+    /** Flush a file descriptor being closed and make it unbuffered
+     *
+     * The buffer is released even if the flush fails, so that a file
+     * opened later with the same descriptor does not reuse it.
+     *
+     * @param fd        file descriptor
+     * @param output    function writing to the file handle
+     * @return          0 on success, -1 on error
+     */
+    int close(int fd, FdOutput output)
+    {
+        if (fd < 0 || fd >= N || !acquire()) {
+            return 0;
+        }
+        int err = _buffers[fd].flush(fd, output);
+        _buffers[fd].setup(NULL, _IONBF, 0);
+        release();
+        return err;
+    }
+
+private:
+    bool acquire()
+    {
+        core_util_critical_section_enter();
+        bool acquired = !_busy;
+        _busy = true;
+        core_util_critical_section_exit();
+        return acquired;
+    }
+
+    void release()
+    {
+        _busy = false;
+    }
+
+    FdBuffer _buffers[N];
+    volatile bool _busy;
+};
+
+/**@}*/
+
+} // namespace internal
+} // namespace mbed
+
+#endif // MBED_FD_BUFFER_H
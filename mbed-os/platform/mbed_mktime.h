@@ -118,6 +118,8 @@ bool _rtc_maketime(const struct tm *time, time_t *seconds, rtc_leap_year_support
  *
  * @note For use by the HAL only.
  * @note Full and partial leap years support.
+ * @note The year of the previous conversion is remembered, so conversions
+ * within the same year only have to find the month and day.
  */
 bool _rtc_localtime(time_t timestamp, struct tm *time_info, rtc_leap_year_support_t leap_year_support);
 
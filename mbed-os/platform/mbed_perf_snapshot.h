@@ -0,0 +1,141 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PERF_SNAPSHOT_H
+#define MBED_PERF_SNAPSHOT_H
+#include <stdint.h>
+#include <stddef.h>
+#include "platform/mbed_error.h"
+#include "platform/mbed_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup platform-public-api */
+/** @{*/
+
+/**
+ * \defgroup platform_perf_snapshot Performance snapshot functions
+ *
+ * A compact record of the system state kept in the crash data RAM, which is
+ * preserved over a reset. It survives hangs and watchdog resets that give the
+ * error handler no chance to run.
+ *
+ * The event queue records each dispatch as it happens, so the last entries
+ * show what was running when the system stopped. Heap, stack and CPU
+ * statistics are refreshed by calling mbed_perf_snapshot_update() periodically.
+ *
+ * A snapshot found at boot is kept, and capture does not start, until the
+ * application reads it with mbed_get_reboot_perf_snapshot() or discards it
+ * with mbed_reset_reboot_perf_snapshot().
+ *
+ * Requires platform.crash-capture-enabled and platform.crash-perf-snapshot-enabled,
+ * and a crash data region large enough for ::mbed_perf_snapshot_t after the
+ * fault and error contexts.
+ * @{
+ */
+
+#ifndef MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES
+#define MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES 8
+#endif
+
+#ifndef MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_THREADS
+#define MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_THREADS 6
+#endif
+
+/** Duration of a dispatch which had not returned when the snapshot was taken */
+#define MBED_PERF_SNAPSHOT_IN_PROGRESS  0xFFFFFFFF
+
+/**
+ * struct mbed_perf_dispatch_t definition
+ */
+typedef struct {
+    uint32_t sequence;      /**< Number of the dispatch since capture started, 0 if unused */
+    uint32_t callback;      /**< Address of the function dispatched */
+    uint32_t start;         /**< Event queue tick (ms) when the dispatch started */
+    uint32_t duration;      /**< Duration in ms, or MBED_PERF_SNAPSHOT_IN_PROGRESS */
+} mbed_perf_dispatch_t;
+
+/**
+ * struct mbed_perf_snapshot_t definition
+ */
+typedef struct {
+    uint32_t magic;             /**< Marks the snapshot as initialized */
+    uint32_t stats_valid;       /**< Nonzero once statistics have been stored completely */
+    mbed_stats_cpu_t cpu;       /**< CPU statistics at the last update */
+    mbed_stats_heap_t heap;     /**< Heap statistics at the last update, including the high-water mark */
+    uint32_t stack_count;       /**< Number of valid entries in stacks */
+    mbed_stats_stack_t stacks[MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_THREADS]; /**< Per-thread stack high-water marks at the last update */
+    uint32_t dispatch_sequence; /**< Number of the most recent dispatch */
+    mbed_perf_dispatch_t dispatches[MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES]; /**< Ring of the most recent dispatches */
+} mbed_perf_snapshot_t;
+
+/**
+ * Initialize performance snapshot capture, this is called by the mbed-os boot sequence.
+ * A valid snapshot already present in the region is preserved for mbed_get_reboot_perf_snapshot().
+ * @param  region           Retained RAM for the snapshot.
+ * @param  size             Size of the region in bytes. Capture is disabled if it is too small.
+ */
+void mbed_perf_snapshot_init(void *region, size_t size);
+
+/**
+ * Refresh the heap, stack and CPU statistics in the snapshot.
+ * Call from one thread only, for example periodically from an event queue. Not for interrupt context.
+ */
+void mbed_perf_snapshot_update(void);
+
+/**
+ * Record the start of an event dispatch. Called by the event queue.
+ * @param  callback         Function being dispatched.
+ * @param  tick             Current event queue tick.
+ * @return                  Token for mbed_perf_snapshot_dispatch_end(), 0 if not recorded.
+ */
+uint32_t mbed_perf_snapshot_dispatch_begin(void (*callback)(void *), uint32_t tick);
+
+/**
+ * Record the end of an event dispatch. Called by the event queue.
+ * @param  token            Value returned by mbed_perf_snapshot_dispatch_begin().
+ * @param  tick             Current event queue tick.
+ */
+void mbed_perf_snapshot_dispatch_end(uint32_t token, uint32_t tick);
+
+/**
+ * Retrieve the snapshot that was in the crash data RAM when the system booted.
+ * It can be retrieved once; capture of a new snapshot then starts in its place.
+ * @param  snapshot             Pointer to mbed_perf_snapshot_t struct allocated by the caller.
+ * @return                      0 or MBED_SUCCESS on success.
+ *                              MBED_ERROR_INVALID_ARGUMENT in case of invalid snapshot pointer
+ *                              MBED_ERROR_ITEM_NOT_FOUND if no snapshot was preserved over the reboot
+ */
+mbed_error_status_t mbed_get_reboot_perf_snapshot(mbed_perf_snapshot_t *snapshot);
+
+/**
+ * Discard the snapshot preserved over the reboot and start capturing a new one.
+ * @return                  MBED_SUCCESS on success.
+ *                          MBED_ERROR_UNSUPPORTED if capture is not available
+ */
+mbed_error_status_t mbed_reset_reboot_perf_snapshot(void);
+
+/** @}*/
+
+/** @}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
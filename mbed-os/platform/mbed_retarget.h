@@ -574,6 +574,29 @@ extern "C" {
     ssize_t read(int fildes, void *buf, size_t nbyte);
     int fsync(int fildes);
     int isatty(int fildes);
+
+    /** Set the userspace output buffering of a file descriptor
+     *
+     * Works like setvbuf(), but in the retarget layer below the C library, so
+     * it also applies to POSIX write() and to unbuffered C streams. Requires
+     * platform.stdio-fd-buffering. Closing the file descriptor flushes it and
+     * makes it unbuffered again.
+     *
+     * @param fildes    file descriptor
+     * @param buf       storage for the buffer, must outlive its use
+     * @param mode      _IONBF, _IOLBF or _IOFBF
+     * @param size      size of buf in bytes
+     * @return          0 on success, -1 on error with errno set
+     */
+    int mbed_fd_setvbuf(int fildes, char *buf, int mode, size_t size);
+
+    /** Write out all buffered file descriptor output
+     *
+     * Takes no locks so it may be used from error and fault handlers. If one
+     * of these interrupted a write in progress, nothing is written, as the
+     * buffers may be in the middle of an update.
+     */
+    void mbed_fd_flush_all(void);
 #if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
     off_t lseek(int fildes, off_t offset, int whence);
     int ftruncate(int fildes, off_t length);
@@ -22,6 +22,10 @@
 #include "ATCmdParser.h"
 #include "mbed_poll.h"
 #include "mbed_debug.h"
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+#include "platform/source/minimal-printf/mbed_printf_implementation.h"
+#endif
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -42,6 +46,56 @@
 
 namespace mbed {
 
+// Pre-scan one line of a scanf-like format so that received characters can be
+// rejected cheaply, without running sscanf on every character.
+//  - prefix_len: number of leading ordinary characters that must match exactly
+//  - last_literal: ordinary character that must end the match, or 0 if the
+//    format ends with a conversion or whitespace
+static void scan_format(const char *format, int len, int *prefix_len, char *last_literal)
+{
+    int i = 0;
+    while (i < len && format[i] != '%' && !isspace((unsigned char)format[i])) {
+        i++;
+    }
+    *prefix_len = i;
+
+    *last_literal = 0;
+    i = 0;
+    while (i < len) {
+        if (format[i] != '%') {
+            *last_literal = isspace((unsigned char)format[i]) ? 0 : format[i];
+            i++;
+            continue;
+        }
+        i++;
+        if (i < len && format[i] == '%') {
+            *last_literal = '%';
+            i++;
+            continue;
+        }
+        // Skip assignment suppression, field width and length modifiers
+        while (i < len && (format[i] == '*' || isdigit((unsigned char)format[i]) ||
+                           strchr("hlLjztq", format[i]))) {
+            i++;
+        }
+        // Scan sets may contain ']' as first member
+        if (i < len && format[i] == '[') {
+            i++;
+            if (i < len && format[i] == '^') {
+                i++;
+            }
+            if (i < len && format[i] == ']') {
+                i++;
+            }
+            while (i < len && format[i] != ']') {
+                i++;
+            }
+        }
+        i++;
+        *last_literal = 0;
+    }
+}
+
 // getc/putc handling with timeouts
 int ATCmdParser::putc(char c)
 {
@@ -57,7 +111,7 @@ int ATCmdParser::putc(char c)
     }
 }
 
-int ATCmdParser::getc()
+bool ATCmdParser::fill_buffer()
 {
     pollfh fhs;
     fhs.fh = _fh;
@@ -65,15 +119,28 @@ int ATCmdParser::getc()
 
     int count = poll(&fhs, 1, _timeout);
     if (count > 0 && (fhs.revents & POLLIN)) {
-        unsigned char ch;
-        return _fh->read(&ch, 1) == 1 ? ch : -1;
-    } else {
+        ssize_t len = _fh->read(_recv_buff, sizeof(_recv_buff));
+        if (len > 0) {
+            _recv_pos = 0;
+            _recv_len = len;
+            return true;
+        }
+    }
+    return false;
+}
+
+int ATCmdParser::getc()
+{
+    if (_recv_pos == _recv_len && !fill_buffer()) {
         return -1;
     }
+    return (unsigned char)_recv_buff[_recv_pos++];
 }
 
 void ATCmdParser::flush()
 {
+    _recv_pos = 0;
+    _recv_len = 0;
     while (_fh->readable()) {
         unsigned char ch;
         _fh->read(&ch, 1);
@@ -95,22 +162,50 @@ int ATCmdParser::write(const char *data, int size)
 
 int ATCmdParser::read(char *data, int size)
 {
-    int i = 0;
-    for (; i < size; i++) {
-        int c = getc();
-        if (c < 0) {
+    // Take what is already buffered, then read the rest straight into the
+    // caller's memory
+    int i = _recv_len - _recv_pos;
+    if (i > size) {
+        i = size;
+    }
+    memcpy(data, _recv_buff + _recv_pos, i);
+    _recv_pos += i;
+
+    while (i < size) {
+        pollfh fhs;
+        fhs.fh = _fh;
+        fhs.events = POLLIN;
+
+        int count = poll(&fhs, 1, _timeout);
+        if (count <= 0 || !(fhs.revents & POLLIN)) {
+            return -1;
+        }
+        ssize_t len = _fh->read(data + i, size - i);
+        if (len <= 0) {
             return -1;
         }
-        data[i] = c;
+        i += len;
     }
     return i;
 }
 
 
 // printf/scanf handling
-int ATCmdParser::vprintf(const char *format, std::va_list args)
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+static int at_printf_sink(void *context, const char *data, size_t size)
 {
+    ATCmdParser *parser = static_cast<ATCmdParser *>(context);
+    return parser->write(data, size) == (int)size ? 0 : -1;
+}
+#endif
 
+int ATCmdParser::vprintf(const char *format, std::va_list args)
+{
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+    // Formatted straight to the file handle, bypassing _buffer
+    int count = mbed_minimal_formatted_string_to_sink(at_printf_sink, this, format, args);
+    return count < 0 ? -1 : count;
+#else
     if (vsprintf(_buffer, format, args) < 0) {
         return false;
     }
@@ -122,11 +217,27 @@ int ATCmdParser::vprintf(const char *format, std::va_list args)
         }
     }
     return i;
+#endif
 }
 
 // Command parsing with line handling
 bool ATCmdParser::vsend(const char *command, std::va_list args)
 {
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+    // Keep the arguments for the debug trace, which needs its own copy
+    std::va_list dbg_args;
+    va_copy(dbg_args, args);
+
+    if (mbed_minimal_formatted_string_to_sink(at_printf_sink, this, command, args) < 0) {
+        va_end(dbg_args);
+        return false;
+    }
+
+    if (_dbg_on) {
+        mbed_minimal_formatted_string(_buffer, _buffer_size, command, dbg_args, NULL);
+    }
+    va_end(dbg_args);
+#else
     // Create and send command
     if (vsprintf(_buffer, command, args) < 0) {
         return false;
@@ -137,6 +248,7 @@ bool ATCmdParser::vsend(const char *command, std::va_list args)
             return false;
         }
     }
+#endif
 
     // Finish with newline
     for (size_t i = 0; _output_delimiter[i]; i++) {
@@ -163,6 +275,8 @@ restart:
         int i = 0;
         int offset = 0;
         bool whole_line_wanted = false;
+        int prefix_len = 0;
+        char last_literal = 0;
 
         while (response && response[i]) {
             if (response[i] == '%' && response[i + 1] != '%' && response[i + 1] != '*') {
@@ -195,6 +309,10 @@ restart:
         _buffer[offset++] = 'n';
         _buffer[offset++] = 0;
 
+        if (response) {
+            scan_format(response, i, &prefix_len, &last_literal);
+        }
+
         debug_if(_dbg_on, "AT? %s\n", _buffer);
         // To workaround scanf's lack of error reporting, we actually
         // make two passes. One checks the validity with the modified
@@ -204,6 +322,10 @@ restart:
         // We keep trying the match until we succeed or some other error
         // derails us.
         int j = 0;
+        // Set when the line can no longer match the expected response
+        bool line_mismatch = false;
+        // Trie level to look for the next character of an oob prefix
+        oob_node *oob_level = _oob_root;
 
         while (true) {
             // Ran out of space
@@ -213,7 +335,7 @@ restart:
 
             // If just peeking for OOBs, and at start of line, check
             // readability
-            if (!response && j == 0 && !_fh->readable()) {
+            if (!response && j == 0 && _recv_pos == _recv_len && !_fh->readable()) {
                 return -1;
             }
 
@@ -245,30 +367,41 @@ restart:
             _buffer[offset + j] = 0;
 
             // Check for oob data
-            if (multiline) {
-                for (struct oob *oob = _oobs; oob; oob = oob->next) {
-                    if ((unsigned)j == oob->len && memcmp(
-                                oob->prefix, _buffer + offset, oob->len) == 0) {
-                        debug_if(_dbg_on, "AT! %s\n", oob->prefix);
-                        _oob_cb_count++;
-                        oob->cb();
-
-                        if (_aborted) {
-                            debug_if(_dbg_on, "AT(Aborted)\n");
-                            return false;
-                        }
-                        // oob may have corrupted non-reentrant buffer,
-                        // so we need to set it up again
-                        goto restart;
+            if (multiline && oob_level) {
+                oob_node *node = oob_level;
+                while (node && node->c != (char)c) {
+                    node = node->sibling;
+                }
+                oob_level = node ? node->child : NULL;
+
+                if (node && node->match) {
+                    struct oob *oob = node->match;
+                    debug_if(_dbg_on, "AT! %s\n", oob->prefix);
+                    _oob_cb_count++;
+                    oob->cb();
+
+                    if (_aborted) {
+                        debug_if(_dbg_on, "AT(Aborted)\n");
+                        return false;
                     }
+                    // oob may have corrupted non-reentrant buffer,
+                    // so we need to set it up again
+                    goto restart;
                 }
             }
 
+            // Ordinary characters leading the response must match exactly
+            if (j <= prefix_len && c != response[j - 1]) {
+                line_mismatch = true;
+            }
+
             // Check for match
             int count = -1;
             if (whole_line_wanted && c != '\n') {
                 // Don't attempt scanning until we get delimiter if they included it in format
                 // This allows recv("Foo: %s\n") to work, and not match with just the first character of a string
+            } else if (line_mismatch || j < prefix_len || (last_literal && c != last_literal)) {
+                // Can't match yet, so don't bother scanning
             } else if (response) {
                 sscanf(_buffer + offset, _buffer, &count);
             }
@@ -297,6 +430,8 @@ restart:
             if (c == '\n' || j + 1 >= _buffer_size - offset) {
                 debug_if(_dbg_on, "AT< %s", _buffer + offset);
                 j = 0;
+                line_mismatch = false;
+                oob_level = _oob_root;
             }
         }
     }
@@ -360,6 +495,41 @@ void ATCmdParser::oob(const char *prefix, Callback<void()> cb)
     oob->cb = cb;
     oob->next = _oobs;
     _oobs = oob;
+
+    if (oob->len == 0) {
+        return;
+    }
+
+    // Find or create the trie path for the prefix, the latest
+    // registration wins if the same prefix is registered twice
+    oob_node **level = &_oob_root;
+    oob_node *node = NULL;
+    for (unsigned i = 0; i < oob->len; i++) {
+        node = *level;
+        while (node && node->c != prefix[i]) {
+            node = node->sibling;
+        }
+        if (!node) {
+            node = new oob_node;
+            node->c = prefix[i];
+            node->match = NULL;
+            node->child = NULL;
+            node->sibling = *level;
+            *level = node;
+        }
+        level = &node->child;
+    }
+    node->match = oob;
+}
+
+void ATCmdParser::free_oob_nodes(oob_node *node)
+{
+    while (node) {
+        oob_node *next = node->sibling;
+        free_oob_nodes(node->child);
+        delete node;
+        node = next;
+    }
 }
 
 void ATCmdParser::abort()
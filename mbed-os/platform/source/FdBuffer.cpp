@@ -0,0 +1,77 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/internal/FdBuffer.h"
+#include <string.h>
+
+namespace mbed {
+namespace internal {
+
+void FdBuffer::setup(char *buffer, int mode, size_t size)
+{
+    _buffer = size ? buffer : NULL;
+    _size = size;
+    _used = 0;
+    _mode = mode;
+}
+
+int FdBuffer::flush(int fd, FdOutput output)
+{
+    size_t written = 0;
+    while (written < _used) {
+        ssize_t r = output(fd, _buffer + written, _used - written);
+        if (r <= 0) {
+            // Keep what could not be written for the next attempt
+            memmove(_buffer, _buffer + written, _used - written);
+            _used -= written;
+            return -1;
+        }
+        written += r;
+    }
+    _used = 0;
+    return 0;
+}
+
+ssize_t FdBuffer::write(int fd, const void *data, size_t size, FdOutput output)
+{
+    if (!buffered()) {
+        return output(fd, data, size);
+    }
+
+    if (_used + size > _size) {
+        if (flush(fd, output) < 0) {
+            return -1;
+        }
+        // Too big to ever fit, so pass straight through
+        if (size > _size) {
+            return output(fd, data, size);
+        }
+    }
+
+    memcpy(_buffer + _used, data, size);
+    _used += size;
+
+    if (_used == _size || (_mode == _IOLBF && memchr(data, '\n', size))) {
+        // The data is held now whether or not this succeeds, so a failure is
+        // left for the next write or flush to report
+        flush(fd, output);
+    }
+    return size;
+}
+
+} // namespace internal
+} // namespace mbed
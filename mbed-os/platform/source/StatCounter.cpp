@@ -0,0 +1,87 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/StatCounter.h"
+
+namespace mbed {
+
+StatCounter *StatCounter::_head = NULL;
+SingletonPtr<PlatformMutex> StatCounter::_mutex;
+
+StatCounter::StatCounter(const char *name) : _value(0), _name(name), _next(NULL)
+{
+    if (name != NULL) {
+        // put this counter at head of the registry
+        _mutex->lock();
+        _next = _head;
+        _head = this;
+        _mutex->unlock();
+    }
+}
+
+StatCounter::~StatCounter()
+{
+    if (_name == NULL) {
+        return;
+    }
+
+    _mutex->lock();
+    if (_head == this) {
+        _head = _next;
+    } else {
+        StatCounter *p = _head;
+        while (p->_next != this) {
+            p = p->_next;
+        }
+        p->_next = _next;
+    }
+    _mutex->unlock();
+}
+
+size_t StatCounter::get_each(mbed_stats_counter_t *stats, size_t count)
+{
+    size_t i = 0;
+    _mutex->lock();
+    for (StatCounter *p = _head; p != NULL && i < count; p = p->_next, i++) {
+        stats[i].name = p->_name;
+        stats[i].value = p->value();
+    }
+    _mutex->unlock();
+    return i;
+}
+
+size_t StatCounter::registered()
+{
+    size_t i = 0;
+    _mutex->lock();
+    for (StatCounter *p = _head; p != NULL; p = p->_next) {
+        i++;
+    }
+    _mutex->unlock();
+    return i;
+}
+
+void StatCounter::reset_all()
+{
+    _mutex->lock();
+    for (StatCounter *p = _head; p != NULL; p = p->_next) {
+        p->reset();
+    }
+    _mutex->unlock();
+}
+
+} // namespace mbed
@@ -16,6 +16,9 @@
  */
 #include "platform/Stream.h"
 #include "platform/mbed_error.h"
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+#include "platform/source/minimal-printf/mbed_printf_implementation.h"
+#endif
 #include <errno.h>
 
 namespace mbed {
@@ -154,15 +157,20 @@ off_t Stream::size()
 
 #if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
 
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+static int stream_printf_sink(void *context, const char *data, size_t size)
+{
+    Stream *stream = static_cast<Stream *>(context);
+    return stream->write(data, size) == (ssize_t)size ? 0 : -1;
+}
+#endif
+
 int Stream::printf(const char *format, ...)
 {
-    lock();
     std::va_list arg;
     va_start(arg, format);
-    std::fseek(_file, 0, SEEK_CUR);
-    int r = vfprintf(_file, format, arg);
+    int r = vprintf(format, arg);
     va_end(arg);
-    unlock();
     return r;
 }
 
@@ -182,7 +190,11 @@ int Stream::vprintf(const char *format, std::va_list args)
 {
     lock();
     std::fseek(_file, 0, SEEK_CUR);
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+    int r = mbed_minimal_formatted_string_to_sink(stream_printf_sink, this, format, args);
+#else
     int r = vfprintf(_file, format, args);
+#endif
     unlock();
     return r;
 }
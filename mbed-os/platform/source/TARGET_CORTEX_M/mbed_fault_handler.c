@@ -24,6 +24,7 @@
 #include "mbed_atomic.h"
 #include "mbed_error.h"
 #include "mbed_interface.h"
+#include "mbed_retarget.h"
 #include "mbed_crash_data_offsets.h"
 
 #ifndef MBED_FAULT_HANDLER_DISABLED
@@ -52,6 +53,8 @@ void mbed_fault_handler(uint32_t fault_type, const mbed_fault_context_t *mbed_fa
      * if they're first prints since boot and we have to init the I/O system.
      */
     if (!core_util_atomic_exchange_bool(&mbed_error_in_progress, true)) {
+        // Output buffered before the fault is the most useful context
+        mbed_fd_flush_all();
         mbed_error_printf("\n++ MbedOS Fault Handler ++\n\nFaultType: ");
 
         switch (fault_type) {
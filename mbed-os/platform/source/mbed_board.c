@@ -22,6 +22,9 @@
 #include "platform/mbed_interface.h"
 #include "platform/mbed_retarget.h"
 #include "platform/mbed_critical.h"
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+#include "platform/source/minimal-printf/mbed_printf_implementation.h"
+#endif
 
 WEAK MBED_NORETURN void mbed_die(void)
 {
@@ -56,6 +59,41 @@ void mbed_error_printf(const char *format, ...)
     va_end(arg);
 }
 
+static void mbed_error_write(const char *str, size_t length, char *stdio_out_prev)
+{
+#if MBED_CONF_PLATFORM_STDIO_CONVERT_NEWLINES || MBED_CONF_PLATFORM_STDIO_CONVERT_TTY_NEWLINES
+    for (; length; str++, length--) {
+        if (*str == '\n' && *stdio_out_prev != '\r') {
+            const char cr = '\r';
+            write(STDERR_FILENO, &cr, 1);
+        }
+        write(STDERR_FILENO, str, 1);
+        *stdio_out_prev = *str;
+    }
+#else
+    write(STDERR_FILENO, str, length);
+#endif
+}
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_STREAMING
+static int mbed_error_sink(void *context, const char *data, size_t size)
+{
+    mbed_error_write(data, size, (char *) context);
+    return 0;
+}
+
+void mbed_error_vprintf(const char *format, va_list arg)
+{
+    // Output is streamed to the console in chunks, so there is no
+    // length limit. See mbed_error_puts for the console handling.
+    char stdio_out_prev = '\0';
+    write(STDERR_FILENO, format, 0);
+
+    core_util_critical_section_enter();
+    mbed_minimal_formatted_string_to_sink(mbed_error_sink, &stdio_out_prev, format, arg);
+    core_util_critical_section_exit();
+}
+#else
 void mbed_error_vprintf(const char *format, va_list arg)
 {
     char buffer[132];
@@ -71,6 +109,7 @@ void mbed_error_vprintf(const char *format, va_list arg)
         mbed_error_puts(buffer);
     }
 }
+#endif
 
 void mbed_error_puts(const char *str)
 {
@@ -96,20 +135,9 @@ void mbed_error_puts(const char *str)
     // may work.
     write(STDERR_FILENO, str, 0);
 
-    core_util_critical_section_enter();
-#if MBED_CONF_PLATFORM_STDIO_CONVERT_NEWLINES || MBED_CONF_PLATFORM_STDIO_CONVERT_TTY_NEWLINES
     char stdio_out_prev = '\0';
-    for (; *str != '\0'; str++) {
-        if (*str == '\n' && stdio_out_prev != '\r') {
-            const char cr = '\r';
-            write(STDERR_FILENO, &cr, 1);
-        }
-        write(STDERR_FILENO, str, 1);
-        stdio_out_prev = *str;
-    }
-#else
-    write(STDERR_FILENO, str, strlen(str));
-#endif
+    core_util_critical_section_enter();
+    mbed_error_write(str, strlen(str), &stdio_out_prev);
     core_util_critical_section_exit();
 }
 
@@ -43,6 +43,13 @@ extern uint32_t __CRASH_DATA_RAM_END__[];
 #define ERROR_CONTEXT_SIZE      (0x80 / 4)    //32 words(128 bytes) bytes for Error Context
 #define FAULT_CONTEXT_LOCATION  (__CRASH_DATA_RAM_START__ + FAULT_CONTEXT_OFFSET)
 #define ERROR_CONTEXT_LOCATION  (__CRASH_DATA_RAM_START__ + ERROR_CONTEXT_OFFSET)
+#define PERF_SNAPSHOT_OFFSET    (ERROR_CONTEXT_OFFSET + ERROR_CONTEXT_SIZE)
+#define PERF_SNAPSHOT_LOCATION  (__CRASH_DATA_RAM_START__ + PERF_SNAPSHOT_OFFSET)
+#if defined(__CC_ARM) || (defined(__ARMCC_VERSION) && (__ARMCC_VERSION >= 6010050))
+#define CRASH_DATA_RAM_SIZE     ((uint32_t) &Image$$RW_m_crash_data$$ZI$$Size)
+#else
+#define CRASH_DATA_RAM_SIZE     ((uint32_t) ((uint8_t *) __CRASH_DATA_RAM_END__ - (uint8_t *) __CRASH_DATA_RAM_START__))
+#endif
 /**@}*/
 #endif
 
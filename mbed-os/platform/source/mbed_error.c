@@ -24,7 +24,9 @@
 #include "platform/mbed_error.h"
 #include "platform/source/mbed_error_hist.h"
 #include "platform/mbed_interface.h"
+#include "platform/mbed_perf_snapshot.h"
 #include "platform/mbed_power_mgmt.h"
+#include "platform/mbed_retarget.h"
 #include "platform/mbed_stats.h"
 #include "platform/source/TARGET_CORTEX_M/mbed_fault_handler.h"
 #include "mbed_rtx.h"
@@ -123,6 +125,8 @@ WEAK MBED_NORETURN void error(const char *format, ...)
     // Prevent recursion if error is called again during store+print attempt
     if (!core_util_atomic_exchange_bool(&mbed_error_in_progress, true)) {
         handle_error(MBED_ERROR_UNKNOWN, 0, NULL, 0, MBED_CALLER_ADDR());
+        // Get buffered output out ahead of the report
+        mbed_fd_flush_all();
         ERROR_REPORT(&last_error_ctx, "Fatal Run-time error", NULL, 0);
 
 #ifndef NDEBUG
@@ -242,6 +246,10 @@ WEAK void mbed_error_reboot_callback(mbed_error_ctx *error_context)
 mbed_error_status_t mbed_error_initialize(void)
 {
 #if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED
+#if MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    mbed_perf_snapshot_init(PERF_SNAPSHOT_LOCATION, CRASH_DATA_RAM_SIZE - PERF_SNAPSHOT_OFFSET * sizeof(uint32_t));
+#endif
+
     uint32_t crc_val = 0;
 
     //Just check if we have valid value for error_status, if error_status is positive(which is not valid), no need to check crc
@@ -316,6 +324,7 @@ WEAK MBED_NORETURN mbed_error_status_t mbed_error(mbed_error_status_t error_stat
         (void) handle_error(error_status, error_value, filename, line_number, MBED_CALLER_ADDR());
 
         //On fatal errors print the error context/report
+        mbed_fd_flush_all();
         ERROR_REPORT(&last_error_ctx, error_msg, filename, line_number);
     }
 
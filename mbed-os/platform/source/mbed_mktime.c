@@ -29,44 +29,38 @@
 #define EDGE_TIMESTAMP_FULL_LEAP_YEAR_SUPPORT 3220095     // 7th of February 1970 at 06:28:15
 #define EDGE_TIMESTAMP_4_YEAR_LEAP_YEAR_SUPPORT 3133695  // 6th of February 1970 at 06:28:15
 
+/* Day number of the 1st of March 2100, the first day after the 29th of February 2100 would have been. */
+#define DAY_1ST_MARCH_2100 47541
+/* Days from the 1st of January 1968, the leap year starting the first 4 year cycle, to the epoch. */
+#define DAYS_1968_TO_EPOCH 731
+#define DAYS_BY_4_YEARS (4 * 365 + 1)
+
 /*
- * 2 dimensional array containing the number of seconds elapsed before a given
- * month.
+ * 2 dimensional array containing the number of days elapsed before a given
+ * month, with a final entry for the length of the year.
  * The second index map to the month while the first map to the type of year:
  *   - 0: non leap year
  *   - 1: leap year
  */
-static const uint32_t seconds_before_month[2][12] = {
-    {
-        0,
-        31 * SECONDS_BY_DAY,
-        (31 + 28) *SECONDS_BY_DAY,
-        (31 + 28 + 31) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31) *SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30) *SECONDS_BY_DAY,
-    },
-    {
-        0,
-        31 * SECONDS_BY_DAY,
-        (31 + 29) *SECONDS_BY_DAY,
-        (31 + 29 + 31) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31) *SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30) *SECONDS_BY_DAY,
-    }
+static const uint16_t days_before_month[2][13] = {
+    { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365 },
+    { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366 }
 };
 
+/*
+ * Year of the last timestamp converted by _rtc_localtime(), one entry per
+ * leap year support mode. Packed in a single word so it is read and written
+ * atomically:
+ *   - bits [0:15]: day number of the 1st of January
+ *   - bits [16:23]: year, counted from 70
+ * Zero is the year 1970, which is valid in both modes.
+ */
+static volatile uint32_t year_cache[2];
+
+#define YEAR_CACHE_DAY(entry) ((entry) & 0xFFFF)
+#define YEAR_CACHE_YEAR(entry) (((entry) >> 16) + 70)
+#define YEAR_CACHE_ENTRY(day, year) ((uint32_t)(day) | ((uint32_t)((year) - 70) << 16))
+
 bool _rtc_is_leap_year(int year, rtc_leap_year_support_t leap_year_support)
 {
     /*
@@ -109,7 +103,7 @@ bool _rtc_maketime(const struct tm *time, time_t *seconds, rtc_leap_year_support
     result += time->tm_min * SECONDS_BY_MINUTES;
     result += time->tm_hour * SECONDS_BY_HOUR;
     result += (time->tm_mday - 1) * SECONDS_BY_DAY;
-    result += seconds_before_month[_rtc_is_leap_year(time->tm_year, leap_year_support)][time->tm_mon];
+    result += days_before_month[_rtc_is_leap_year(time->tm_year, leap_year_support)][time->tm_mon] * SECONDS_BY_DAY;
 
     /* Check if we are within valid range. */
     if (time->tm_year == LAST_VALID_YEAR) {
@@ -156,39 +150,49 @@ bool _rtc_localtime(time_t timestamp, struct tm *time_info, rtc_leap_year_suppor
      */
     time_info->tm_wday = (seconds + 4) % 7;
 
-    /* Years start at 70. */
-    time_info->tm_year = 70;
-    while (true) {
-        if (_rtc_is_leap_year(time_info->tm_year, leap_year_support) && seconds >= 366) {
-            ++time_info->tm_year;
-            seconds -= 366;
-        } else if (!_rtc_is_leap_year(time_info->tm_year, leap_year_support) && seconds >= 365) {
-            ++time_info->tm_year;
-            seconds -= 365;
-        } else {
-            /* The remaining days are less than a years. */
-            break;
+    /* Conversions within the year of the previous one skip the search for the year. */
+    uint32_t cached = year_cache[leap_year_support];
+    int year = YEAR_CACHE_YEAR(cached);
+    uint32_t year_start = YEAR_CACHE_DAY(cached);
+    bool leap = _rtc_is_leap_year(year, leap_year_support);
+
+    if (seconds < year_start || seconds - year_start >= days_before_month[leap][12]) {
+        /* Count whole 4 year cycles from 1968, each starting with a leap year.
+         * Without 2100 as a leap year, days from its missing 29th of February
+         * on are shifted by one so the cycles still line up.
+         */
+        uint32_t days = seconds + DAYS_1968_TO_EPOCH;
+        if (leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT && seconds >= DAY_1ST_MARCH_2100) {
+            days++;
         }
+        uint32_t day_of_cycle = days % DAYS_BY_4_YEARS;
+        year = 68 + (days / DAYS_BY_4_YEARS) * 4;
+        if (day_of_cycle >= 366) {
+            year += 1 + (day_of_cycle - 366) / 365;
+        }
+        leap = _rtc_is_leap_year(year, leap_year_support);
+
+        uint32_t day_of_year = (day_of_cycle < 366) ? day_of_cycle : (day_of_cycle - 366) % 365;
+        if (leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT && year == 200 && seconds >= DAY_1ST_MARCH_2100) {
+            day_of_year--;
+        }
+        year_start = seconds - day_of_year;
+        year_cache[leap_year_support] = YEAR_CACHE_ENTRY(year_start, year);
     }
 
-    time_info->tm_yday = seconds;
+    uint32_t yday = seconds - year_start;
+    time_info->tm_year = year;
+    time_info->tm_yday = yday;
 
-    /* Convert days into seconds and find the current month. */
-    seconds *= SECONDS_BY_DAY;
-    time_info->tm_mon = 11;
-    bool leap = _rtc_is_leap_year(time_info->tm_year, leap_year_support);
-    for (uint32_t i = 0; i < 12; ++i) {
-        if ((uint32_t) seconds < seconds_before_month[leap][i]) {
-            time_info->tm_mon = i - 1;
-            break;
-        }
+    /* Months are at most 31 days long, so yday / 32 never overshoots the month. */
+    uint32_t month = yday >> 5;
+    while (yday >= days_before_month[leap][month + 1]) {
+        month++;
     }
+    time_info->tm_mon = month;
 
-    /* Remove month from timestamp and compute the number of days.
-     * Note: unlike other fields, days are not 0 indexed.
-     */
-    seconds -= seconds_before_month[leap][time_info->tm_mon];
-    time_info->tm_mday = (seconds / SECONDS_BY_DAY) + 1;
+    /* Note: unlike other fields, days are not 0 indexed. */
+    time_info->tm_mday = yday - days_before_month[leap][month] + 1;
 
     return true;
 }
@@ -0,0 +1,162 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "platform/mbed_atomic.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_perf_snapshot.h"
+
+#define PERF_SNAPSHOT_MAGIC 0x50455246 // "PERF"
+
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+static mbed_perf_snapshot_t *snapshot;
+static bool is_capturing;
+static bool is_reboot_snapshot_valid;
+
+static void start_capture(void)
+{
+    memset(snapshot, 0, sizeof(mbed_perf_snapshot_t));
+    snapshot->magic = PERF_SNAPSHOT_MAGIC;
+    is_capturing = true;
+}
+#endif
+
+void mbed_perf_snapshot_init(void *region, size_t size)
+{
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    is_capturing = false;
+    is_reboot_snapshot_valid = false;
+    if (size < sizeof(mbed_perf_snapshot_t)) {
+        snapshot = NULL;
+        return;
+    }
+
+    snapshot = (mbed_perf_snapshot_t *) region;
+    if (snapshot->magic == PERF_SNAPSHOT_MAGIC) {
+        // Hold the previous run's snapshot until the application has seen it
+        is_reboot_snapshot_valid = true;
+    } else {
+        start_capture();
+    }
+#endif
+}
+
+void mbed_perf_snapshot_update(void)
+{
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    if (!is_capturing) {
+        return;
+    }
+
+    // Gather first so the retained copy is only invalid for a short time
+    mbed_stats_cpu_t cpu;
+    mbed_stats_heap_t heap;
+    mbed_stats_stack_t stacks[MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_THREADS];
+    mbed_stats_cpu_get(&cpu);
+    mbed_stats_heap_get(&heap);
+    size_t stack_count = mbed_stats_stack_get_each(stacks, MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_THREADS);
+
+    // A reset part way through leaves stats_valid clear
+    snapshot->stats_valid = 0;
+    snapshot->cpu = cpu;
+    snapshot->heap = heap;
+    snapshot->stack_count = stack_count;
+    memcpy(snapshot->stacks, stacks, sizeof(stacks));
+    snapshot->stats_valid = 1;
+#endif
+}
+
+uint32_t mbed_perf_snapshot_dispatch_begin(void (*callback)(void *), uint32_t tick)
+{
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    if (!is_capturing) {
+        return 0;
+    }
+
+    // Claiming the slot atomically lets several queues dispatch concurrently
+    uint32_t sequence = core_util_atomic_incr_u32(&snapshot->dispatch_sequence, 1);
+    if (sequence == 0) {
+        return 0;
+    }
+
+    mbed_perf_dispatch_t *dispatch = &snapshot->dispatches[sequence % MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES];
+    dispatch->sequence = 0;
+    dispatch->callback = (uint32_t)(uintptr_t) callback;
+    dispatch->start = tick;
+    dispatch->duration = MBED_PERF_SNAPSHOT_IN_PROGRESS;
+    dispatch->sequence = sequence;
+    return sequence;
+#else
+    return 0;
+#endif
+}
+
+void mbed_perf_snapshot_dispatch_end(uint32_t token, uint32_t tick)
+{
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    if (token == 0 || !is_capturing) {
+        return;
+    }
+
+    mbed_perf_dispatch_t *dispatch = &snapshot->dispatches[token % MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_DISPATCHES];
+    // The slot may have been reused while a long dispatch ran
+    if (dispatch->sequence == token) {
+        dispatch->duration = tick - dispatch->start;
+    }
+#endif
+}
+
+mbed_error_status_t mbed_get_reboot_perf_snapshot(mbed_perf_snapshot_t *perf_snapshot)
+{
+    mbed_error_status_t status = MBED_ERROR_ITEM_NOT_FOUND;
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    if (is_reboot_snapshot_valid) {
+        if (perf_snapshot != NULL) {
+            core_util_critical_section_enter();
+            memcpy(perf_snapshot, snapshot, sizeof(mbed_perf_snapshot_t));
+            // The caller has its copy now, so the region can record this run
+            is_reboot_snapshot_valid = false;
+            start_capture();
+            core_util_critical_section_exit();
+            status = MBED_SUCCESS;
+        } else {
+            status = MBED_ERROR_INVALID_ARGUMENT;
+        }
+    }
+#endif
+    return status;
+}
+
+mbed_error_status_t mbed_reset_reboot_perf_snapshot(void)
+{
+#if MBED_CONF_PLATFORM_CRASH_CAPTURE_ENABLED && MBED_CONF_PLATFORM_CRASH_PERF_SNAPSHOT_ENABLED
+    if (snapshot == NULL) {
+        return MBED_ERROR_UNSUPPORTED;
+    }
+
+    core_util_critical_section_enter();
+    is_reboot_snapshot_valid = false;
+    if (!is_capturing) {
+        start_capture();
+    }
+    core_util_critical_section_exit();
+    return MBED_SUCCESS;
+#else
+    return MBED_ERROR_UNSUPPORTED;
+#endif
+}
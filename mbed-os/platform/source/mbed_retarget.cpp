@@ -30,6 +30,7 @@
 #include "platform/mbed_atomic.h"
 #include "platform/mbed_critical.h"
 #include "platform/mbed_poll.h"
+#include "platform/internal/FdBuffer.h"
 #include "drivers/UARTSerial.h"
 #include "hal/us_ticker_api.h"
 #include "hal/lp_ticker_api.h"
@@ -125,6 +126,11 @@ static SingletonPtr<PlatformMutex> filehandle_mutex;
 static char stdio_in_prev[RETARGET_OPEN_MAX];
 static char stdio_out_prev[RETARGET_OPEN_MAX];
 
+static int fd_buffer_flush(int fildes);
+#if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
+static int fd_buffer_close(int fildes);
+#endif
+
 namespace mbed {
 void mbed_set_unbuffered_stream(std::FILE *_file);
 
@@ -662,6 +668,7 @@ extern "C" int PREFIX(_close)(FILEHANDLE fh)
 #if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
 extern "C" int close(int fildes)
 {
+    fd_buffer_close(fildes);
     FileHandle *fhc = mbed_file_handle(fildes);
     filehandles[fildes] = NULL;
     if (fhc == NULL) {
@@ -772,7 +779,7 @@ finish:
 #endif
 }
 
-extern "C" ssize_t write(int fildes, const void *buf, size_t length)
+static ssize_t write_unbuffered(int fildes, const void *buf, size_t length)
 {
 #if MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
     if (fildes != STDOUT_FILENO && fildes != STDERR_FILENO) {
@@ -804,6 +811,136 @@ extern "C" ssize_t write(int fildes, const void *buf, size_t length)
     }
 }
 
+#if MBED_CONF_PLATFORM_STDIO_FD_BUFFERING
+/* Userspace output buffering below the C library, so that it also covers
+ * streams newlib leaves unbuffered and direct POSIX write() calls.
+ */
+static mbed::internal::FdBufferTable<RETARGET_OPEN_MAX> fd_buffers;
+static SingletonPtr<PlatformMutex> fd_buffer_mutex;
+
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+static char stdout_buffer[MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE];
+static bool stdout_buffer_init;
+#endif
+
+static bool fd_buffer_usable()
+{
+    // Locking is not allowed here; stay unbuffered so output is not lost
+    return !core_util_is_isr_active() && core_util_are_interrupts_enabled() && !mbed_get_error_in_progress();
+}
+
+static void fd_buffer_lazy_init()
+{
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+    if (!stdout_buffer_init) {
+        stdout_buffer_init = true;
+        fd_buffers.setvbuf(STDOUT_FILENO, stdout_buffer, MBED_CONF_PLATFORM_STDIO_BUFFER_MODE, sizeof stdout_buffer, write_unbuffered);
+    }
+#endif
+}
+
+/* Whether writes to a descriptor have to go through fd_buffers */
+static bool fd_buffer_in_use(int fildes)
+{
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+    if (fildes == STDOUT_FILENO && !stdout_buffer_init) {
+        return true;
+    }
+#endif
+    return fd_buffers.buffered(fildes);
+}
+
+static int fd_buffer_flush(int fildes)
+{
+    if (!fd_buffer_usable()) {
+        return fd_buffers.flush(fildes, write_unbuffered);
+    }
+    fd_buffer_mutex->lock();
+    int err = fd_buffers.flush(fildes, write_unbuffered);
+    fd_buffer_mutex->unlock();
+    return err;
+}
+
+#if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
+static int fd_buffer_close(int fildes)
+{
+    if (!fd_buffer_usable()) {
+        return fd_buffers.close(fildes, write_unbuffered);
+    }
+    fd_buffer_mutex->lock();
+    int err = fd_buffers.close(fildes, write_unbuffered);
+    fd_buffer_mutex->unlock();
+    return err;
+}
+#endif
+
+extern "C" int mbed_fd_setvbuf(int fildes, char *buf, int mode, size_t size)
+{
+    if ((mode != _IONBF && mode != _IOLBF && mode != _IOFBF) || (mode != _IONBF && buf == NULL && size)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    fd_buffer_mutex->lock();
+    fd_buffer_lazy_init();
+    int err = fd_buffers.setvbuf(fildes, buf, mode, mode == _IONBF ? 0 : size, write_unbuffered);
+    fd_buffer_mutex->unlock();
+    return err;
+}
+
+extern "C" void mbed_fd_flush_all(void)
+{
+    // Called on error paths; take no locks and ignore failures
+    fd_buffers.flush_all(write_unbuffered);
+}
+
+extern "C" ssize_t write(int fildes, const void *buf, size_t length)
+{
+    if (!fd_buffer_usable()) {
+        return fd_buffers.write(fildes, buf, length, write_unbuffered, false);
+    }
+
+    // Unbuffered descriptors hold nothing to keep in order with, so they
+    // need not wait for writes to other descriptors
+    if (!fd_buffer_in_use(fildes)) {
+        return write_unbuffered(fildes, buf, length);
+    }
+
+    fd_buffer_mutex->lock();
+    fd_buffer_lazy_init();
+    ssize_t ret = fd_buffers.write(fildes, buf, length, write_unbuffered, true);
+    fd_buffer_mutex->unlock();
+    return ret;
+}
+#else
+static int fd_buffer_flush(int fildes)
+{
+    return 0;
+}
+
+#if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
+static int fd_buffer_close(int fildes)
+{
+    return 0;
+}
+#endif
+
+extern "C" int mbed_fd_setvbuf(int fildes, char *buf, int mode, size_t size)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+extern "C" void mbed_fd_flush_all(void)
+{
+}
+
+extern "C" ssize_t write(int fildes, const void *buf, size_t length)
+{
+    return write_unbuffered(fildes, buf, length);
+}
+#endif // MBED_CONF_PLATFORM_STDIO_FD_BUFFERING
+
 #if MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
 /* Write one character to a serial interface */
 MBED_WEAK int mbed::minimal_console_putc(int c)
@@ -895,6 +1032,11 @@ extern "C" int PREFIX(_read)(FILEHANDLE fh, unsigned char *buffer, unsigned int
 
 extern "C" ssize_t read(int fildes, void *buf, size_t length)
 {
+    // Make sure any prompt is visible before blocking for input
+    if (fildes == STDIN_FILENO) {
+        fd_buffer_flush(STDOUT_FILENO);
+    }
+
 #if MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
     if (fildes != STDIN_FILENO && fildes != STDERR_FILENO) {
         errno = EBADF;
@@ -1048,6 +1190,10 @@ extern "C" int PREFIX(_ensure)(FILEHANDLE fh)
 extern "C" int fsync(int fildes)
 {
 #if !MBED_CONF_PLATFORM_STDIO_MINIMAL_CONSOLE_ONLY
+    if (fd_buffer_flush(fildes) < 0) {
+        return -1;
+    }
+
     FileHandle *fhc = mbed_file_handle(fildes);
     if (fhc == NULL) {
         errno = EBADF;
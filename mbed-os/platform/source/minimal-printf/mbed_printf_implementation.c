@@ -0,0 +1,578 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017-2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed_printf_implementation.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT
+#include <math.h>
+#endif
+
+/* Integer arithmetic is done in the widest type enabled in the feature set,
+ * so 64-bit division helpers are not pulled in unless required.
+ */
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+typedef int64_t mbed_signed_integer_t;
+typedef uint64_t mbed_unsigned_integer_t;
+#define MBED_UNSIGNED_INTEGER_MAX UINT64_MAX
+/* Longest integer is a 64-bit value printed in octal */
+#define MBED_INTEGER_DIGITS_MAX 22
+#else
+typedef int32_t mbed_signed_integer_t;
+typedef uint32_t mbed_unsigned_integer_t;
+#define MBED_UNSIGNED_INTEGER_MAX UINT32_MAX
+#define MBED_INTEGER_DIGITS_MAX 11
+#endif
+
+#define FLAG_LEFT   0x01
+#define FLAG_PLUS   0x02
+#define FLAG_SPACE  0x04
+#define FLAG_ALT    0x08
+#define FLAG_ZERO   0x10
+#define FLAG_UPPER  0x20
+#define FLAG_PREFIX 0x40
+
+typedef enum {
+    LENGTH_NONE,
+    LENGTH_HH,
+    LENGTH_H,
+    LENGTH_L,
+    LENGTH_LL,
+    LENGTH_J,
+    LENGTH_Z,
+    LENGTH_T,
+    LENGTH_CAPITAL_L
+} length_t;
+
+typedef struct {
+    mbed_minimal_printf_sink_t sink;
+    void *context;
+    int result;
+    size_t used;
+    char chunk[MBED_MINIMAL_PRINTF_CHUNK_SIZE];
+} printf_state_t;
+
+static void mbed_minimal_flush(printf_state_t *state)
+{
+    if (state->used && state->result >= 0) {
+        if (state->sink(state->context, state->chunk, state->used) < 0) {
+            state->result = -1;
+        }
+    }
+    state->used = 0;
+}
+
+static void mbed_minimal_putchar(printf_state_t *state, char c)
+{
+    if (state->result < 0) {
+        return;
+    }
+    state->chunk[state->used++] = c;
+    state->result++;
+    if (state->used == sizeof(state->chunk)) {
+        mbed_minimal_flush(state);
+    }
+}
+
+static void mbed_minimal_putrepeat(printf_state_t *state, char c, int count)
+{
+    while (count-- > 0) {
+        mbed_minimal_putchar(state, c);
+    }
+}
+
+static void mbed_minimal_putstring(printf_state_t *state, const char *str, size_t length)
+{
+    if (state->result < 0) {
+        return;
+    }
+    if (length < sizeof(state->chunk)) {
+        while (length--) {
+            mbed_minimal_putchar(state, *str++);
+        }
+        return;
+    }
+    /* Long strings go straight to the sink rather than through the chunk */
+    mbed_minimal_flush(state);
+    if (state->result >= 0) {
+        if (state->sink(state->context, str, length) < 0) {
+            state->result = -1;
+        } else {
+            state->result += length;
+        }
+    }
+}
+
+static void mbed_minimal_format_integer(printf_state_t *state, mbed_unsigned_integer_t value, bool negative,
+                                        unsigned base, int flags, int width, int precision)
+{
+    const char *symbols = (flags & FLAG_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char digits[MBED_INTEGER_DIGITS_MAX];
+    int count = 0;
+    bool zero_value = (value == 0);
+
+    while (value) {
+        digits[count++] = symbols[value % base];
+        value /= base;
+    }
+
+    /* Precision is the minimum number of digits, 0 prints nothing for 0 */
+    int zeros = 0;
+    if (precision >= 0) {
+        if (precision > count) {
+            zeros = precision - count;
+        }
+    } else if (count == 0) {
+        zeros = 1;
+    }
+
+    char prefix[2];
+    int prefix_length = 0;
+    if (negative) {
+        prefix[prefix_length++] = '-';
+    } else if (flags & FLAG_PLUS) {
+        prefix[prefix_length++] = '+';
+    } else if (flags & FLAG_SPACE) {
+        prefix[prefix_length++] = ' ';
+    }
+
+    if ((flags & FLAG_ALT) && base == 8 && zeros == 0) {
+        zeros = 1;
+    }
+    if (((flags & FLAG_ALT) && base == 16 && !zero_value) || (flags & FLAG_PREFIX)) {
+        prefix[prefix_length++] = '0';
+        prefix[prefix_length++] = (flags & FLAG_UPPER) ? 'X' : 'x';
+    }
+
+    int padding = width - (prefix_length + zeros + count);
+    if (!(flags & FLAG_LEFT)) {
+        if ((flags & FLAG_ZERO) && precision < 0) {
+            zeros += padding;
+        } else {
+            mbed_minimal_putrepeat(state, ' ', padding);
+        }
+        padding = 0;
+    }
+    mbed_minimal_putstring(state, prefix, prefix_length);
+    mbed_minimal_putrepeat(state, '0', zeros);
+    while (count) {
+        mbed_minimal_putchar(state, digits[--count]);
+    }
+    mbed_minimal_putrepeat(state, ' ', padding);
+}
+
+static void mbed_minimal_format_padded(printf_state_t *state, const char *str, size_t length, int flags, int width)
+{
+    int padding = width - (int)length;
+    if (!(flags & FLAG_LEFT)) {
+        mbed_minimal_putrepeat(state, ' ', padding);
+        padding = 0;
+    }
+    mbed_minimal_putstring(state, str, length);
+    mbed_minimal_putrepeat(state, ' ', padding);
+}
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT
+/* Fixed point notation. Exact ties round half to even, as the C library does.
+ * Values too large for the integer type have their least significant integer
+ * digits printed as 0.
+ */
+static void mbed_minimal_format_double(printf_state_t *state, double value, int flags, int width, int precision)
+{
+    bool negative = signbit(value);
+    if (negative) {
+        value = -value;
+    }
+
+    char sign = 0;
+    if (negative) {
+        sign = '-';
+    } else if (flags & FLAG_PLUS) {
+        sign = '+';
+    } else if (flags & FLAG_SPACE) {
+        sign = ' ';
+    }
+
+    if (isnan(value) || isinf(value)) {
+        char special[4];
+        int length = 0;
+        if (sign) {
+            special[length++] = sign;
+        }
+        const char *text = isnan(value) ? ((flags & FLAG_UPPER) ? "NAN" : "nan") : ((flags & FLAG_UPPER) ? "INF" : "inf");
+        memcpy(special + length, text, 3);
+        mbed_minimal_format_padded(state, special, length + 3, flags, width);
+        return;
+    }
+
+    if (precision < 0) {
+        precision = 6;
+    }
+    if (precision > MBED_CONF_PLATFORM_MINIMAL_PRINTF_SET_FLOATING_POINT_MAX_DECIMALS) {
+        precision = MBED_CONF_PLATFORM_MINIMAL_PRINTF_SET_FLOATING_POINT_MAX_DECIMALS;
+    }
+
+    mbed_unsigned_integer_t scale = 1;
+    for (int i = 0; i < precision; i++) {
+        scale *= 10;
+    }
+
+    int trailing_zeros = 0;
+    while (value >= (double)MBED_UNSIGNED_INTEGER_MAX / 2) {
+        value /= 10;
+        trailing_zeros++;
+    }
+
+    mbed_unsigned_integer_t integer = (mbed_unsigned_integer_t)value;
+    mbed_unsigned_integer_t fraction = 0;
+    if (!trailing_zeros) {
+        double scaled = (value - (double)integer) * (double)scale;
+        fraction = (mbed_unsigned_integer_t)scaled;
+        double rest = scaled - (double)fraction;
+        if (rest > 0.5 || (rest == 0.5 && ((precision ? fraction : integer) & 1))) {
+            fraction++;
+        }
+        if (fraction >= scale) {
+            integer++;
+            fraction -= scale;
+        }
+    }
+
+    char digits[MBED_INTEGER_DIGITS_MAX];
+    int count = 0;
+    do {
+        digits[count++] = '0' + (integer % 10);
+        integer /= 10;
+    } while (integer);
+
+    bool point = precision > 0 || (flags & FLAG_ALT);
+    int padding = width - ((sign ? 1 : 0) + count + trailing_zeros + (point ? 1 : 0) + precision);
+    int zeros = 0;
+    if (!(flags & FLAG_LEFT)) {
+        if (flags & FLAG_ZERO) {
+            zeros = padding;
+        } else {
+            mbed_minimal_putrepeat(state, ' ', padding);
+        }
+        padding = 0;
+    }
+    if (sign) {
+        mbed_minimal_putchar(state, sign);
+    }
+    mbed_minimal_putrepeat(state, '0', zeros);
+    while (count) {
+        mbed_minimal_putchar(state, digits[--count]);
+    }
+    mbed_minimal_putrepeat(state, '0', trailing_zeros);
+    if (point) {
+        mbed_minimal_putchar(state, '.');
+    }
+    for (int i = precision; i > 0; i--) {
+        scale /= 10;
+        mbed_minimal_putchar(state, '0' + (fraction / scale) % 10);
+    }
+    mbed_minimal_putrepeat(state, ' ', padding);
+}
+#endif
+
+int mbed_minimal_formatted_string_to_sink(mbed_minimal_printf_sink_t sink, void *context, const char *format, va_list arguments)
+{
+    printf_state_t state;
+    state.sink = sink;
+    state.context = context;
+    state.result = 0;
+    state.used = 0;
+
+    /* va_list may be an array type, so take a copy that can be passed by pointer */
+    va_list args;
+    va_copy(args, arguments);
+
+    const char *literal = format;
+    while (*format && state.result >= 0) {
+        if (*format != '%') {
+            format++;
+            continue;
+        }
+        mbed_minimal_putstring(&state, literal, format - literal);
+        const char *spec = format++;
+
+        int flags = 0;
+        for (;; format++) {
+            if (*format == '-') {
+                flags |= FLAG_LEFT;
+            } else if (*format == '+') {
+                flags |= FLAG_PLUS;
+            } else if (*format == ' ') {
+                flags |= FLAG_SPACE;
+            } else if (*format == '#') {
+                flags |= FLAG_ALT;
+            } else if (*format == '0') {
+                flags |= FLAG_ZERO;
+            } else {
+                break;
+            }
+        }
+
+        int width = 0;
+        if (*format == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            format++;
+        } else {
+            while (*format >= '0' && *format <= '9') {
+                width = width * 10 + (*format++ - '0');
+            }
+        }
+
+        int precision = -1;
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                precision = va_arg(args, int);
+                if (precision < 0) {
+                    precision = -1;
+                }
+                format++;
+            } else {
+                while (*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format++ - '0');
+                }
+            }
+        }
+
+        length_t length = LENGTH_NONE;
+        if (*format == 'h') {
+            format++;
+            length = LENGTH_H;
+            if (*format == 'h') {
+                format++;
+                length = LENGTH_HH;
+            }
+        } else if (*format == 'l') {
+            format++;
+            length = LENGTH_L;
+            if (*format == 'l') {
+                format++;
+                length = LENGTH_LL;
+            }
+        } else if (*format == 'j') {
+            format++;
+            length = LENGTH_J;
+        } else if (*format == 'z') {
+            format++;
+            length = LENGTH_Z;
+        } else if (*format == 't') {
+            format++;
+            length = LENGTH_T;
+        } else if (*format == 'L') {
+            format++;
+            length = LENGTH_CAPITAL_L;
+        }
+
+        char conversion = *format;
+        if (conversion) {
+            format++;
+        }
+
+        switch (conversion) {
+            case 'd':
+            case 'i': {
+                mbed_signed_integer_t value;
+                switch (length) {
+                    case LENGTH_HH:
+                        value = (signed char) va_arg(args, int);
+                        break;
+                    case LENGTH_H:
+                        value = (short) va_arg(args, int);
+                        break;
+                    case LENGTH_L:
+                        value = va_arg(args, long);
+                        break;
+                    case LENGTH_LL:
+                        value = va_arg(args, long long);
+                        break;
+                    case LENGTH_J:
+                        value = va_arg(args, intmax_t);
+                        break;
+                    case LENGTH_Z:
+                    case LENGTH_T:
+                        value = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, int);
+                        break;
+                }
+                mbed_unsigned_integer_t magnitude = value < 0 ? (mbed_unsigned_integer_t)0 - (mbed_unsigned_integer_t)value
+                                                    : (mbed_unsigned_integer_t)value;
+                mbed_minimal_format_integer(&state, magnitude, value < 0, 10, flags, width, precision);
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X': {
+                mbed_unsigned_integer_t value;
+                switch (length) {
+                    case LENGTH_HH:
+                        value = (unsigned char) va_arg(args, unsigned int);
+                        break;
+                    case LENGTH_H:
+                        value = (unsigned short) va_arg(args, unsigned int);
+                        break;
+                    case LENGTH_L:
+                        value = va_arg(args, unsigned long);
+                        break;
+                    case LENGTH_LL:
+                        value = va_arg(args, unsigned long long);
+                        break;
+                    case LENGTH_J:
+                        value = va_arg(args, uintmax_t);
+                        break;
+                    case LENGTH_Z:
+                    case LENGTH_T:
+                        value = va_arg(args, size_t);
+                        break;
+                    default:
+                        value = va_arg(args, unsigned int);
+                        break;
+                }
+                unsigned base = conversion == 'u' ? 10 : conversion == 'o' ? 8 : 16;
+                flags &= ~(FLAG_PLUS | FLAG_SPACE);
+                if (conversion == 'X') {
+                    flags |= FLAG_UPPER;
+                }
+                mbed_minimal_format_integer(&state, value, false, base, flags, width, precision);
+                break;
+            }
+            case 'p': {
+                uintptr_t value = (uintptr_t) va_arg(args, void *);
+                flags &= ~(FLAG_PLUS | FLAG_SPACE | FLAG_ALT);
+                mbed_minimal_format_integer(&state, value, false, 16, flags | FLAG_PREFIX, width, precision);
+                break;
+            }
+            case 'c': {
+                char c = (char) va_arg(args, int);
+                mbed_minimal_format_padded(&state, &c, 1, flags, width);
+                break;
+            }
+            case 's': {
+                const char *str = va_arg(args, const char *);
+                if (!str) {
+                    str = "(null)";
+                }
+                size_t str_length = 0;
+                while (str[str_length] && (precision < 0 || str_length < (size_t)precision)) {
+                    str_length++;
+                }
+                mbed_minimal_format_padded(&state, str, str_length, flags, width);
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G': {
+                double value;
+                if (length == LENGTH_CAPITAL_L) {
+                    value = (double) va_arg(args, long double);
+                } else {
+                    value = va_arg(args, double);
+                }
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT
+                if (conversion == 'f' || conversion == 'F') {
+                    if (conversion == 'F') {
+                        flags |= FLAG_UPPER;
+                    }
+                    mbed_minimal_format_double(&state, value, flags, width, precision);
+                    break;
+                }
+#endif
+                /* Exponent notations are not supported, print the specification as is */
+                (void) value;
+                mbed_minimal_putstring(&state, spec, format - spec);
+                break;
+            }
+            case '%':
+                mbed_minimal_putchar(&state, '%');
+                break;
+            case 'n':
+                /* Writing back through the argument list is not supported */
+                (void) va_arg(args, int *);
+                break;
+            default:
+                /* Unsupported conversion, print the specification as is */
+                mbed_minimal_putstring(&state, spec, format - spec);
+                break;
+        }
+        literal = format;
+    }
+    mbed_minimal_putstring(&state, literal, format - literal);
+    mbed_minimal_flush(&state);
+
+    va_end(args);
+
+    return state.result;
+}
+
+typedef struct {
+    char *buffer;
+    size_t length;
+    size_t position;
+} buffer_sink_t;
+
+static int mbed_minimal_buffer_sink(void *context, const char *data, size_t size)
+{
+    buffer_sink_t *dest = (buffer_sink_t *) context;
+    /* Keep room for the null terminator and silently truncate the rest */
+    if (dest->position + 1 < dest->length) {
+        size_t space = dest->length - 1 - dest->position;
+        memcpy(dest->buffer + dest->position, data, size < space ? size : space);
+    }
+    dest->position += size;
+    return 0;
+}
+
+static int mbed_minimal_stream_sink(void *context, const char *data, size_t size)
+{
+    return fwrite(data, 1, size, (FILE *) context) == size ? 0 : -1;
+}
+
+int mbed_minimal_formatted_string(char *buffer, size_t length, const char *format, va_list arguments, FILE *stream)
+{
+    if (stream) {
+        return mbed_minimal_formatted_string_to_sink(mbed_minimal_stream_sink, stream, format, arguments);
+    }
+
+    buffer_sink_t dest;
+    dest.buffer = buffer;
+    dest.length = buffer ? length : 0;
+    dest.position = 0;
+
+    int result = mbed_minimal_formatted_string_to_sink(mbed_minimal_buffer_sink, &dest, format, arguments);
+
+    if (dest.length) {
+        buffer[dest.position < dest.length ? dest.position : dest.length - 1] = '\0';
+    }
+    return result;
+}
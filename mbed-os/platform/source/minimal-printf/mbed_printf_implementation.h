@@ -0,0 +1,96 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017-2019 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PRINTF_IMPLEMENTATION_H
+#define MBED_PRINTF_IMPLEMENTATION_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \ingroup mbed-os-internal */
+/** \addtogroup platform-internal-api */
+/** @{*/
+
+/* Feature set, selected at compile time through the platform configuration */
+#ifndef MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+#define MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT 1
+#endif
+
+#ifndef MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT
+#define MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_FLOATING_POINT 0
+#endif
+
+#ifndef MBED_CONF_PLATFORM_MINIMAL_PRINTF_SET_FLOATING_POINT_MAX_DECIMALS
+#define MBED_CONF_PLATFORM_MINIMAL_PRINTF_SET_FLOATING_POINT_MAX_DECIMALS 6
+#endif
+
+/* Size of the on-stack staging buffer handed to the sink in one go */
+#ifndef MBED_MINIMAL_PRINTF_CHUNK_SIZE
+#define MBED_MINIMAL_PRINTF_CHUNK_SIZE 32
+#endif
+
+/*
+ * Output sink for the streaming formatter
+ *
+ * @param context   opaque pointer passed through from the caller
+ * @param data      chunk of formatted output, not null terminated
+ * @param size      number of bytes in the chunk
+ * @return          0 on success, negative on failure to stop formatting
+ */
+typedef int (*mbed_minimal_printf_sink_t)(void *context, const char *data, size_t size);
+
+/*
+ * Format a string into a buffer or onto a stdio stream
+ *
+ * Neither the heap nor newlib's printf is used, and stack usage is bounded.
+ * Floating point is printed with %f and %F only; %e, %E, %g and %G, like
+ * other unsupported conversions, are output as written in the format.
+ *
+ * @param buffer    destination buffer, used when stream is NULL
+ * @param length    size of the buffer including the null terminator
+ * @param format    printf-style format string
+ * @param arguments arguments for the format string
+ * @param stream    stdio stream to write to, or NULL to write into buffer
+ * @return          number of characters that the full output contains
+ */
+int mbed_minimal_formatted_string(char *buffer, size_t length, const char *format, va_list arguments, FILE *stream);
+
+/*
+ * Format a string and stream it in chunks to a sink
+ *
+ * Output is staged in a small on-stack buffer of MBED_MINIMAL_PRINTF_CHUNK_SIZE
+ * bytes and handed to the sink when full and at the end of formatting.
+ *
+ * @param sink      function receiving the formatted chunks
+ * @param context   opaque pointer passed to the sink
+ * @param format    printf-style format string
+ * @param arguments arguments for the format string
+ * @return          number of characters output, or negative if the sink failed
+ */
+int mbed_minimal_formatted_string_to_sink(mbed_minimal_printf_sink_t sink, void *context, const char *format, va_list arguments);
+
+/** @}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MBED_PRINTF_IMPLEMENTATION_H
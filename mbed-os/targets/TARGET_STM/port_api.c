@@ -27,6 +27,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *******************************************************************************
  */
+#include <stddef.h>
 #include "port_api.h"
 #include "pinmap.h"
 #include "gpio_api.h"
@@ -43,6 +44,16 @@ PinName port_pin(PortName port, int pin_n)
     return (PinName)(pin_n + (port << 4));
 }
 
+bool port_pin_lookup(PinName pin, PortName *port, int *pin_n)
+{
+    if (pin == NC) {
+        return false;
+    }
+    *port = (PortName)STM_PORT(pin);
+    *pin_n = STM_PIN(pin);
+    return true;
+}
+
 void port_init(port_t *obj, PortName port, int mask, PinDirection dir)
 {
     uint32_t port_index = (uint32_t)port;
@@ -87,7 +98,10 @@ void port_mode(port_t *obj, PinMode mode)
 
 void port_write(port_t *obj, int value)
 {
-    *obj->reg_out = (*obj->reg_out & ~obj->mask) | (value & obj->mask);
+    // Set and reset the pins with one BSRR write rather than a read-modify-write
+    // of ODR, so that a concurrent change to another pin of the port is kept
+    GPIO_TypeDef *gpio = (GPIO_TypeDef *)((uintptr_t)obj->reg_out - offsetof(GPIO_TypeDef, ODR));
+    gpio->BSRR = (value & obj->mask) | ((~value & obj->mask) << 16);
 }
 
 int port_read(port_t *obj)